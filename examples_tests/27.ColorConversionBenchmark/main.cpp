@@ -0,0 +1,106 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace video;
+
+//! Converts every format pair IVideoDriver::convertColor supports, once per instruction set level,
+//! prints the throughput and checks the vectorized results against the scalar ones.
+
+#define PIXEL_COUNT (1024*1024+13) // odd count so the scalar tails get exercised too
+#define REPETITIONS 32
+
+struct SLevel
+{
+	const char* name;
+	SCPUFeatures features;
+};
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<uint32_t>(64, 64);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+	IVideoDriver* driver = device->getVideoDriver();
+
+	const ECOLOR_FORMAT formats[] = {ECF_A1R5G5B5,ECF_R5G6B5,ECF_A8R8G8B8,ECF_R8G8B8,ECF_R8G8B8A8};
+	const char* formatNames[] = {"A1R5G5B5","R5G6B5","A8R8G8B8","R8G8B8","R8G8B8A8"};
+	const uint32_t formatCount = sizeof(formats)/sizeof(ECOLOR_FORMAT);
+
+	const SCPUFeatures& detected = SCPUFeatures::detect();
+	std::vector<SLevel> levels;
+	{
+		SLevel scalar = {"scalar",SCPUFeatures()};
+		levels.push_back(scalar);
+
+		SLevel ssse3 = {"SSSE3",SCPUFeatures()};
+		ssse3.features.SSE2 = ssse3.features.SSE3 = ssse3.features.SSSE3 = true;
+		if (detected.SSSE3)
+			levels.push_back(ssse3);
+
+		SLevel avx2 = {"AVX2",detected};
+		if (detected.AVX2)
+			levels.push_back(avx2);
+	}
+
+	std::vector<uint8_t> source(PIXEL_COUNT*4);
+	srand(0x45u);
+	for (size_t i=0; i<source.size(); i++)
+		source[i] = rand();
+	std::vector<uint8_t> reference(PIXEL_COUNT*4);
+	std::vector<uint8_t> result(PIXEL_COUNT*4);
+
+	printf("%-10s -> %-10s","from","to");
+	for (size_t l=0; l<levels.size(); l++)
+		printf(" %12s",levels[l].name);
+	printf("   (MPixels/s)\n");
+
+	bool allExact = true;
+	for (uint32_t i=0; i<formatCount; i++)
+	for (uint32_t j=0; j<formatCount; j++)
+	{
+		// R8G8B8A8 is only reachable from and to the 32 and 24 bit formats
+		if ((formats[i]==ECF_R8G8B8A8||formats[j]==ECF_R8G8B8A8)&&(getBitsPerPixelFromFormat(formats[i])<24u||getBitsPerPixelFromFormat(formats[j])<24u))
+			continue;
+
+		const size_t outSize = size_t(PIXEL_COUNT)*getBitsPerPixelFromFormat(formats[j])/8;
+		printf("%-10s -> %-10s",formatNames[i],formatNames[j]);
+		for (size_t l=0; l<levels.size(); l++)
+		{
+			SCPUFeatures::setAllowed(levels[l].features);
+			uint8_t* out = l ? result.data():reference.data();
+			memset(out,0,outSize);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t r=0; r<REPETITIONS; r++)
+				driver->convertColor(source.data(),formats[i],PIXEL_COUNT,out,formats[j]);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			const double seconds = std::chrono::duration<double>(end-start).count();
+			printf(" %12.1f",double(PIXEL_COUNT)*REPETITIONS/seconds*0.000001);
+
+			if (l&&memcmp(reference.data(),result.data(),outSize)!=0)
+			{
+				printf(" (MISMATCH)");
+				allExact = false;
+			}
+		}
+		printf("\n");
+	}
+	SCPUFeatures::setAllowed(detected);
+
+	printf(allExact ? "All vectorized conversions match the scalar ones.\n":"Vectorized conversions DIFFER from the scalar ones!\n");
+
+	device->drop();
+	return allExact ? 0:1;
+}
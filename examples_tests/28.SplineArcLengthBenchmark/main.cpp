@@ -0,0 +1,110 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+
+//! Compares CQuadraticSpline position queries with the Newton-Raphson arc length solver
+//! against the precomputed arc length tables, both one at a time and batched.
+
+#define CONTROL_POINT_COUNT 256
+#define QUERY_COUNT (1024*1024)
+
+struct SResult
+{
+	double milliseconds;
+	double maxError;
+	double avgError;
+};
+
+template<class F>
+SResult measure(F query, const std::vector<vectorSIMDf>& reference, std::vector<vectorSIMDf>& positions)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	query();
+	auto end = std::chrono::high_resolution_clock::now();
+
+	SResult result;
+	result.milliseconds = std::chrono::duration<double,std::milli>(end-start).count();
+	result.maxError = 0.0;
+	result.avgError = 0.0;
+	for (size_t i=0; i<positions.size(); i++)
+	{
+		double error = (positions[i]-reference[i]).getLengthAsFloat();
+		result.maxError = core::max_(result.maxError,error);
+		result.avgError += error;
+	}
+	result.avgError /= double(positions.size());
+	return result;
+}
+
+void print(const char* name, const SResult& result)
+{
+	printf("%-28s %10.2f ms %10.2f MQueries/s   max error %.6f avg error %.6f\n",name,result.milliseconds,
+			double(QUERY_COUNT)/result.milliseconds*0.001,result.maxError,result.avgError);
+}
+
+int main()
+{
+	srand(0x45u);
+	std::vector<vectorSIMDf> controlPoints(CONTROL_POINT_COUNT);
+	for (size_t i=0; i<controlPoints.size(); i++)
+		controlPoints[i] = vectorSIMDf(rand()%256,rand()%256,rand()%256);
+
+	CQuadraticBSpline spline(controlPoints.data(),controlPoints.size());
+
+	//! random (segment,distance) pairs, all within their segment so every query succeeds
+	std::vector<uint32_t> segmentIDs(QUERY_COUNT);
+	std::vector<float> distances(QUERY_COUNT);
+	for (size_t i=0; i<QUERY_COUNT; i++)
+	{
+		segmentIDs[i] = rand()%spline.getSegmentCount();
+		distances[i] = float(rand())/float(RAND_MAX)*spline.getSegmentLength(segmentIDs[i])*0.999f;
+	}
+
+	std::vector<vectorSIMDf> reference(QUERY_COUNT);
+	std::vector<vectorSIMDf> positions(QUERY_COUNT);
+	std::vector<uint32_t> outSegments(QUERY_COUNT);
+
+	//! tight solver threshold as ground truth
+	for (size_t i=0; i<QUERY_COUNT; i++)
+	{
+		float distance = distances[i];
+		spline.getPos(reference[i],distance,segmentIDs[i],NULL,0.0001f);
+	}
+
+	auto singleQueries = [&]()
+	{
+		for (size_t i=0; i<QUERY_COUNT; i++)
+		{
+			float distance = distances[i];
+			spline.getPos(positions[i],distance,segmentIDs[i]);
+		}
+	};
+	auto batchQuery = [&]()
+	{
+		spline.getPosBatch(positions.data(),outSegments.data(),segmentIDs.data(),distances.data(),QUERY_COUNT);
+	};
+
+	print("getPos, solver",measure(singleQueries,reference,positions));
+	print("getPosBatch, solver",measure(batchQuery,reference,positions));
+
+	const float maxErrors[] = {0.01f,0.001f};
+	for (size_t i=0; i<sizeof(maxErrors)/sizeof(float); i++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		const float achieved = spline.buildArcLengthTables(maxErrors[i]);
+		auto end = std::chrono::high_resolution_clock::now();
+		printf("\nTables for max error %.4f built in %.2f ms, achieved %.6f\n",maxErrors[i],std::chrono::duration<double,std::milli>(end-start).count(),achieved);
+
+		print("getPos, tables",measure(singleQueries,reference,positions));
+		print("getPosBatch, tables",measure(batchQuery,reference,positions));
+	}
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+//! Writes a few hundred binary STL files, loads them one after another with ISceneManager::getMesh,
+//! then again all at once with ISceneManager::getMeshAsync and prints both wall times.
+//! Every file is requested twice asynchronously to check the duplicate requests get merged, the mesh cache's
+//! hit counter tells the second requests which found the load still running from the ones served by the cache.
+//! Then checks that a relative and an absolute path to one file share a load, and that an OBJ file,
+//! whose loader is not IMeshLoader::isReentrant(), gets loaded on the calling thread.
+
+#define MESH_COUNT 384
+#define TRIANGLES_PER_MESH 8192
+
+static void writeSTL(io::IFileSystem* fs, const io::path& filename, uint32_t seed)
+{
+	io::IWriteFile* file = fs->createAndWriteFile(filename);
+	if (!file)
+		return;
+
+	// binary STL headers must not start with "solid"
+	char header[80] = "binary";
+	file->write(header,sizeof(header));
+	const uint32_t triangleCount = TRIANGLES_PER_MESH;
+	file->write(&triangleCount,4);
+
+	std::vector<uint8_t> triangles(TRIANGLES_PER_MESH*50);
+	for (uint32_t i=0; i<TRIANGLES_PER_MESH; i++)
+	{
+		float facet[12];
+		for (uint32_t j=0; j<12; j++)
+			facet[j] = float((i*7u+j*13u+seed)%97u);
+		memcpy(triangles.data()+i*50,facet,sizeof(facet));
+		memset(triangles.data()+i*50+sizeof(facet),0,2);
+	}
+	file->write(triangles.data(),triangles.size());
+	file->drop();
+}
+
+static bool isReady(const std::shared_future<ICPUMesh*>& future)
+{
+	return future.wait_for(std::chrono::seconds(0))==std::future_status::ready;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<uint32_t>(64, 64);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+	device->getLogger()->setLogLevel(ELL_WARNING);
+
+	io::IFileSystem* fs = device->getFileSystem();
+	ISceneManager* smgr = device->getSceneManager();
+
+	std::vector<io::path> filenames;
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+	{
+		char name[64];
+		sprintf(name,"asyncMeshLoading_%03d.stl",i);
+		filenames.push_back(fs->getAbsolutePath(name));
+		writeSTL(fs,filenames.back(),i);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	uint32_t serialFailed = 0;
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+	{
+		if (!smgr->getMesh(filenames[i]))
+			serialFailed++;
+	}
+	const double serialTime = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+
+	IMeshCache<ICPUMesh>* cache = smgr->getMeshCache();
+	cache->clear();
+	cache->resetStatistics();
+
+	start = std::chrono::high_resolution_clock::now();
+	std::vector<std::shared_future<ICPUMesh*> > requests;
+	for (uint32_t r=0; r<2; r++)
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+		requests.push_back(smgr->getMeshAsync(filenames[i]));
+
+	uint32_t asyncFailed = 0, notMerged = 0;
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+	{
+		ICPUMesh* mesh = requests[i].get();
+		if (!mesh)
+			asyncFailed++;
+		else if (mesh!=requests[i+MESH_COUNT].get())
+			notMerged++;
+	}
+	const double asyncTime = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+
+	// a first request misses the cache and queues the load, a second one either finds the load running
+	// and gets merged into it without looking at the cache, or comes after it finished and hits the cache
+	const SMeshCacheStatistics afterRequests = cache->getStatistics();
+	const uint32_t merged = MESH_COUNT-uint32_t(afterRequests.Hits);
+	uint32_t checksFailed = 0;
+	if (afterRequests.Misses!=MESH_COUNT||cache->getMeshCount()!=MESH_COUNT)
+		checksFailed++;
+
+	// everything is loaded now, so all of these must be cache hits which are ready right away
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+	{
+		std::shared_future<ICPUMesh*> request = smgr->getMeshAsync(filenames[i]);
+		if (!isReady(request)||request.get()!=requests[i].get())
+			checksFailed++;
+	}
+	if (cache->getStatistics().Hits!=afterRequests.Hits+MESH_COUNT||cache->getStatistics().Misses!=afterRequests.Misses)
+		checksFailed++;
+
+	// relative and absolute paths to the same file share one load
+	cache->clear();
+	std::shared_future<ICPUMesh*> relative = smgr->getMeshAsync("asyncMeshLoading_000.stl");
+	std::shared_future<ICPUMesh*> absolute = smgr->getMeshAsync(filenames[0]);
+	if (!relative.get()||relative.get()!=absolute.get()||cache->getMeshCount()!=1u)
+		checksFailed++;
+
+	// the OBJ loader is not reentrant, so its files get loaded before getMeshAsync returns
+	const io::path objFilename = fs->getAbsolutePath("asyncMeshLoading.obj");
+	{
+		const char obj[] = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+		io::IWriteFile* file = fs->createAndWriteFile(objFilename);
+		if (file)
+		{
+			file->write(obj,sizeof(obj)-1);
+			file->drop();
+		}
+	}
+	std::shared_future<ICPUMesh*> obj = smgr->getMeshAsync(objFilename);
+	if (!isReady(obj)||!obj.get())
+		checksFailed++;
+
+	printf("%u meshes of %u triangles\n",MESH_COUNT,TRIANGLES_PER_MESH);
+	printf("getMesh      %10.2f ms  (%u failed)\n",serialTime,serialFailed);
+	printf("getMeshAsync %10.2f ms  (%u failed, %u duplicate loads, %u meshes cached)\n",asyncTime,asyncFailed,notMerged,MESH_COUNT);
+	printf("             %u second requests merged into running loads, %u served by the cache\n",merged,uint32_t(afterRequests.Hits));
+	printf("speedup      %10.2fx\n",serialTime/asyncTime);
+	printf("%u checks failed\n",checksFailed);
+
+	device->drop();
+
+	for (uint32_t i=0; i<MESH_COUNT; i++)
+		remove(filenames[i].c_str());
+	remove(objFilename.c_str());
+
+	return (serialFailed||asyncFailed||notMerged||checksFailed) ? 1:0;
+}
@@ -0,0 +1,97 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace video;
+
+//! Writes a set of PNG and JPG images, then decodes all of them with IVideoDriver::createImageDataFromFiles
+//! at increasing thread counts and prints the images decoded per second.
+
+#define IMAGE_COUNT 128
+#define IMAGE_SIZE 512
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<uint32_t>(64, 64);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+	device->getLogger()->setLogLevel(ELL_WARNING);
+
+	IVideoDriver* driver = device->getVideoDriver();
+	io::IFileSystem* fs = device->getFileSystem();
+
+	// smooth gradients with some noise, so neither format compresses trivially
+	std::vector<io::path> filenames;
+	srand(0x33u);
+	for (uint32_t i=0; i<IMAGE_COUNT; i++)
+	{
+		IImage* image = driver->createImage(ECF_R8G8B8,dimension2d<uint32_t>(IMAGE_SIZE,IMAGE_SIZE));
+		uint8_t* data = (uint8_t*)image->getData();
+		for (uint32_t y=0; y<IMAGE_SIZE; y++)
+		for (uint32_t x=0; x<IMAGE_SIZE; x++)
+		{
+			uint8_t* texel = data+y*image->getPitch()+x*3;
+			texel[0] = (x+i*7)&0xff;
+			texel[1] = (y+i*13)&0xff;
+			texel[2] = ((x^y)+rand()%16)&0xff;
+		}
+
+		char name[64];
+		sprintf(name,"imageDecodeBenchmark_%03d.%s",i,i&1 ? "jpg":"png");
+		filenames.push_back(fs->getAbsolutePath(name));
+		driver->writeImageToFile(image,filenames.back(),90);
+		image->drop();
+	}
+
+	std::vector<uint32_t> threadCounts;
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(),1u);
+	for (uint32_t t=1; t<hardwareThreads; t*=2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(hardwareThreads);
+
+	printf("%u images (%ux%u, half PNG half JPG)\n",IMAGE_COUNT,IMAGE_SIZE,IMAGE_SIZE);
+	printf("%8s %12s %14s\n","threads","ms","images/s");
+	bool allLoaded = true;
+	double singleThreadTime = 0.0;
+	for (size_t t=0; t<threadCounts.size(); t++)
+	{
+		std::atomic<uint32_t> callbacks(0u);
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<std::vector<CImageData*> > images = driver->createImageDataFromFiles(filenames,threadCounts[t],
+			[&](const uint32_t& index, const std::vector<CImageData*>& loaded) {callbacks++;});
+		const double time = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+		if (t==0)
+			singleThreadTime = time;
+
+		for (size_t i=0; i<images.size(); i++)
+		{
+			if (images[i].empty())
+				allLoaded = false;
+			IVideoDriver::dropWholeMipChain(images[i]);
+		}
+		if (callbacks!=IMAGE_COUNT)
+			allLoaded = false;
+
+		printf("%8u %12.2f %14.1f   (%.2fx)\n",threadCounts[t],time,IMAGE_COUNT*1000.0/time,singleThreadTime/time);
+	}
+
+	device->drop();
+
+	for (uint32_t i=0; i<IMAGE_COUNT; i++)
+		remove(filenames[i].c_str());
+
+	if (!allLoaded)
+		printf("Some images failed to load!\n");
+	return allLoaded ? 0:1;
+}
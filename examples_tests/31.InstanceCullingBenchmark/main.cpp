@@ -0,0 +1,180 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+//! Culls a million randomly placed instances against a camera frustum and picks one of three LoDs for each,
+//! first with a scalar loop like the CPUCullingFunc of 08.HardwareInstancing, then with scene::CCPUInstanceCuller
+//! at increasing thread counts. Checks the culler wrote out the same instances as the scalar loop, with the same matrices
+//! up to float rounding (the compiler is free to reorder the scalar arithmetic).
+
+#define INSTANCE_COUNT (1024*1024)
+#define LOD_COUNT 3
+#define RUNS 5
+
+static const float lodDistances[LOD_COUNT] = {20.f,60.f,120.f};
+
+//! the scalar reference, returns the number of instances written
+static size_t cullScalar(uint8_t** outputPtrs, const aabbox3df& LoDInvariantBBox, const std::vector<matrix4x3>& instances,
+						 const matrix4& ProjView, const matrix4x3& View, const matrix4x3& World)
+{
+	matrix4x3 ViewWorldMat = concatenateBFollowedByA(View,World);
+	matrix4 ProjViewWorldMat = concatenateBFollowedByA(ProjView,World);
+	matrix4x3 ViewInverse;
+	View.getInverse(ViewInverse);
+	vectorSIMDf eyePos;
+	eyePos.set(ViewInverse.getTranslation());
+
+	vectorSIMDf LoDInvariantBBoxCenter;
+	LoDInvariantBBoxCenter.set(LoDInvariantBBox.getCenter());
+
+	size_t written = 0;
+	for (size_t i=0; i<instances.size(); i++)
+	{
+		vectorSIMDf instancePos;
+		instances[i].transformVect(instancePos.pointer,LoDInvariantBBoxCenter.pointer);
+		World.transformVect(instancePos.pointer);
+
+		vectorSIMDf eyeToInstance = instancePos-eyePos;
+		float distanceToInstanceSQ = dot(eyeToInstance,eyeToInstance).X;
+
+		uint32_t instanceLoD = 0;
+		while (instanceLoD<LOD_COUNT&&distanceToInstanceSQ>=lodDistances[instanceLoD]*lodDistances[instanceLoD])
+			instanceLoD++;
+		if (instanceLoD==LOD_COUNT)
+			continue;
+
+		matrix4 instanceWorldViewProjMat = concatenateBFollowedByA(ProjViewWorldMat,instances[i]);
+		if (!instanceWorldViewProjMat.isBoxInsideFrustum(LoDInvariantBBox))
+			continue;
+
+		*reinterpret_cast<matrix4*>(outputPtrs[instanceLoD]) = instanceWorldViewProjMat;
+		*reinterpret_cast<matrix4x3*>(outputPtrs[instanceLoD]+64) = concatenateBFollowedByA(ViewWorldMat,instances[i]);
+		outputPtrs[instanceLoD] += CCPUInstanceCuller::OutputSizePerInstance;
+		written++;
+	}
+	return written;
+}
+
+static bool outputsMatch(const uint8_t* a, const uint8_t* b, const size_t& instanceCount)
+{
+	const float* fa = reinterpret_cast<const float*>(a);
+	const float* fb = reinterpret_cast<const float*>(b);
+	for (size_t i=0; i<instanceCount*CCPUInstanceCuller::OutputSizePerInstance/sizeof(float); i++)
+	{
+		if (fabsf(fa[i]-fb[i])>0.00001f*std::max(std::max(fabsf(fa[i]),fabsf(fb[i])),1.f))
+			return false;
+	}
+	return true;
+}
+
+static float randomFloat(const float& minVal, const float& maxVal)
+{
+	return minVal+(maxVal-minVal)*float(rand())/float(RAND_MAX);
+}
+
+int main()
+{
+	const aabbox3df box(-1.f,-1.f,-1.f,1.f,1.f,1.f);
+
+	std::vector<matrix4x3> instances(INSTANCE_COUNT);
+	srand(0x34u);
+	for (size_t i=0; i<INSTANCE_COUNT; i++)
+	{
+		instances[i].setRotationDegrees(vector3df(randomFloat(0.f,360.f),randomFloat(0.f,360.f),randomFloat(0.f,360.f)));
+		instances[i].setScale(randomFloat(0.5f,2.f));
+		instances[i].setTranslation(vector3df(randomFloat(-150.f,150.f),randomFloat(-20.f,20.f),randomFloat(-150.f,150.f)));
+	}
+
+	CCPUInstanceCuller culler;
+	culler.setLoDs(lodDistances,LOD_COUNT,box);
+	culler.setSlotCount(INSTANCE_COUNT);
+	for (size_t i=0; i<INSTANCE_COUNT; i++)
+		culler.setInstance(i,instances[i]);
+
+	matrix4 proj;
+	proj.buildProjectionMatrixPerspectiveFovLH(core::PI/3.f,16.f/9.f,0.1f,200.f);
+	matrix4x3 view;
+	view.buildCameraLookAtMatrixLH(vector3df(-10.f,5.f,-10.f),vector3df(30.f,0.f,40.f),vector3df(0.f,1.f,0.f));
+	const matrix4 projView = concatenateBFollowedByA(proj,view);
+	matrix4x3 world;
+	world.setTranslation(vector3df(0.f,-1.f,0.f));
+
+	//! every LoD gets room for all instances, only the pages written to get committed
+	const size_t outputSizePerLoD = INSTANCE_COUNT*CCPUInstanceCuller::OutputSizePerInstance;
+	uint8_t* referenceOutput = (uint8_t*)malloc(outputSizePerLoD*LOD_COUNT);
+	uint8_t* cullerOutput = (uint8_t*)malloc(outputSizePerLoD*LOD_COUNT);
+
+	size_t referenceCounts[LOD_COUNT];
+	size_t referenceVisible = 0;
+	double referenceTime = 1e30;
+	for (uint32_t r=0; r<RUNS; r++)
+	{
+		uint8_t* outputs[LOD_COUNT];
+		for (size_t j=0; j<LOD_COUNT; j++)
+			outputs[j] = referenceOutput+j*outputSizePerLoD;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		referenceVisible = cullScalar(outputs,box,instances,projView,view,world);
+		referenceTime = std::min(referenceTime,std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count());
+
+		for (size_t j=0; j<LOD_COUNT; j++)
+			referenceCounts[j] = (outputs[j]-referenceOutput-j*outputSizePerLoD)/CCPUInstanceCuller::OutputSizePerInstance;
+	}
+
+	std::vector<uint32_t> threadCounts;
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(),1u);
+	for (uint32_t t=1; t<hardwareThreads; t*=2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(hardwareThreads);
+
+	printf("%u instances, %u visible (LoD0 %u, LoD1 %u, LoD2 %u)\n",INSTANCE_COUNT,uint32_t(referenceVisible),
+		uint32_t(referenceCounts[0]),uint32_t(referenceCounts[1]),uint32_t(referenceCounts[2]));
+	printf("%8s %12s %16s\n","threads","ms","Minstances/s");
+	printf("%8s %12.2f %16.1f   (scalar)\n","-",referenceTime,INSTANCE_COUNT/(referenceTime*1000.0));
+
+	bool matches = true;
+	for (size_t t=0; t<threadCounts.size(); t++)
+	{
+		size_t visible = 0;
+		double time = 1e30;
+		uint8_t* outputs[LOD_COUNT];
+		for (uint32_t r=0; r<RUNS; r++)
+		{
+			for (size_t j=0; j<LOD_COUNT; j++)
+				outputs[j] = cullerOutput+j*outputSizePerLoD;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			visible = culler.cull(outputs,CCPUInstanceCuller::OutputSizePerInstance,projView,view,world,threadCounts[t]);
+			time = std::min(time,std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count());
+		}
+
+		if (visible!=referenceVisible)
+			matches = false;
+		for (size_t j=0; j<LOD_COUNT; j++)
+		{
+			const size_t count = (outputs[j]-cullerOutput-j*outputSizePerLoD)/CCPUInstanceCuller::OutputSizePerInstance;
+			if (count!=referenceCounts[j]||!outputsMatch(cullerOutput+j*outputSizePerLoD,referenceOutput+j*outputSizePerLoD,count))
+				matches = false;
+		}
+
+		printf("%8u %12.2f %16.1f   (%.2fx)\n",threadCounts[t],time,INSTANCE_COUNT/(time*1000.0),referenceTime/time);
+	}
+
+	free(referenceOutput);
+	free(cullerOutput);
+
+	if (!matches)
+		printf("CCPUInstanceCuller output differs from the scalar loop!\n");
+	return matches ? 0:1;
+}
@@ -0,0 +1,127 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+
+//! Microbenchmarks of CJobSystem at every worker count from 0 up to the number of hardware threads:
+//! submitting and waiting for empty jobs, a chain of dependent jobs, parallelFor over small and nested loops.
+//! Also checks that with 0 workers jobs run in submission order and dependencies are respected at every worker count.
+
+#define EMPTY_JOBS 100000
+#define CHAIN_LENGTH 20000
+#define FOR_COUNT 20000
+#define NESTED_COUNT 64
+#define RUNS 3
+
+static double millisecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+{
+	return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+}
+
+//! roughly a microsecond of arithmetic which the compiler can't drop
+static float spin(const uint32_t& seed)
+{
+	float x = float(seed&0xffu);
+	for (uint32_t i=0; i<400u; i++)
+		x = x*0.999f+0.5f;
+	return x;
+}
+
+int main()
+{
+	bool correct = true;
+
+	//! with no workers jobs run in submission order on the waiting thread
+	{
+		CJobSystem* jobSystem = new CJobSystem(0u);
+		std::vector<uint32_t> order;
+		std::vector<CJobSystem::CJob*> jobs;
+		for (uint32_t i=0; i<100u; i++)
+			jobs.push_back(jobSystem->submit([&order,i]() {order.push_back(i);}));
+		jobSystem->wait(jobs.back());
+		for (uint32_t i=0; i<100u; i++)
+		{
+			if (order[i]!=i)
+				correct = false;
+			jobs[i]->drop();
+		}
+		jobSystem->drop();
+	}
+
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(),1u);
+	printf("%8s %14s %14s %14s %12s %16s %10s %10s\n","workers","empty ns/job","chain ns/link","for ns/index","nested ms","queued ns/job","stolen","sleeps");
+	for (uint32_t workers=0; workers<hardwareThreads; workers++)
+	{
+		CJobSystem* jobSystem = new CJobSystem(workers);
+		double emptyTime = 1e30, chainTime = 1e30, forTime = 1e30, nestedTime = 1e30;
+		for (uint32_t r=0; r<RUNS; r++)
+		{
+			jobSystem->resetStatistics();
+
+			std::vector<CJobSystem::CJob*> jobs(EMPTY_JOBS);
+			auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i=0; i<EMPTY_JOBS; i++)
+				jobs[i] = jobSystem->submit([]() {});
+			for (uint32_t i=0; i<EMPTY_JOBS; i++)
+			{
+				jobSystem->wait(jobs[i]);
+				jobs[i]->drop();
+			}
+			emptyTime = std::min(emptyTime,millisecondsSince(start)*1000000.0/EMPTY_JOBS);
+
+			//! every link checks the previous one already ran
+			std::vector<uint32_t> links(CHAIN_LENGTH,0u);
+			start = std::chrono::high_resolution_clock::now();
+			CJobSystem::CJob* previous = NULL;
+			for (uint32_t i=0; i<CHAIN_LENGTH; i++)
+			{
+				CJobSystem::CJob* job = jobSystem->submit([&links,i]() {links[i] = i ? links[i-1u]+1u:1u;},&previous,previous ? 1u:0u);
+				if (previous)
+					previous->drop();
+				previous = job;
+			}
+			jobSystem->wait(previous);
+			previous->drop();
+			chainTime = std::min(chainTime,millisecondsSince(start)*1000000.0/CHAIN_LENGTH);
+			if (links.back()!=CHAIN_LENGTH)
+				correct = false;
+
+			std::vector<float> results(FOR_COUNT);
+			start = std::chrono::high_resolution_clock::now();
+			jobSystem->parallelFor(FOR_COUNT,[&](const uint32_t& i) {results[i] = spin(i);});
+			forTime = std::min(forTime,millisecondsSince(start)*1000000.0/FOR_COUNT);
+			if (results[FOR_COUNT/2]!=spin(FOR_COUNT/2))
+				correct = false;
+
+			std::vector<float> nestedResults(NESTED_COUNT*NESTED_COUNT);
+			start = std::chrono::high_resolution_clock::now();
+			jobSystem->parallelFor(NESTED_COUNT,[&](const uint32_t& i)
+			{
+				jobSystem->parallelFor(NESTED_COUNT,[&](const uint32_t& j) {nestedResults[i*NESTED_COUNT+j] = spin(i^j);});
+			});
+			nestedTime = std::min(nestedTime,millisecondsSince(start));
+			for (uint32_t i=0; i<NESTED_COUNT*NESTED_COUNT; i++)
+			{
+				if (nestedResults[i]!=spin((i/NESTED_COUNT)^(i%NESTED_COUNT)))
+					correct = false;
+			}
+		}
+
+		const CJobSystem::SStatistics stats = jobSystem->getStatistics();
+		printf("%8u %14.1f %14.1f %14.1f %12.3f %16.1f %10u %10u\n",workers,emptyTime,chainTime,forTime,nestedTime,
+				double(stats.queueLatencyNs)/double(std::max(stats.jobsExecuted,uint64_t(1u))),uint32_t(stats.jobsStolen),uint32_t(stats.workerSleeps));
+		if (stats.jobsExecuted!=stats.jobsSubmitted)
+			correct = false;
+		jobSystem->drop();
+	}
+
+	if (!correct)
+		printf("CJobSystem produced wrong results!\n");
+	return correct ? 0:1;
+}
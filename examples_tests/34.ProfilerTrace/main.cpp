@@ -0,0 +1,95 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+//! Loads a couple of meshes and an image, welds a mesh buffer and then draws a few hundred frames of a scene full of
+//! animated nodes, first without and then with core::CProfiler recording, to show what recording costs.
+//! Prints the zone breakdown of the last frame and writes everything still in the profiler's buffers to profilerTrace.json,
+//! which can be opened in chrome://tracing or https://ui.perfetto.dev
+
+#define NODE_COUNT 4096
+#define FRAME_COUNT 300
+
+static double drawFrames(IVideoDriver* driver, ISceneManager* smgr)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t i=0; i<FRAME_COUNT; i++)
+	{
+		driver->beginScene(true,true,SColor(255,0,0,0));
+		smgr->drawAll();
+		driver->endScene();
+	}
+	return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count()/FRAME_COUNT;
+}
+
+int main()
+{
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = dimension2d<uint32_t>(64, 64);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+	device->getLogger()->setLogLevel(ELL_WARNING);
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+#ifndef _IRR_COMPILE_WITH_PROFILER_
+	printf("The engine was built without _IRR_COMPILE_WITH_PROFILER_, only frames will be recorded.\n");
+#endif
+	CProfiler::setRecording(true);
+
+	ICPUMesh* cow = smgr->getMesh("../media/cow.obj");
+	smgr->getMesh("../media/dwarf.x");
+	IVideoDriver::dropWholeMipChain(driver->createImageDataFromFile("../media/wall.jpg"));
+	if (cow&&cow->getMeshBufferCount())
+	{
+		ICPUMeshBuffer* welded = smgr->getMeshManipulator()->createMeshBufferWelded(cow->getMeshBuffer(0),true,true);
+		if (welded)
+			welded->drop();
+	}
+
+	for (uint32_t i=0; i<NODE_COUNT; i++)
+	{
+		ISceneNode* node = smgr->addEmptySceneNode();
+		node->setPosition(vector3df(float(i%64),0.f,float(i/64)));
+		ISceneNodeAnimator* animator = smgr->createRotationAnimator(vector3df(0.f,float(i%7),0.f));
+		node->addAnimator(animator);
+		animator->drop();
+	}
+	smgr->addCameraSceneNode(0,vector3df(32.f,20.f,-20.f),vector3df(32.f,0.f,32.f));
+
+	CProfiler::setRecording(false);
+	const double plainTime = drawFrames(driver,smgr);
+	CProfiler::setRecording(true);
+	const double recordedTime = drawFrames(driver,smgr);
+	CProfiler::setRecording(false);
+
+	printf("%u nodes, %.3f ms per frame without recording, %.3f ms with\n",NODE_COUNT,plainTime,recordedTime);
+
+	CProfiler::SFrameSummary summary;
+	if (CProfiler::getLastFrameSummary(summary))
+	{
+		printf("frame %u took %.3f ms\n",uint32_t(summary.frameNumber),double(summary.endNs-summary.startNs)*0.000001);
+		for (size_t i=0; i<summary.zones.size(); i++)
+			printf("  %-48s %6u calls %10.3f ms\n",summary.zones[i].name,summary.zones[i].calls,double(summary.zones[i].totalNs)*0.000001);
+	}
+
+	io::IWriteFile* trace = device->getFileSystem()->createAndWriteFile("profilerTrace.json");
+	const bool written = CProfiler::writeChromeTrace(trace);
+	if (trace)
+		trace->drop();
+	printf(written ? "wrote profilerTrace.json\n":"could not write profilerTrace.json\n");
+
+	device->drop();
+
+	return written ? 0:1;
+}
@@ -0,0 +1,1913 @@
+#define _IRR_STATIC_LIB_
+#include <irrlicht.h>
+#include "matrix3x4SIMD.h"
+#include "../../source/Irrlicht/CBAWMeshWriter.h"
+#include "../../source/Irrlicht/CSkinningStateManager.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+using namespace video;
+
+//! Headless micro-benchmarks of the engine's CPU paths: vector and matrix math, CPU skinning, posing instances with animation layers, command list recording and replay, mesh manipulator passes, mesh cache lookups and eviction, the mesh and image loaders
+//! on inputs made by the matching writers or generated here, BAW writing and reading (and the sizes of its blob codings), BC1 to BC5 block compression, color conversion, blitting, mip chain generation, collision queries, CPU occlusion culling, small buffered reads and concurrent reads of archive entries.
+//! Every benchmark is run in batches long enough to time reliably, the fastest and the median batch get printed
+//! and written to a JSON file so runs on different commits or machines can be diffed by a script.
+//! Round trips and other correctness checks run alongside, a failed one prints CHECK FAILED and makes the exit code non-zero.
+//! Usage: Benchmarks [output.json] [substring the benchmark names have to contain]
+
+#define MIN_BATCH_MS 20.0
+#define BATCH_COUNT 5
+#define ARRAY_SIZE 1024
+
+struct SResult
+{
+	std::string name;
+	uint64_t iterations;
+	double nsMin;
+	double nsMedian;
+	double itemsPerSecond;
+	//! against a double precision reference, negative if not checked
+	double maxError;
+};
+
+static std::vector<SResult> Results;
+static const char* NameFilter = NULL;
+//! keeps the compiler from throwing away what is being measured
+static volatile float Sink;
+
+template<typename F>
+static double timeCalls(const uint64_t& calls, F& func)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint64_t i=0; i<calls; i++)
+		func();
+	return std::chrono::duration<double,std::nano>(std::chrono::high_resolution_clock::now()-start).count();
+}
+
+//! Runs `func` until a batch of calls takes at least MIN_BATCH_MS, then times BATCH_COUNT such batches.
+//! `itemsPerCall` is how many vectors, pixels, indices or rays one call processes.
+template<typename F>
+static bool measure(const char* name, const uint64_t& itemsPerCall, F func)
+{
+	if (NameFilter&&!strstr(name,NameFilter))
+		return false;
+
+	func();
+	uint64_t calls = 1u;
+	while (timeCalls(calls,func)<MIN_BATCH_MS*1000000.0&&calls<(1ull<<30))
+		calls *= 2u;
+
+	double batches[BATCH_COUNT];
+	for (uint32_t i=0; i<BATCH_COUNT; i++)
+		batches[i] = timeCalls(calls,func)/double(calls);
+	std::sort(batches,batches+BATCH_COUNT);
+
+	SResult result = {name,calls*BATCH_COUNT,batches[0],batches[BATCH_COUNT/2],double(itemsPerCall)*1000000000.0/batches[BATCH_COUNT/2],-1.0};
+	Results.push_back(result);
+	printf("%-48s %14.1f ns %14.1f ns %16.0f items/s\n",name,result.nsMin,result.nsMedian,result.itemsPerSecond);
+	return true;
+}
+
+//! Correctness checks which fail are printed and counted, any makes the exit code non-zero.
+static uint32_t FailedChecks = 0u;
+
+static void check(const bool passed, const char* what)
+{
+	if (passed)
+		return;
+	FailedChecks++;
+	printf("CHECK FAILED: %s\n",what);
+}
+
+static float randomFloat(uint32_t& state)
+{
+	state = state*1664525u+1013904223u;
+	return float(state>>8)/float(1u<<24);
+}
+
+static void benchmarkMath()
+{
+	uint32_t seed = 1u;
+	std::vector<vectorSIMDf> vectors(ARRAY_SIZE+1), outVectors(ARRAY_SIZE);
+	std::vector<matrix3x4SIMD> matrices(ARRAY_SIZE+1), outMatrices(ARRAY_SIZE);
+	//! matrixSIMD4 is shadowed by matrix4.h's include guard, matrix4 is what the 4x4 paths of the engine really use
+	std::vector<matrix4> matrices4(ARRAY_SIZE+1), outMatrices4(ARRAY_SIZE);
+	std::vector<vector3df> points(ARRAY_SIZE);
+	for (size_t i=0; i<=ARRAY_SIZE; i++)
+	{
+		vectors[i] = vectorSIMDf(randomFloat(seed),randomFloat(seed),randomFloat(seed),1.f)*2.f-vectorSIMDf(1.f);
+		vectors[i].w = 1.f;
+
+		const vector3df angles(randomFloat(seed),randomFloat(seed),randomFloat(seed));
+		matrices[i].setScaleRotationAndTranslation(vectorSIMDf(1.f+randomFloat(seed)),quaternion(angles.X,angles.Y,angles.Z),vectors[i]);
+		matrices4[i].setRotationRadians(angles);
+		matrices4[i].setTranslation(vectors[i].getAsVector3df());
+		if (i<ARRAY_SIZE)
+			points[i] = vectors[i].getAsVector3df();
+	}
+
+	measure("math/vectorSIMDf/dot",ARRAY_SIZE,[&]()
+	{
+		vectorSIMDf sum(0.f);
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			sum += dot(vectors[i],vectors[i+1]);
+		Sink = sum.x;
+	});
+	measure("math/vectorSIMDf/cross",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			outVectors[i] = cross(vectors[i],vectors[i+1]);
+		Sink = outVectors[ARRAY_SIZE/2].x;
+	});
+	measure("math/vectorSIMDf/normalize",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			outVectors[i] = normalize(vectors[i]);
+		Sink = outVectors[ARRAY_SIZE/2].x;
+	});
+	measure("math/matrix3x4SIMD/concatenate",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			outMatrices[i] = matrix3x4SIMD::concatenateBFollowedByA(matrices[i],matrices[i+1]);
+		Sink = outMatrices[ARRAY_SIZE/2].rows[0].x;
+	});
+	measure("math/matrix3x4SIMD/getInverse",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			matrices[i].getInverse(outMatrices[i]);
+		Sink = outMatrices[ARRAY_SIZE/2].rows[0].x;
+	});
+	measure("math/matrix3x4SIMD/transformVect",ARRAY_SIZE,[&]()
+	{
+		const matrix3x4SIMD& mat = matrices[0];
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			mat.transformVect(outVectors[i].pointer,vectors[i].pointer);
+		Sink = outVectors[ARRAY_SIZE/2].x;
+	});
+	measure("math/matrix4/multiply",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			outMatrices4[i] = matrices4[i]*matrices4[i+1];
+		Sink = outMatrices4[ARRAY_SIZE/2][0];
+	});
+	measure("math/matrix4/getInverse",ARRAY_SIZE,[&]()
+	{
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			matrices4[i].getInverse(outMatrices4[i]);
+		Sink = outMatrices4[ARRAY_SIZE/2][0];
+	});
+	measure("math/matrix4/transformVect",ARRAY_SIZE,[&]()
+	{
+		const matrix4& mat = matrices4[0];
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+			mat.transformVect(outVectors[i].pointer,points[i]);
+		Sink = outVectors[ARRAY_SIZE/2].x;
+	});
+}
+
+//! largest absolute difference between packed float triplets and a double precision reference
+static double maxAbsError(const float* values, const std::vector<double>& reference)
+{
+	double error = 0.0;
+	for (size_t i=0; i<reference.size(); i++)
+		error = std::max(error,std::abs(double(values[i])-reference[i]));
+	return error;
+}
+
+//! The array kernels of matrix3x4SIMD against the loop over the single item functions they replace,
+//! once for every instruction set the runtime dispatch can pick on this CPU.
+static void benchmarkMatrixStreams()
+{
+	uint32_t seed = 7u;
+	const size_t count = ARRAY_SIZE*4;
+	std::vector<float> points(count*3), outPoints(count*3);
+	std::vector<aabbox3df> boxes(count), outBoxes(count);
+	std::vector<matrix3x4SIMD> matrices(count+1), outMatrices(count);
+	for (size_t i=0; i<count*3; i++)
+		points[i] = randomFloat(seed)*200.f-100.f;
+	for (size_t i=0; i<count; i++)
+	{
+		const vector3df center(points[i*3],points[i*3+1],points[i*3+2]);
+		const vector3df extent(randomFloat(seed),randomFloat(seed),randomFloat(seed));
+		boxes[i] = aabbox3df(center-extent,center+extent);
+	}
+	for (size_t i=0; i<=count; i++)
+	{
+		const vector3df angles(randomFloat(seed)*6.f,randomFloat(seed)*6.f,randomFloat(seed)*6.f);
+		const vectorSIMDf translation(randomFloat(seed)*20.f-10.f,randomFloat(seed)*20.f-10.f,randomFloat(seed)*20.f-10.f);
+		matrices[i].setScaleRotationAndTranslation(vectorSIMDf(0.5f+randomFloat(seed)),quaternion(angles.X,angles.Y,angles.Z),translation);
+	}
+	const matrix3x4SIMD& mat = matrices[0];
+
+	std::vector<double> pointReference(count*3), normalReference(count*3), matrixReference(count*12);
+	for (size_t i=0; i<count; i++)
+	for (size_t r=0; r<3; r++)
+	{
+		const float* row = mat.rows[r].pointer;
+		const float* in = &points[i*3];
+		normalReference[i*3+r] = double(row[0])*in[0]+double(row[1])*in[1]+double(row[2])*in[2];
+		pointReference[i*3+r] = normalReference[i*3+r]+double(row[3]);
+		for (size_t c=0; c<4; c++)
+		{
+			const matrix3x4SIMD& a = matrices[i];
+			const matrix3x4SIMD& b = matrices[i+1];
+			double sum = r<3&&c==3 ? double(a.rows[r].pointer[3]):0.0;
+			for (size_t k=0; k<3; k++)
+				sum += double(a.rows[r].pointer[k])*double(b.rows[k].pointer[c]);
+			matrixReference[i*12+r*4+c] = sum;
+		}
+	}
+	auto matrixError = [&]() -> double
+	{
+		double error = 0.0;
+		for (size_t i=0; i<count; i++)
+		for (size_t r=0; r<3; r++)
+		for (size_t c=0; c<4; c++)
+			error = std::max(error,std::abs(double(outMatrices[i].rows[r].pointer[c])-matrixReference[i*12+r*4+c]));
+		return error;
+	};
+
+	if (measure("math/matrix3x4SIMD/transformPoints/scalarLoop",count,[&]()
+		{
+			for (size_t i=0; i<count; i++)
+			{
+				const float in[4] = {points[i*3],points[i*3+1],points[i*3+2],1.f};
+				mat.transformVect(&outPoints[i*3],in);
+			}
+			Sink = outPoints[count];
+		}))
+		Results.back().maxError = maxAbsError(outPoints.data(),pointReference);
+	if (measure("math/matrix3x4SIMD/transformNormals/scalarLoop",count,[&]()
+		{
+			for (size_t i=0; i<count; i++)
+			{
+				const float in[4] = {points[i*3],points[i*3+1],points[i*3+2],0.f};
+				mat.mulSub3x3With3x1(&outPoints[i*3],in);
+			}
+			Sink = outPoints[count];
+		}))
+		Results.back().maxError = maxAbsError(outPoints.data(),normalReference);
+	measure("math/matrix3x4SIMD/transformBoxes/scalarLoop",count,[&]()
+	{
+		for (size_t i=0; i<count; i++)
+			outBoxes[i] = transformBoxEx(boxes[i],mat);
+		Sink = outBoxes[count/2].MinEdge.X;
+	});
+	if (measure("math/matrix3x4SIMD/concatenateArray/scalarLoop",count,[&]()
+		{
+			for (size_t i=0; i<count; i++)
+				outMatrices[i] = matrix3x4SIMD::concatenateBFollowedByA(matrices[i],matrices[i+1]);
+			Sink = outMatrices[count/2].rows[0].x;
+		}))
+		Results.back().maxError = matrixError();
+
+	const SCPUFeatures& detected = SCPUFeatures::detect();
+	SCPUFeatures sse;
+	sse.SSE2 = detected.SSE2;
+	sse.SSE3 = detected.SSE3;
+	sse.SSSE3 = detected.SSSE3;
+	sse.SSE4_1 = detected.SSE4_1;
+	SCPUFeatures avx = sse;
+	avx.AVX = detected.AVX;
+	const SCPUFeatures* isas[] = {&sse,detected.AVX ? &avx:NULL,detected.AVX2&&detected.FMA ? &detected:NULL};
+	const char* isaNames[] = {"sse","avx","avx2fma"};
+	for (size_t j=0; j<sizeof(isas)/sizeof(*isas); j++)
+	{
+		if (!isas[j])
+			continue;
+		SCPUFeatures::setAllowed(*isas[j]);
+
+		std::string name = std::string("math/matrix3x4SIMD/transformPoints/")+isaNames[j];
+		if (measure(name.c_str(),count,[&]()
+			{
+				matrix3x4SIMD::transformPoints(mat,outPoints.data(),points.data(),count);
+				Sink = outPoints[count];
+			}))
+			Results.back().maxError = maxAbsError(outPoints.data(),pointReference);
+		name = std::string("math/matrix3x4SIMD/transformNormals/")+isaNames[j];
+		if (measure(name.c_str(),count,[&]()
+			{
+				matrix3x4SIMD::transformNormals(mat,outPoints.data(),points.data(),count);
+				Sink = outPoints[count];
+			}))
+			Results.back().maxError = maxAbsError(outPoints.data(),normalReference);
+		name = std::string("math/matrix3x4SIMD/transformBoxes/")+isaNames[j];
+		measure(name.c_str(),count,[&]()
+		{
+			matrix3x4SIMD::transformBoxes(mat,outBoxes.data(),boxes.data(),count);
+			Sink = outBoxes[count/2].MinEdge.X;
+		});
+		name = std::string("math/matrix3x4SIMD/concatenateArray/")+isaNames[j];
+		if (measure(name.c_str(),count,[&]()
+			{
+				matrix3x4SIMD::concatenateBFollowedByA(outMatrices.data(),matrices.data(),matrices.data()+1,count);
+				Sink = outMatrices[count/2].rows[0].x;
+			}))
+			Results.back().maxError = matrixError();
+	}
+	SCPUFeatures::setAllowed(detected);
+}
+
+//! CCPUSkinner on a synthetic skinned vertex soup, 1 to 4 bones per vertex, against a double precision blend of the transformed vertices.
+static void benchmarkSkinning()
+{
+	const uint32_t vertexCount = 1u<<18;
+	const uint32_t boneCount = 64u;
+	uint32_t seed = 11u;
+
+	std::vector<ISkinningStateManager::FinalBoneData> bones(boneCount);
+	for (uint32_t i=0; i<boneCount; i++)
+	{
+		const vector3df angles(randomFloat(seed)*6.f,randomFloat(seed)*6.f,randomFloat(seed)*6.f);
+		const vectorSIMDf translation(randomFloat(seed)*2.f-1.f,randomFloat(seed)*2.f-1.f,randomFloat(seed)*2.f-1.f);
+		bones[i].SkinningTransform = matrix3x4SIMD().setScaleRotationAndTranslation(vectorSIMDf(0.5f+randomFloat(seed)),quaternion(angles.X,angles.Y,angles.Z),translation).getAsRetardedIrrlichtMatrix();
+		bones[i].SkinningTransform.getSub3x3InverseTranspose(bones[i].SkinningNormalMatrix);
+	}
+
+	ICPUMeshDataFormatDesc* desc = new ICPUMeshDataFormatDesc();
+	core::ICPUBuffer* positionBuffer = new core::ICPUBuffer(vertexCount*sizeof(vector3df));
+	core::ICPUBuffer* normalBuffer = new core::ICPUBuffer(vertexCount*sizeof(vector3df));
+	core::ICPUBuffer* skinningBuffer = new core::ICPUBuffer(vertexCount*sizeof(SkinnedVertexFinalData));
+	desc->mapVertexAttrBuffer(positionBuffer,EVAI_ATTR0,ECPA_THREE,ECT_FLOAT);
+	desc->mapVertexAttrBuffer(normalBuffer,EVAI_ATTR3,ECPA_THREE,ECT_FLOAT);
+	desc->mapVertexAttrBuffer(skinningBuffer,EVAI_ATTR5,ECPA_FOUR,ECT_INTEGER_UNSIGNED_BYTE,8,0);
+	desc->mapVertexAttrBuffer(skinningBuffer,EVAI_ATTR6,ECPA_FOUR,ECT_NORMALIZED_UNSIGNED_INT_2_10_10_10_REV,8,4);
+
+	float* positions = reinterpret_cast<float*>(positionBuffer->getPointer());
+	float* normals = reinterpret_cast<float*>(normalBuffer->getPointer());
+	SkinnedVertexFinalData* skinning = reinterpret_cast<SkinnedVertexFinalData*>(skinningBuffer->getPointer());
+	std::vector<double> positionReference(vertexCount*3u,0.0), normalReference(vertexCount*3u,0.0);
+	for (uint32_t i=0; i<vertexCount; i++)
+	{
+		for (uint32_t k=0; k<3; k++)
+		{
+			positions[i*3u+k] = randomFloat(seed)*2.f-1.f;
+			normals[i*3u+k] = randomFloat(seed)*2.f-1.f;
+		}
+
+		//! split 1023 into `influences` quantized weights, like the loaders do
+		const uint32_t influences = 1u+uint32_t(randomFloat(seed)*4.f);
+		uint32_t cuts[5] = {0u,1023u,1023u,1023u,1023u};
+		for (uint32_t j=1; j<influences; j++)
+			cuts[j] = uint32_t(randomFloat(seed)*1023.f);
+		std::sort(cuts,cuts+influences);
+		uint32_t quantized[4] = {0u,0u,0u,0u};
+		for (uint32_t j=0; j<influences; j++)
+			quantized[j] = (j+1u<influences ? cuts[j+1]:1023u)-cuts[j];
+		skinning[i].boneWeights = quantized[0]|(quantized[1]<<10)|(quantized[2]<<20)|((influences-1u)<<30);
+
+		double weights[4] = {quantized[0]/1023.0,quantized[1]/1023.0,quantized[2]/1023.0,0.0};
+		weights[3] = 1.0-weights[0]-weights[1]-weights[2];
+		for (uint32_t j=0; j<4; j++)
+			skinning[i].boneIDs[j] = uint8_t(randomFloat(seed)*boneCount);
+		for (uint32_t j=0; j<influences; j++)
+		{
+			const ISkinningStateManager::FinalBoneData& bone = bones[skinning[i].boneIDs[j]];
+			for (uint32_t r=0; r<3; r++)
+			{
+				double position = bone.SkinningTransform(r,3);
+				double normal = 0.0;
+				for (uint32_t c=0; c<3; c++)
+				{
+					position += double(bone.SkinningTransform(r,c))*positions[i*3u+c];
+					normal += double(bone.SkinningNormalMatrix[c*3u+r])*normals[i*3u+c];
+				}
+				positionReference[i*3u+r] += weights[j]*position;
+				normalReference[i*3u+r] += weights[j]*normal;
+			}
+		}
+	}
+	positionBuffer->drop();
+	normalBuffer->drop();
+	skinningBuffer->drop();
+
+	SCPUSkinMeshBuffer* meshbuffer = new SCPUSkinMeshBuffer();
+	meshbuffer->setMeshDataAndFormat(desc);
+	desc->drop();
+
+	std::vector<float> outPositions(vertexCount*3u), outNormals(vertexCount*3u);
+	const uint32_t allThreads = CJobSystem::getGlobal()->getWorkerCount()+1u;
+	const uint32_t threadCounts[2] = {1u,allThreads};
+	for (uint32_t t=0; t<(allThreads>1u ? 2u:1u); t++)
+	{
+		char name[64];
+		sprintf(name,"skinning/cpu/positions/%uthreads",threadCounts[t]);
+		if (measure(name,vertexCount,[&]() {CCPUSkinner::skin(outPositions.data(),NULL,12u,meshbuffer,bones.data(),boneCount,0u,vertexCount,threadCounts[t]);}))
+			Results.back().maxError = maxAbsError(outPositions.data(),positionReference);
+
+		sprintf(name,"skinning/cpu/positionsAndNormals/%uthreads",threadCounts[t]);
+		if (measure(name,vertexCount,[&]() {CCPUSkinner::skin(outPositions.data(),outNormals.data(),12u,meshbuffer,bones.data(),boneCount,0u,vertexCount,threadCounts[t]);}))
+			Results.back().maxError = std::max(maxAbsError(outPositions.data(),positionReference),maxAbsError(outNormals.data(),normalReference));
+	}
+	meshbuffer->drop();
+}
+
+//! CSkinningStateManager posing a crowd whose instances crossfade two clips and add a third on the upper half of the bones, all in one performBoning(), on one and on all threads.
+//! The additive layers take keyframe 0 as reference, which scales every bone to nothing along X, so the poses have to stay finite.
+//! Instances whose layers only sample their own frame must come out posed like instances animated by setFrame() alone.
+static void benchmarkAnimationLayers(IVideoDriver* driver)
+{
+	const uint32_t boneCount = 32u;
+	const uint32_t keyframeCount = 16u;
+	const uint32_t instanceCount = 1024u;
+	const uint32_t layerCount = 3u;
+	const size_t levelEnds[4] = {1u,4u,12u,32u};
+	uint32_t seed = 17u;
+
+	std::vector<CFinalBoneHierarchy::BoneReferenceData> bones(boneCount);
+	std::vector<core::stringc> boneNames(boneCount);
+	for (uint32_t i=0, level=0; i<boneCount; i++)
+	{
+		if (i==levelEnds[level])
+			level++;
+		//! every bone hangs off one of the previous level
+		uint32_t parent = i;
+		if (level)
+		{
+			const uint32_t parentLevelStart = level>1u ? levelEnds[level-2u]:0u;
+			parent = parentLevelStart+(i-levelEnds[level-1u])%(levelEnds[level-1u]-parentLevelStart);
+		}
+		bones[i].PoseBindMatrix = matrix4x3();
+		for (uint32_t k=0; k<3; k++)
+		{
+			bones[i].MinBBoxEdge[k] = -0.1f;
+			bones[i].MaxBBoxEdge[k] = 0.1f;
+		}
+		bones[i].parentOffsetRelative = i-parent;
+		bones[i].parentOffsetFromTop = parent;
+	}
+
+	std::vector<float> keyframes(keyframeCount);
+	for (uint32_t k=0; k<keyframeCount; k++)
+		keyframes[k] = float(k);
+	std::vector<CFinalBoneHierarchy::AnimationKeyData> keys(boneCount*keyframeCount);
+	for (uint32_t i=0; i<keys.size(); i++)
+	{
+		float norm = 0.f;
+		for (uint32_t c=0; c<4; c++)
+		{
+			keys[i].Rotation[c] = randomFloat(seed)*2.f-1.f;
+			norm += keys[i].Rotation[c]*keys[i].Rotation[c];
+		}
+		for (uint32_t c=0; c<4; c++)
+			keys[i].Rotation[c] /= sqrtf(norm);
+		for (uint32_t c=0; c<3; c++)
+		{
+			keys[i].Position[c] = randomFloat(seed)*2.f-1.f;
+			keys[i].Scale[c] = 0.5f+randomFloat(seed);
+		}
+		if (i%keyframeCount==0u)
+			keys[i].Scale[0] = 0.f;
+	}
+
+	CFinalBoneHierarchy* hierarchy = new CFinalBoneHierarchy(bones.data(),bones.data()+boneCount,boneNames.data(),boneNames.data()+boneCount,levelEnds,levelEnds+4,
+		keyframes.data(),keyframes.data()+keyframeCount,keys.data(),keys.data()+keys.size(),keys.data(),keys.data()+keys.size());
+	CSkinningStateManager* manager = new CSkinningStateManager(ISkinningStateManager::EBUM_NONE,driver,hierarchy);
+	hierarchy->drop();
+
+	std::vector<float> upperBody(boneCount);
+	for (uint32_t i=0; i<boneCount; i++)
+		upperBody[i] = i<boneCount/2u ? 0.f:1.f;
+	const uint32_t mask = manager->addBoneMask(upperBody.data());
+
+	std::vector<uint32_t> instances(instanceCount);
+	std::vector<ISkinningStateManager::SAnimationLayer> layers(instanceCount*layerCount);
+	for (uint32_t i=0; i<instanceCount; i++)
+	{
+		ISkinningStateManager::SAnimationLayer* instanceLayers = layers.data()+i*layerCount;
+		instanceLayers[0].frame = 1.f+randomFloat(seed)*6.f;
+		instanceLayers[0].weight = randomFloat(seed);
+		instanceLayers[1].frame = 8.f+randomFloat(seed)*6.f;
+		instanceLayers[1].weight = 1.f-instanceLayers[0].weight;
+		instanceLayers[2].frame = 1.f+randomFloat(seed)*13.f;
+		instanceLayers[2].weight = 0.5f;
+		instanceLayers[2].boneMask = mask;
+		instanceLayers[2].additive = true;
+
+		instances[i] = manager->addInstance();
+		manager->setFrame(instanceLayers[0].frame,instances[i]);
+	}
+
+	//! every call moves all the layers on, like a frame of a game would
+	auto animate = [&]()
+	{
+		for (uint32_t i=0; i<instanceCount; i++)
+		{
+			ISkinningStateManager::SAnimationLayer* instanceLayers = layers.data()+i*layerCount;
+			for (uint32_t l=0; l<layerCount; l++)
+				instanceLayers[l].frame = instanceLayers[l].frame<14.f ? instanceLayers[l].frame+0.25f:1.f;
+			manager->setAnimationLayers(instances[i],instanceLayers,layerCount);
+		}
+		manager->performBoning();
+	};
+
+	const uint32_t allThreads = CJobSystem::getGlobal()->getWorkerCount()+1u;
+	const uint32_t threadCounts[2] = {1u,allThreads};
+	for (uint32_t t=0; t<(allThreads>1u ? 2u:1u); t++)
+	{
+		char name[64];
+		sprintf(name,"skinning/animationLayers/%uthreads",threadCounts[t]);
+		manager->setMaxBoningThreads(threadCounts[t]);
+		measure(name,instanceCount*boneCount,animate);
+	}
+	manager->setMaxBoningThreads(0u);
+
+	animate();
+	bool finite = true;
+	for (uint32_t i=0; i<instanceCount; i++)
+	{
+		const ISkinningStateManager::FinalBoneData* boneData = manager->getInstanceBoneData(instances[i]);
+		for (uint32_t j=0; j<boneCount; j++)
+		for (uint32_t r=0; r<3; r++)
+		for (uint32_t c=0; c<4; c++)
+			finite = finite&&std::isfinite(boneData[j].SkinningTransform(r,c));
+	}
+	check(finite,"additive animation layers with a reference pose of zero scale give finite bone transforms");
+
+	//! a crossfade of the instance's own frame with itself, and an additive layer against its own reference, change nothing
+	const uint32_t plain = manager->addInstance();
+	const uint32_t layered = manager->addInstance();
+	manager->setFrame(5.5f,plain);
+	manager->setFrame(5.5f,layered);
+	ISkinningStateManager::SAnimationLayer sameFrame[3];
+	sameFrame[0].frame = 5.5f;
+	sameFrame[0].weight = 0.3f;
+	sameFrame[1].frame = 5.5f;
+	sameFrame[1].weight = 0.7f;
+	sameFrame[2].frame = 9.25f;
+	sameFrame[2].referenceFrame = 9.25f;
+	sameFrame[2].additive = true;
+	manager->setAnimationLayers(layered,sameFrame,3u);
+	manager->performBoning();
+
+	double maxError = 0.0;
+	const ISkinningStateManager::FinalBoneData* plainData = manager->getInstanceBoneData(plain);
+	const ISkinningStateManager::FinalBoneData* layeredData = manager->getInstanceBoneData(layered);
+	for (uint32_t j=0; j<boneCount; j++)
+	for (uint32_t r=0; r<3; r++)
+	for (uint32_t c=0; c<4; c++)
+		maxError = std::max(maxError,double(fabsf(plainData[j].SkinningTransform(r,c)-layeredData[j].SkinningTransform(r,c))));
+	check(maxError<1e-4,"animation layers sampling the instance's own frame pose it like setFrame() does");
+
+	manager->drop();
+}
+
+//! CCommandList recording a scene's draws on worker threads and replaying them on the null driver, against calling the driver directly.
+//! The draws come sorted by material, so most material changes are redundant, and every 4th draw repeats the previous world transform.
+static void benchmarkCommandLists(IVideoDriver* driver)
+{
+	const uint32_t drawCount = 1u<<14;
+	const uint32_t drawsPerList = 256u;
+	const uint32_t listCount = drawCount/drawsPerList;
+	const uint32_t meshbufferCount = 64u;
+	const uint32_t materialCount = 16u;
+	uint32_t seed = 13u;
+
+	std::vector<IGPUMeshBuffer*> meshbuffers(meshbufferCount);
+	for (uint32_t i=0; i<meshbufferCount; i++)
+	{
+		meshbuffers[i] = new IGPUMeshBuffer();
+		meshbuffers[i]->setPrimitiveType(EPT_TRIANGLES);
+		meshbuffers[i]->setIndexCount(3u*(1u+uint32_t(randomFloat(seed)*1000.f)));
+	}
+	std::vector<SMaterial> materials(materialCount);
+	for (uint32_t i=0; i<materialCount; i++)
+		materials[i].MaterialTypeParam = float(i);
+
+	struct SDraw
+	{
+		uint32_t material;
+		uint32_t meshbuffer;
+		matrix4x3 world;
+	};
+	std::vector<SDraw> draws(drawCount);
+	for (uint32_t i=0; i<drawCount; i++)
+	{
+		draws[i].material = i*materialCount/drawCount;
+		draws[i].meshbuffer = uint32_t(randomFloat(seed)*meshbufferCount);
+		if (i&&(i&3u)==0u)
+			draws[i].world = draws[i-1u].world;
+		else
+			draws[i].world.setTranslation(vector3df(randomFloat(seed),randomFloat(seed),randomFloat(seed)));
+	}
+
+	auto recordList = [&](CCommandList* list, const uint32_t& listIx)
+	{
+		list->reset();
+		for (uint32_t i=listIx*drawsPerList; i<(listIx+1u)*drawsPerList; i++)
+		{
+			list->setMaterial(materials[draws[i].material]);
+			list->setTransform(E4X3TS_WORLD,draws[i].world);
+			list->drawMeshBuffer(meshbuffers[draws[i].meshbuffer]);
+		}
+	};
+
+	std::vector<CCommandList*> lists(listCount);
+	for (uint32_t i=0; i<listCount; i++)
+	{
+		lists[i] = new CCommandList();
+		recordList(lists[i],i);
+	}
+
+	const uint32_t allThreads = CJobSystem::getGlobal()->getWorkerCount()+1u;
+	const uint32_t threadCounts[2] = {1u,allThreads};
+	for (uint32_t t=0; t<(allThreads>1u ? 2u:1u); t++)
+	{
+		char name[64];
+		sprintf(name,"commandList/record/%uthreads",threadCounts[t]);
+		measure(name,drawCount,[&]()
+		{
+			CJobSystem::getGlobal()->parallelFor(listCount,[&](const uint32_t& i) {recordList(lists[i],i);},threadCounts[t]);
+		});
+	}
+
+	//! every list is one material's draws, so only the first list of each material sets it, and the repeated transforms get dropped
+	if (measure("commandList/execute",drawCount,[&]() {CCommandList::execute(driver,lists.data(),listCount);}))
+	{
+		uint32_t recorded = 0u;
+		for (uint32_t i=0; i<listCount; i++)
+			recorded += lists[i]->getCommandCount();
+		const CCommandList::SExecuteStatistics stats = CCommandList::execute(driver,lists.data(),listCount);
+		Results.back().maxError = fabs(double(stats.commandsExecuted)-double(recorded))+fabs(double(stats.materialsSkipped)-double(listCount-materialCount))+
+									fabs(double(stats.transformsSkipped)-double(drawCount/4u-1u));
+	}
+
+	measure("commandList/directDriverCalls",drawCount,[&]()
+	{
+		for (uint32_t i=0; i<drawCount; i++)
+		{
+			driver->setMaterial(materials[draws[i].material]);
+			driver->setTransform(E4X3TS_WORLD,draws[i].world);
+			driver->drawMeshBuffer(meshbuffers[draws[i].meshbuffer]);
+		}
+	});
+
+	for (uint32_t i=0; i<listCount; i++)
+		lists[i]->drop();
+	for (uint32_t i=0; i<meshbufferCount; i++)
+		meshbuffers[i]->drop();
+}
+
+static void benchmarkMeshManipulator(IMeshManipulator* manipulator, ICPUMesh* sphere)
+{
+	ICPUMeshBuffer* buffer = sphere->getMeshBuffer(0);
+	const uint64_t indexCount = buffer->getIndexCount();
+
+	IMeshManipulator::SErrorMetric metrics[EVAI_COUNT];
+
+	measure("meshManipulator/duplicate",indexCount,[&]()
+	{
+		manipulator->createMeshBufferDuplicate(buffer)->drop();
+	});
+	measure("meshManipulator/duplicateAndRequantize",indexCount,[&]()
+	{
+		ICPUMeshBuffer* duplicate = manipulator->createMeshBufferDuplicate(buffer);
+		manipulator->requantizeMeshBuffer(duplicate,metrics);
+		duplicate->drop();
+	});
+	measure("meshManipulator/welded",indexCount,[&]()
+	{
+		ICPUMeshBuffer* welded = manipulator->createMeshBufferWelded(buffer,true,true);
+		if (welded)
+			welded->drop();
+	});
+	measure("meshManipulator/uniquePrimitives",indexCount,[&]()
+	{
+		ICPUMeshBuffer* unique = manipulator->createMeshBufferUniquePrimitives(buffer);
+		if (unique)
+			unique->drop();
+	});
+	measure("meshManipulator/optimized",indexCount,[&]()
+	{
+		ICPUMeshBuffer* optimized = manipulator->createOptimizedMeshBuffer(buffer,metrics);
+		if (optimized)
+			optimized->drop();
+	});
+
+	ICPUMeshBuffer* flipped = manipulator->createMeshBufferDuplicate(buffer);
+	measure("meshManipulator/flipSurfaces",indexCount,[&]()
+	{
+		manipulator->flipSurfaces(flipped);
+	});
+	flipped->drop();
+
+	//! how far below the sphere the triangles' centers and edge midpoints sag, the simplified vertices themselves stay on it
+	vectorSIMDf firstVertex;
+	buffer->getAttribute(firstVertex,buffer->getPositionAttributeIx(),0u);
+	firstVertex.w = 0.f;
+	const float radius = firstVertex.getLengthAsFloat();
+	auto sphereDeviation = [&](ICPUMeshBuffer* mb) -> double
+	{
+		double deviation = 0.0;
+		for (uint64_t i=0; i+2u<mb->getIndexCount(); i+=3u)
+		{
+			vectorSIMDf corners[3];
+			for (uint32_t k=0; k<3u; k++)
+			{
+				const uint32_t ix = mb->getIndexType()==EIT_16BIT ? ((const uint16_t*)mb->getIndices())[i+k]:((const uint32_t*)mb->getIndices())[i+k];
+				mb->getAttribute(corners[k],mb->getPositionAttributeIx(),ix);
+				corners[k].w = 0.f;
+			}
+			const vectorSIMDf samples[4] = {(corners[0]+corners[1]+corners[2])/3.f,(corners[0]+corners[1])*0.5f,(corners[1]+corners[2])*0.5f,(corners[2]+corners[0])*0.5f};
+			for (uint32_t k=0; k<4u; k++)
+				deviation = std::max(deviation,fabs(double(radius)-double(samples[k].getLengthAsFloat())));
+		}
+		return deviation;
+	};
+
+	const float ratios[3] = {0.5f,0.1f,0.01f};
+	for (uint32_t r=0; r<3u; r++)
+	{
+		char name[64];
+		sprintf(name,"meshManipulator/simplified/%upercent",uint32_t(ratios[r]*100.f+0.5f));
+		const uint32_t targetTriangles = uint32_t(double(indexCount/3u)*ratios[r]);
+		ICPUMeshBuffer* simplified = NULL;
+		if (measure(name,indexCount,[&]()
+			{
+				if (simplified)
+					simplified->drop();
+				simplified = manipulator->createMeshBufferSimplified(buffer,targetTriangles);
+			}))
+		{
+			//! missing the target triangle count counts as an infinite error
+			Results.back().maxError = simplified&&simplified->getIndexCount()<=targetTriangles*3u ? sphereDeviation(simplified):DBL_MAX;
+		}
+		if (simplified)
+			simplified->drop();
+	}
+
+	const float lodRatios[4] = {0.5f,0.25f,0.1f,0.02f};
+	ICPUMesh* lods[4] = {NULL,NULL,NULL,NULL};
+	float lodErrors[4];
+	auto dropLoDs = [&]()
+	{
+		for (uint32_t i=0; i<4u; i++)
+		{
+			if (lods[i])
+				lods[i]->drop();
+			lods[i] = NULL;
+		}
+	};
+	if (measure("meshManipulator/lodChain",indexCount,[&]()
+		{
+			dropLoDs();
+			manipulator->createMeshLoDChain(lods,lodErrors,sphere,lodRatios,4u);
+		}))
+	{
+		double deviation = 0.0;
+		for (uint32_t i=0; i<4u; i++)
+			deviation = lods[i] ? std::max(deviation,sphereDeviation(lods[i]->getMeshBuffer(0))):DBL_MAX;
+		Results.back().maxError = deviation;
+	}
+	dropLoDs();
+
+	//! a points meshbuffer next to the sphere must not fail the chain, it goes into every level as it is
+	ICPUMeshBuffer* points = manipulator->createMeshBufferDuplicate(buffer);
+	points->setPrimitiveType(EPT_POINTS);
+	SCPUMesh* mixed = new SCPUMesh();
+	mixed->addMeshBuffer(buffer);
+	mixed->addMeshBuffer(points);
+	const bool created = manipulator->createMeshLoDChain(lods,NULL,mixed,lodRatios,4u);
+	check(created,"LoD chain of a mesh with a points meshbuffer gets created");
+	if (created)
+	{
+		for (uint32_t i=0; i<4u; i++)
+		{
+			check(lods[i]->getMeshBufferCount()==2u&&lods[i]->getMeshBuffer(1)==points,"points meshbuffer is passed through the LoD chain unchanged");
+			check(lods[i]->getMeshBuffer(0)->getIndexCount()<buffer->getIndexCount(),"triangle meshbuffer next to a points one still gets simplified");
+		}
+	}
+	dropLoDs();
+	mixed->drop();
+	points->drop();
+}
+
+static void benchmarkMeshCache(ISceneManager* smgr)
+{
+	const uint32_t meshCount = 64u;
+	IMeshCache<ICPUMesh>* cache = smgr->getMeshCache();
+	const uint64_t oldBudget = cache->getMemoryBudget();
+	cache->clear();
+	cache->setMemoryBudget(0u);
+
+	std::vector<io::path> names;
+	for (uint32_t i=0; i<meshCount; i++)
+	{
+		char name[32];
+		sprintf(name,"meshCache/cube%02u",i);
+		names.push_back(name);
+		ICPUMesh* cube = smgr->getGeometryCreator()->createCubeMeshCPU(vector3df(1.f));
+		cache->addMesh(names.back(),cube);
+		cube->drop();
+	}
+	const uint64_t meshSize = cache->getMemoryUsage()/meshCount;
+
+	uint32_t next = 0u;
+	measure("meshCache/getMeshByName",1u,[&]()
+		{
+			if (!cache->getMeshByName(names[next++%meshCount]))
+				Sink = 0.f;
+		});
+
+	//! touch the even meshes, so the odd ones are the least recently used, and keep one odd mesh referenced
+	for (uint32_t i=0; i<meshCount; i+=2u)
+		cache->getMeshByName(names[i]);
+	ICPUMesh* held = cache->getMeshByName(names[1]);
+	held->grab();
+	cache->resetStatistics();
+
+	//! half the budget evicts the 31 unreferenced odd meshes and then the least recently used even one
+	cache->setMemoryBudget(meshSize*meshCount/2u);
+	const SMeshCacheStatistics stats = cache->getStatistics();
+	check(stats.Evictions==meshCount/2u&&stats.EvictedBytes==meshSize*meshCount/2u,"mesh cache evicts down to its budget");
+	check(cache->getMemoryUsage()<=cache->getMemoryBudget(),"mesh cache usage is within its budget after eviction");
+	bool lruOrder = cache->isMeshLoaded(names[1])&&!cache->isMeshLoaded(names[0]);
+	for (uint32_t i=2u; i<meshCount; i++)
+		lruOrder = lruOrder&&cache->isMeshLoaded(names[i])==(i%2u==0u);
+	check(lruOrder,"mesh cache evicts least recently used unreferenced meshes first");
+
+	//! adding past the budget evicts the next least recently used one
+	ICPUMesh* extra = smgr->getGeometryCreator()->createCubeMeshCPU(vector3df(1.f));
+	cache->addMesh("meshCache/extra",extra);
+	extra->drop();
+	check(cache->isMeshLoaded("meshCache/extra")&&!cache->isMeshLoaded(names[2])&&cache->isMeshLoaded(names[4]),"mesh cache evicts on adding past its budget");
+	held->drop();
+
+	//! with two meshes under one name, removing or renaming the newer one makes the older one findable again
+	cache->setMemoryBudget(0u);
+	ICPUMesh* older = smgr->getGeometryCreator()->createCubeMeshCPU(vector3df(1.f));
+	ICPUMesh* newer = smgr->getGeometryCreator()->createCubeMeshCPU(vector3df(1.f));
+	cache->addMesh("meshCache/same",older);
+	cache->addMesh("meshCache/same",newer);
+	check(cache->getMeshByName("meshCache/same")==newer,"mesh cache finds the newest mesh added under a name");
+	cache->removeMesh(newer);
+	check(cache->getMeshByName("meshCache/same")==older,"mesh cache finds the older mesh under a name after removing the newer one");
+	cache->addMesh("meshCache/same",newer);
+	cache->renameMesh(newer,"meshCache/renamed");
+	check(cache->getMeshByName("meshCache/same")==older&&cache->getMeshByName("meshCache/renamed")==newer,"mesh cache finds the older mesh under a name after renaming the newer one");
+	older->drop();
+	newer->drop();
+
+	cache->clear();
+	cache->resetStatistics();
+	cache->setMemoryBudget(oldBudget);
+}
+
+//! Puts the data in an actual file, so the loaders get to read it through CReadFile like they do outside of benchmarks
+static bool writeDiskFile(io::IFileSystem* fs, const char* fileName, const void* data, const size_t& size)
+{
+	io::IWriteFile* file = fs->createAndWriteFile(fileName);
+	if (!file)
+		return false;
+	const bool written = file->write(data,size)==int32_t(size);
+	file->drop();
+	return written;
+}
+
+//! Loads from memory, and then once more from disk as "<name>/fromDisk"
+static void benchmarkMeshLoader(ISceneManager* smgr, io::IFileSystem* fs, const char* name, const char* fileName,
+								const void* data, const size_t& size, const uint64_t& indexCount)
+{
+	auto load = [&](const bool fromDisk) -> bool
+	{
+		io::IReadFile* file = fromDisk ? fs->createAndOpenFile(fileName):fs->createMemoryReadFile(data,size,fileName);
+		if (!file)
+			return false;
+		ICPUMesh* loadedMesh = smgr->getMesh(file);
+		file->drop();
+		if (!loadedMesh)
+			return false;
+		smgr->getMeshCache()->removeMesh(loadedMesh);
+		return true;
+	};
+	if ((!NameFilter||strstr(name,NameFilter))&&!load(false))
+	{
+		printf("%s could not load its input, skipping it\n",name);
+		return;
+	}
+	measure(name,indexCount,[&]() {load(false);});
+
+	const std::string diskName = std::string(name)+"/fromDisk";
+	if ((!NameFilter||strstr(diskName.c_str(),NameFilter))&&writeDiskFile(fs,fileName,data,size))
+	{
+		measure(diskName.c_str(),indexCount,[&]() {load(true);});
+		remove(fileName);
+	}
+}
+
+//! A UV sphere as plain arrays, for the formats which have a loader but no writer.
+struct SGeneratedMesh
+{
+	std::vector<vector3df> positions;
+	std::vector<vector3df> normals;
+	std::vector<vector2df> uvs;
+	std::vector<uint32_t> indices;
+};
+
+static void generateSphere(SGeneratedMesh& mesh, const uint32_t& segments)
+{
+	for (uint32_t y=0; y<=segments; y++)
+	for (uint32_t x=0; x<=segments; x++)
+	{
+		const float theta = PI*float(y)/float(segments);
+		const float phi = 2.f*PI*float(x)/float(segments);
+		const vector3df normal(sinf(theta)*cosf(phi),cosf(theta),sinf(theta)*sinf(phi));
+		mesh.positions.push_back(normal*5.f);
+		mesh.normals.push_back(normal);
+		mesh.uvs.push_back(vector2df(float(x)/float(segments),float(y)/float(segments)));
+	}
+	for (uint32_t y=0; y<segments; y++)
+	for (uint32_t x=0; x<segments; x++)
+	{
+		const uint32_t corner = y*(segments+1u)+x;
+		const uint32_t quad[6] = {corner,corner+1u,corner+segments+1u,corner+1u,corner+segments+2u,corner+segments+1u};
+		mesh.indices.insert(mesh.indices.end(),quad,quad+6);
+	}
+}
+
+static std::string generateOBJ(const SGeneratedMesh& mesh)
+{
+	std::string obj;
+	char line[256];
+	for (size_t i=0; i<mesh.positions.size(); i++)
+	{
+		sprintf(line,"v %f %f %f\nvn %f %f %f\nvt %f %f\n",mesh.positions[i].X,mesh.positions[i].Y,mesh.positions[i].Z,
+				mesh.normals[i].X,mesh.normals[i].Y,mesh.normals[i].Z,mesh.uvs[i].X,mesh.uvs[i].Y);
+		obj += line;
+	}
+	for (size_t i=0; i<mesh.indices.size(); i+=3)
+	{
+		const uint32_t a = mesh.indices[i]+1u, b = mesh.indices[i+1]+1u, c = mesh.indices[i+2]+1u;
+		sprintf(line,"f %u/%u/%u %u/%u/%u %u/%u/%u\n",a,a,a,b,b,b,c,c,c);
+		obj += line;
+	}
+	return obj;
+}
+
+static std::string generateX(const SGeneratedMesh& mesh)
+{
+	const size_t vertexCount = mesh.positions.size();
+	const size_t faceCount = mesh.indices.size()/3u;
+	char line[256];
+
+	std::string x("xof 0303txt 0032\nMesh {\n");
+	sprintf(line,"%u;\n",uint32_t(vertexCount));
+	x += line;
+	for (size_t i=0; i<vertexCount; i++)
+	{
+		sprintf(line,"%f;%f;%f;%s\n",mesh.positions[i].X,mesh.positions[i].Y,mesh.positions[i].Z,i+1u<vertexCount ? ",":";");
+		x += line;
+	}
+	std::string faces;
+	sprintf(line,"%u;\n",uint32_t(faceCount));
+	faces += line;
+	for (size_t i=0; i<faceCount; i++)
+	{
+		sprintf(line,"3;%u,%u,%u;%s\n",mesh.indices[i*3],mesh.indices[i*3+1],mesh.indices[i*3+2],i+1u<faceCount ? ",":";");
+		faces += line;
+	}
+	x += faces;
+
+	sprintf(line,"MeshNormals {\n%u;\n",uint32_t(vertexCount));
+	x += line;
+	for (size_t i=0; i<vertexCount; i++)
+	{
+		sprintf(line,"%f;%f;%f;%s\n",mesh.normals[i].X,mesh.normals[i].Y,mesh.normals[i].Z,i+1u<vertexCount ? ",":";");
+		x += line;
+	}
+	x += faces;
+	sprintf(line,"}\nMeshTextureCoords {\n%u;\n",uint32_t(vertexCount));
+	x += line;
+	for (size_t i=0; i<vertexCount; i++)
+	{
+		sprintf(line,"%f;%f;%s\n",mesh.uvs[i].X,mesh.uvs[i].Y,i+1u<vertexCount ? ",":";");
+		x += line;
+	}
+	x += "}\n}\n";
+	return x;
+}
+
+//! Times the mesh writers and the loaders reading their output back, the formats without a writer get generated inputs.
+static void benchmarkMeshIO(IrrlichtDevice* device, ICPUMesh* mesh)
+{
+	io::IFileSystem* fs = device->getFileSystem();
+	ISceneManager* smgr = device->getSceneManager();
+	const uint64_t indexCount = mesh->getMeshBuffer(0)->getIndexCount();
+
+	struct SFormat
+	{
+		EMESH_WRITER_TYPE type;
+		int32_t flags;
+		const char* fileName;
+		const char* writeName;
+		const char* loadName;
+	};
+	const SFormat formats[] = {
+		{EMWT_STL,EMWF_WRITE_BINARY,"benchmark.stl","meshWriter/stl","meshLoader/stl"},
+		{EMWT_STL,EMWF_NONE,"benchmarkAscii.stl","meshWriter/stlAscii","meshLoader/stlAscii"},
+		{EMWT_BAW,EMWF_NONE,"benchmark.baw","baw/write","baw/read"},
+		{EMWT_BAW,EMWF_WRITE_COMPRESSED,"benchmarkCompressed.baw","baw/writeCompressed","baw/readCompressed"}
+	};
+
+	std::vector<uint8_t> memory(256u<<20);
+	for (size_t i=0; i<sizeof(formats)/sizeof(SFormat); i++)
+	{
+		const SFormat& format = formats[i];
+		IMeshWriter* writer = smgr->createMeshWriter(format.type);
+		if (!writer)
+			continue;
+
+		size_t fileSize = 0u;
+		measure(format.writeName,indexCount,[&]()
+		{
+			io::IWriteFile* file = fs->createMemoryWriteFile(memory.data(),memory.size(),format.fileName);
+			writer->writeMesh(file,mesh,format.flags);
+			fileSize = file->getPos();
+			file->drop();
+		});
+
+		//! the writer's benchmark can be filtered out, in which case there is nothing to load yet
+		if (!fileSize)
+		{
+			io::IWriteFile* file = fs->createMemoryWriteFile(memory.data(),memory.size(),format.fileName);
+			writer->writeMesh(file,mesh,format.flags);
+			fileSize = file->getPos();
+			file->drop();
+		}
+
+		//! on disk every write reaches the C library, which is what an unbuffered writer pays for the most
+		const std::string diskName = std::string(format.writeName)+"/toDisk";
+		measure(diskName.c_str(),indexCount,[&]()
+		{
+			io::IWriteFile* file = fs->createAndWriteFile(format.fileName);
+			if (!file)
+				return;
+			writer->writeMesh(file,mesh,format.flags);
+			file->drop();
+		});
+		writer->drop();
+
+		benchmarkMeshLoader(smgr,fs,format.loadName,format.fileName,memory.data(),fileSize,indexCount);
+	}
+
+	//! NEW_MESHES compiles out the OBJ writer and both PLY loader and writer, X never had a writer
+	SGeneratedMesh generated;
+	generateSphere(generated,256u);
+	const std::string obj = generateOBJ(generated);
+	benchmarkMeshLoader(smgr,fs,"meshLoader/obj","benchmark.obj",obj.data(),obj.size(),generated.indices.size());
+	const std::string x = generateX(generated);
+	benchmarkMeshLoader(smgr,fs,"meshLoader/x","benchmark.x",x.data(),x.size(),generated.indices.size());
+}
+
+//! Sizes and read speeds of BAW files with no compression, LZMA, the geometry coding followed by LZ4 and the codecs picked per blob for the fastest load or the smallest file,
+//! on the sphere as generated and as reordered by createOptimizedMeshBuffer. The error of a read is how many bytes of the index and vertex buffers differ from what was written.
+static void benchmarkBAWCoding(IrrlichtDevice* device, ICPUMesh* sphere)
+{
+	io::IFileSystem* fs = device->getFileSystem();
+	ISceneManager* smgr = device->getSceneManager();
+	IMeshWriter* writer = smgr->createMeshWriter(EMWT_BAW);
+	CBAWMeshWriter* bawWriter = dynamic_cast<CBAWMeshWriter*>(writer);
+	if (!bawWriter)
+	{
+		if (writer)
+			writer->drop();
+		return;
+	}
+
+	IMeshManipulator::SErrorMetric metrics[EVAI_COUNT];
+	SCPUMesh* optimized = new SCPUMesh();
+	ICPUMeshBuffer* optimizedBuffer = smgr->getMeshManipulator()->createOptimizedMeshBuffer(sphere->getMeshBuffer(0),metrics);
+	if (optimizedBuffer)
+	{
+		optimized->addMeshBuffer(optimizedBuffer);
+		optimizedBuffer->drop();
+	}
+
+	struct SSample
+	{
+		const char* name;
+		ICPUMesh* mesh;
+	};
+	const SSample samples[] = {{"sphere",sphere},{"optimized",optimized}};
+	struct SCoding
+	{
+		const char* name;
+		int32_t flags;
+		//! negative to write with `flags` alone
+		int32_t selection;
+	};
+	const SCoding codings[] = {
+		{"Raw",EMWF_NONE,-1},
+		{"Lzma",EMWF_WRITE_COMPRESSED,-1},
+		{"Geometry",EMWF_WRITE_COMPRESSED|EMWF_WRITE_GEOMETRY_CODED,-1},
+		{"MinLoadTime",EMWF_NONE,CBAWMeshWriter::ECS_MIN_LOAD_TIME},
+		{"MinSize",EMWF_NONE,CBAWMeshWriter::ECS_MIN_SIZE}
+	};
+
+	auto countMismatchedBytes = [](ICPUMeshBuffer* a, ICPUMeshBuffer* b) -> double
+	{
+		auto compare = [](const ICPUBuffer* x, const ICPUBuffer* y) -> double
+		{
+			if (!x||!y)
+				return x==y ? 0.0:DBL_MAX;
+			if (x->getSize()!=y->getSize())
+				return DBL_MAX;
+			double mismatched = 0.0;
+			for (size_t i=0; i<x->getSize(); i++)
+				mismatched += ((const uint8_t*)x->getPointer())[i]!=((const uint8_t*)y->getPointer())[i] ? 1.0:0.0;
+			return mismatched;
+		};
+		double mismatched = compare(a->getMeshDataAndFormat()->getIndexBuffer(),b->getMeshDataAndFormat()->getIndexBuffer());
+		for (uint32_t attr=0; attr<EVAI_COUNT; attr++)
+			mismatched += compare(a->getMeshDataAndFormat()->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)attr),b->getMeshDataAndFormat()->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)attr));
+		return mismatched;
+	};
+
+	std::vector<uint8_t> memory(256u<<20);
+	for (size_t i=0; i<sizeof(samples)/sizeof(SSample); i++)
+	{
+		ICPUMesh* mesh = samples[i].mesh;
+		if (!mesh->getMeshBufferCount())
+			continue;
+		const uint64_t indexCount = mesh->getMeshBuffer(0)->getIndexCount();
+
+		//! what the sizes get compared to, written even if the raw read is filtered out
+		io::IWriteFile* rawFile = fs->createMemoryWriteFile(memory.data(),memory.size(),"benchmarkCoding.baw");
+		writer->writeMesh(rawFile,mesh,EMWF_NONE);
+		const size_t rawSize = rawFile->getPos();
+		rawFile->drop();
+
+		for (size_t j=0; j<sizeof(codings)/sizeof(SCoding); j++)
+		{
+			const std::string name = std::string("baw/")+samples[i].name+"/read"+codings[j].name;
+			if (NameFilter&&!strstr(name.c_str(),NameFilter))
+				continue;
+
+			io::IWriteFile* file = fs->createMemoryWriteFile(memory.data(),memory.size(),"benchmarkCoding.baw");
+			CBAWMeshWriter::SCodecSelectionSummary summary;
+			if (codings[j].selection<0)
+				writer->writeMesh(file,mesh,codings[j].flags);
+			else
+			{
+				CBAWMeshWriter::WriteProperties properties;
+				properties.encryptBlobBitField = CBAWMeshWriter::EET_NOTHING;
+				properties.geometryCoding = true;
+				properties.codecSelection = (CBAWMeshWriter::E_CODEC_SELECTION)codings[j].selection;
+				properties.summary = &summary;
+				bawWriter->writeMesh(file,mesh,properties);
+			}
+			const size_t fileSize = file->getPos();
+			file->drop();
+
+			ICPUMesh* loaded = NULL;
+			auto load = [&]()
+			{
+				io::IReadFile* readFile = fs->createMemoryReadFile(memory.data(),fileSize,"benchmarkCoding.baw");
+				loaded = smgr->getMesh(readFile);
+				readFile->drop();
+				if (loaded)
+				{
+					loaded->grab();
+					smgr->getMeshCache()->removeMesh(loaded);
+				}
+			};
+			load();
+			if (!loaded)
+			{
+				printf("%s could not load its input, skipping it\n",name.c_str());
+				continue;
+			}
+			const double mismatched = loaded->getMeshBufferCount() ? countMismatchedBytes(mesh->getMeshBuffer(0),loaded->getMeshBuffer(0)):DBL_MAX;
+			loaded->drop();
+
+			printf("%-48s %14u bytes %13.3f of raw\n",name.c_str(),uint32_t(fileSize),double(fileSize)/double(rawSize));
+			if (codings[j].selection>=0)
+				printf("%-48s %8u LZ4, %u LZ4HC, %u LZMA, %u raw blobs, %u geometry coded, projected load %.2f ms\n","",summary.blobCount[CBAWMeshWriter::EBC_LZ4],summary.blobCount[CBAWMeshWriter::EBC_LZ4HC],
+						summary.blobCount[CBAWMeshWriter::EBC_LZMA],summary.blobCount[CBAWMeshWriter::EBC_RAW],summary.geometryCodedBlobs,summary.projectedLoadTime*1000.0);
+			if (measure(name.c_str(),indexCount,[&]() {load(); if (loaded) loaded->drop();}))
+				Results.back().maxError = mismatched;
+		}
+	}
+
+	optimized->drop();
+	writer->drop();
+}
+
+//! PSNR in dB of `decoded` against `reference`, both R8G8B8A8, over the first `channels` channels
+static double psnrRGBA(const uint8_t* reference, const uint8_t* decoded, const size_t& texelCount, const uint32_t& channels)
+{
+	double squaredError = 0.0;
+	for (size_t i=0; i<texelCount; i++)
+	for (uint32_t c=0; c<channels; c++)
+	{
+		const double difference = double(reference[i*4u+c])-double(decoded[i*4u+c]);
+		squaredError += difference*difference;
+	}
+	if (squaredError==0.0)
+		return DBL_MAX;
+	return 10.0*std::log10(255.0*255.0*double(texelCount*channels)/squaredError);
+}
+
+//! BC1 to BC5 compression of a smooth image with some noise, every block format is decoded again and has to stay above a PSNR,
+//! then the same through the DDS writer and loader.
+static void benchmarkBlockCompression(IVideoDriver* driver, io::IFileSystem* fs)
+{
+	const uint32_t size = 256u;
+	const size_t texelCount = size*size;
+	uint32_t seed = 5u;
+	std::vector<uint8_t> texels(texelCount*4u);
+	for (uint32_t y=0; y<size; y++)
+	for (uint32_t x=0; x<size; x++)
+	{
+		uint8_t* texel = texels.data()+(y*size+x)*4u;
+		texel[0] = uint8_t(x+randomFloat(seed)*4.f);
+		texel[1] = uint8_t(y+randomFloat(seed)*4.f);
+		texel[2] = uint8_t((x+y)/2u+randomFloat(seed)*4.f);
+		texel[3] = uint8_t(255u-(x^y)/4u);
+	}
+
+	struct SFormat
+	{
+		const char* name;
+		ECOLOR_FORMAT format;
+		uint32_t channels;
+		double minPSNR;
+	};
+	const SFormat formats[] = {{"bc1",ECF_RGBA_BC1,3u,35.0},{"bc3",ECF_RGBA_BC3,4u,35.0},{"bc4",ECF_R_BC4,1u,55.0},{"bc5",ECF_RG_BC5,2u,55.0}};
+	const CBlockCompressor::E_COMPRESSION_QUALITY qualities[] = {CBlockCompressor::ECQ_FAST,CBlockCompressor::ECQ_HIGH};
+	const char* const qualityNames[] = {"Fast","High"};
+
+	std::vector<uint8_t> decoded(texelCount*4u);
+	for (size_t f=0; f<sizeof(formats)/sizeof(SFormat); f++)
+	for (size_t q=0; q<2u; q++)
+	{
+		std::vector<uint8_t> blocks(CBlockCompressor::getCompressedSize(formats[f].format,size,size));
+		const std::string name = std::string("blockCompressor/")+formats[f].name+qualityNames[q];
+		const bool compressed = CBlockCompressor::compress(texels.data(),ECF_R8G8B8A8,size,size,size*4u,blocks.data(),formats[f].format,qualities[q]);
+		measure(name.c_str(),texelCount,[&]()
+		{
+			CBlockCompressor::compress(texels.data(),ECF_R8G8B8A8,size,size,size*4u,blocks.data(),formats[f].format,qualities[q]);
+		});
+
+		const bool decompressed = compressed&&CBlockCompressor::decompress(blocks.data(),formats[f].format,size,size,decoded.data(),size*4u);
+		const double psnr = decompressed ? psnrRGBA(texels.data(),decoded.data(),texelCount,formats[f].channels):0.0;
+		check(psnr>=formats[f].minPSNR,(name+" round trip PSNR").c_str());
+		if (!NameFilter||strstr(name.c_str(),NameFilter))
+			printf("%-48s %.2f dB\n","",psnr);
+	}
+
+	//! the writer gets A8R8G8B8, the loader has to give back the BC3 blocks it wrote
+	IImage* image = driver->createImage(ECF_A8R8G8B8,dimension2d<uint32_t>(size,size));
+	uint32_t* pixels = reinterpret_cast<uint32_t*>(image->getData());
+	for (size_t i=0; i<texelCount; i++)
+		pixels[i] = SColor(texels[i*4u+3u],texels[i*4u+0u],texels[i*4u+1u],texels[i*4u+2u]).color;
+
+	std::vector<uint8_t> memory(texelCount*4u);
+	io::IWriteFile* outFile = fs->createMemoryWriteFile(memory.data(),memory.size(),"roundtrip.dds");
+	const bool written = driver->writeImageToFile(image,outFile,EDWF_BC3);
+	const size_t fileSize = outFile->getPos();
+	outFile->drop();
+	image->drop();
+
+	double psnr = 0.0;
+	if (written)
+	{
+		io::IReadFile* inFile = fs->createMemoryReadFile(memory.data(),fileSize,"roundtrip.dds");
+		const std::vector<CImageData*> mipChain = driver->createImageDataFromFile(inFile);
+		inFile->drop();
+		if (mipChain.size()==1u&&mipChain[0]->getColorFormat()==ECF_RGBA_BC3&&CBlockCompressor::decompress(mipChain[0]->getData(),ECF_RGBA_BC3,size,size,decoded.data(),size*4u))
+			psnr = psnrRGBA(texels.data(),decoded.data(),texelCount,4u);
+		IVideoDriver::dropWholeMipChain(mipChain);
+	}
+	check(psnr>=35.0,"DDS writer and loader BC3 round trip PSNR");
+	if (!NameFilter||strstr("blockCompressor/dds",NameFilter))
+		printf("%-48s BC3 through DDS: %.2f dB\n","",psnr);
+}
+
+static void benchmarkImageIO(IVideoDriver* driver, io::IFileSystem* fs, IImage* image)
+{
+	const uint64_t pixelCount = image->getImageDataSizeInPixels();
+	const char* const extensions[] = {"png","jpg","bmp","tga","ppm","pcx","psd","dds"};
+
+	std::vector<uint8_t> memory(64u<<20);
+	for (size_t i=0; i<sizeof(extensions)/sizeof(const char*); i++)
+	{
+		const std::string fileName = std::string("benchmark.")+extensions[i];
+		io::IWriteFile* outFile = fs->createMemoryWriteFile(memory.data(),memory.size(),fileName.c_str());
+		const bool written = driver->writeImageToFile(image,outFile);
+		const size_t fileSize = outFile->getPos();
+		outFile->drop();
+		if (!written||!fileSize)
+		{
+			printf("no image writer could write %s, skipping its loader\n",fileName.c_str());
+			continue;
+		}
+
+		const std::string name = std::string("imageLoader/")+extensions[i];
+		auto load = [&](const bool fromDisk) -> bool
+		{
+			io::IReadFile* file = fromDisk ? fs->createAndOpenFile(fileName.c_str()):fs->createMemoryReadFile(memory.data(),fileSize,fileName.c_str());
+			if (!file)
+				return false;
+			const std::vector<CImageData*> mipChain = driver->createImageDataFromFile(file);
+			file->drop();
+			IVideoDriver::dropWholeMipChain(mipChain);
+			return !mipChain.empty();
+		};
+		if ((!NameFilter||strstr(name.c_str(),NameFilter))&&!load(false))
+		{
+			printf("%s could not load its input, skipping it\n",name.c_str());
+			continue;
+		}
+		measure(name.c_str(),pixelCount,[&]() {load(false);});
+
+		const std::string diskName = name+"/fromDisk";
+		if ((!NameFilter||strstr(diskName.c_str(),NameFilter))&&writeDiskFile(fs,fileName.c_str(),memory.data(),fileSize))
+		{
+			measure(diskName.c_str(),pixelCount,[&]() {load(true);});
+			remove(fileName.c_str());
+		}
+	}
+}
+
+//! What a chunk based loader pays per field, four bytes at a time through CReadFile and through a CBufferedReadFile wrapped around it
+static void benchmarkBufferedReads(io::IFileSystem* fs)
+{
+	const char* fileName = "benchmark.bin";
+	const uint32_t valueCount = 1u<<20;
+	std::vector<uint32_t> values(valueCount);
+	for (uint32_t i=0; i<valueCount; i++)
+		values[i] = i*2654435761u;
+	if (!writeDiskFile(fs,fileName,values.data(),values.size()*sizeof(uint32_t)))
+		return;
+
+	io::IReadFile* file = fs->createAndOpenFile(fileName);
+	if (file)
+	{
+		measure("io/readFile/read4Bytes",valueCount,[&]()
+		{
+			uint32_t sum = 0u, value = 0u;
+			file->seek(0);
+			for (uint32_t i=0; i<valueCount; i++)
+			{
+				file->read(&value,sizeof(value));
+				sum += value;
+			}
+			Sink = float(sum);
+		});
+		measure("io/bufferedReadFile/readLE4Bytes",valueCount,[&]()
+		{
+			uint32_t sum = 0u, value = 0u;
+			file->seek(0);
+			io::CBufferedReadFile buffered(file);
+			for (uint32_t i=0; i<valueCount; i++)
+			{
+				buffered.readLE(value);
+				sum += value;
+			}
+			Sink = float(sum);
+		});
+		file->drop();
+	}
+	remove(fileName);
+}
+
+//! Reads every entry of a PAK archive through the limit files it hands out, split over one and then all hardware threads.
+//! The entries are opened up front since the file system itself is not thread safe, only the reads happen concurrently.
+static void benchmarkArchive(io::IFileSystem* fs)
+{
+	const char* fileName = "benchmark.pak";
+	const uint32_t entryCount = 64u;
+	const uint32_t entrySize = 1u<<19;
+	//! same layout as io::SPAKFileHeader and io::SPAKFileEntry
+	struct SEntry
+	{
+		char name[56];
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	std::vector<uint8_t> data(12u+size_t(entryCount)*entrySize+entryCount*sizeof(SEntry));
+	uint32_t header[3] = {0x4b434150u,uint32_t(12u+entryCount*entrySize),uint32_t(entryCount*sizeof(SEntry))}; // "PACK"
+	memcpy(data.data(),header,sizeof(header));
+	uint32_t seed = 5u;
+	for (uint32_t i=0; i<entryCount*entrySize; i++)
+		data[12u+i] = uint8_t(randomFloat(seed)*256.f);
+	for (uint32_t i=0; i<entryCount; i++)
+	{
+		SEntry entry;
+		memset(&entry,0,sizeof(entry));
+		sprintf(entry.name,"entry%u.bin",i);
+		entry.offset = 12u+i*entrySize;
+		entry.length = entrySize;
+		memcpy(&data[header[1]+i*sizeof(SEntry)],&entry,sizeof(entry));
+	}
+
+	io::IWriteFile* outFile = fs->createAndWriteFile(fileName);
+	const bool written = outFile&&outFile->write(data.data(),data.size())==int32_t(data.size());
+	if (outFile)
+		outFile->drop();
+	io::IFileArchive* archive = NULL;
+	if (!written||!fs->addFileArchive(fileName,true,true,io::EFAT_PAK,"",&archive))
+	{
+		printf("could not write or open %s, skipping the archive benchmarks\n",fileName);
+		return;
+	}
+
+	std::vector<io::IReadFile*> entries;
+	for (uint32_t i=0; i<entryCount; i++)
+	{
+		//! not by index, the archive sorts its file list
+		char entryName[56];
+		sprintf(entryName,"entry%u.bin",i);
+		io::IReadFile* entry = archive->createAndOpenFile(io::path(entryName));
+		if (entry)
+			entries.push_back(entry);
+	}
+
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(),1u);
+	const uint32_t threadCounts[] = {1u,hardwareThreads};
+	for (size_t j=0; entries.size()==entryCount&&j<(hardwareThreads>1u ? 2u:1u); j++)
+	{
+		const uint32_t threadCount = threadCounts[j];
+		std::vector<uint8_t> chunks(size_t(threadCount)<<16);
+		std::vector<uint32_t> mismatches(threadCount);
+		auto readEntries = [&](const uint32_t thread)
+		{
+			uint8_t* chunk = &chunks[size_t(thread)<<16];
+			for (uint32_t i=thread; i<entryCount; i+=threadCount)
+			{
+				io::IReadFile* entry = entries[i];
+				entry->seek(0);
+				for (uint32_t offset=0u; offset<entrySize; offset+=1u<<16)
+				{
+					if (entry->read(chunk,1u<<16)!=(1<<16) || memcmp(chunk,&data[12u+i*entrySize+offset],1u<<16))
+						mismatches[thread]++;
+				}
+			}
+		};
+		char name[64];
+		sprintf(name,"io/pakArchive/readEntries/%uthreads",threadCount);
+		measure(name,uint64_t(entryCount)*entrySize,[&]()
+		{
+			std::vector<std::thread> threads;
+			for (uint32_t i=1u; i<threadCount; i++)
+				threads.push_back(std::thread(readEntries,i));
+			readEntries(0u);
+			for (size_t i=0; i<threads.size(); i++)
+				threads[i].join();
+		});
+		uint32_t totalMismatches = 0u;
+		for (uint32_t i=0; i<threadCount; i++)
+			totalMismatches += mismatches[i];
+		if (totalMismatches)
+			printf("%s read %u chunks that do not match what was written\n",name,totalMismatches);
+	}
+
+	if (entries.size()!=entryCount)
+		printf("%s did not open all of its entries, skipping the archive benchmarks\n",fileName);
+	for (size_t i=0; i<entries.size(); i++)
+		entries[i]->drop();
+	fs->removeFileArchive(archive);
+	remove(fileName);
+}
+
+static void benchmarkColorConverter(IVideoDriver* driver, IImage* image)
+{
+	const uint32_t pixelCount = image->getImageDataSizeInPixels();
+	std::vector<uint8_t> rgb(pixelCount*3u), converted(pixelCount*4u);
+	driver->convertColor(image->getData(),ECF_A8R8G8B8,pixelCount,rgb.data(),ECF_R8G8B8);
+
+	const struct
+	{
+		const char* name;
+		const void* source;
+		ECOLOR_FORMAT sourceFormat;
+		ECOLOR_FORMAT destinationFormat;
+	} conversions[] = {
+		{"colorConverter/A8R8G8B8toR8G8B8",image->getData(),ECF_A8R8G8B8,ECF_R8G8B8},
+		{"colorConverter/A8R8G8B8toR8G8B8A8",image->getData(),ECF_A8R8G8B8,ECF_R8G8B8A8},
+		{"colorConverter/A8R8G8B8toR5G6B5",image->getData(),ECF_A8R8G8B8,ECF_R5G6B5},
+		{"colorConverter/A8R8G8B8toA1R5G5B5",image->getData(),ECF_A8R8G8B8,ECF_A1R5G5B5},
+		{"colorConverter/R8G8B8toA8R8G8B8",rgb.data(),ECF_R8G8B8,ECF_A8R8G8B8}
+	};
+	for (size_t i=0; i<sizeof(conversions)/sizeof(conversions[0]); i++)
+	{
+		measure(conversions[i].name,pixelCount,[&]()
+		{
+			driver->convertColor(conversions[i].source,conversions[i].sourceFormat,pixelCount,converted.data(),conversions[i].destinationFormat);
+		});
+	}
+}
+
+static void benchmarkBlit(IVideoDriver* driver, IImage* image)
+{
+	const dimension2d<uint32_t>& size = image->getDimension();
+	const uint64_t pixelCount = image->getImageDataSizeInPixels();
+
+	IImage* target = driver->createImage(ECF_A8R8G8B8,size);
+	IImage* halfTarget = driver->createImage(ECF_A8R8G8B8,dimension2d<uint32_t>(size.Width/2u,size.Height/2u));
+	const rect<int32_t> sourceRect(0,0,size.Width,size.Height);
+
+	measure("blit/copyTo",pixelCount,[&]()
+	{
+		image->copyTo(target);
+	});
+	measure("blit/copyToWithAlpha",pixelCount,[&]()
+	{
+		image->copyToWithAlpha(target,position2d<int32_t>(0,0),sourceRect,SColor(255,255,255,255));
+	});
+	measure("blit/copyToScalingBoxFilter",pixelCount,[&]()
+	{
+		image->copyToScalingBoxFilter(halfTarget);
+	});
+
+	halfTarget->drop();
+	target->drop();
+}
+
+//! Mip chains of the test image with both filters, and the contents of chains of small images:
+//! odd sizes have to halve rounding down and a constant color has to stay the same on every level.
+static void benchmarkMipMapGenerator(IImage* image)
+{
+	CImageData* base = new CImageData(image);
+	CMipMapGenerator::SParameters params;
+	measure("mipMapGenerator/box",image->getImageDataSizeInPixels(),[&]()
+	{
+		IVideoDriver::dropWholeMipChain(CMipMapGenerator::generateMipChain(base,params));
+	});
+	params.filter = CMipMapGenerator::EMGF_KAISER;
+	measure("mipMapGenerator/kaiser",image->getImageDataSizeInPixels(),[&]()
+	{
+		IVideoDriver::dropWholeMipChain(CMipMapGenerator::generateMipChain(base,params));
+	});
+	base->drop();
+
+	const uint8_t color[4] = {37u,200u,128u,90u};
+	const uint32_t width = 37u, height = 10u;
+	std::vector<uint8_t> texels(width*height*4u);
+	for (size_t i=0; i<width*height; i++)
+		memcpy(texels.data()+i*4u,color,4u);
+	uint32_t minCoord[3] = {0u,0u,0u};
+	uint32_t maxCoord[3] = {width,height,1u};
+	base = new CImageData(texels.data(),minCoord,maxCoord,0u,ECF_R8G8B8A8);
+	for (uint32_t f=0; f<2u; f++)
+	for (uint32_t sRGB=0; sRGB<2u; sRGB++)
+	{
+		CMipMapGenerator::SParameters constantParams;
+		constantParams.filter = f ? CMipMapGenerator::EMGF_KAISER:CMipMapGenerator::EMGF_BOX;
+		constantParams.sRGB = sRGB!=0u;
+		const std::vector<CImageData*> chain = CMipMapGenerator::generateMipChain(base,constantParams);
+		bool sizesRight = chain.size()==CMipMapGenerator::getFullMipChainLength(width,height)&&chain.size()==6u;
+		bool constant = true;
+		for (size_t level=0; level<chain.size(); level++)
+		{
+			const uint32_t levelWidth = std::max(width>>level,1u);
+			const uint32_t levelHeight = std::max(height>>level,1u);
+			sizesRight = sizesRight&&chain[level]->getSliceMax()[0]==levelWidth&&chain[level]->getSliceMax()[1]==levelHeight&&chain[level]->getSupposedMipLevel()==level;
+			if (!sizesRight)
+				break;
+			for (uint32_t y=0; y<levelHeight; y++)
+			for (uint32_t x=0; x<levelWidth; x++)
+				constant = constant&&memcmp(reinterpret_cast<const uint8_t*>(chain[level]->getSliceRowPointer(0u,y))+x*4u,color,4u)==0;
+		}
+		check(sizesRight,f ? "mip chain of a 37x10 image has the level sizes of a full chain, Kaiser":"mip chain of a 37x10 image has the level sizes of a full chain, box");
+		check(constant,sRGB ? "constant color stays constant down the mip chain, sRGB":"constant color stays constant down the mip chain, linear");
+		IVideoDriver::dropWholeMipChain(chain);
+	}
+	base->drop();
+}
+
+static void benchmarkCollision()
+{
+	const uint32_t gridSize = 64u;
+	uint32_t seed = 7u;
+
+	//! a bumpy heightfield, rays come straight down at it
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+	for (uint32_t z=0; z<=gridSize; z++)
+	for (uint32_t x=0; x<=gridSize; x++)
+	{
+		vertices.push_back(float(x));
+		vertices.push_back(randomFloat(seed));
+		vertices.push_back(float(z));
+	}
+	for (uint32_t z=0; z<gridSize; z++)
+	for (uint32_t x=0; x<gridSize; x++)
+	{
+		const uint32_t corner = z*(gridSize+1u)+x;
+		const uint32_t quad[6] = {corner,corner+gridSize+1u,corner+1u,corner+1u,corner+gridSize+1u,corner+gridSize+2u};
+		indices.insert(indices.end(),quad,quad+6);
+	}
+	STriangleMeshCollider* heightfield = new STriangleMeshCollider();
+	heightfield->Init(vertices.data(),indices.size(),indices.data());
+
+	std::vector<vectorSIMDf> origins(ARRAY_SIZE);
+	for (size_t i=0; i<ARRAY_SIZE; i++)
+		origins[i] = vectorSIMDf(randomFloat(seed)*gridSize,2.f,randomFloat(seed)*gridSize);
+	const vectorSIMDf down(0.f,-1.f,0.f);
+
+	measure("collision/triangleMeshRay",ARRAY_SIZE,[&]()
+	{
+		float sum = 0.f;
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+		{
+			float distance;
+			if (heightfield->CollideWithRay(distance,origins[i],down,4.f))
+				sum += distance;
+		}
+		Sink = sum;
+	});
+
+	//! one box per cell of the grid, the heightfield sits in the middle, rays are shot across the whole lot
+	SCollisionEngine engine;
+	for (uint32_t z=0; z<32u; z++)
+	for (uint32_t x=0; x<32u; x++)
+	{
+		SCompoundCollider* collider = new SCompoundCollider();
+		const vector3df corner(float(x)*2.f,randomFloat(seed)*4.f,float(z)*2.f);
+		collider->AddBox(SAABoxCollider(aabbox3df(corner,corner+vector3df(1.f))));
+		SColliderData data;
+		data.instanceID = z*32u+x;
+		collider->setColliderData(data);
+		engine.addCompoundCollider(collider);
+		collider->drop();
+	}
+	SCompoundCollider* heightfieldCollider = new SCompoundCollider();
+	heightfieldCollider->AddTriangleMesh(heightfield);
+	engine.addCompoundCollider(heightfieldCollider);
+	heightfieldCollider->drop();
+	heightfield->drop();
+
+	std::vector<vectorSIMDf> directions(ARRAY_SIZE);
+	for (size_t i=0; i<ARRAY_SIZE; i++)
+	{
+		origins[i] = vectorSIMDf(-1.f,randomFloat(seed)*4.f,randomFloat(seed)*64.f);
+		directions[i] = normalize(vectorSIMDf(1.f,randomFloat(seed)*0.1f-0.05f,randomFloat(seed)-0.5f));
+	}
+
+	measure("collision/engineFastCollide",ARRAY_SIZE,[&]()
+	{
+		float sum = 0.f;
+		for (size_t i=0; i<ARRAY_SIZE; i++)
+		{
+			SColliderData hit;
+			float distance;
+			if (engine.FastCollide(hit,distance,origins[i],directions[i],128.f))
+				sum += distance;
+		}
+		Sink = sum;
+	});
+}
+
+//! whether the segment from `origin` to `target` passes through the box, the end points excluded
+static bool segmentHitsBox(const vector3df& origin, const vector3df& target, const aabbox3df& box)
+{
+	float enter = 0.f, leave = 1.f;
+	const float o[3] = {origin.X,origin.Y,origin.Z};
+	const float d[3] = {target.X-origin.X,target.Y-origin.Y,target.Z-origin.Z};
+	const float lo[3] = {box.MinEdge.X,box.MinEdge.Y,box.MinEdge.Z};
+	const float hi[3] = {box.MaxEdge.X,box.MaxEdge.Y,box.MaxEdge.Z};
+	for (uint32_t k=0; k<3; k++)
+	{
+		if (d[k]==0.f)
+		{
+			if (o[k]<=lo[k]||o[k]>=hi[k])
+				return false;
+			continue;
+		}
+		float t0 = (lo[k]-o[k])/d[k];
+		float t1 = (hi[k]-o[k])/d[k];
+		if (t0>t1)
+			std::swap(t0,t1);
+		enter = std::max(enter,t0);
+		leave = std::min(leave,t1);
+	}
+	return enter<leave&&leave>0.f&&enter<1.f;
+}
+
+//! A city at street level: a grid of buildings as occluders and props scattered over the streets and the yards between them.
+static void benchmarkOcclusion(ISceneManager* smgr)
+{
+	const uint32_t blocks = 32u;
+	const float blockSize = 20.f;
+	const float streetWidth = 6.f;
+	const size_t propCount = 16384u;
+	uint32_t seed = 11u;
+
+	CCPUOcclusionCuller culler;
+	ICPUMesh* cube = smgr->getGeometryCreator()->createCubeMeshCPU(vector3df(1.f));
+	std::vector<aabbox3df> buildings;
+	for (uint32_t z=0; z<blocks; z++)
+	for (uint32_t x=0; x<blocks; x++)
+	{
+		const float height = 10.f+randomFloat(seed)*30.f;
+		const vector3df corner(float(x)*blockSize+streetWidth*0.5f,0.f,float(z)*blockSize+streetWidth*0.5f);
+		buildings.push_back(aabbox3df(corner,corner+vector3df(blockSize-streetWidth,height,blockSize-streetWidth)));
+
+		matrix4x3 transform;
+		transform.setScale(buildings.back().getExtent());
+		transform.setTranslation(buildings.back().getCenter());
+		culler.addOccluder(cube->getMeshBuffer(0),transform);
+	}
+	cube->drop();
+
+	//! half of the props stand on the streets, the others anywhere on the blocks, mostly inside of or behind the buildings
+	std::vector<aabbox3df> props(propCount);
+	for (size_t i=0; i<propCount; i++)
+	{
+		const float cellX = float(uint32_t(randomFloat(seed)*blocks))*blockSize;
+		const float cellZ = float(uint32_t(randomFloat(seed)*blocks))*blockSize;
+		vector3df corner(cellX+randomFloat(seed)*(blockSize-2.f),0.f,cellZ+randomFloat(seed)*(blockSize-2.f));
+		if (i&1u)
+			corner.Y = 2.f;
+		else if (randomFloat(seed)<0.5f)
+			corner.X = cellX+randomFloat(seed)*(streetWidth*0.5f-1.f);
+		else
+			corner.Z = cellZ+randomFloat(seed)*(streetWidth*0.5f-1.f);
+		props[i] = aabbox3df(corner,corner+vector3df(0.5f+randomFloat(seed),0.5f+randomFloat(seed),0.5f+randomFloat(seed)));
+	}
+
+	//! standing on a crossing, looking down a street at an angle
+	const vector3df eye(blocks*blockSize*0.5f,1.7f,blocks*blockSize*0.25f);
+	const float nearValue = 0.1f;
+	matrix4 projection;
+	projection.buildProjectionMatrixPerspectiveFovLH(PI/3.f,2.f,nearValue,2000.f);
+	matrix4x3 view;
+	view.buildCameraLookAtMatrixLH(eye,eye+vector3df(0.4f,0.f,1.f),vector3df(0.f,1.f,0.f));
+	const matrix4 projView = concatenateBFollowedByA(projection,view);
+
+	culler.rasterize(projView,nearValue);
+	const size_t triangles = culler.getRasterizedTriangleCount();
+	measure("occlusion/rasterize",triangles,[&]()
+	{
+		culler.rasterize(projView,nearValue);
+	});
+
+	std::vector<uint8_t> occluded(propCount);
+	measure("occlusion/testBoxesSingleThread",propCount,[&]()
+	{
+		culler.testBoxes(occluded.data(),props.data(),NULL,propCount,1u);
+	});
+	if (!measure("occlusion/testBoxes",propCount,[&]()
+		{
+			culler.testBoxes(occluded.data(),props.data(),NULL,propCount);
+		}))
+		return;
+
+	//! a culled prop is wrong if a ray from the eye reaches one of its corners or its center unobstructed while on screen,
+	//! those are props peeking out less than a pixel past a building's silhouette
+	size_t culled = 0u, wronglyCulled = 0u;
+	for (size_t i=0; i<propCount; i++)
+	{
+		if (!occluded[i])
+			continue;
+		culled++;
+
+		const aabbox3df& prop = props[i];
+		for (uint32_t k=0; k<9u; k++)
+		{
+			const vector3df target = k<8u ? vector3df((k&1u) ? prop.MaxEdge.X:prop.MinEdge.X,(k&2u) ? prop.MaxEdge.Y:prop.MinEdge.Y,(k&4u) ? prop.MaxEdge.Z:prop.MinEdge.Z):prop.getCenter();
+			const float* m = projView.pointer();
+			const float clipX = m[0]*target.X+m[4]*target.Y+m[8]*target.Z+m[12];
+			const float clipY = m[1]*target.X+m[5]*target.Y+m[9]*target.Z+m[13];
+			const float clipW = m[3]*target.X+m[7]*target.Y+m[11]*target.Z+m[15];
+			if (clipW<nearValue||std::abs(clipX)>clipW||std::abs(clipY)>clipW)
+				continue;
+
+			bool hidden = false;
+			for (size_t b=0; b<buildings.size()&&!hidden; b++)
+				hidden = segmentHitsBox(eye,target,buildings[b]);
+			if (!hidden)
+			{
+				wronglyCulled++;
+				break;
+			}
+		}
+	}
+	Results.back().maxError = double(wronglyCulled);
+	printf("%-48s %zu of %zu props culled, %zu of them visible at a corner or the center, %zu triangles\n","",culled,propCount,wronglyCulled,triangles);
+}
+
+static void appendJSONString(std::string& out, const char* str)
+{
+	out += '"';
+	for (; *str; str++)
+	{
+		if (*str=='"'||*str=='\\')
+			out += '\\';
+		out += *str;
+	}
+	out += '"';
+}
+
+static bool writeJSON(io::IFileSystem* fs, const char* fileName)
+{
+	const SCPUFeatures& cpu = SCPUFeatures::get();
+	char numbers[256];
+
+	std::string json("{\n\"suite\":\"IrrlichtBAW\",\n\"version\":");
+	appendJSONString(json,IRRLICHT_SDK_VERSION);
+	sprintf(numbers,",\n\"cpu\":{\"SSE2\":%s,\"SSE3\":%s,\"SSSE3\":%s,\"SSE4_1\":%s,\"AVX\":%s,\"AVX2\":%s,\"FMA\":%s},\n\"benchmarks\":[",
+			cpu.SSE2 ? "true":"false",cpu.SSE3 ? "true":"false",cpu.SSSE3 ? "true":"false",cpu.SSE4_1 ? "true":"false",
+			cpu.AVX ? "true":"false",cpu.AVX2 ? "true":"false",cpu.FMA ? "true":"false");
+	json += numbers;
+	for (size_t i=0; i<Results.size(); i++)
+	{
+		json += i ? ",\n{\"name\":":"\n{\"name\":";
+		appendJSONString(json,Results[i].name.c_str());
+		sprintf(numbers,",\"iterations\":%llu,\"ns_min\":%.3f,\"ns_median\":%.3f,\"items_per_second\":%.1f",
+				(unsigned long long)Results[i].iterations,Results[i].nsMin,Results[i].nsMedian,Results[i].itemsPerSecond);
+		json += numbers;
+		if (Results[i].maxError>=0.0)
+		{
+			sprintf(numbers,",\"max_abs_error\":%.9g",Results[i].maxError);
+			json += numbers;
+		}
+		json += "}";
+	}
+	json += "\n]\n}\n";
+
+	io::IWriteFile* file = fs->createAndWriteFile(fileName);
+	if (!file)
+		return false;
+	const bool written = file->write(json.data(),json.size())==int32_t(json.size());
+	file->drop();
+	return written;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* outputName = argc>1 ? argv[1]:"benchmarks.json";
+	if (argc>2)
+		NameFilter = argv[2];
+
+	irr::SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.DeviceType = EIDT_CONSOLE;
+	params.WindowSize = dimension2d<uint32_t>(1, 1);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return 1;
+	device->getLogger()->setLogLevel(ELL_ERROR);
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+	io::IFileSystem* fs = device->getFileSystem();
+
+	printf("%-48s %17s %17s %22s\n","benchmark","fastest batch","median batch","median throughput");
+
+	benchmarkMath();
+	benchmarkMatrixStreams();
+	benchmarkSkinning();
+	benchmarkAnimationLayers(driver);
+	benchmarkCommandLists(driver);
+
+	ICPUMesh* sphere = smgr->getGeometryCreator()->createSphereMeshCPU(5.f,256u,256u);
+	benchmarkMeshManipulator(smgr->getMeshManipulator(),sphere);
+	benchmarkMeshCache(smgr);
+	benchmarkMeshIO(device,sphere);
+	benchmarkBAWCoding(device,sphere);
+	sphere->drop();
+
+	//! noise on top of a gradient, so the compressing writers have some work to do
+	IImage* image = driver->createImage(ECF_A8R8G8B8,dimension2d<uint32_t>(1024u,1024u));
+	uint32_t seed = 3u;
+	uint32_t* pixels = reinterpret_cast<uint32_t*>(image->getData());
+	for (uint32_t y=0; y<1024u; y++)
+	for (uint32_t x=0; x<1024u; x++)
+		pixels[y*1024u+x] = SColor((x+y)>>3,x>>2,y>>2,uint32_t(randomFloat(seed)*32.f)+(x^y)&0xffu).color;
+
+	benchmarkBlockCompression(driver,fs);
+	benchmarkImageIO(driver,fs,image);
+	benchmarkColorConverter(driver,image);
+	benchmarkBlit(driver,image);
+	benchmarkMipMapGenerator(image);
+	image->drop();
+
+	benchmarkCollision();
+	benchmarkOcclusion(smgr);
+	benchmarkBufferedReads(fs);
+	benchmarkArchive(fs);
+
+	const bool written = writeJSON(fs,outputName);
+	printf(written ? "wrote %s\n":"could not write %s\n",outputName);
+	if (FailedChecks)
+		printf("%u checks failed\n",FailedChecks);
+
+	device->drop();
+
+	return written&&!FailedChecks ? 0:1;
+}
@@ -58,7 +58,14 @@ namespace core
 			EBCT_LZ4 = 0x02,
 			EBCT_LZ4_AES128_GCM = 0x03,
 			EBCT_LZMA = 0x04,
-			EBCT_LZMA_AES128_GCM = 0x05
+			EBCT_LZMA_AES128_GCM = 0x05,
+			//! Index or vertex buffer rearranged by a geometry-aware coding before the LZ4 or LZMA compression, only allowed from file version 1 on
+			EBCT_GEOMETRY = 0x08,
+			EBCT_GEOMETRY_AES128_GCM = 0x09,
+			EBCT_GEOMETRY_LZ4 = 0x0a,
+			EBCT_GEOMETRY_LZ4_AES128_GCM = 0x0b,
+			EBCT_GEOMETRY_LZMA = 0x0c,
+			EBCT_GEOMETRY_LZMA_AES128_GCM = 0x0d
 		};
 		//! Type of blob enumeration
 		enum E_BLOB_TYPE
@@ -0,0 +1,85 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BLOCK_COMPRESSOR_H_INCLUDED__
+#define __C_BLOCK_COMPRESSOR_H_INCLUDED__
+
+#include "CImageData.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! CPU encoder for the BC1 to BC5 (S3TC/RGTC) block compressed formats.
+/** Meant for offline conversion and asset baking, the engine itself never needs to call it at runtime.
+The image is split into rows of 4x4 blocks which are shared out between worker threads.
+Block endpoint search and index selection use SSE2.
+Supported source formats are all the 8bit-per-channel and 16bit packed uncompressed formats
+(ECF_A1R5G5B5, ECF_R5G6B5, ECF_R8G8B8, ECF_A8R8G8B8, ECF_R8, ECF_R8G8, ECF_R8G8B8A8). */
+class CBlockCompressor
+{
+    public:
+        enum E_COMPRESSION_QUALITY
+        {
+            //! Bounding box endpoints with inset, single pass index selection.
+            ECQ_FAST = 0,
+            //! Principal axis endpoints with least squares refinement, the lowest error candidate gets picked.
+            ECQ_HIGH
+        };
+
+        //! Filled in by the compression functions if a pointer is provided.
+        struct SCompressionStatistics
+        {
+            //! Number of source texels which were encoded.
+            uint64_t    texelCount;
+            //! Wall clock time spent compressing, does not include the PSNR measurement.
+            double      seconds;
+            //! texelCount/seconds in millions
+            double      megaTexelsPerSecond;
+            //! Peak signal to noise ratio in dB over the channels stored in the target format, infinite for lossless results.
+            double      PSNR;
+        };
+
+        //! Whether `format` is a block format we can encode into.
+        static bool isEncodableFormat(const ECOLOR_FORMAT& format);
+
+        //! Whether texels of `format` can be fed to the compressor.
+        static bool isSourceFormatSupported(const ECOLOR_FORMAT& format);
+
+        //! Size in bytes of a `width`x`height` image in block format `format`.
+        static size_t getCompressedSize(const ECOLOR_FORMAT& format, const uint32_t& width, const uint32_t& height);
+
+        //! Compresses one 2D image.
+        /**
+        @param srcData First texel of the source image.
+        @param srcFormat Format of the source texels.
+        @param width Width of the source image in texels.
+        @param height Height of the source image in texels.
+        @param srcPitch Distance between the start of two rows in bytes.
+        @param outBlocks Output memory, needs to be at least getCompressedSize(blockFormat,width,height) bytes large.
+        @param blockFormat One of the formats for which isEncodableFormat() returns true.
+        @param quality Speed versus quality trade-off.
+        @param threadCount Number of threads to use, 0 uses all the threads of CJobSystem::getGlobal().
+        @param outStats Optional statistics, if not NULL the PSNR is computed after the compression which costs a decode pass.
+        @returns false if one of the formats is not supported. */
+        static bool compress(const void* srcData, const ECOLOR_FORMAT& srcFormat, const uint32_t& width, const uint32_t& height, const uint32_t& srcPitch,
+                             void* outBlocks, const ECOLOR_FORMAT& blockFormat, const E_COMPRESSION_QUALITY& quality=ECQ_FAST,
+                             const uint32_t& threadCount=0, SCompressionStatistics* outStats=NULL);
+
+        //! Compresses all slices of an image.
+        /** @returns a new CImageData with the same coordinates and mip level hint as `image`, or NULL on failure. Needs to be dropped by the caller. */
+        static CImageData* compress(const CImageData* image, const ECOLOR_FORMAT& blockFormat, const E_COMPRESSION_QUALITY& quality=ECQ_FAST,
+                                    const uint32_t& threadCount=0, SCompressionStatistics* outStats=NULL);
+
+        //! Decodes a block compressed image into R8G8B8A8 texels.
+        /** Channels not present in the block format are returned as 0 for color and 255 for alpha. */
+        static bool decompress(const void* blocks, const ECOLOR_FORMAT& blockFormat, const uint32_t& width, const uint32_t& height,
+                               uint8_t* outRGBA, const uint32_t& outPitch);
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
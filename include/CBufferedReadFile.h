@@ -0,0 +1,126 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BUFFERED_READ_FILE_H_INCLUDED__
+#define __C_BUFFERED_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+#include "irrMath.h"
+#include <vector>
+
+namespace irr
+{
+namespace io
+{
+
+	//! Read-ahead window over another IReadFile, for loaders which read a few bytes at a time.
+	/** Fills its window with one readAt of the wrapped file and serves everything it can from memory,
+	so the many tiny reads of a chunk based or text format cost a memcpy instead of a virtual call and an fread each.
+	The typed and byte reads are inline, loaders should call them on a CBufferedReadFile rather than through IReadFile.
+	Starts at the current position of the wrapped file and leaves it where reading stopped when dropped,
+	it can also live on the stack of a loader for the duration of a load, as long as nothing grabs it.
+	Chunks limit all reads to the end of the innermost one, popChunk skips whatever of it was not read. */
+	class CBufferedReadFile : public IReadFile
+	{
+        public:
+            enum E_DEFAULTS
+            {
+                DEFAULT_WINDOW_SIZE = 0x10000u
+            };
+
+            CBufferedReadFile(IReadFile* file, const size_t& windowSize=DEFAULT_WINDOW_SIZE);
+            virtual ~CBufferedReadFile();
+
+            //! returns how much was read, never past the end of the current chunk
+            virtual int32_t read(void* buffer, uint32_t sizeToRead);
+
+            //! from the window if it has all of it, otherwise straight from the wrapped file, ignores chunks
+            virtual size_t readAt(const size_t& offset, void* buffer, const size_t& sizeToRead);
+
+            //! keeps the window if the new position is inside it, fails past the end of the current chunk
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
+
+            //! returns size of file
+            virtual size_t getSize() const {return FileSize;}
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const {return WindowStart+WindowPos;}
+
+            //! returns name of file
+            virtual const io::path& getFileName() const {return File->getFileName();}
+
+            //! False at the end of the file or of the current chunk
+            inline bool readByte(uint8_t& c)
+            {
+                if (WindowPos==WindowEnd && !fill())
+                    return false;
+                c = Window[WindowPos++];
+                return true;
+            }
+
+            //! Same as readByte but does not consume it
+            inline bool peekByte(uint8_t& c)
+            {
+                if (WindowPos==WindowEnd && !fill())
+                    return false;
+                c = Window[WindowPos];
+                return true;
+            }
+
+            //! Reads a little endian integer or float, false if there were not enough bytes left
+            template<typename T>
+            inline bool readLE(T& value)
+            {
+                if (WindowEnd-WindowPos<sizeof(T) && !fill(sizeof(T)))
+                    return false;
+                memcpy(&value,Window+WindowPos,sizeof(T));
+                WindowPos += sizeof(T);
+#ifdef __BIG_ENDIAN__
+                uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+                for (size_t i=0; i<sizeof(T)/2; i++)
+                    core::swap(bytes[i],bytes[sizeof(T)-1-i]);
+#endif
+                return true;
+            }
+
+            //! Skips bytes without copying them anywhere
+            inline bool skip(const size_t& bytes) {return seek(bytes,true);}
+
+            //! Limits all reads to the next `size` bytes until the matching popChunk, chunks nest.
+            /** \return False if the chunk would reach past the one it is in, nothing gets pushed then. */
+            bool pushChunk(const size_t& size);
+
+            //! Moves to the end of the innermost chunk and lifts its limit
+            void popChunk();
+
+            //! Bytes left until the end of the innermost chunk, or of the file if there is none
+            inline size_t getChunkRemaining() const {return Limit-getPos();}
+
+            //! Number of chunks currently pushed
+            inline size_t getChunkDepth() const {return ChunkEnds.size();}
+
+        private:
+            //! moves the window to the current position and reads at least `atLeast` bytes into it, or what is left before the limit
+            bool fill(const size_t& atLeast=1u);
+
+            IReadFile* File;
+            size_t FileSize;
+            uint8_t* Window;
+            size_t WindowSize;
+            //! file offset of Window[0]
+            size_t WindowStart;
+            //! bytes actually read into the window
+            size_t WindowFilled;
+            //! how many of them can be handed out, never more than there are before Limit
+            size_t WindowEnd;
+            size_t WindowPos;
+            //! end of the innermost chunk or of the file
+            size_t Limit;
+            std::vector<size_t> ChunkEnds;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BUFFERED_WRITE_FILE_H_INCLUDED__
+#define __C_BUFFERED_WRITE_FILE_H_INCLUDED__
+
+#include "IWriteFile.h"
+#include <string.h>
+
+namespace irr
+{
+namespace io
+{
+
+	//! Output buffer in front of another IWriteFile, for writers which emit a few bytes or a number at a time.
+	/** Collects everything in memory and hands it to the wrapped file in large writes, so the many small
+	tokens of a text format cost a memcpy instead of a virtual call and an fwrite each.
+	The appends and number formatting are inline, writers should call them on a CBufferedWriteFile rather than through IWriteFile.
+	Whatever is still buffered goes out on flush, seek and when dropped, so it can also live on the stack of a writer
+	for the duration of a write, as long as nothing grabs it. */
+	class CBufferedWriteFile : public IWriteFile
+	{
+        public:
+            enum E_DEFAULTS
+            {
+                DEFAULT_BUFFER_SIZE = 0x40000u,
+                //! room formatFloat and formatUint need at `out`, more than any of their outputs
+                MAX_NUMBER_CHARS = 32u
+            };
+
+            CBufferedWriteFile(IWriteFile* file, const size_t& bufferSize=DEFAULT_BUFFER_SIZE);
+            virtual ~CBufferedWriteFile();
+
+            //! always takes all of it, check hasFailed() after the final flush to know if it reached the file
+            virtual int32_t write(const void* buffer, uint32_t sizeToWrite);
+
+            //! flushes first
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
+
+            //! position including what is still buffered
+            virtual size_t getPos() const {return File->getPos()+Used;}
+
+            //! returns name of file
+            virtual const io::path& getFileName() const {return File->getFileName();}
+
+            //! Hands everything buffered to the wrapped file, false if it did not take all of it
+            bool flush();
+
+            //! True if the wrapped file ever refused to take some of the data
+            inline bool hasFailed() const {return Failed;}
+
+            inline void append(const void* data, const size_t& size)
+            {
+                if (Used+size>BufferSize)
+                {
+                    write(data,size);
+                    return;
+                }
+                memcpy(Buffer+Used,data,size);
+                Used += size;
+            }
+
+            //! Appends a string literal without its terminating zero
+            template<size_t N>
+            inline void appendLiteral(const char (&str)[N]) {append(str,N-1u);}
+
+            inline void appendChar(const char& c)
+            {
+                if (Used==BufferSize)
+                    flush();
+                Buffer[Used++] = c;
+            }
+
+            //! Same text as printf's "%g", which is also what an std::ostream prints by default
+            inline void appendFloat(const float& value)
+            {
+                reserve(MAX_NUMBER_CHARS);
+                Used = formatFloat(Buffer+Used,value)-Buffer;
+            }
+
+            inline void appendUint(const uint32_t& value)
+            {
+                reserve(MAX_NUMBER_CHARS);
+                Used = formatUint(Buffer+Used,value)-Buffer;
+            }
+
+            //! Writes `value` as printf's "%g" would to `out`, which needs MAX_NUMBER_CHARS of room, and returns the end of it.
+            /** No terminating zero is written. Values printed in fixed notation are formatted from their exact
+            decimal scaling without going through the C library, the rest falls back to snprintf. */
+            static char* formatFloat(char* out, const float& value);
+
+            //! Decimal digits of `value`, no terminating zero
+            static inline char* formatUint(char* out, uint32_t value)
+            {
+                char tmp[10];
+                char* digit = tmp+10;
+                do
+                {
+                    *(--digit) = char('0'+value%10u);
+                    value /= 10u;
+                } while (value);
+                const size_t len = tmp+10-digit;
+                memcpy(out,digit,len);
+                return out+len;
+            }
+
+        private:
+            inline void reserve(const size_t& bytes)
+            {
+                if (BufferSize-Used<bytes)
+                    flush();
+            }
+
+            IWriteFile* File;
+            char* Buffer;
+            size_t BufferSize;
+            size_t Used;
+            bool Failed;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,96 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CPU_INSTANCE_CULLER_H_INCLUDED__
+#define __C_CPU_INSTANCE_CULLER_H_INCLUDED__
+
+#include <vector>
+#include "SColor.h"
+#include "matrix4x3.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Frustum culling, LoD selection and compaction of instance transforms on the CPU.
+/** Keeps the relative transforms of all instance slots in SoA layout (one array per matrix component), so four
+instances are culled at once with SSE. Every instance is tested by transforming the shared LoD invariant
+bounding box, exactly like core::matrix4::isBoxInsideFrustum does, and gets the first LoD whose distance is larger than
+the distance from the eye to the transformed box center. Visible instances are written out compacted per LoD, in slot order,
+which does not depend on the number of threads used.
+Works on plain memory only, so it is usable without a GPU, IMeshSceneNodeInstanced uses it as its built-in CPU culling path. */
+class CCPUInstanceCuller
+{
+    public:
+        //! Size of the data written for every visible instance.
+        /** Same layout as the transform feedback output of the instancing examples, the core::matrix4 WorldViewProj
+        followed by the core::matrix4x3 WorldView matrix of the instance. */
+        static const size_t OutputSizePerInstance = 28*sizeof(float);
+
+        CCPUInstanceCuller();
+        ~CCPUInstanceCuller();
+
+        //! Sets the LoD switch distances (must be increasing) and the bounding box which encloses all LoD meshes.
+        void setLoDs(const float* lodDistances, const size_t& lodCount, const core::aabbox3df& lodInvariantBBox);
+
+        //! Number of LoDs set with setLoDs().
+        size_t getLoDCount() const {return LoDDistancesSQ.size();}
+
+        //! Resizes the slot storage, slots added at the end start out unused.
+        void setSlotCount(const size_t& slotCount);
+
+        //! Number of instance slots.
+        const size_t& getSlotCount() const {return SlotCount;}
+
+        //! Marks the slot as used by a visible instance with the given transform.
+        void setInstance(const size_t& slot, const core::matrix4x3& relativeTransform);
+
+        //! Changes the transform, keeps the visibility of the instance.
+        void setInstanceTransform(const size_t& slot, const core::matrix4x3& relativeTransform);
+
+        //! Hidden instances are skipped by cull() without being removed.
+        void setInstanceVisible(const size_t& slot, const bool& visible);
+
+        //! Marks the slot as unused.
+        void removeInstance(const size_t& slot);
+
+        //! Culls all the instances and writes the visible ones out.
+        /** @param outputPtrs One pointer per LoD, every pointer is advanced past the instances written for its LoD
+        (like the pointers given to a IMeshSceneNodeInstanced::CPUCullingFunc).
+        @param outputStride Bytes between consecutive instances in the output, at least OutputSizePerInstance.
+        @param ProjView The camera's projection times view matrix.
+        @param View The camera's view matrix.
+        @param World Transformation of the whole instance group (the node's absolute transformation).
+        @param threadCount Number of threads to spread the slots over, 0 uses all the threads of CJobSystem::getGlobal().
+        @returns Total number of instances written. */
+        size_t cull(uint8_t** outputPtrs, const size_t& outputStride, const core::matrix4& ProjView, const core::matrix4x3& View,
+                    const core::matrix4x3& World, const uint32_t& threadCount=0);
+
+    private:
+        enum E_SLOT_STATE
+        {
+            ESS_USED = 0x1u,
+            ESS_VISIBLE = 0x2u
+        };
+
+        void reallocateTransforms(const size_t& newPaddedCount);
+
+        std::vector<float> LoDDistancesSQ;
+        core::aabbox3df LoDInvariantBBox;
+
+        size_t SlotCount;
+        //! Slot count rounded up to a whole number of SIMD lanes
+        size_t PaddedSlotCount;
+        //! 12 arrays of PaddedSlotCount floats, element (row,column) of the relative transform lives in array column*3+row
+        float* Transforms;
+        std::vector<uint32_t> SlotStates;
+        //! LoD picked for every slot during the last cull, 0xff if not visible
+        std::vector<uint8_t> SlotLoDs;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,145 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CPU_OCCLUSION_CULLER_H_INCLUDED__
+#define __C_CPU_OCCLUSION_CULLER_H_INCLUDED__
+
+#include <vector>
+#include "SColor.h"
+#include "matrix4x3.h"
+#include "aabbox3d.h"
+#include "dimension2d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ICPUMeshBuffer;
+
+//! Occlusion culling against a low resolution depth buffer rasterized on the CPU, no GPU and no frame of latency needed.
+/** Designated occluders (big and simple meshes like buildings, walls and terrain, usually a low LoD of them) get rasterized
+with SSE, 4 pixels at a time, into a buffer of reciprocal view depths (1/w, which is linear in screen space, 0 where nothing got drawn).
+Every pixel keeps the farthest depth the triangle covering its center has anywhere inside the pixel, so an occluder never gets
+nearer than it is, but coverage is sampled at pixel centers, so boxes peeking through less than a pixel at occluder silhouettes may get culled.
+A hierarchy of the farthest and nearest depth of every 2x2, 4x4... pixels lets a box be tested with a few texel reads:
+the box's screen rectangle is occluded if its nearest point is farther than the farthest occluder in every texel it touches.
+Occluders are drawn nearest first and triangles behind everything already drawn in the tiles they overlap are skipped.
+Rasterization is spread over horizontal bands of the buffer and batches of boxes get tested in parallel, both on CJobSystem::getGlobal().
+CSceneManager keeps one, rasterizes it from the active camera every frame and tests the nodes with EAC_CPU_OCCLUSION set. */
+class CCPUOcclusionCuller
+{
+    public:
+        //! Returned by addOccluder() when the occluder could not be added.
+        static const uint32_t InvalidOccluder = 0xffffffffu;
+
+        //! @param resolution Size of the depth buffer, the default is enough to cull city blocks and is rasterized in well under a millisecond.
+        CCPUOcclusionCuller(const core::dimension2d<uint32_t>& resolution=core::dimension2d<uint32_t>(256u,128u));
+        ~CCPUOcclusionCuller();
+
+        //! Changes the size of the depth buffer, takes effect with the next rasterize().
+        void setResolution(const core::dimension2d<uint32_t>& resolution);
+
+        const core::dimension2d<uint32_t>& getResolution() const {return Resolution;}
+
+        //! Adds an occluder made of a triangle list, the positions and indices get copied.
+        /** Occluders are rasterized double sided and must be solid, a box hidden behind one is culled.
+        @returns Id for setOccluderTransform() and removeOccluder(). */
+        uint32_t addOccluder(const core::vectorSIMDf* positions, const uint32_t& vertexCount, const uint32_t* indices, const uint32_t& indexCount,
+                             const core::matrix4x3& transform);
+
+        //! Adds the triangles (list, strip or fan) of a mesh buffer as an occluder.
+        /** @returns Id for setOccluderTransform() and removeOccluder(), InvalidOccluder if the mesh buffer has no positions or no triangles. */
+        uint32_t addOccluder(const ICPUMeshBuffer* meshbuffer, const core::matrix4x3& transform);
+
+        void setOccluderTransform(const uint32_t& id, const core::matrix4x3& transform);
+
+        void removeOccluder(const uint32_t& id);
+
+        //! Number of occluders added and not removed.
+        size_t getOccluderCount() const {return OccluderCount;}
+
+        //! Rasterizes all the occluders as seen by the camera into the depth buffer and rebuilds the hierarchy.
+        /** @param ProjView The camera's projection times view matrix, the boxes get tested with it until the next rasterize().
+        @param nearValue The camera's near plane distance, occluder triangles are clipped against it.
+        @param threadCount Number of threads to spread the work over, 0 uses all the threads of CJobSystem::getGlobal(). */
+        void rasterize(const core::matrix4& ProjView, const float& nearValue, const uint32_t& threadCount=0);
+
+        //! Whether the box is hidden behind the occluders of the last rasterize().
+        /** Boxes crossing the near plane or outside of the screen are never occluded. */
+        bool isBoxOccluded(const core::aabbox3df& box, const core::matrix4x3& transform) const;
+
+        //! Tests many boxes at once, in parallel.
+        /** @param outOccluded Gets 1 for every occluded box and 0 for the others.
+        @param transforms One per box, or NULL if the boxes are in world space already. */
+        void testBoxes(uint8_t* outOccluded, const core::aabbox3df* boxes, const core::matrix4x3* transforms, const size_t& count, const uint32_t& threadCount=0) const;
+
+        //! Depth buffer of the last rasterize(), reciprocal view depths, getResolution().Width floats per row.
+        const float* getDepthBuffer() const {return Levels.size() ? Levels[0].farthest.data():NULL;}
+
+        //! Number of triangles which got past clipping and covered a pixel center in the last rasterize().
+        size_t getRasterizedTriangleCount() const {return Triangles.size();}
+
+    private:
+        struct SOccluder
+        {
+            SOccluder() : used(false) {}
+
+            bool used;
+            std::vector<core::vectorSIMDf> positions;
+            std::vector<uint32_t> indices;
+            core::matrix4x3 transform;
+        };
+
+        //! A triangle set up for rasterization, x and y are in pixels from the center of pixel (minX,minY) so the constants stay small
+        struct STriangle
+        {
+            //! edge functions, positive inside: edge[k][0]*x+edge[k][1]*y+edge[k][2]
+            float edge[3][3];
+            //! where the edges cross a row: crossing[k][0]*y+crossing[k][1], the inside is right of it if edge[k][0] is positive
+            float crossing[3][2];
+            //! reciprocal depth plane: depth[0]*x+depth[1]*y+depth[2], already moved to the farthest value inside a pixel
+            float depth[3];
+            //! farthest reciprocal depth of the corners, the plane gets clamped to it
+            float farthest;
+            //! nearest reciprocal depth of the corners
+            float nearest;
+            int32_t minX, maxX, minY, maxY;
+        };
+
+        //! One level of the hierarchy, level 0 has farthest==nearest and is the depth buffer itself
+        struct SLevel
+        {
+            uint32_t width, height;
+            std::vector<float> farthest;
+            std::vector<float> nearest;
+        };
+
+        bool isBoxOccludedProjected(const core::aabbox3df& box, const core::matrix4& ProjViewWorld) const;
+        void setupTriangle(const float (*clip)[3]);
+        void buildHierarchy();
+        bool isRectOccluded(const uint32_t& level, const int32_t& x, const int32_t& y, const int32_t& minX, const int32_t& maxX,
+                            const int32_t& minY, const int32_t& maxY, const float& boxNearest) const;
+
+        core::dimension2d<uint32_t> Resolution;
+        std::vector<SOccluder> Occluders;
+        size_t OccluderCount;
+
+        std::vector<STriangle> Triangles;
+        //! Triangles overlapping every band of rows
+        std::vector<std::vector<uint32_t> > Bins;
+        std::vector<SLevel> Levels;
+        //! Width padded to a multiple of the SIMD width, the rows of level 0 are this far apart while rasterizing
+        uint32_t Pitch;
+        std::vector<float> PaddedDepth;
+
+        core::matrix4 ProjView;
+        float NearValue;
+        bool HasDepth;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,53 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CPU_SKINNER_H_INCLUDED__
+#define __C_CPU_SKINNER_H_INCLUDED__
+
+#include "SSkinMeshBuffer.h"
+#include "ISkinningStateManager.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Linear blend skinning of SCPUSkinMeshBuffer vertices on the CPU.
+/** Does what the hardware skinning vertex shaders do with getBoneDataTBO(), for when the deformed vertices are needed
+on the CPU (ray picking with STriangleMeshCollider, software rendering, baking). Every vertex is transformed by
+up to 4 bones picked by its EVAI_ATTR5 bone IDs (4 unsigned bytes) and blended with its EVAI_ATTR6 weights
+(ECT_NORMALIZED_UNSIGNED_INT_2_10_10_10_REV, three weights and the bone count minus one, the 4th weight is what is left),
+the layout the mesh loaders produce. The bones' matrices are blended with SSE and the vertex transformed once,
+vertex ranges are spread over the threads of CJobSystem::getGlobal(). */
+class CCPUSkinner
+{
+    public:
+        //! Skins vertices [firstVertex,firstVertex+vertexCount) of the mesh buffer with the bone data of one instance.
+        /** @param outPositions Skinned positions, 3 floats per vertex `outputStride` bytes apart.
+        @param outNormals Skinned normals (not renormalized) laid out the same way, can be NULL.
+        @param outputStride Bytes between consecutive vertices in the outputs, at least 3 floats, 12 makes a packed float array
+        as STriangleMeshCollider::Init wants it.
+        @param boneData The instance's ISkinningStateManager::FinalBoneData, as returned by ISkinningStateManager::getInstanceBoneData.
+        @param boneCount Number of bones in boneData, vertices referencing bones past it collapse onto the origin.
+        @param threadCount Number of threads to spread the vertices over, 0 uses all the threads of CJobSystem::getGlobal().
+        @returns False if the mesh buffer lacks positions or skinning attributes in the layout above,
+        or if the range goes past the end of its vertex data, nothing is written then. */
+        static bool skin(float* outPositions, float* outNormals, const size_t& outputStride, const SCPUSkinMeshBuffer* meshbuffer,
+                        const ISkinningStateManager::FinalBoneData* boneData, const size_t& boneCount,
+                        const uint32_t& firstVertex, const uint32_t& vertexCount, const uint32_t& threadCount=0);
+
+        //! Same as above for the bones of one instance of a skinning state manager, after its performBoning().
+        static inline bool skin(float* outPositions, float* outNormals, const size_t& outputStride, const SCPUSkinMeshBuffer* meshbuffer,
+                                const ISkinningStateManager* skinningState, const uint32_t& instanceID,
+                                const uint32_t& firstVertex, const uint32_t& vertexCount, const uint32_t& threadCount=0)
+        {
+            return skin(outPositions,outNormals,outputStride,meshbuffer,skinningState->getInstanceBoneData(instanceID),skinningState->getBoneCount(),
+                        firstVertex,vertexCount,threadCount);
+        }
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_COMMAND_LIST_H_INCLUDED__
+#define __C_COMMAND_LIST_H_INCLUDED__
+
+#include "IVideoDriver.h"
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace irr
+{
+namespace video
+{
+
+//! Driver calls recorded on any thread and replayed later on the driver's thread.
+/** IVideoDriver may only be called from the thread owning its context, so scene traversal and culling running on
+CJobSystem workers can not draw what they find. Instead every worker records material, transform, draw and buffer update
+calls into its own CCommandList, and the driver thread replays the lists in order with execute().
+The commands are packed one after the other in a single growing arena (a material is stored once and referenced),
+reset() empties the list and keeps the memory for the next frame.
+
+Replaying drops material and transform changes which set what is already set, across all the lists of one execute().
+
+Recording does not grab anything (reference counting is not thread safe), everything passed to the list
+has to stay alive until the list has been executed or reset. A list must only be used by one thread at a time. */
+class CCommandList : public IReferenceCounted
+{
+    public:
+        //! What execute() did, to tell how much redundant state the recorded scene had
+        struct SExecuteStatistics
+        {
+            SExecuteStatistics() : commandsExecuted(0), materialsSkipped(0), transformsSkipped(0) {}
+
+            uint32_t commandsExecuted;
+            uint32_t materialsSkipped;
+            uint32_t transformsSkipped;
+        };
+
+        CCommandList() : CommandsSize(0), CommandCount(0)
+        {
+            #ifdef _DEBUG
+            setDebugName("CCommandList");
+            #endif
+        }
+
+        //! Drops all recorded commands, the memory is kept for recording the next ones
+        inline void reset()
+        {
+            CommandsSize = 0;
+            Materials.clear();
+            CommandCount = 0;
+        }
+
+        //! Number of commands recorded since the last reset()
+        inline const uint32_t& getCommandCount() const {return CommandCount;}
+
+        //! Bytes the recorded commands take up in the arena
+        inline const size_t& getRecordedSize() const {return CommandsSize;}
+
+        //! Records IVideoDriver::setMaterial(), the material is copied.
+        void setMaterial(const SMaterial& material);
+
+        //! Records IVideoDriver::setTransform()
+        void setTransform(const E_4X3_TRANSFORMATION_STATE& state, const core::matrix4x3& mat);
+
+        //! Records IVideoDriver::setTransform()
+        void setTransform(const E_PROJECTION_TRANSFORMATION_STATE& state, const core::matrix4& mat);
+
+        //! Records IVideoDriver::drawMeshBuffer(), NULL mesh buffers are not recorded
+        void drawMeshBuffer(const scene::IGPUMeshBuffer* mb, IOcclusionQuery* query=NULL);
+
+        //! Records IVideoDriver::drawArraysIndirect()
+        void drawArraysIndirect(const scene::IMeshDataFormatDesc<video::IGPUBuffer>* vao, const scene::E_PRIMITIVE_TYPE& mode,
+                                const IGPUBuffer* indirectDrawBuff, const size_t& offset, const size_t& count, const size_t& stride,
+                                IOcclusionQuery* query=NULL);
+
+        //! Records IVideoDriver::drawIndexedIndirect()
+        void drawIndexedIndirect(const scene::IMeshDataFormatDesc<video::IGPUBuffer>* vao, const scene::E_PRIMITIVE_TYPE& mode, const E_INDEX_TYPE& type,
+                                const IGPUBuffer* indirectDrawBuff, const size_t& offset, const size_t& count, const size_t& stride,
+                                IOcclusionQuery* query=NULL);
+
+        //! Records IGPUBuffer::updateSubRange(), `data` is copied into the list so it can be freed right after.
+        void updateBuffer(IGPUBuffer* buffer, const size_t& offset, const size_t& size, const void* data);
+
+        //! Replays the commands on the driver, must be called on the driver's thread
+        inline SExecuteStatistics execute(IVideoDriver* driver) const
+        {
+            const CCommandList* self = this;
+            return execute(driver,&self,1u);
+        }
+
+        //! Replays `listCount` lists in order as if they were one, the redundant state removal carries over from one list to the next.
+        static SExecuteStatistics execute(IVideoDriver* driver, const CCommandList* const* lists, const uint32_t& listCount);
+
+    private:
+        enum E_COMMAND_TYPE
+        {
+            ECT_SET_MATERIAL = 0,
+            ECT_SET_TRANSFORM_4X3,
+            ECT_SET_TRANSFORM_PROJECTION,
+            ECT_DRAW_MESH_BUFFER,
+            ECT_DRAW_ARRAYS_INDIRECT,
+            ECT_DRAW_INDEXED_INDIRECT,
+            ECT_UPDATE_BUFFER
+        };
+
+        //! alignment of every command in the arena, the arena itself comes from operator new which aligns at least as much
+        enum {COMMAND_ALIGNMENT=8u};
+
+        template<typename T>
+        inline void record(const E_COMMAND_TYPE& type, const T& command, const void* extraData=NULL, const size_t& extraSize=0)
+        {
+            static_assert(alignof(T)<=COMMAND_ALIGNMENT,"command would be misaligned in the arena");
+            const size_t paddedSize = (sizeof(T)+extraSize+COMMAND_ALIGNMENT-1u)&~size_t(COMMAND_ALIGNMENT-1u);
+            const uint32_t header[2] = {uint32_t(type),uint32_t(paddedSize)};
+            static_assert(sizeof(header)%COMMAND_ALIGNMENT==0u,"header would misalign the commands after it");
+            const size_t newSize = CommandsSize+sizeof(header)+paddedSize;
+            //! resize() zeroes the new bytes, so grow geometrically and only when full, a reset() list keeps its storage and records over it without zeroing again
+            if (newSize>Commands.size())
+                Commands.resize(std::max(newSize,Commands.size()*2u));
+            uint8_t* out = Commands.data()+CommandsSize;
+            memcpy(out,header,sizeof(header));
+            new (out+sizeof(header)) T(command);
+            if (extraSize)
+                memcpy(out+sizeof(header)+sizeof(T),extraData,extraSize);
+            CommandsSize = newSize;
+            CommandCount++;
+        }
+
+        //! every command is a type and size followed by its parameters, padded so that the next command stays aligned
+        std::vector<uint8_t> Commands;
+        size_t CommandsSize;
+        std::vector<SMaterial> Materials;
+        uint32_t CommandCount;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,189 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_JOB_SYSTEM_H_INCLUDED__
+#define __C_JOB_SYSTEM_H_INCLUDED__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IReferenceCounted.h"
+#include "irrTypes.h"
+
+namespace irr
+{
+
+//! Work-stealing thread pool running short jobs for the whole engine.
+/** Every worker thread has its own queue, jobs submitted from a worker go onto the back of its queue and the worker
+takes them back from there (so nested work stays hot in its cache), idle workers steal from the front of the others' queues.
+Jobs submitted from any other thread go into a shared queue which is emptied in submission order.
+A thread waiting for a job runs other queued jobs in the meantime, so jobs can submit and wait for jobs themselves.
+With no worker threads nothing runs in the background, every job runs inside wait() (or parallelFor()) on the calling thread
+in submission order, which makes runs reproducible.
+
+The IrrlichtDevice owns one, engine code which is not handed a device uses getGlobal(). */
+class CJobSystem : public IReferenceCounted
+{
+    public:
+        typedef std::function<void()> JobFunc;
+
+        //! Handle to a submitted job, the submitter holds one reference to it.
+        /** Referenced from several threads at once, so unlike IReferenceCounted the counter is atomic. */
+        class CJob
+        {
+            public:
+                void grab() {ReferenceCounter++;}
+
+                //! \return True, if the job was deleted.
+                bool drop()
+                {
+                    if (--ReferenceCounter)
+                        return false;
+                    delete this;
+                    return true;
+                }
+
+                //! Whether the job has finished running.
+                bool isDone() const {return Done.load(std::memory_order_acquire);}
+
+            private:
+                friend class CJobSystem;
+
+                CJob(const JobFunc& func) : ReferenceCounter(1), Func(func), PendingDependencies(1u), Done(false), ReadyTime(0) {}
+
+                std::atomic<int32_t> ReferenceCounter;
+                JobFunc Func;
+                //! unfinished dependencies, plus one while submit() is still registering them
+                std::atomic<uint32_t> PendingDependencies;
+                std::atomic<bool> Done;
+                std::mutex ContinuationLock;
+                //! jobs depending on this one, each holds a reference
+                std::vector<CJob*> Continuations;
+                uint64_t ReadyTime;
+        };
+
+        struct SStatistics
+        {
+            SStatistics() : jobsSubmitted(0), jobsExecuted(0), jobsStolen(0), failedSteals(0), workerSleeps(0),
+                            parallelForCalls(0), queueLatencyNs(0) {}
+
+            uint64_t jobsSubmitted;
+            uint64_t jobsExecuted;
+            //! Jobs a worker took from another worker's queue.
+            uint64_t jobsStolen;
+            //! Times a thread looked through all the queues without finding a job.
+            uint64_t failedSteals;
+            uint64_t workerSleeps;
+            uint64_t parallelForCalls;
+            //! Summed up time between jobs becoming ready to run and a thread starting them.
+            uint64_t queueLatencyNs;
+        };
+
+        //! Worker count to pass to the constructor to get one worker less than there are hardware threads.
+        static const uint32_t AutoWorkerCount = 0xffffffffu;
+
+        //! Starts the worker threads.
+        /** @param workerCount Number of background threads, 0 runs all jobs on the threads waiting for them. */
+        CJobSystem(uint32_t workerCount=AutoWorkerCount);
+
+        //! Runs the jobs left in the queues and stops the workers.
+        ~CJobSystem();
+
+        const uint32_t& getWorkerCount() const {return WorkerCount;}
+
+        //! Queues a job, it runs once all `dependencies` (which can be NULL or already done) have finished.
+        /** @returns The job, drop() it when done with it. */
+        CJob* submit(const JobFunc& func, CJob* const* dependencies=NULL, const uint32_t& dependencyCount=0);
+
+        //! Returns once the job has finished, running other queued jobs in the meantime.
+        void wait(CJob* job);
+
+        //! Calls `func(index)` for every index in [0,count) and returns when all are done.
+        /** Indices are handed out one at a time to the calling thread and up to `maxThreads-1` workers,
+        so every index should stand for a decent amount of work.
+        @param maxThreads Limit on the threads working on the loop, including the caller, 0 means all the workers join in. */
+        template<class F>
+        void parallelFor(const uint32_t& count, const F& func, const uint32_t& maxThreads=0)
+        {
+            parallelFor_impl(count,maxThreads,&callIndexFunctor<F>,const_cast<F*>(&func));
+        }
+
+        SStatistics getStatistics() const;
+
+        void resetStatistics();
+
+        //! The job system used by engine code which doesn't have a device at hand.
+        /** Set to the job system of the last created IrrlichtDevice, if there is none one with AutoWorkerCount workers
+        gets created on first use.
+        The returned pointer is not grabbed, the global holds the reference and it stays valid until setGlobal() replaces it,
+        which the owning IrrlichtDevice does when it gets destroyed. Grab it to keep using it past that. */
+        static CJobSystem* getGlobal();
+
+        //! Same as getGlobal(), except that it returns NULL instead of creating a default job system when there is none.
+        static CJobSystem* peekGlobal();
+
+        //! Replaces the job system returned by getGlobal(), NULL makes the next getGlobal() create a default one.
+        /** The global grabs `jobSystem` and drops the one it replaces. */
+        static void setGlobal(CJobSystem* jobSystem);
+
+    private:
+        struct SQueue
+        {
+            std::mutex lock;
+            std::deque<CJob*> jobs;
+        };
+
+        template<class F>
+        static void callIndexFunctor(void* functor, const uint32_t& index)
+        {
+            (*reinterpret_cast<const F*>(functor))(index);
+        }
+
+        void parallelFor_impl(const uint32_t& count, const uint32_t& maxThreads, void (*func)(void*,const uint32_t&), void* functor);
+
+        //! index of the calling thread's queue, the shared queue for non-worker threads
+        uint32_t getQueueIndex() const;
+
+        void enqueue(CJob* job);
+
+        //! own queue from the back, then the shared queue and other workers' queues from the front
+        CJob* findJob(const uint32_t& queueIndex);
+
+        void execute(CJob* job);
+
+        void workerMain(const uint32_t index);
+
+        uint32_t WorkerCount;
+        std::vector<std::thread> Workers;
+        //! WorkerCount worker queues followed by the shared queue
+        std::vector<SQueue*> Queues;
+
+        std::atomic<uint32_t> QueuedJobs;
+        std::atomic<bool> Stopping;
+
+        std::mutex SleepLock;
+        std::condition_variable WorkAvailable;
+        std::atomic<uint32_t> SleepingWorkers;
+
+        std::mutex WaitLock;
+        std::condition_variable JobFinished;
+        std::atomic<uint32_t> WaitingThreads;
+
+        std::atomic<uint64_t> StatJobsSubmitted;
+        std::atomic<uint64_t> StatJobsExecuted;
+        std::atomic<uint64_t> StatJobsStolen;
+        std::atomic<uint64_t> StatFailedSteals;
+        std::atomic<uint64_t> StatWorkerSleeps;
+        std::atomic<uint64_t> StatParallelForCalls;
+        std::atomic<uint64_t> StatQueueLatencyNs;
+};
+
+} // end namespace irr
+
+#endif
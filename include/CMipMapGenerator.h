@@ -0,0 +1,73 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MIP_MAP_GENERATOR_H_INCLUDED__
+#define __C_MIP_MAP_GENERATOR_H_INCLUDED__
+
+#include <vector>
+#include "CImageData.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! CPU generator of full mip-chains for uncompressed images.
+/** Meant for asset baking and headless tools which can't rely on the GL driver to build the mip-maps.
+Every level is resampled from the previous one kept in linear 32bit float RGBA, so there is no requantization
+error accumulated down the chain. The filters are separable and process whole RGBA texels with SSE,
+rows of every level are shared out between worker threads.
+Depth slices of the base image are treated as array layers (or cubemap faces) and are not reduced. */
+class CMipMapGenerator
+{
+    public:
+        enum E_MIP_GENERATION_FILTER
+        {
+            //! Area weighted average, exactly 2x2 for even sizes, also handles odd sizes without shifting the image.
+            EMGF_BOX = 0,
+            //! Kaiser windowed sinc, sharper results than the box filter.
+            EMGF_KAISER
+        };
+
+        //! Options for generateMipChain()
+        struct SParameters
+        {
+            SParameters() : filter(EMGF_BOX), sRGB(false), premultipliedAlpha(false), levelCount(0), threadCount(0),
+                            kaiserAlpha(4.f), kaiserRadius(3.f) {}
+
+            E_MIP_GENERATION_FILTER filter;
+            //! Color channels of normalized integer formats are sRGB encoded, filtering gets done on linearized values.
+            /** Alpha and the floating point formats are always treated as linear. */
+            bool sRGB;
+            //! Weight color by alpha while filtering, so fully transparent texels do not bleed into the visible ones.
+            /** The output still has straight (non-premultiplied) alpha. */
+            bool premultipliedAlpha;
+            //! Maximum number of levels to generate below the base level, 0 generates the chain all the way down to 1x1.
+            uint32_t levelCount;
+            //! Number of threads to use, 0 uses all the threads of CJobSystem::getGlobal().
+            uint32_t threadCount;
+            //! Shape parameter of the Kaiser window.
+            float kaiserAlpha;
+            //! Half-width of the Kaiser filter in destination texels.
+            float kaiserRadius;
+        };
+
+        //! Whether mip-maps can be generated for images of `format`.
+        /** All the uncompressed color formats are supported, including the floating point ones. */
+        static bool isFormatSupported(const ECOLOR_FORMAT& format);
+
+        //! Number of levels in a full mip-chain of a `width`x`height` image, including the base level.
+        static uint32_t getFullMipChainLength(const uint32_t& width, const uint32_t& height);
+
+        //! Builds the mip-chain for `baseLevel`.
+        /** @returns The base level (grabbed) followed by the generated levels, with the mip level hints set so that the
+        vector can be passed straight to IVideoDriver::addTexture. Release with IVideoDriver::dropWholeMipChain.
+        The returned vector is empty if the format is not supported or the image does not start at texel (0,0). */
+        static std::vector<CImageData*> generateMipChain(CImageData* baseLevel, const SParameters& params=SParameters());
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,122 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_PROFILER_H_INCLUDED__
+#define __C_PROFILER_H_INCLUDED__
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "IrrCompileConfig.h"
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace io
+{
+    class IWriteFile;
+}
+namespace core
+{
+
+//! Records CPU timing zones of all threads, for frame-time breakdowns and Chrome trace files.
+/** Every thread writes its zones into its own ring buffer of EventsPerThread events without taking any locks,
+once a ring is full the oldest events get overwritten. The ring of an exited thread is kept for exporting and handed
+to the next thread which starts recording, so there are only as many rings as threads ever alive at once.
+Nothing is recorded until setRecording(true) is called, until then a zone costs one relaxed atomic load.
+The engine marks its hot paths with _IRR_PROFILE_ZONE, which compiles to nothing unless _IRR_COMPILE_WITH_PROFILER_
+is defined (it is not by default), and calls endFrame() from IVideoDriver::endScene(). */
+class CProfiler
+{
+    public:
+        struct SEvent
+        {
+            //! Must point to a string which outlives the profiler, usually a literal.
+            const char* name;
+            uint64_t startNs;
+            uint64_t endNs;
+        };
+
+        struct SZoneSummary
+        {
+            const char* name;
+            uint32_t calls;
+            //! Summed up duration of all the calls, including the time spent in nested zones.
+            uint64_t totalNs;
+        };
+
+        struct SFrameSummary
+        {
+            SFrameSummary() : frameNumber(0), startNs(0), endNs(0) {}
+
+            uint64_t frameNumber;
+            uint64_t startNs;
+            uint64_t endNs;
+            //! Zones which started and ended within the frame on any thread, longest total first.
+            std::vector<SZoneSummary> zones;
+        };
+
+        //! Records the duration of the enclosing scope, use through _IRR_PROFILE_ZONE.
+        class CScopedZone
+        {
+            public:
+                CScopedZone(const char* name) : Name(name), StartNs(isRecording() ? getTimestampNs():0ull) {}
+                ~CScopedZone()
+                {
+                    if (StartNs)
+                        recordEvent(Name,StartNs,getTimestampNs());
+                }
+
+            private:
+                const char* Name;
+                uint64_t StartNs;
+        };
+
+        //! Size of every thread's ring buffer.
+        static const size_t EventsPerThread = 1u<<16;
+
+        static void setRecording(const bool& record) {Recording.store(record,std::memory_order_relaxed);}
+
+        static bool isRecording() {return Recording.load(std::memory_order_relaxed);}
+
+        static uint64_t getTimestampNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        //! Appends an event to the calling thread's ring buffer.
+        static void recordEvent(const char* name, const uint64_t& startNs, const uint64_t& endNs);
+
+        //! Closes the current frame and records it as a "Frame" event, the engine calls it at the end of every frame.
+        static void endFrame();
+
+        //! Summarizes the zones of the last frame closed with endFrame().
+        /** @returns False if no frame was recorded yet. */
+        static bool getLastFrameSummary(SFrameSummary& outSummary);
+
+        //! Copies out the events still in the ring buffers of all threads, in no particular order.
+        /** @param outThreadIndices Optional, gets the index of the thread which recorded each event. */
+        static void getEvents(std::vector<SEvent>& outEvents, std::vector<uint32_t>* outThreadIndices=NULL);
+
+        //! Writes all the events still in the ring buffers as a Chrome trace (chrome://tracing, Perfetto) JSON file.
+        static bool writeChromeTrace(io::IWriteFile* file);
+
+    private:
+        static std::atomic<bool> Recording;
+};
+
+} // end namespace core
+} // end namespace irr
+
+#ifdef _IRR_COMPILE_WITH_PROFILER_
+    #define _IRR_PROFILE_CONCAT_IMPL(a,b) a##b
+    #define _IRR_PROFILE_CONCAT(a,b) _IRR_PROFILE_CONCAT_IMPL(a,b)
+    //! Times the rest of the enclosing scope as a zone called NAME, which must be a string literal.
+    #define _IRR_PROFILE_ZONE(NAME) irr::core::CProfiler::CScopedZone _IRR_PROFILE_CONCAT(irrProfileZone,__LINE__)(NAME)
+#else
+    #define _IRR_PROFILE_ZONE(NAME)
+#endif // _IRR_COMPILE_WITH_PROFILER_
+
+#endif
@@ -21,7 +21,9 @@ namespace scene
 		EAC_FRUSTUM_BOX = 2,
 		EAC_FRUSTUM_SPHERE = 4,
 		EAC_OCC_QUERY = 8,
-		EAC_COND_RENDER = 16
+		EAC_COND_RENDER = 16,
+		//! tested against the CPU rasterized occluders of ISceneManager::getCPUOcclusionCuller()
+		EAC_CPU_OCCLUSION = 32
 	};
 
 	//! Names for culling type
@@ -33,6 +35,7 @@ namespace scene
 		"frustum_sphere",	// camera frustum against node sphere
 		"occ_query",	// occlusion query
 		"cond_render",
+		"cpu_occlusion",	// CPU rasterized occluders
 		0
 	};
 
@@ -0,0 +1,48 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __E_IMAGE_WRITER_ENUMS_H_INCLUDED__
+#define __E_IMAGE_WRITER_ENUMS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+	//! Block format the DDS writer encodes into, goes in the lowest byte of the `param` of IVideoDriver::writeImageToFile
+	enum E_DDS_WRITER_FORMAT
+	{
+		//! BC1 for images without alpha, BC3 with alpha, BC4 for single and BC5 for two channel images
+		EDWF_AUTO = 0,
+		EDWF_BC1,
+		//! BC1 with 1bit punch-through alpha
+		EDWF_BC1_ALPHA,
+		EDWF_BC2,
+		EDWF_BC3,
+		EDWF_BC4,
+		EDWF_BC5,
+
+		EDWF_FORMAT_MASK = 0xff
+	};
+
+	//! flags configuring DDS writing, OR-ed with an E_DDS_WRITER_FORMAT
+	enum E_DDS_WRITER_FLAGS
+	{
+		//! no writer flags, fast compression
+		EDWF_NONE = 0,
+
+		//! slower compression with lower error
+		EDWF_HIGH_QUALITY = 0x100,
+
+		//! decode the compressed image again to log the PSNR and compression speed, costs an extra pass
+		EDWF_LOG_STATISTICS = 0x200
+	};
+
+} // end namespace video
+} // end namespace irr
+
+
+#endif // __E_IMAGE_WRITER_ENUMS_H_INCLUDED__
@@ -46,7 +46,11 @@ namespace scene
 		EMWF_WRITE_COMPRESSED = 0x2,
 
 		//! write in binary format rather than text
-		EMWF_WRITE_BINARY = 0x4
+		EMWF_WRITE_BINARY = 0x4,
+
+		//! together with EMWF_WRITE_COMPRESSED, code vertex and index data in a way which decodes fast
+		//! and compresses almost as well as the slowest compression (BAW only)
+		EMWF_WRITE_GEOMETRY_CODED = 0x8
 	};
 
 } // end namespace scene
@@ -14,6 +14,21 @@ namespace irr
 namespace scene
 {
 
+	//! Counters kept by a mesh cache since it was created or IMeshCache::resetStatistics() was last called.
+	struct SMeshCacheStatistics
+	{
+		SMeshCacheStatistics() : Hits(0), Misses(0), Evictions(0), EvictedBytes(0) {}
+
+		//! getMeshByName() calls which found the mesh
+		uint64_t Hits;
+		//! getMeshByName() calls which did not
+		uint64_t Misses;
+		//! meshes dropped to get back under the memory budget
+		uint64_t Evictions;
+		//! sum of the sizes of the evicted meshes
+		uint64_t EvictedBytes;
+	};
+
 	//! The mesh cache stores already loaded meshes and provides an interface to them.
 	/** You can access it using ISceneManager::getMeshCache(). All existing
 	scene managers will return a pointer to the same mesh cache, because it
@@ -120,6 +135,31 @@ namespace scene
 		/** Warning: If you have pointers to meshes that were loaded with ISceneManager::getMesh()
 		and you did not grab them, then they may become invalid. */
 		virtual void clearUnusedMeshes() = 0;
+
+		//! Sets how many bytes of buffer data the cached meshes may hold.
+		/** A mesh's size is the sum of the distinct vertex and index buffers
+		its mesh buffers reference, measured when it is added. Whenever the
+		total exceeds the budget, the least recently used meshes which are
+		not used anywhere else are dropped until it fits again, the same way
+		clearUnusedMeshes() would drop them. Meshes that something else still
+		holds a reference to are never evicted, so the budget can be overshot.
+		Adding meshes and changing the budget are the only times eviction runs.
+		Warning: Pointers to meshes that were returned by getMesh() and not
+		grabbed may become invalid after a later load.
+		\param bytes Budget in bytes, 0 means unlimited which is the default. */
+		virtual void setMemoryBudget(const uint64_t& bytes) = 0;
+
+		//! Returns the budget set with setMemoryBudget(), 0 if unlimited.
+		virtual uint64_t getMemoryBudget() const = 0;
+
+		//! Returns the summed size of all cached meshes in bytes.
+		virtual uint64_t getMemoryUsage() const = 0;
+
+		//! Returns the hit, miss and eviction counters.
+		virtual SMeshCacheStatistics getStatistics() const = 0;
+
+		//! Zeroes the hit, miss and eviction counters.
+		virtual void resetStatistics() = 0;
 	};
 
 } // end namespace scene
@@ -34,6 +34,13 @@ public:
 	virtual bool isALoadableFileExtension(const io::path& filename) const = 0;
 
 	virtual ICPUMesh* createMesh(io::IReadFile* file) = 0;
+
+	//! Returns true if createMesh() may run on the loader threads of ISceneManager::getMeshAsync().
+	/** Only return true if the loader holds no state between calls to createMesh() and touches nothing but the file
+	it is given and the objects it creates. Reference counting is not thread safe, so a loader which uses the file system,
+	textures, archives or the mesh cache must return false, its files then get loaded on the thread calling getMeshAsync().
+	\return True if createMesh() can run on several threads at once, next to anything else the engine does. */
+	virtual bool isReentrant() const { return false; }
 };
 
 
@@ -98,6 +98,31 @@ namespace scene
 
 		virtual ICPUMeshBuffer* createMeshBufferDuplicate(const ICPUMeshBuffer* _src) const = 0;
 
+		//! Creates a meshbuffer with fewer triangles, sharing the vertex buffers of the given one.
+		/** Collapses edges onto one of their two vertices, cheapest first by quadric error metric, so the new meshbuffer only gets a new index buffer.
+		Vertices with the same position but different attributes (UV or normal seams) only slide along their seam, and vertices on an open border along the border,
+		so seams do not tear and silhouettes keep their shape. Vertices must be welded (see createMeshBufferWelded()) for anything but seams to simplify.
+		@param inbuffer Triangle list, strip or fan meshbuffer, indexed or not.
+		@param targetTriangleCount Simplification stops once the meshbuffer has no more triangles than this.
+		@param maxError Largest distance, in the units of the vertex positions, that the simplified surface may deviate from the original. Stops before reaching `targetTriangleCount` if it has to.
+		@param outError If not NULL, receives the error the simplification reached, as a distance.
+		@return A new triangle list meshbuffer or NULL if the meshbuffer has no positions or is not made of triangles. */
+		virtual ICPUMeshBuffer* createMeshBufferSimplified(const ICPUMeshBuffer* inbuffer, const uint32_t& targetTriangleCount, const float& maxError=FLT_MAX, float* outError=NULL) const = 0;
+
+		//! Creates a chain of levels of detail of a mesh, the meshbuffers of all levels are simplified in parallel on the threads of CJobSystem::getGlobal().
+		/** Every level is simplified from the original mesh, as in createMeshBufferSimplified(), so errors do not build up along the chain and all levels share the vertex buffers of the mesh.
+		To fill IMeshSceneNodeInstanced::setLoDMeshes convert the levels with IVideoDriver::createGPUMeshFromCPU, `outErrors` tell how far each level can be from the camera
+		before its error shows (the MeshLoD::lodDistance), it can also be written out with the BAW writer as any other mesh.
+		Meshbuffers not made of triangles (points, lines) are put into every level unchanged, NULL ones are left out.
+		@param outLoDs Receives `lodCount` new meshes, drop them when done.
+		@param outErrors If not NULL, receives `lodCount` errors, each the largest error of the meshbuffers of the level.
+		@param mesh Mesh to simplify.
+		@param triangleRatios `lodCount` fractions of the triangles of each meshbuffer to keep, decreasing for decreasing detail.
+		@param lodCount Number of levels of detail.
+		@param maxError Largest error allowed in any level, see createMeshBufferSimplified().
+		@return False if a meshbuffer of the mesh could not be simplified, nothing is created then. */
+		virtual bool createMeshLoDChain(ICPUMesh** outLoDs, float* outErrors, const ICPUMesh* mesh, const float* triangleRatios, const uint32_t& lodCount, const float& maxError=FLT_MAX) const = 0;
+
 		//! Get amount of polygons in mesh buffer.
 		/** \param meshbuffer Input mesh buffer
 		\param Outputted Number of polygons in mesh buffer, if successful.
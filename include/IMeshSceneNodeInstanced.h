@@ -73,6 +73,16 @@ public:
 	    cpuCullingUserData = data;
 	}
 
+	//! Culls with the engine's SIMD culler (see CCPUInstanceCuller) whenever the instance count is below the GPU culling threshold.
+	/** Takes precedence over the CPUCullingFunc and does not need one to be set. The output is CCPUInstanceCuller's layout,
+	so `dataSizePerInstanceOutput` given to setLoDMeshes must be at least CCPUInstanceCuller::OutputSizePerInstance.
+	Needs to be called again after every setLoDMeshes.
+	\param threadCount Number of threads to cull with, 0 uses all the threads of CJobSystem::getGlobal().
+	\return false if there are no LoD meshes set or the per instance output is too small. */
+	virtual bool setBuiltinCPUCulling(const bool& enable, const uint32_t& threadCount=0) = 0;
+
+	virtual bool isBuiltinCPUCullingEnabled() const = 0;
+
 	virtual const size_t& getInstanceCount() const = 0;
 
 	virtual const core::aabbox3df& getLoDInvariantBBox() const = 0;
@@ -371,23 +371,17 @@ class IMetaGranularGPUMappedBuffer : public core::IMetaGranularBuffer<video::IGP
             if (!B)
                 return;
 
+            //! drivers without GPU buffers (the null driver) leave only the back buffer, still good for the CPU side
             A = Driver->createGPUBuffer(GranuleByteSize*granuleCount,NULL,true,InClientMemeory);
-            if (!A)
-            {
-                B->drop();
-                B = NULL;
-
-                Granules = 0;
-                if (residencyRedirectTo)
-                    free(residencyRedirectTo);
-                residencyRedirectTo = NULL;
-            }
         }
 
         virtual video::IGPUBuffer* getFrontBuffer() {return A;}
 
         virtual void SwapBuffers(void (*StuffToDoToNewBuffer)(video::IGPUBuffer*,void*)=NULL,void* userData=NULL)
         {
+            if (!A)
+                return;
+
 #ifdef _IRR_SWAP_BY_RECREATE_
             A->clandestineRecreate(Allocated*GranuleByteSize,B->getPointer());
 #else
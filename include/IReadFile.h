@@ -23,6 +23,16 @@ namespace io
 		\return How many bytes were read. */
 		virtual int32_t read(void* buffer, uint32_t sizeToRead) = 0;
 
+		//! Reads an amount of bytes from a given position in the file.
+		/** Neither uses nor changes the current position, so several threads can
+		call it on the same file at once, and it is how files inside archives
+		read from the archive without disturbing each other.
+		\param offset Position in the file to read from.
+		\param buffer Pointer to buffer where read bytes are written to.
+		\param sizeToRead Amount of bytes to read from the file.
+		\return How many bytes were read, less than sizeToRead only at the end of the file or on an error. */
+		virtual size_t readAt(const size_t& offset, void* buffer, const size_t& sizeToRead) = 0;
+
 		//! Changes position in file
 		/** \param finalPos Destination position in the file.
 		\param relativeMovement If set to true, the position in the file is
@@ -20,6 +20,7 @@
 #include "IMeshCache.h"
 #include "ISkinnedMesh.h"
 #include "ISkinnedMeshSceneNode.h"
+#include <future>
 
 namespace irr
 {
@@ -89,6 +90,7 @@ namespace scene
 
 	class IAnimatedMeshSceneNode;
 	class IBillboardSceneNode;
+	class CCPUOcclusionCuller;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
 	class ILightManager;
@@ -326,6 +328,22 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual ICPUMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Get pointer to an animateable mesh without blocking the calling thread.
+		/** Opens the file on the calling thread and loads it on one of the scene manager's loader threads.
+		Only files which nothing but IMeshLoader::isReentrant() loaders would load go to the loader threads,
+		all other files get loaded on the calling thread before this returns, as their loaders may use objects
+		whose reference counting is not thread safe. Files inside archives get read into memory on the calling thread.
+		Requests are merged by the absolute path of the file: requests for a file which is already being loaded
+		get the future of that load, and getMesh() called on such a file waits for it instead of loading it again.
+		The loaded mesh is published into the mesh cache before the future becomes ready,
+		so once it is, getMesh() with the same name returns it immediately. Meshes which a loader thread publishes
+		past the cache's memory budget only get evicted by the next IMeshCache::addMesh() or setMemoryBudget().
+		Loader threads do not log, and mesh loaders must not be added while loads are pending.
+		\param filename: Filename of the mesh to load.
+		\return Future yielding the same value getMesh() would have.
+		The mesh pointer should not be dropped. */
+		virtual std::shared_future<ICPUMesh*> getMeshAsync(const io::path& filename) = 0;
+
 		//! Get interface to the mesh cache which is shared beween all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -750,6 +768,11 @@ namespace scene
 		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
 		virtual IMeshManipulator* getMeshManipulator() = 0;
 
+		//! Get pointer to the CPU occlusion culler the nodes with EAC_CPU_OCCLUSION are tested against.
+		/** Occluders added to it get rasterized from the active camera in drawAll(), before the nodes register for rendering.
+		The culler is owned by the scene manager and must not be deleted. */
+		virtual CCPUOcclusionCuller* getCPUOcclusionCuller() = 0;
+
 		//! Adds a scene node to the deletion queue.
 		/** The scene node is immediatly
 		deleted when it's secure. Which means when the scene node does not
@@ -4,6 +4,7 @@
 #include "CFinalBoneHierarchy.h"
 #include "IMetaGranularBuffer.h"
 #include "IDummyTransformationSceneNode.h"
+#include <vector>
 
 namespace irr
 {
@@ -80,6 +81,41 @@ namespace scene
     class ISkinningStateManager : public virtual IReferenceCounted
     {
         public:
+            //! What performBoning() computes for every bone of every instance, also the layout of getBoneDataTBO()
+            #include "irrpack.h"
+            struct FinalBoneData
+            {
+                core::matrix4x3 SkinningTransform;
+                float SkinningNormalMatrix[9];
+                float MinBBoxEdge[3];
+                float MaxBBoxEdge[3];
+                float lastAnimatedFrame; //to pad to 128bit align, maybe parentOffsetRelative?
+            } PACK_STRUCT;
+            #include "irrunpack.h"
+
+            //! How many animation layers setAnimationLayers() takes per instance
+            enum E_ANIMATION_LAYER_LIMITS
+            {
+                MAX_ANIMATION_LAYERS = 4u
+            };
+
+            //! One frame of the hierarchy's animation blended into the pose of an instance, see setAnimationLayers()
+            struct SAnimationLayer
+            {
+                SAnimationLayer() : frame(0.f), weight(1.f), referenceFrame(0.f), boneMask(0xdeadbeefu), additive(false) {}
+
+                //! where to sample the keyframes, clips are just ranges of frames of the CFinalBoneHierarchy
+                float frame;
+                //! contribution of the layer, multiplied by the weight the bone mask gives each bone
+                float weight;
+                //! for additive layers, the frame whose pose counts as "no change", the layer adds its difference from it
+                float referenceFrame;
+                //! ID returned by addBoneMask(), 0xdeadbeefu affects all bones
+                uint32_t boneMask;
+                //! false crossfades the layer with the other non-additive ones, true applies it on top of their result
+                bool additive;
+            };
+
             enum E_BONE_UPDATE_MODE
             {
                 //! do nothing, no bones get made, GPU_BONING compatibile
@@ -310,6 +346,42 @@ namespace scene
                 reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+finalBoneDataInstanceBuffer->getRedirectFromID(ID)*actualSizeOfInstanceDataElement)->frame = frame;
             }
 
+            //! Registers per bone weights in [0,1] that layers can limit themselves with (e.g. only the upper body).
+            /** @param boneWeights getBoneCount() weights, in the bone order of the CFinalBoneHierarchy.
+            @returns The ID to put in SAnimationLayer::boneMask. */
+            inline uint32_t addBoneMask(const float* boneWeights)
+            {
+                const size_t boneCount = referenceHierarchy->getBoneCount();
+                boneMasks.insert(boneMasks.end(),boneWeights,boneWeights+boneCount);
+                return uint32_t(boneMasks.size()/boneCount-1u);
+            }
+
+            //! Makes the pose of an instance a blend of up to MAX_ANIMATION_LAYERS frames instead of just the one set with setFrame().
+            /** The non-additive layers are averaged by their weights (rotations with a normalized lerp), bones none of them
+            weigh in on keep the pose of setFrame(), then the additive layers are applied on top in order.
+            All layers are sampled in the same performBoning() pass, so a crossfade no longer needs two passes over the instance.
+            The layers are copied, call this again whenever their frames or weights change, a layerCount of 0 goes back to setFrame() only.
+            In EBUM_READ, bone nodes updated before the next performBoning() already read the layered pose. */
+            inline void setAnimationLayers(const uint32_t& ID, const SAnimationLayer* layers, const uint32_t& layerCount)
+            {
+                assert(ID<instanceDataSize);
+                assert(layerCount<=MAX_ANIMATION_LAYERS);
+                BoneHierarchyInstanceData* instance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+finalBoneDataInstanceBuffer->getRedirectFromID(ID)*actualSizeOfInstanceDataElement);
+                instance->layerCount = layerCount<uint32_t(MAX_ANIMATION_LAYERS) ? layerCount:uint32_t(MAX_ANIMATION_LAYERS);
+                for (uint32_t i=0; i<instance->layerCount; i++)
+                {
+                    assert(layers[i].boneMask==0xdeadbeefu||layers[i].boneMask<boneMasks.size()/referenceHierarchy->getBoneCount());
+                    instance->layers[i] = layers[i];
+                }
+                instance->layersChanged = true;
+            }
+
+            inline uint32_t getAnimationLayerCount(const uint32_t& ID) const
+            {
+                assert(ID<instanceDataSize);
+                return reinterpret_cast<const BoneHierarchyInstanceData*>(instanceData+finalBoneDataInstanceBuffer->getRedirectFromID(ID)*actualSizeOfInstanceDataElement)->layerCount;
+            }
+
             inline IBoneSceneNode* getBone(const uint32_t& boneID, const uint32_t& ID)
             {
                 assert(ID<instanceDataSize);
@@ -320,6 +392,16 @@ namespace scene
 
             inline const size_t& getDataInstanceCount() const {return finalBoneDataInstanceBuffer->getAllocatedCount();}
 
+            //! Number of FinalBoneData every instance has
+            inline size_t getBoneCount() const {return referenceHierarchy->getBoneCount();}
+
+            //! CPU copy of the bone data of an instance as of the last performBoning(), for skinning on the CPU
+            inline const FinalBoneData* getInstanceBoneData(const uint32_t& ID) const
+            {
+                assert(ID<instanceDataSize);
+                return reinterpret_cast<const FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer())+finalBoneDataInstanceBuffer->getRedirectFromID(ID)*referenceHierarchy->getBoneCount();
+            }
+
         protected:
             virtual ~ISkinningStateManager()
             {
@@ -354,7 +436,7 @@ namespace scene
             class BoneHierarchyInstanceData
             {
                 public:
-                    BoneHierarchyInstanceData() : refCount(0), frame(0.f), lastAnimatedFrame(-1.f), interpolateAnimation(true), attachedNode(NULL)
+                    BoneHierarchyInstanceData() : refCount(0), frame(0.f), lastAnimatedFrame(-1.f), interpolateAnimation(true), attachedNode(NULL), layerCount(0), layersChanged(false)
                     {
                     }
 
@@ -369,6 +451,12 @@ namespace scene
 
                     bool interpolateAnimation;
                     ISkinnedMeshSceneNode* attachedNode; //can be NULL
+
+                    //! 0 animates with `frame` alone
+                    uint32_t layerCount;
+                    //! set by setAnimationLayers() until the next performBoning()
+                    bool layersChanged;
+                    SAnimationLayer layers[MAX_ANIMATION_LAYERS];
             };
             inline core::matrix4x3* getGlobalMatrices(BoneHierarchyInstanceData* currentInstance)
             {
@@ -383,16 +471,9 @@ namespace scene
             size_t instanceDataSize;
 
             size_t instanceFinalBoneDataSize;
-            #include "irrpack.h"
-            struct FinalBoneData
-            {
-                core::matrix4x3 SkinningTransform;
-                float SkinningNormalMatrix[9];
-                float MinBBoxEdge[3];
-                float MaxBBoxEdge[3];
-                float lastAnimatedFrame; //to pad to 128bit align, maybe parentOffsetRelative?
-            } PACK_STRUCT;
-            #include "irrunpack.h"
+
+            //! getBoneCount() weights per mask added with addBoneMask()
+            std::vector<float> boneMasks;
     };
 
 } // end namespace scene
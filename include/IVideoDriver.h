@@ -28,6 +28,7 @@
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
 #include <string>
+#include <functional>
 
 namespace irr
 {
@@ -779,6 +780,34 @@ namespace video
 		See IReferenceCounted::drop() for more information. */
 		virtual std::vector<CImageData*> createImageDataFromFile(io::IReadFile* file) =0;
 
+		//! Called on the decoding thread as soon as one file of a batch has been loaded.
+		/** Receives the index of the file in the batch and the images loaded from it, which are empty if it failed.
+		The images stay owned by the batch result, grab them to keep them past it. */
+		typedef std::function<void(const uint32_t&,const std::vector<CImageData*>&)> ImageDecodedCallback;
+
+		//! Loads many image files at once, spread over a pool of threads.
+		/** Each thread runs the same loaders createImageDataFromFile() would,
+		with its own libpng/libjpeg decoder state, so the files decode in parallel.
+		The call returns once all of them are done. The files get opened and closed on the calling thread,
+		only reading and decoding them runs on the others, and whatever the loaders log reaches the logger
+		from the calling thread too, after all files are done.
+		\param filenames Files to load.
+		\param threadCount Number of threads to decode with, 0 uses all the threads of CJobSystem::getGlobal().
+		\param callback Optional, invoked once per file as soon as it is loaded, possibly on different threads at once.
+		\return One image list per file, in the order of filenames, empty for files which failed to load.
+		If you no longer need the image data, call CImageData::drop() on all members. */
+		virtual std::vector<std::vector<CImageData*> > createImageDataFromFiles(const std::vector<io::path>& filenames, const uint32_t& threadCount=0,
+																				const ImageDecodedCallback& callback=ImageDecodedCallback()) =0;
+
+		//! Loads many image files at once, spread over a pool of threads.
+		/** Same as the above, for files which are already open. No two threads ever read the same file.
+		\param files Files to load, the caller keeps ownership.
+		\param threadCount Number of threads to decode with, 0 uses all the threads of CJobSystem::getGlobal().
+		\param callback Optional, invoked once per file as soon as it is loaded, possibly on different threads at once.
+		\return One image list per file, in the order of files, empty for files which failed to load. */
+		virtual std::vector<std::vector<CImageData*> > createImageDataFromFiles(const std::vector<io::IReadFile*>& files, const uint32_t& threadCount=0,
+																				const ImageDecodedCallback& callback=ImageDecodedCallback()) =0;
+
 		//! Convenience function for releasing all images in a mip chain.
 		/**
 		\param List of .
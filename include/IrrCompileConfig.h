@@ -76,6 +76,8 @@
 //! So defines can be controlled from Makefiles or Projectfiles which allows building
 //! different library versions without having to change the sources.
 //! Example: NO_IRR_COMPILE_WITH_X11_ would disable X11
+//! BAW_SERVER builds the headless server library, it leaves out X11, OpenGL and the software renderer
+//! so only the console device with the null driver remains.
 
 
 //! Uncomment this line to compile with the SDL device
@@ -129,9 +131,9 @@
 #define _IRR_LINUX_PLATFORM_
 #endif
 #define _IRR_POSIX_API_
-///#ifndef BAW_SERVER
+#ifndef BAW_SERVER
 #define _IRR_COMPILE_WITH_X11_DEVICE_
-///#endif
+#endif
 #endif
 
 
@@ -188,7 +190,9 @@ define out. */
 
 //! Define _IRR_COMPILE_WITH_BURNINGSVIDEO_ to compile the Irrlicht engine with Burning's video driver
 /** If you do not need this software driver, you can comment this define out. */
+#ifndef BAW_SERVER
 #define _IRR_COMPILE_WITH_BURNINGSVIDEO_
+#endif
 #ifdef NO_IRR_COMPILE_WITH_BURNINGSVIDEO_
 #undef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 #endif
@@ -197,9 +201,9 @@ define out. */
 /** If you do not wish the engine to be compiled with X11, comment this
 define out. */
 // Only used in LinuxDevice.
-///#ifndef BAW_SERVER
+#ifndef BAW_SERVER
 #define _IRR_COMPILE_WITH_X11_
-///#endif
+#endif
 #ifdef NO_IRR_COMPILE_WITH_X11_
 #undef _IRR_COMPILE_WITH_X11_
 #endif
@@ -211,9 +215,6 @@ define out. */
 #define _IRR_OPENGL_USE_EXTPOINTER_
 #endif
 
-#ifdef BAW_SERVER
-#define NO_IRR_LINUX_X11_RANDR_
-#endif
 //! VidMode is ANCIENT
 //#define NO_IRR_LINUX_X11_VIDMODE_
 //! On some Linux systems the XF86 vidmode extension or X11 RandR are missing. Use these flags
@@ -502,6 +503,12 @@ tool <http://developer.nvidia.com/object/nvperfhud_home.html>. */
 #ifdef NO_IRR_COMPILE_WITH_TGA_WRITER_
 #undef _IRR_COMPILE_WITH_TGA_WRITER_
 #endif
+//! Define _IRR_COMPILE_WITH_DDS_WRITER_ if you want to write block compressed .dds files
+/** Shares the file header definitions with the DDS loader, so it gets disabled along with it. */
+#define _IRR_COMPILE_WITH_DDS_WRITER_
+#if defined(NO_IRR_COMPILE_WITH_DDS_WRITER_) || !defined(_IRR_COMPILE_WITH_DDS_LOADER_)
+#undef _IRR_COMPILE_WITH_DDS_WRITER_
+#endif
 
 //! Define __IRR_COMPILE_WITH_ZIP_ARCHIVE_LOADER_ if you want to open ZIP and GZIP archives
 /** ZIP reading has several more options below to configure. */
@@ -582,6 +589,14 @@ currently only supports zip archives, though. */
 #undef __IRR_COMPILE_WITH_WAD_ARCHIVE_LOADER_
 #endif
 
+//! Define _IRR_COMPILE_WITH_PROFILER_ to compile the _IRR_PROFILE_ZONE timing zones of the engine's hot paths in
+/** Nothing gets recorded until core::CProfiler::setRecording(true) is called, until then a zone costs an atomic load.
+Off by default, so the zones cost nothing at all in builds which are not being profiled. */
+//#define _IRR_COMPILE_WITH_PROFILER_
+#ifdef NO_IRR_COMPILE_WITH_PROFILER_
+#undef _IRR_COMPILE_WITH_PROFILER_
+#endif
+
 //! Set FPU settings
 /** Irrlicht should use approximate float and integer fpu techniques
 precision will be lower but speed higher. currently X86 only
@@ -20,6 +20,7 @@ namespace irr
 {
 	class ILogger;
 	class IEventReceiver;
+	class CJobSystem;
 
 	namespace io {
 		class IFileSystem;
@@ -122,6 +123,12 @@ namespace irr
 		\return Pointer to the ITimer object. */
 		virtual ITimer* getTimer() = 0;
 
+		//! Provides access to the engine's job system.
+		/** Its worker count is set by SIrrlichtCreationParameters::JobWorkerCount,
+		the device also makes it the CJobSystem::getGlobal() one used by engine code without access to the device.
+		\return Pointer to the job system. */
+		virtual CJobSystem* getJobSystem() = 0;
+
 		//! Sets the caption of the window.
 		/** \param text: New text of the window caption. */
 		virtual void setWindowCaption(const std::wstring& text) = 0;
@@ -0,0 +1,45 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_CPU_FEATURES_H_INCLUDED__
+#define __S_CPU_FEATURES_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace core
+{
+
+//! x86 instruction set extensions for code paths which pick their implementation at runtime.
+/** The __IRR_COMPILE_WITH_SSE3 and similar defines only say what the whole engine got compiled for,
+kernels compiled with per-function target attributes check these instead. */
+struct SCPUFeatures
+{
+    SCPUFeatures() : SSE2(false), SSE3(false), SSSE3(false), SSE4_1(false), AVX(false), AVX2(false), FMA(false) {}
+
+    bool SSE2;
+    bool SSE3;
+    bool SSSE3;
+    bool SSE4_1;
+    //! Only set if the OS also saves the YMM registers.
+    bool AVX;
+    bool AVX2;
+    bool FMA;
+
+    //! Features the runtime dispatched code may use, these are the detected ones unless restricted with setAllowed().
+    static const SCPUFeatures& get();
+
+    //! Features reported by CPUID, queried once.
+    static const SCPUFeatures& detect();
+
+    //! Restricts get() to the features of `allowed` which the CPU also supports.
+    /** Meant for benchmarking and testing the fallback paths, don't call while other threads are running dispatched code. */
+    static void setAllowed(const SCPUFeatures& allowed);
+};
+
+} // end namespace core
+} // end namespace irr
+
+#endif
@@ -44,6 +44,7 @@ namespace irr
 			DisplayAdapter(0),
 			AuxGLContexts(0),
 			UsePerformanceTimer(true),
+			JobWorkerCount(0xffffffffu),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
 		}
@@ -74,6 +75,7 @@ namespace irr
 			AuxGLContexts = other.AuxGLContexts;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			JobWorkerCount = other.JobWorkerCount;
 			return *this;
 		}
 
@@ -257,6 +259,12 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Number of worker threads of the device's job system.
+		/** 0 runs every job on the thread waiting for it, in submission order, which makes
+		multithreaded engine code (image decoding, mip-map generation, culling, ...) run single-threaded and deterministic.
+		Default: 0xffffffffu, which is one less than the number of hardware threads. */
+		uint32_t JobWorkerCount;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
@@ -41,6 +41,7 @@
 #include "EMaterialFlags.h"
 #include "EMaterialTypes.h"
 #include "EMeshWriterEnums.h"
+#include "EImageWriterEnums.h"
 #include "ESceneNodeAnimatorTypes.h"
 #include "ESceneNodeTypes.h"
 #include "heapsort.h"
@@ -57,6 +58,16 @@
 #include "IGPUTransientBuffer.h"
 #include "IGPUProgrammingServices.h"
 #include "CImageData.h"
+#include "CBlockCompressor.h"
+#include "CMipMapGenerator.h"
+#include "CCPUInstanceCuller.h"
+#include "CCPUOcclusionCuller.h"
+#include "CCPUSkinner.h"
+#include "CCommandList.h"
+#include "CJobSystem.h"
+#include "CProfiler.h"
+#include "CBufferedReadFile.h"
+#include "CBufferedWriteFile.h"
 #include "IImage.h"
 #include "IImageLoader.h"
 #include "IImageWriter.h"
@@ -116,6 +127,7 @@
 #include "SAnimatedMesh.h"
 #include "SceneParameters.h"
 #include "SColor.h"
+#include "SCPUFeatures.h"
 #include "SCollisionEngine.h"
 #include "SExposedVideoData.h"
 #include "SIrrCreationParameters.h"
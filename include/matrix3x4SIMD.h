@@ -124,6 +124,15 @@ struct matrix3x4SIMD
 		return *this = concatenateBFollowedByAPrecisely(_other, *this);
 	}
 
+	//! Array versions of transformVect, mulSub3x3With3x1, concatenateBFollowedByA and transformBoxEx, for transforming a lot of data at once.
+	/** Points and normals are tightly packed float triplets, `_out` may be the same array as `_in` (or `_a` or `_b`).
+	The AVX2 with FMA, AVX or SSE kernel gets picked at runtime according to core::SCPUFeatures::get(),
+	all but the FMA one give the same results as calling the single item functions in a loop. Defined in matrix3x4SIMD.cpp */
+	static void transformPoints(const matrix3x4SIMD& _mtx, float* _out, const float* _in, size_t _count);
+	static void transformNormals(const matrix3x4SIMD& _mtx, float* _out, const float* _in, size_t _count);
+	static void concatenateBFollowedByA(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count);
+	static void transformBoxes(const matrix3x4SIMD& _mtx, aabbox3df* _out, const aabbox3df* _in, size_t _count);
+
 	inline bool operator==(const matrix3x4SIMD& _other)
 	{
 		for (size_t i = 0u; i < 3u; ++i)
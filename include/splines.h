@@ -39,6 +39,17 @@ class ISpline
         virtual uint32_t    getPos(vectorSIMDf& pos, float& distanceAlongSeg, const uint32_t& segmentID, float* paramHint=NULL, const float& accuracyThresh=0.00390625f) const = 0;
         virtual bool        getPos_fromParameter(vectorSIMDf& pos, const uint32_t& segmentID, const float& parameter) const = 0;
 
+        //get many positions at once
+        //outSegments receives what getPos would have returned for every (segmentIDs[i],distancesAlongSeg[i]) pair, the distances are left untouched
+        virtual void        getPosBatch(vectorSIMDf* outPos, uint32_t* outSegments, const uint32_t* segmentIDs, const float* distancesAlongSeg, const size_t& count, const float& accuracyThresh=0.00390625f) const
+        {
+            for (size_t i=0; i<count; i++)
+            {
+                float distance = distancesAlongSeg[i];
+                outSegments[i] = getPos(outPos[i],distance,segmentIDs[i],NULL,accuracyThresh);
+            }
+        }
+
         //to get direction to look in
         virtual bool        getUnnormDirection(vectorSIMDf& tan, const uint32_t& segmentID, const float& distanceAlongSeg) const = 0;
         virtual bool        getUnnormDirection_fromParameter(vectorSIMDf& tan, const uint32_t& segmentID, const float& parameter) const = 0;
@@ -305,7 +316,7 @@ class CLinearSpline : public ISpline
 class CQuadraticSpline : public ISpline
 {
     public:
-        CQuadraticSpline(vectorSIMDf* controlPoints, const size_t& count, const bool loop = false, const bool preemptFirstTurn=false) : ISpline(loop)
+        CQuadraticSpline(vectorSIMDf* controlPoints, const size_t& count, const bool loop = false, const bool preemptFirstTurn=false) : ISpline(loop), arcLenTableError(FLT_MAX)
         {
             //assert(count<0x80000000u && count);
             float currentApproxLen;
@@ -384,46 +395,20 @@ class CQuadraticSpline : public ISpline
         //this function returns the id of the segment you might have moved into - 0xdeadbeefu is an error code
         virtual uint32_t    getPos(vectorSIMDf& pos, float& distanceAlongSeg, const uint32_t& segmentID, float* paramHint=NULL, const float& accuracyThresh=0.00390625f) const
         {
-            if (distanceAlongSeg<0.f)
+            const uint32_t actualSeg = findSegment(distanceAlongSeg,segmentID);
+            if (actualSeg==0xdeadbeefu)
                 return 0xdeadbeefu;
 
-            uint32_t actualSeg;
-            if (isLoop)
-            {
-                actualSeg = segmentID%segments.size();
-                while (distanceAlongSeg>=segments[actualSeg].length)
-                {
-                    distanceAlongSeg -= segments[actualSeg].length;
-                    actualSeg++;
-                    if (actualSeg==segments.size())
-                        actualSeg = 0;
-                }
-            }
-            else
-            {
-                if (segmentID>=segments.size())
-                    return 0xdeadbeefu;
-
-                actualSeg = segmentID;
-                while (distanceAlongSeg>=segments[actualSeg].length)
-                {
-                    distanceAlongSeg -= segments[actualSeg].length;
-                    actualSeg++;
-                    if (actualSeg==segments.size())
-                        return 0xdeadbeefu;
-                }
-            }
-
             if (paramHint)
             {
                 if (actualSeg!=segmentID)
                     *paramHint = -1.f;
 
-                *paramHint = segments[actualSeg].getParameterFromArcLen(distanceAlongSeg,*paramHint,accuracyThresh);
+                *paramHint = getParameterFromArcLen(segments[actualSeg],distanceAlongSeg,*paramHint,accuracyThresh);
                 pos = segments[actualSeg].posHelper(*paramHint);
             }
             else
-                pos = segments[actualSeg].posHelper(segments[actualSeg].getParameterFromArcLen(distanceAlongSeg,-1.f,accuracyThresh));
+                pos = segments[actualSeg].posHelper(getParameterFromArcLen(segments[actualSeg],distanceAlongSeg,-1.f,accuracyThresh));
 
             return actualSeg;
         }
@@ -437,13 +422,91 @@ class CQuadraticSpline : public ISpline
             return true;
         }
 
+        //with usable arc length tables the parameters of 4 pairs at a time get looked up and interpolated in SIMD
+        virtual void        getPosBatch(vectorSIMDf* outPos, uint32_t* outSegments, const uint32_t* segmentIDs, const float* distancesAlongSeg, const size_t& count, const float& accuracyThresh=0.00390625f) const
+        {
+            if (arcLenTableError>accuracyThresh)
+            {
+                ISpline::getPosBatch(outPos,outSegments,segmentIDs,distancesAlongSeg,count,accuracyThresh);
+                return;
+            }
+
+            const float* table = arcLenTable.const_pointer();
+            const Segment* segs = segments.const_pointer();
+            for (size_t i=0; i<count; i+=4)
+            {
+                const size_t lanes = core::min_(count-i,size_t(4));
+
+                //! invalid and missing lanes stay at 0 which samples nothing
+                float distance[4] = {0.f,0.f,0.f,0.f};
+                float stepRecip[4] = {0.f,0.f,0.f,0.f};
+                float lastIndex[4] = {0.f,0.f,0.f,0.f};
+                float upperClamp[4] = {0.f,0.f,0.f,0.f};
+                for (size_t j=0; j<lanes; j++)
+                {
+                    distance[j] = distancesAlongSeg[i+j];
+                    const uint32_t actualSeg = outSegments[i+j] = findSegment(distance[j],segmentIDs[i+j]);
+                    if (actualSeg==0xdeadbeefu)
+                        continue;
+
+                    const Segment& seg = segs[actualSeg];
+                    if (seg.tableIntervals)
+                    {
+                        stepRecip[j] = seg.tableStepRecip;
+                        lastIndex[j] = float(seg.tableIntervals-1u);
+                        upperClamp[j] = float(seg.tableIntervals);
+                    }
+                    else //! straight segment, the "table" is the identity scaled by lenC_reciprocal
+                    {
+                        stepRecip[j] = seg.lenC_reciprocal;
+                        lastIndex[j] = FLT_MAX;
+                        upperClamp[j] = seg.parameterLength;
+                    }
+                }
+
+                //! position in table intervals, split into index and fraction
+                __m128 x = _mm_mul_ps(_mm_loadu_ps(distance),_mm_loadu_ps(stepRecip));
+                x = _mm_min_ps(_mm_max_ps(x,_mm_setzero_ps()),_mm_loadu_ps(upperClamp));
+                const __m128 index = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(x)),_mm_loadu_ps(lastIndex));
+                const __m128 fraction = _mm_sub_ps(x,index);
+                float indices[4];
+                _mm_storeu_ps(indices,index);
+
+                float lower[4];
+                float upper[4];
+                for (size_t j=0; j<4; j++)
+                {
+                    if (j<lanes&&outSegments[i+j]!=0xdeadbeefu&&segs[outSegments[i+j]].tableIntervals)
+                    {
+                        const float* segTable = table+segs[outSegments[i+j]].tableOffset+uint32_t(indices[j]);
+                        lower[j] = segTable[0];
+                        upper[j] = segTable[1];
+                    }
+                    else
+                    {
+                        lower[j] = indices[j];
+                        upper[j] = indices[j]+1.f;
+                    }
+                }
+
+                const __m128 lowerParam = _mm_loadu_ps(lower);
+                float param[4];
+                _mm_storeu_ps(param,_mm_add_ps(lowerParam,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(upper),lowerParam),fraction)));
+                for (size_t j=0; j<lanes; j++)
+                {
+                    if (outSegments[i+j]!=0xdeadbeefu)
+                        outPos[i+j] = segs[outSegments[i+j]].posHelper(param[j]);
+                }
+            }
+        }
+
         //to get direction to look in
         virtual bool        getUnnormDirection(vectorSIMDf& tan, const uint32_t& segmentID, const float& distanceAlongSeg) const
         {
             if (segmentID>=segments.size()||distanceAlongSeg>segments[segmentID].length)
                 return false;
 
-            tan = segments[segmentID].directionHelper(segments[segmentID].getParameterFromArcLen(distanceAlongSeg,-1.f,0.00390625f));
+            tan = segments[segmentID].directionHelper(getParameterFromArcLen(segments[segmentID],distanceAlongSeg,-1.f,0.00390625f));
 
             return true;
         }
@@ -487,7 +550,55 @@ class CQuadraticSpline : public ISpline
         }
 
 
-        virtual bool            isArcLengthPrecise() const {return true;}/**
+        virtual bool            isArcLengthPrecise() const {return true;}
+
+        //! Precomputes per segment tables from arc length to parameter, so that getPos needs no Newton-Raphson solve.
+        /** Every table is refined until linearly interpolating it misses the requested arc length by at most `maxError`,
+        or it reaches `maxIntervalsPerSegment`. Straight segments need no table. getPos, getUnnormDirection and getPosBatch
+        use the tables when the achieved error is within their `accuracyThresh`, otherwise the tables only seed the solver.
+        \return Worst arc length error of the lookup over all segments. */
+        float                   buildArcLengthTables(const float& maxError=0.001f, const uint32_t& maxIntervalsPerSegment=1024u)
+        {
+            arcLenTable.clear();
+            arcLenTableError = 0.f;
+
+            std::vector<float> params;
+            for (size_t i=0; i<segments.size(); i++)
+            {
+                Segment& seg = segments[i];
+                seg.tableIntervals = 0u;
+                if (seg.isStraight())
+                    continue;
+
+                float segError;
+                for (uint32_t intervals=4u; ; intervals*=2u)
+                {
+                    segError = seg.sampleArcLenTable(params,intervals,maxError*0.0625f);
+                    if (segError<=maxError||intervals>=maxIntervalsPerSegment)
+                        break;
+                }
+
+                seg.tableOffset = arcLenTable.size();
+                seg.tableIntervals = params.size()-1u;
+                seg.tableStepRecip = float(seg.tableIntervals)/seg.length;
+                for (size_t j=0; j<params.size(); j++)
+                    arcLenTable.push_back(params[j]);
+
+                arcLenTableError = core::max_(arcLenTableError,segError);
+            }
+
+            return arcLenTableError;
+        }
+        //! Frees the tables, getPos goes back to solving for every call.
+        void                    clearArcLengthTables()
+        {
+            arcLenTable.clear();
+            arcLenTableError = FLT_MAX;
+            for (size_t i=0; i<segments.size(); i++)
+                segments[i].tableIntervals = 0u;
+        }
+        //! Worst arc length error of the tables, FLT_MAX if they were not built.
+        float                   getArcLengthTableError() const {return arcLenTableError;}/**
         virtual float           parameterToDistance(const float& param) const
         {
         }
@@ -496,7 +607,57 @@ class CQuadraticSpline : public ISpline
         }**/
 
     protected:
-        CQuadraticSpline(bool loop) : ISpline(loop) {}
+        CQuadraticSpline(bool loop) : ISpline(loop), arcLenTableError(FLT_MAX) {}
+
+        //! walks forward from `segmentID` until `distanceAlongSeg` falls within a segment, 0xdeadbeefu if it falls off the end
+        inline uint32_t findSegment(float& distanceAlongSeg, const uint32_t& segmentID) const
+        {
+            if (distanceAlongSeg<0.f)
+                return 0xdeadbeefu;
+
+            uint32_t actualSeg;
+            if (isLoop)
+            {
+                actualSeg = segmentID%segments.size();
+                while (distanceAlongSeg>=segments[actualSeg].length)
+                {
+                    distanceAlongSeg -= segments[actualSeg].length;
+                    actualSeg++;
+                    if (actualSeg==segments.size())
+                        actualSeg = 0;
+                }
+            }
+            else
+            {
+                if (segmentID>=segments.size())
+                    return 0xdeadbeefu;
+
+                actualSeg = segmentID;
+                while (distanceAlongSeg>=segments[actualSeg].length)
+                {
+                    distanceAlongSeg -= segments[actualSeg].length;
+                    actualSeg++;
+                    if (actualSeg==segments.size())
+                        return 0xdeadbeefu;
+                }
+            }
+
+            return actualSeg;
+        }
+
+        class Segment;
+        //! table lookup when precise enough, else Newton-Raphson seeded by the table (if any)
+        inline float getParameterFromArcLen(const Segment& seg, const float& arcLen, float parameterHint, const float& accuracyThresh) const
+        {
+            if (seg.tableIntervals)
+            {
+                parameterHint = seg.getParameterFromTable(arcLenTable.const_pointer(),arcLen);
+                if (arcLenTableError<=accuracyThresh)
+                    return parameterHint;
+            }
+
+            return seg.getParameterFromArcLen(arcLen,parameterHint,accuracyThresh);
+        }
 
         void finalize()
         {
@@ -594,6 +755,9 @@ class CQuadraticSpline : public ISpline
             inline void finalize(const float &currentApproxLen)
             {
                 parameterLength = currentApproxLen;
+                tableOffset = 0u;
+                tableIntervals = 0u;
+                tableStepRecip = 0.f;
 
                 lenASq       = dot(weights[0],weights[0]).x;
                 double lenCSq= dot(weights[1],weights[1]).x;
@@ -671,8 +835,9 @@ class CQuadraticSpline : public ISpline
             {
                 if (std::abs(lenASq)>0.000001f)
                 {
+                    //! a start control point on the start point makes the curve leave it with zero speed
                     if (arcLen<=accuracyThresh)
-                        return arcLen;
+                        return lenC>0.f ? arcLen/lenC:0.f;
                     if (arcLen>=length-accuracyThresh)
                         return parameterLength;
                     if (parameterHint<0.f||parameterHint>parameterLength)
@@ -694,6 +859,37 @@ class CQuadraticSpline : public ISpline
                     return arcLen*lenC_reciprocal;
             }
 
+            inline bool isStraight() const {return std::abs(lenASq)<=0.000001f;}
+
+            //! parameters at `intervals`+1 evenly spaced arc lengths, returns the worst arc length error of interpolating between them
+            inline float sampleArcLenTable(std::vector<float>& outParams, const uint32_t& intervals, const float& solverThresh) const
+            {
+                outParams.resize(intervals+1u);
+                const float step = length/float(intervals);
+
+                outParams[0] = 0.f;
+                for (uint32_t i=1; i<intervals; i++)
+                    outParams[i] = getParameterFromArcLen(step*float(i),outParams[i-1],solverThresh);
+                outParams[intervals] = parameterLength;
+
+                //! the interpolation error of a smooth monotonic function peaks around the middle of the interval
+                float maxError = 0.f;
+                for (uint32_t i=0; i<intervals; i++)
+                {
+                    const float midParam = (outParams[i]+outParams[i+1])*0.5f;
+                    maxError = core::max_(maxError,std::abs(getArcLenFromParameter(midParam)-step*(float(i)+0.5f)));
+                }
+                return maxError;
+            }
+
+            inline float getParameterFromTable(const float* table, const float& arcLen) const
+            {
+                const float x = core::clamp(arcLen*tableStepRecip,0.f,float(tableIntervals));
+                const uint32_t index = core::min_(uint32_t(x),tableIntervals-1u);
+                table += tableOffset+index;
+                return table[0]+(table[1]-table[0])*(x-float(index));
+            }
+
             inline vectorSIMDf posHelper(const float& parameter) const
             {
                 return (weights[0]*parameter+weights[1])*parameter+weights[2];
@@ -754,6 +950,9 @@ class CQuadraticSpline : public ISpline
             };
             float arcCalcConstants[6];
             vectorSIMDf weights[3];
+            //! slice of CQuadraticSpline::arcLenTable, tableIntervals==0 means no table
+            uint32_t tableOffset,tableIntervals;
+            float tableStepRecip;
 
             private:
                 Segment() {}
@@ -761,6 +960,10 @@ class CQuadraticSpline : public ISpline
 
         core::array<Segment> segments;
         float splineLen;
+
+        //! parameters at evenly spaced arc lengths, for all segments back to back
+        core::array<float> arcLenTable;
+        float arcLenTableError;
 };
 
 
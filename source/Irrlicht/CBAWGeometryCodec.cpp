@@ -0,0 +1,232 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBAWGeometryCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace irr { namespace core
+{
+
+namespace
+{
+	// vertices are (de)transposed this many at a time, so the strided side stays in cache
+	const size_t VERTICES_PER_BLOCK = 256u;
+
+	inline uint64_t zigzag(int64_t _v) { return (uint64_t(_v)<<1) ^ uint64_t(_v>>63); }
+	inline int64_t unzigzag(uint64_t _v) { return int64_t(_v>>1) ^ -int64_t(_v&1u); }
+}
+
+
+void CBAWGeometryCodec::encode(std::vector<uint8_t>& _out, const void* _data, size_t _size, const SStreamLayout& _layout)
+{
+	_out.resize(calcMaxEncodedSize(_size));
+	uint8_t* const out = _out.data();
+	out[0] = uint8_t(_layout.kind);
+	out[1] = 0u;
+	out[2] = uint8_t(_layout.stride);
+	out[3] = uint8_t(_layout.stride>>8);
+
+	const uint8_t* const data = (const uint8_t*)_data;
+	size_t outSize = HEADER_SIZE;
+	size_t elementSize = 1u;
+	switch (_layout.kind)
+	{
+		case ESK_INDICES_16BIT:
+			elementSize = 2u;
+			encodeIndices(out, outSize, (const uint16_t*)data, _size/elementSize);
+			break;
+		case ESK_INDICES_32BIT:
+			elementSize = 4u;
+			encodeIndices(out, outSize, (const uint32_t*)data, _size/elementSize);
+			break;
+		default:
+			elementSize = _layout.stride;
+			encodeVertices(out+outSize, data, _size/elementSize, elementSize);
+			outSize += _size/elementSize*elementSize;
+			break;
+	}
+
+	// whatever does not make up a whole element stays as it is
+	const size_t remainder = _size%elementSize;
+	memcpy(out+outSize, data+_size-remainder, remainder);
+	_out.resize(outSize+remainder);
+}
+
+bool CBAWGeometryCodec::decode(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize)
+{
+	const uint8_t* const src = (const uint8_t*)_src;
+	uint8_t* const dst = (uint8_t*)_dst;
+	if (_srcSize < HEADER_SIZE)
+		return false;
+
+	const uint32_t stride = uint32_t(src[2]) | (uint32_t(src[3])<<8);
+	size_t srcPos = HEADER_SIZE;
+	size_t elementSize = 1u;
+	switch (src[0])
+	{
+		case ESK_INDICES_16BIT:
+			elementSize = 2u;
+			if (!decodeIndices((uint16_t*)dst, _dstSize/elementSize, src, _srcSize, srcPos))
+				return false;
+			break;
+		case ESK_INDICES_32BIT:
+			elementSize = 4u;
+			if (!decodeIndices((uint32_t*)dst, _dstSize/elementSize, src, _srcSize, srcPos))
+				return false;
+			break;
+		case ESK_VERTICES:
+			elementSize = stride;
+			if (!stride || _srcSize-srcPos < _dstSize)
+				return false;
+			decodeVertices(dst, _dstSize/elementSize, elementSize, src+srcPos);
+			srcPos += _dstSize/elementSize*elementSize;
+			break;
+		default:
+			return false;
+	}
+
+	const size_t remainder = _dstSize%elementSize;
+	if (_srcSize-srcPos < remainder)
+		return false;
+	memcpy(dst+_dstSize-remainder, src+srcPos, remainder);
+	return true;
+}
+
+template<typename T>
+void CBAWGeometryCodec::encodeIndices(uint8_t* _out, size_t& _outSize, const T* _indices, size_t _count)
+{
+	uint32_t fifo[FIFO_SIZE] = {0u};
+	uint32_t fifoHead = 0u;
+	uint32_t next = 0u;
+	uint32_t last = 0u;
+	for (size_t i = 0; i < _count; ++i)
+	{
+		T value;
+		memcpy(&value, _indices+i, sizeof(T)); // index buffers need not be aligned
+		const uint32_t index = value;
+
+		if (index == next)
+		{
+			_out[_outSize++] = CODE_NEXT;
+			fifo[fifoHead++%FIFO_SIZE] = index;
+			next++;
+		}
+		else
+		{
+			uint32_t hit = 0u;
+			for (uint32_t k = 1u; k <= FIFO_SIZE && !hit; ++k)
+			{
+				if (fifo[(fifoHead-k)%FIFO_SIZE] == index)
+					hit = k;
+			}
+
+			if (hit)
+				_out[_outSize++] = uint8_t(hit);
+			else
+			{
+				_out[_outSize++] = CODE_DELTA;
+				uint64_t delta = zigzag(int64_t(index)-int64_t(last));
+				do
+				{
+					_out[_outSize++] = uint8_t(delta&0x7fu) | (delta > 0x7fu ? 0x80u : 0u);
+					delta >>= 7;
+				} while (delta);
+
+				fifo[fifoHead++%FIFO_SIZE] = index;
+				next = std::max(next, index+1u);
+			}
+		}
+		last = index;
+	}
+}
+
+template<typename T>
+bool CBAWGeometryCodec::decodeIndices(T* _indices, size_t _count, const uint8_t* _src, size_t _srcSize, size_t& _srcPos)
+{
+	uint32_t fifo[FIFO_SIZE] = {0u};
+	uint32_t fifoHead = 0u;
+	uint32_t next = 0u;
+	uint32_t last = 0u;
+	for (size_t i = 0; i < _count; ++i)
+	{
+		if (_srcPos >= _srcSize)
+			return false;
+
+		const uint8_t code = _src[_srcPos++];
+		uint32_t index;
+		if (code == CODE_NEXT)
+		{
+			index = next++;
+			fifo[fifoHead++%FIFO_SIZE] = index;
+		}
+		else if (code < CODE_DELTA)
+			index = fifo[(fifoHead-code)%FIFO_SIZE];
+		else if (code == CODE_DELTA)
+		{
+			uint64_t delta = 0u;
+			uint8_t byte;
+			uint32_t shift = 0u;
+			do
+			{
+				if (_srcPos >= _srcSize || shift > 63u)
+					return false;
+				byte = _src[_srcPos++];
+				delta |= uint64_t(byte&0x7fu)<<shift;
+				shift += 7u;
+			} while (byte&0x80u);
+
+			index = uint32_t(int64_t(last)+unzigzag(delta));
+			fifo[fifoHead++%FIFO_SIZE] = index;
+			next = std::max(next, index+1u);
+		}
+		else
+			return false;
+
+		const T value = T(index);
+		memcpy(_indices+i, &value, sizeof(T));
+		last = index;
+	}
+	return true;
+}
+
+void CBAWGeometryCodec::encodeVertices(uint8_t* _out, const uint8_t* _vertices, size_t _count, size_t _stride)
+{
+	for (size_t block = 0; block < _count; block += VERTICES_PER_BLOCK)
+	{
+		const size_t blockEnd = std::min(block+VERTICES_PER_BLOCK, _count);
+		for (size_t j = 0; j < _stride; ++j)
+		{
+			uint8_t* column = _out+j*_count;
+			uint8_t previous = block ? _vertices[(block-1u)*_stride+j] : 0u;
+			for (size_t i = block; i < blockEnd; ++i)
+			{
+				const uint8_t byte = _vertices[i*_stride+j];
+				column[i] = uint8_t(byte-previous);
+				previous = byte;
+			}
+		}
+	}
+}
+
+void CBAWGeometryCodec::decodeVertices(uint8_t* _vertices, size_t _count, size_t _stride, const uint8_t* _src)
+{
+	for (size_t block = 0; block < _count; block += VERTICES_PER_BLOCK)
+	{
+		const size_t blockEnd = std::min(block+VERTICES_PER_BLOCK, _count);
+		for (size_t j = 0; j < _stride; ++j)
+		{
+			const uint8_t* column = _src+j*_count;
+			uint8_t previous = block ? _vertices[(block-1u)*_stride+j] : 0u;
+			for (size_t i = block; i < blockEnd; ++i)
+			{
+				previous = uint8_t(previous+column[i]);
+				_vertices[i*_stride+j] = previous;
+			}
+		}
+	}
+}
+
+}}
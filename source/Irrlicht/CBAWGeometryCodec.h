@@ -0,0 +1,85 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BAW_GEOMETRY_CODEC_H_INCLUDED__
+#define __C_BAW_GEOMETRY_CODEC_H_INCLUDED__
+
+#include "irrTypes.h"
+#include <vector>
+
+namespace irr { namespace core
+{
+
+//! Reversible coding of index and vertex buffers for core::Blob::EBCT_GEOMETRY blobs.
+/** Generic compressors see vertex and index buffers as bytes and find little to match in them, this rearranges
+the bytes so that what repeats lines up, and is meant to be followed by LZ4.
+Indices become one byte codes: the next not yet seen vertex, a hit in a FIFO of the 16 last new or far vertices
+(what a vertex cache optimized mesh mostly references), or a delta from the previous index.
+Vertices get split into byte columns (every byte of the vertex stride on its own, so the bytes of one attribute component
+are next to each other) and every byte is stored as the difference to the same byte of the previous vertex.
+The coded stream starts with the layout, so decoding only needs the decoded size.
+*/
+class CBAWGeometryCodec
+{
+	// private, undefined constructor
+	CBAWGeometryCodec();
+
+public:
+	enum E_STREAM_KIND
+	{
+		ESK_NONE = 0,
+		ESK_INDICES_16BIT,
+		ESK_INDICES_32BIT,
+		ESK_VERTICES
+	};
+
+	//! What a buffer holds, as far as the coding is concerned
+	struct SStreamLayout
+	{
+		SStreamLayout(E_STREAM_KIND _kind = ESK_NONE, uint32_t _stride = 0u) : kind(_kind), stride(_stride) {}
+
+		E_STREAM_KIND kind;
+		//! Bytes between consecutive vertices, only for ESK_VERTICES
+		uint32_t stride;
+	};
+
+	//! Whether a stream with this layout can be coded
+	static bool isCodable(const SStreamLayout& _layout)
+	{
+		return _layout.kind == ESK_INDICES_16BIT || _layout.kind == ESK_INDICES_32BIT || (_layout.kind == ESK_VERTICES && _layout.stride && _layout.stride <= 0xffffu);
+	}
+
+	//! Largest coded size of `_decodedSize` bytes of any layout
+	static size_t calcMaxEncodedSize(size_t _decodedSize) { return HEADER_SIZE + 2u*_decodedSize; }
+
+	//! Codes `_size` bytes of `_data`, the layout must be codable.
+	static void encode(std::vector<uint8_t>& _out, const void* _data, size_t _size, const SStreamLayout& _layout);
+
+	//! Decodes a stream made by encode() into `_dstSize` bytes.
+	/** @param _srcSize Bytes available in `_src`, they can be more than what the stream takes.
+	@returns False if the stream is corrupt or shorter than it should be. */
+	static bool decode(void* _dst, size_t _dstSize, const void* _src, size_t _srcSize);
+
+private:
+	enum
+	{
+		HEADER_SIZE = 4u,
+		FIFO_SIZE = 16u,
+		// codes of an index: 0 is the next new vertex, 1 to FIFO_SIZE a FIFO hit and then a zigzag varint delta follows
+		CODE_NEXT = 0u,
+		CODE_DELTA = FIFO_SIZE+1u
+	};
+
+	template<typename T>
+	static void encodeIndices(uint8_t* _out, size_t& _outSize, const T* _indices, size_t _count);
+	template<typename T>
+	static bool decodeIndices(T* _indices, size_t _count, const uint8_t* _src, size_t _srcSize, size_t& _srcPos);
+
+	static void encodeVertices(uint8_t* _out, const uint8_t* _vertices, size_t _count, size_t _stride);
+	static void decodeVertices(uint8_t* _vertices, size_t _count, size_t _stride, const uint8_t* _src);
+};
+
+}}
+
+#endif
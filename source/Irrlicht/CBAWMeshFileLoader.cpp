@@ -11,6 +11,7 @@
 #include "SMesh.h"
 #include "CSkinnedMesh.h"
 #include "os.h"
+#include "CBAWGeometryCodec.h"
 #include "lzma/LzmaDec.h"
 #include "lz4/lz4.h"
 
@@ -153,7 +154,7 @@ bool CBAWMeshFileLoader::verifyFile(SContext& _ctx) const
 		return false;
 
 	_ctx.fileVersion = ((uint64_t*)headerStr)[3];
-	if (_ctx.fileVersion >= 1)
+	if (_ctx.fileVersion >= 2)
         return false;
 
 	return true;
@@ -195,6 +196,12 @@ bool CBAWMeshFileLoader::validateHeaders(uint32_t* _blobCnt, uint32_t** _offsets
 	if (offsets[*_blobCnt-1] + headers[*_blobCnt-1].effectiveSize() >= _ctx.file->getSize()) // whether last blob doesn't "go out of file"
 		nope = true;
 
+	// whether every blob's coding is one this loader knows and the file's version allows, geometry coding came with version 1
+	const uint8_t knownCodingBits = core::Blob::EBCT_AES128_GCM | core::Blob::EBCT_LZ4 | core::Blob::EBCT_LZMA | (_ctx.fileVersion >= 1 ? core::Blob::EBCT_GEOMETRY : 0);
+	for (uint32_t i = 0; i < *_blobCnt; ++i)
+		if ((headers[i].compressionType & ~knownCodingBits) || ((headers[i].compressionType & core::Blob::EBCT_LZ4) && (headers[i].compressionType & core::Blob::EBCT_LZMA)))
+			nope = true;
+
 	if (nope)
 	{
 		free(offsets);
@@ -214,14 +221,17 @@ bool CBAWMeshFileLoader::safeRead(io::IReadFile * _file, void * _buf, size_t _si
 
 void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData & _data, SContext & _ctx, unsigned char _pwd[16], void * _stackPtr, size_t _stackSize) const
 {
+	const bool encrypted = (_data.header->compressionType & core::Blob::EBCT_AES128_GCM);
+	const bool compressed = (_data.header->compressionType & core::Blob::EBCT_LZ4) || (_data.header->compressionType & core::Blob::EBCT_LZMA);
+	const bool geometryCoded = (_data.header->compressionType & core::Blob::EBCT_GEOMETRY);
+	// geometry coded blobs get decompressed into a scratch buffer first (their coded size is not stored) and decoded from it at the end
+	const size_t dstSize = geometryCoded ? core::CBAWGeometryCodec::calcMaxEncodedSize(_data.header->blobSizeDecompr) : _data.header->blobSizeDecompr;
+
 	void* dst;
-	if (_stackPtr && _data.header->blobSizeDecompr <= _stackSize && _data.header->effectiveSize() <= _stackSize)
+	if (!geometryCoded && _stackPtr && _data.header->blobSizeDecompr <= _stackSize && _data.header->effectiveSize() <= _stackSize)
 		dst = _stackPtr;
 	else
-		dst = malloc(core::BlobHeaderV0::calcEncSize(_data.header->blobSizeDecompr));
-
-	const bool encrypted = (_data.header->compressionType & core::Blob::EBCT_AES128_GCM);
-	const bool compressed = (_data.header->compressionType & core::Blob::EBCT_LZ4) || (_data.header->compressionType & core::Blob::EBCT_LZMA);
+		dst = malloc(core::BlobHeaderV0::calcEncSize(dstSize));
 
 	void* dstCompressed = dst; // ptr to mem to load possibly compressed data
 	if (compressed)
@@ -269,9 +279,9 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData & _data, SContext &
 		bool res = false;
 
 		if (comprType & core::Blob::EBCT_LZ4)
-			res = decompressLz4(dst, _data.header->blobSizeDecompr, dstCompressed, _data.header->blobSize);
+			res = decompressLz4(dst, dstSize, dstCompressed, _data.header->blobSize);
 		else if (comprType & core::Blob::EBCT_LZMA)
-			res = decompressLzma(dst, _data.header->blobSizeDecompr, dstCompressed, _data.header->blobSize);
+			res = decompressLzma(dst, dstSize, dstCompressed, _data.header->blobSize);
 
 		free(dstCompressed);
 		if (!res)
@@ -285,6 +295,28 @@ void* CBAWMeshFileLoader::tryReadBlobOnStack(const SBlobData & _data, SContext &
 		}
 	}
 
+	if (geometryCoded)
+	{
+		void* decoded;
+		if (_stackPtr && _data.header->blobSizeDecompr <= _stackSize)
+			decoded = _stackPtr;
+		else
+			decoded = malloc(core::BlobHeaderV0::calcEncSize(_data.header->blobSizeDecompr));
+
+		const bool res = core::CBAWGeometryCodec::decode(decoded, _data.header->blobSizeDecompr, dst, compressed ? dstSize : _data.header->blobSize);
+		free(dst); // never on stack when geometry coded
+		if (!res)
+		{
+			if (decoded != _stackPtr)
+				free(decoded);
+#ifdef _DEBUG
+			os::Printer::log("Blob geometry decoding failed!", ELL_ERROR);
+#endif
+			return NULL;
+		}
+		dst = decoded;
+	}
+
 	return dst;
 }
 
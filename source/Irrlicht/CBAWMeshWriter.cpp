@@ -14,10 +14,25 @@
 #include "ISkinnedMesh.h"
 #include "CFinalBoneHierarchy.h"
 #include "os.h"
+#include "CJobSystem.h"
 #include "lz4/lz4.h"
+#include "lz4/lz4hc.h"
 #include "lzma/LzmaEnc.h"
 
-#define BAW_FILE_VERSION 0
+#include <sstream>
+
+//! version 1 added geometry coded blobs, files without them are still written as version 0 so older loaders keep reading them
+#define BAW_FILE_VERSION 1
+#define BAW_FILE_VERSION_WITHOUT_GEOMETRY_CODING 0
+
+namespace
+{
+	// Decompression speeds in decompressed bytes per second for projecting load times, roughly what one desktop core manages.
+	// Reading a raw blob costs nothing on top of the disk.
+	const double LZ4_DECOMPRESSION_SPEED = 2000.0*1024.0*1024.0;
+	const double LZMA_DECOMPRESSION_SPEED = 60.0*1024.0*1024.0;
+	const double GEOMETRY_DECODING_SPEED = 1000.0*1024.0*1024.0;
+}
 
 
 namespace irr {namespace scene {
@@ -101,7 +116,8 @@ namespace irr {namespace scene {
 	template<>
 	void CBAWMeshWriter::exportAsBlob<core::ICPUBuffer>(core::ICPUBuffer* _obj, uint32_t _headerIdx, io::IWriteFile* _file, SContext& _ctx, bool _compress)
 	{
-		tryWrite(_obj->getPointer(), _file, _ctx, _obj->getSize(), _headerIdx, _compress);
+		std::unordered_map<const core::ICPUBuffer*, core::CBAWGeometryCodec::SStreamLayout>::const_iterator layout = _ctx.geometryLayouts.find(_obj);
+		tryWrite(_obj->getPointer(), _file, _ctx, _obj->getSize(), _headerIdx, _compress, layout != _ctx.geometryLayouts.end() ? &layout->second : NULL);
 	}
 
 	bool CBAWMeshWriter::writeMesh(io::IWriteFile* _file, ICPUMesh* _mesh, int32_t _flags)
@@ -110,6 +126,7 @@ namespace irr {namespace scene {
 		if (!(_flags & EMWF_WRITE_COMPRESSED))
 			wp.blobLz4ComprThresh = wp.blobLzmaComprThresh = 0xffffffffFFFFFFFFU;
 		wp.encryptBlobBitField = EET_NOTHING;
+		wp.geometryCoding = (_flags & EMWF_WRITE_GEOMETRY_CODED);
 		return writeMesh(_file, _mesh, wp);
 	}
 
@@ -129,14 +146,40 @@ namespace irr {namespace scene {
 
 		uint64_t header[4];
 		memcpy(header, BAW_FILE_HEADER, FILE_HEADER_SIZE);
-		header[3] = BAW_FILE_VERSION;
+		header[3] = _propsStruct.geometryCoding ? BAW_FILE_VERSION : BAW_FILE_VERSION_WITHOUT_GEOMETRY_CODING;
 
 		_file->write(header, FILE_HEADER_SIZE);
 
 		SContext ctx; // context of this call of `writeMesh`
 		ctx.props = &_propsStruct;
+		if (_propsStruct.summary)
+			_propsStruct.summary->clear();
 
 		const uint32_t numOfInternalBlobs = genHeaders(_mesh, ctx);
+
+		// raw data buffers are where nearly all the bytes are, pick their compression all at once in parallel
+		if (_propsStruct.codecSelection != ECS_THRESHOLDS)
+		{
+			ctx.precompressed.resize(ctx.headers.size());
+			std::vector<uint32_t> buffers;
+			for (uint32_t i = 0; i < ctx.headers.size(); ++i)
+			{
+				if (ctx.headers[i].blobType == core::Blob::EBT_RAW_DATA_BUFFER && reinterpret_cast<core::ICPUBuffer*>(ctx.headers[i].handle)->getSize() >= _propsStruct.blobLz4ComprThresh)
+					buffers.push_back(i);
+			}
+			// failed trial compressions log, which has to reach the Logger from this thread
+			std::vector<os::Printer::LogCapture> logs(buffers.size());
+			CJobSystem::getGlobal()->parallelFor(uint32_t(buffers.size()), [&](const uint32_t& job)
+			{
+				const core::ICPUBuffer* buffer = reinterpret_cast<core::ICPUBuffer*>(ctx.headers[buffers[job]].handle);
+				std::unordered_map<const core::ICPUBuffer*, core::CBAWGeometryCodec::SStreamLayout>::const_iterator layout = ctx.geometryLayouts.find(buffer);
+				logs[job].begin();
+				pickCompression(ctx.precompressed[buffers[job]], buffer->getPointer(), buffer->getSize(), layout != ctx.geometryLayouts.end() ? &layout->second : NULL, _propsStruct);
+				logs[job].end();
+			});
+			for (size_t i = 0; i < logs.size(); ++i)
+				logs[i].replay();
+		}
 		const uint32_t OFFSETS_FILE_OFFSET = FILE_HEADER_SIZE + sizeof(uint32_t) + sizeof(core::BAWFileV0::iv);
 		const uint32_t HEADERS_FILE_OFFSET = OFFSETS_FILE_OFFSET + numOfInternalBlobs * sizeof(ctx.offsets[0]);
 
@@ -194,12 +237,26 @@ namespace irr {namespace scene {
 
 		_file->seek(prevPos);
 
+#ifdef _DEBUG
+		if (_propsStruct.summary)
+		{
+			const char* const codecNames[EBC_COUNT] = {"raw", "LZ4", "LZ4HC", "LZMA"};
+			std::ostringstream tmpString("BAW blob codecs:");
+			tmpString.seekp(0, std::ios_base::end);
+			for (uint32_t i = 0; i < EBC_COUNT; ++i)
+				tmpString << " " << codecNames[i] << " " << _propsStruct.summary->blobCount[i] << " (" << _propsStruct.summary->storedBytes[i] << "/" << _propsStruct.summary->decompressedBytes[i] << " bytes)";
+			tmpString << ", projected load time " << _propsStruct.summary->projectedLoadTime*1000.0 << "ms";
+			os::Printer::log(tmpString.str());
+		}
+#endif // _DEBUG
+
 		return true;
 	}
 
 	uint32_t CBAWMeshWriter::genHeaders(ICPUMesh* _mesh, SContext& _ctx)
 	{
 		_ctx.headers.clear();
+		_ctx.geometryLayouts.clear();
 
 		bool isMeshAnimated = true;
 		ICPUSkinnedMesh* skinnedMesh = 0;
@@ -276,6 +333,9 @@ namespace irr {namespace scene {
 			const core::ICPUBuffer* idxBuffer = desc->getIndexBuffer();
 			if (idxBuffer && countedObjects.find(idxBuffer) == countedObjects.end())
 			{
+				if (meshBuffer->getIndexType() != video::EIT_UNKNOWN)
+					_ctx.geometryLayouts[idxBuffer] = core::CBAWGeometryCodec::SStreamLayout(meshBuffer->getIndexType() == video::EIT_16BIT ? core::CBAWGeometryCodec::ESK_INDICES_16BIT : core::CBAWGeometryCodec::ESK_INDICES_32BIT);
+
 				core::BlobHeaderV0 bh;
 				bh.handle = reinterpret_cast<uint64_t>(idxBuffer);
 				bh.compressionType = core::Blob::EBCT_RAW;
@@ -289,6 +349,9 @@ namespace irr {namespace scene {
 				const core::ICPUBuffer* attBuffer = desc->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)attId);
 				if (attBuffer && countedObjects.find(attBuffer) == countedObjects.end())
 				{
+					// interleaved attributes share the stride, the first attribute sourced from a buffer decides
+					_ctx.geometryLayouts[attBuffer] = core::CBAWGeometryCodec::SStreamLayout(core::CBAWGeometryCodec::ESK_VERTICES, uint32_t(desc->getMappedBufferStride((E_VERTEX_ATTRIBUTE_ID)attId)));
+
 					core::BlobHeaderV0 bh;
 					bh.handle = reinterpret_cast<uint64_t>(attBuffer);
 					bh.compressionType = core::Blob::EBCT_RAW;
@@ -307,7 +370,7 @@ namespace irr {namespace scene {
 		_ctx.offsets.push_back(!_ctx.offsets.size() ? 0 : _ctx.offsets.getLast() + _blobSize);
 	}
 
-	void CBAWMeshWriter::tryWrite(void* _data, io::IWriteFile * _file, SContext & _ctx, size_t _size, uint32_t _headerIdx, bool _encrypt) const
+	void CBAWMeshWriter::tryWrite(void* _data, io::IWriteFile * _file, SContext & _ctx, size_t _size, uint32_t _headerIdx, bool _encrypt, const core::CBAWGeometryCodec::SStreamLayout* _geometry) const
 	{
 		if (!_data)
 			return pushCorruptedOffset(_ctx);
@@ -315,20 +378,58 @@ namespace irr {namespace scene {
 		uint8_t stack[1u<<14];
 
 		size_t compressedSize = _size;
-		void* data = _data;
+		void* input = _data;
+		size_t inputSize = _size;
 		uint8_t comprType = core::Blob::EBCT_RAW;
+		E_BLOB_CODEC codec = EBC_RAW;
+		void* data = input;
 
-		if (_size >= _ctx.props->blobLzmaComprThresh)
+		std::vector<uint8_t> coded;
+		SCompressedBlob picked;
+		if (_ctx.props->codecSelection != ECS_THRESHOLDS)
 		{
-			data = compressWithLzma(data, _size, compressedSize);
-			if (data != _data)
-				comprType |= core::Blob::EBCT_LZMA;
+			SCompressedBlob& blob = (_headerIdx < _ctx.precompressed.size() && _ctx.precompressed[_headerIdx].picked) ? _ctx.precompressed[_headerIdx] : picked;
+			if (!blob.picked)
+				pickCompression(blob, _data, _size, _geometry, *_ctx.props);
+			if (blob.bytes.size())
+			{
+				input = data = blob.bytes.data();
+				compressedSize = blob.bytes.size();
+			}
+			inputSize = blob.decompressedSize;
+			comprType = blob.comprType;
+			codec = blob.codec;
 		}
-		else if (_size >= _ctx.props->blobLz4ComprThresh)
+		else
 		{
-			data = compressWithLz4AndTryOnStack(data, _size, stack, sizeof(stack), compressedSize);
-			if (data != _data)
-				comprType |= core::Blob::EBCT_LZ4;
+			// geometry coded data is meant to be followed by LZ4, LZMA would decode too slow to be worth it
+			const bool geometryCode = _ctx.props->geometryCoding && _geometry && core::CBAWGeometryCodec::isCodable(*_geometry) && _size >= _ctx.props->blobLz4ComprThresh;
+			if (geometryCode)
+			{
+				core::CBAWGeometryCodec::encode(coded, _data, _size, *_geometry);
+				input = data = coded.data();
+				inputSize = compressedSize = coded.size();
+				comprType |= core::Blob::EBCT_GEOMETRY;
+			}
+
+			if (_size >= _ctx.props->blobLzmaComprThresh && !geometryCode)
+			{
+				data = compressWithLzma(data, inputSize, compressedSize);
+				if (data != input)
+				{
+					comprType |= core::Blob::EBCT_LZMA;
+					codec = EBC_LZMA;
+				}
+			}
+			else if (_size >= _ctx.props->blobLz4ComprThresh)
+			{
+				data = compressWithLz4AndTryOnStack(data, inputSize, stack, sizeof(stack), compressedSize);
+				if (data != input)
+				{
+					comprType |= core::Blob::EBCT_LZ4;
+					codec = EBC_LZ4;
+				}
+			}
 		}
 
 		if (_encrypt)
@@ -340,7 +441,7 @@ namespace irr {namespace scene {
 			void* out = malloc(encrSize);
 			if (core::encAes128gcm(data, encrSize, out, encrSize, _ctx.props->encryptionPassPhrase, _ctx.props->initializationVector, _ctx.headers[_headerIdx].gcmTag))
 			{
-				if (data != _data && data != stack) // allocated in compressing functions?
+				if (data != input && data != stack) // allocated in compressing functions?
 					free(data);
 				data = out;
 				free(in);
@@ -361,7 +462,17 @@ namespace irr {namespace scene {
 		_file->write(data, writeSize);
 		calcAndPushNextOffset(!_headerIdx ? 0 : _ctx.headers[_headerIdx - 1].effectiveSize(), _ctx);
 
-		if (data != stack && data != _data)
+		if (SCodecSelectionSummary* summary = _ctx.props->summary)
+		{
+			const bool geometryCoded = (comprType & core::Blob::EBCT_GEOMETRY);
+			summary->blobCount[codec]++;
+			summary->decompressedBytes[codec] += _size;
+			summary->storedBytes[codec] += writeSize;
+			summary->geometryCodedBlobs += geometryCoded ? 1u : 0u;
+			summary->projectedLoadTime += projectLoadTime(*_ctx.props, codec, writeSize, inputSize, geometryCoded ? _size : 0u);
+		}
+
+		if (data != stack && data != input)
 			free(const_cast<void*>(data)); // safe const_cast since the only case when this executes is when `data` points to malloc'd memory
 	}
 
@@ -370,6 +481,116 @@ namespace irr {namespace scene {
 		return (_wp.encryptBlobBitField & _req);
 	}
 
+	void CBAWMeshWriter::pickCompression(SCompressedBlob& _out, const void* _data, size_t _size, const core::CBAWGeometryCodec::SStreamLayout* _geometry, const WriteProperties& _props) const
+	{
+		_out = SCompressedBlob();
+		_out.picked = true;
+		_out.decompressedSize = _size;
+		if (_size < _props.blobLz4ComprThresh)
+			return;
+
+		std::vector<uint8_t> coded;
+		const bool tryGeometry = _props.geometryCoding && _geometry && core::CBAWGeometryCodec::isCodable(*_geometry);
+		if (tryGeometry)
+			core::CBAWGeometryCodec::encode(coded, _data, _size, *_geometry);
+
+		const bool minSize = (_props.codecSelection == ECS_MIN_SIZE);
+		double bestTime = projectLoadTime(_props, EBC_RAW, _size, _size, 0u);
+		size_t bestSize = _size;
+		auto consider = [&](E_BLOB_CODEC _codec, bool _geometryCoded, const void* _stored, size_t _storedSize, size_t _decompressedSize)
+		{
+			const double time = projectLoadTime(_props, _codec, _storedSize, _decompressedSize, _geometryCoded ? _size : 0u);
+			const bool better = minSize ? (_storedSize < bestSize || (_storedSize == bestSize && time < bestTime)) : (time < bestTime || (time == bestTime && _storedSize < bestSize));
+			if (!better)
+				return;
+
+			bestTime = time;
+			bestSize = _storedSize;
+			_out.bytes.assign((const uint8_t*)_stored, (const uint8_t*)_stored + _storedSize);
+			_out.codec = _codec;
+			_out.comprType = (_geometryCoded ? core::Blob::EBCT_GEOMETRY : core::Blob::EBCT_RAW) | (_codec == EBC_LZMA ? core::Blob::EBCT_LZMA : (_codec == EBC_RAW ? core::Blob::EBCT_RAW : core::Blob::EBCT_LZ4));
+			_out.decompressedSize = _decompressedSize;
+		};
+
+		for (uint32_t pass = 0; pass < (tryGeometry ? 2u : 1u); ++pass)
+		{
+			const bool geometryCoded = (pass == 1u);
+			const void* input = geometryCoded ? coded.data() : _data;
+			const size_t inputSize = geometryCoded ? coded.size() : _size;
+			if (geometryCoded)
+				consider(EBC_RAW, true, input, inputSize, inputSize);
+
+			for (uint32_t c = EBC_LZ4; c < EBC_COUNT; ++c)
+			{
+				const E_BLOB_CODEC codec = (E_BLOB_CODEC)c;
+				// not even reading nothing at all and just decompressing would load faster, so no need to compress
+				if (!minSize && projectLoadTime(_props, codec, 0u, inputSize, geometryCoded ? _size : 0u) >= bestTime)
+					continue;
+
+				size_t compressedSize = inputSize;
+				void* compressed = NULL;
+				switch (codec)
+				{
+					case EBC_LZ4:
+						compressed = compressWithLz4AndTryOnStack(input, inputSize, NULL, 0u, compressedSize);
+						break;
+					case EBC_LZ4HC:
+						compressed = compressWithLz4HC(input, inputSize, compressedSize);
+						break;
+					default:
+						compressed = compressWithLzma(input, inputSize, compressedSize, geometryCoded);
+						break;
+				}
+				if (compressed == input)
+					continue;
+				consider(codec, geometryCoded, compressed, compressedSize, inputSize);
+				free(compressed);
+			}
+		}
+	}
+
+	double CBAWMeshWriter::projectLoadTime(const WriteProperties& _props, E_BLOB_CODEC _codec, size_t _storedSize, size_t _decompressedSize, size_t _decodedSize)
+	{
+		double time = double(_storedSize)/_props.diskBytesPerSecond + double(_decodedSize)/GEOMETRY_DECODING_SPEED;
+		switch (_codec)
+		{
+			case EBC_LZ4:
+			case EBC_LZ4HC:
+				time += double(_decompressedSize)/LZ4_DECOMPRESSION_SPEED;
+				break;
+			case EBC_LZMA:
+				time += double(_decompressedSize)/LZMA_DECOMPRESSION_SPEED;
+				break;
+			default:
+				break;
+		}
+		return time;
+	}
+
+	void* CBAWMeshWriter::compressWithLz4HC(const void* _input, size_t _inputSize, size_t& _outComprSize) const
+	{
+		void* data = NULL;
+		int compressedSize = 0;
+		const int lz4CompressBound = LZ4_compressBound(_inputSize);
+
+		if (lz4CompressBound) // if input is not too large
+		{
+			data = malloc(core::BlobHeaderV0::calcEncSize(lz4CompressBound));
+			compressedSize = LZ4_compress_HC((const char*)_input, (char*)data, _inputSize, lz4CompressBound, LZ4HC_CLEVEL_DEFAULT);
+		}
+		if (!compressedSize) // if compression did not succeed
+		{
+			free(data);
+			_outComprSize = _inputSize;
+#ifdef _DEBUG
+			os::Printer::log("Failed to compress (lz4hc). Blob exported without compression.", ELL_WARNING);
+#endif
+			return const_cast<void*>(_input);
+		}
+		_outComprSize = compressedSize;
+		return data;
+	}
+
 	void* CBAWMeshWriter::compressWithLz4AndTryOnStack(const void* _input, size_t _inputSize, void* _stack, size_t _stackSize, size_t& _outComprSize) const
 	{
 		void* data = _stack;
@@ -400,7 +621,7 @@ namespace irr {namespace scene {
 		return data;
 	}
 
-	void* CBAWMeshWriter::compressWithLzma(const void* _input, size_t _inputSize, size_t& _outComprSize) const
+	void* CBAWMeshWriter::compressWithLzma(const void* _input, size_t _inputSize, size_t& _outComprSize, bool _endMark) const
 	{
 		ISzAlloc alloc{&core::LzmaMemMngmnt::alloc, &core::LzmaMemMngmnt::release};
 		SizeT propsSize = LZMA_PROPS_SIZE;
@@ -419,6 +640,7 @@ namespace irr {namespace scene {
 		props.level = 5; // compression level [0;9]
 		props.algo = 0; // fast algo: a little worse compression, a little less loading time
 		props.lp = 2; // 2^2==sizeof(float)
+		props.writeEndMark = _endMark;
 
 		const SizeT heapSize = _inputSize + LZMA_PROPS_SIZE;
 		uint8_t* data = (uint8_t*)malloc(heapSize);
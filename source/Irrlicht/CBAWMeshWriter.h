@@ -9,7 +9,10 @@
 #include "IMeshWriter.h"
 #include "IMesh.h"
 #include "CBAWFile.h"
+#include "CBAWGeometryCodec.h"
 #include "irrArray.h"
+#include <unordered_map>
+#include <vector>
 
 namespace irr {
 
@@ -38,11 +41,64 @@ namespace scene
 			EET_EVERYTHING = 0xffffffffu
 		};
 
+		//! How the compression of every blob gets picked.
+		/** @see @ref WriteProperties::codecSelection
+		*/
+		enum E_CODEC_SELECTION
+		{
+			//! LZMA from WriteProperties::blobLzmaComprThresh bytes on, else LZ4 from WriteProperties::blobLz4ComprThresh bytes on
+			ECS_THRESHOLDS = 0,
+			//! Blobs from WriteProperties::blobLz4ComprThresh bytes on are trial compressed with every codec,
+			//! the one projected to read and decompress the fastest at WriteProperties::diskBytesPerSecond is kept
+			ECS_MIN_LOAD_TIME,
+			//! Same trial as ECS_MIN_LOAD_TIME, the smallest result is kept
+			ECS_MIN_SIZE
+		};
+
+		//! Codecs a blob can end up stored with, LZ4 and LZ4HC share the decoder and so core::Blob::EBCT_LZ4.
+		enum E_BLOB_CODEC
+		{
+			EBC_RAW = 0,
+			EBC_LZ4,
+			EBC_LZ4HC,
+			EBC_LZMA,
+			EBC_COUNT
+		};
+
+		//! What the blobs of one written file got compressed with.
+		struct SCodecSelectionSummary
+		{
+			SCodecSelectionSummary() { clear(); }
+
+			void clear()
+			{
+				for (uint32_t i = 0; i < EBC_COUNT; ++i)
+				{
+					blobCount[i] = 0u;
+					decompressedBytes[i] = storedBytes[i] = 0u;
+				}
+				geometryCodedBlobs = 0u;
+				projectedLoadTime = 0.0;
+			}
+
+			//! Per E_BLOB_CODEC, blobs stored with it.
+			uint32_t blobCount[EBC_COUNT];
+			//! Per E_BLOB_CODEC, size of the blobs as loaded.
+			uint64_t decompressedBytes[EBC_COUNT];
+			//! Per E_BLOB_CODEC, size of the blobs in the file.
+			uint64_t storedBytes[EBC_COUNT];
+			//! Blobs core::CBAWGeometryCodec coded before compression, counted in the above as well.
+			uint32_t geometryCodedBlobs;
+			//! Seconds reading all blobs at WriteProperties::diskBytesPerSecond and decompressing them is projected to take.
+			double projectedLoadTime;
+		};
+
 		//! Settings struct for mesh export
 		struct WriteProperties
 		{
 			//! Default constructor
-			WriteProperties() : blobLz4ComprThresh(4096u), blobLzmaComprThresh(32768u), encryptBlobBitField(EET_RAW_BUFFERS | EET_ANIMATION_DATA | EET_TEXTURES) {}
+			WriteProperties() : blobLz4ComprThresh(4096u), blobLzmaComprThresh(32768u), encryptBlobBitField(EET_RAW_BUFFERS | EET_ANIMATION_DATA | EET_TEXTURES), geometryCoding(false),
+				codecSelection(ECS_THRESHOLDS), diskBytesPerSecond(200.0*1024.0*1024.0), summary(NULL) {}
 			//! Size of blob threshold to be compressed with LZ4. Defaulted to 4096 bytes.
 			size_t blobLz4ComprThresh;
 			//! Size of blob threshold to be compressed with LZMA. Shall always be higher than LZ4 threshold. Defaulted to 32768 bytes.
@@ -55,14 +111,45 @@ namespace scene
 			uint64_t encryptBlobBitField;
 			//! Directory to which texture paths will be relative in output mesh file
 			io::path relPath;
+			//! Whether index and vertex buffers at least LZ4 threshold large get core::CBAWGeometryCodec coded before being compressed. Defaulted to false.
+			/** With ECS_THRESHOLDS the coded data always gets LZ4 compressed, which decodes several times faster than LZMA at a similar size.
+			With ECS_MIN_LOAD_TIME and ECS_MIN_SIZE the coding is only one more trial, the coded data may end up stored raw,
+			LZ4 or LZ4HC compressed or LZMA compressed with an end marker, whichever the selection picks. */
+			bool geometryCoding;
+			//! How the codec of every blob gets picked. Defaulted to ECS_THRESHOLDS.
+			/** With ECS_MIN_LOAD_TIME and ECS_MIN_SIZE, blobs below blobLz4ComprThresh stay uncompressed, geometryCoding makes the coding one more option to trial
+			and raw data buffers get trial compressed in parallel on the CJobSystem. */
+			E_CODEC_SELECTION codecSelection;
+			//! Read bandwidth of the disk the file is expected to be loaded from, for ECS_MIN_LOAD_TIME and the projected load time. Defaulted to 200MB/s.
+			double diskBytesPerSecond;
+			//! If not NULL, gets filled with the codecs chosen and the projected load time. Defaulted to NULL.
+			SCodecSelectionSummary* summary;
 		};
 
 	private:
+		//! Result of trial compressing a blob
+		struct SCompressedBlob
+		{
+			SCompressedBlob() : picked(false), comprType(core::Blob::EBCT_RAW), codec(EBC_RAW), decompressedSize(0u) {}
+
+			bool picked;
+			//! The blob as it will be stored, empty if stored as it is
+			std::vector<uint8_t> bytes;
+			uint8_t comprType;
+			E_BLOB_CODEC codec;
+			//! Size after undoing `codec`, the geometry coded size if geometry coded
+			size_t decompressedSize;
+		};
+
 		struct SContext
 		{
 			core::array<core::BlobHeaderV0> headers;
 			core::array<uint32_t> offsets;
 			const WriteProperties* props;
+			//! What the index and vertex buffers hold, for the geometry coding
+			std::unordered_map<const core::ICPUBuffer*, core::CBAWGeometryCodec::SStreamLayout> geometryLayouts;
+			//! Per header, compression picked ahead of writing by ECS_MIN_LOAD_TIME or ECS_MIN_SIZE (raw data buffers only)
+			std::vector<SCompressedBlob> precompressed;
 		};
 
 	protected:
@@ -101,12 +188,21 @@ namespace scene
 		void pushCorruptedOffset(SContext& _ctx) const { _ctx.offsets.push_back(0xffffffff); }
 
 		//! Tries to write given data to file. If not possible (i.e. _data is NULL) - pushes "corrupted offset" and does not call .finalize() on blob-header.
-		void tryWrite(void* _data, io::IWriteFile* _file, SContext& _ctx, size_t _size, uint32_t _headerIdx, bool _encrypt) const;
+		/** @param _geometry Layout of the data if it is an index or vertex buffer.*/
+		void tryWrite(void* _data, io::IWriteFile* _file, SContext& _ctx, size_t _size, uint32_t _headerIdx, bool _encrypt, const core::CBAWGeometryCodec::SStreamLayout* _geometry = NULL) const;
 
 		bool toEncrypt(const WriteProperties& _wp, E_ENCRYPTION_TARGETS _req) const;
 
+		//! Trial compresses a blob with every codec (with and without the geometry coding if `_geometry` allows) and keeps the best by WriteProperties::codecSelection.
+		void pickCompression(SCompressedBlob& _out, const void* _data, size_t _size, const core::CBAWGeometryCodec::SStreamLayout* _geometry, const WriteProperties& _props) const;
+		//! Seconds to read `_storedSize` bytes and decompress them with `_codec` into `_decompressedSize` bytes, plus geometry decoding into `_decodedSize` bytes if not 0.
+		static double projectLoadTime(const WriteProperties& _props, E_BLOB_CODEC _codec, size_t _storedSize, size_t _decompressedSize, size_t _decodedSize);
+
+		void* compressWithLz4HC(const void* _input, size_t _inputSize, size_t& _outComprSize) const;
+
 		void* compressWithLz4AndTryOnStack(const void* _input, size_t _inputSize, void* _stack, size_t _stackSize, size_t& _outComprSize) const;
-		void* compressWithLzma(const void* _input, size_t _inputSize, size_t& _outComprSize) const;
+		//! @param _endMark Whether to end the stream with a marker, needed when the loader does not know the exact decompressed size (geometry coded blobs).
+		void* compressWithLzma(const void* _input, size_t _inputSize, size_t& _outComprSize, bool _endMark = false) const;
 
 	private:
 		io::IFileSystem* m_fileSystem;
@@ -0,0 +1,986 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBlockCompressor.h"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "FW_Mutex.h"
+#include "CJobSystem.h"
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+
+//! Texels of one 4x4 block, split into R,G,B,A planes.
+struct SBlockTexels
+{
+    uint8_t plane[4][16];
+};
+
+//! Converts `count` texels of an uncompressed format into interleaved R8G8B8A8.
+void convertRowToRGBA8(const uint8_t* src, const ECOLOR_FORMAT& format, const uint32_t& count, uint8_t* out)
+{
+    switch (format)
+    {
+        case ECF_A1R5G5B5:
+        case ECF_R5G6B5:
+        case ECF_A8R8G8B8:
+            for (uint32_t i=0; i<count; i++,out+=4)
+            {
+                uint32_t color;
+                if (format==ECF_A8R8G8B8)
+                    color = reinterpret_cast<const uint32_t*>(src)[i];
+                else if (format==ECF_A1R5G5B5)
+                    color = A1R5G5B5toA8R8G8B8(reinterpret_cast<const uint16_t*>(src)[i]);
+                else
+                    color = R5G6B5toA8R8G8B8(reinterpret_cast<const uint16_t*>(src)[i]);
+                out[0] = (color>>16)&0xffu;
+                out[1] = (color>>8)&0xffu;
+                out[2] = color&0xffu;
+                out[3] = color>>24;
+            }
+            break;
+        case ECF_R8G8B8A8:
+            memcpy(out,src,count*4u);
+            break;
+        case ECF_R8G8B8:
+            for (uint32_t i=0; i<count; i++,src+=3,out+=4)
+            {
+                out[0] = src[0];
+                out[1] = src[1];
+                out[2] = src[2];
+                out[3] = 0xffu;
+            }
+            break;
+        case ECF_R8G8:
+            for (uint32_t i=0; i<count; i++,src+=2,out+=4)
+            {
+                out[0] = src[0];
+                out[1] = src[1];
+                out[2] = 0u;
+                out[3] = 0xffu;
+            }
+            break;
+        case ECF_R8:
+            for (uint32_t i=0; i<count; i++,src++,out+=4)
+            {
+                out[0] = src[0];
+                out[1] = 0u;
+                out[2] = 0u;
+                out[3] = 0xffu;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+//! How many bytes a block takes up.
+inline uint32_t getBlockByteSize(const ECOLOR_FORMAT& format)
+{
+    return getBitsPerPixelFromFormat(format)*2u; // 16 texels
+}
+
+inline float horizontalMin(__m128 v)
+{
+    v = _mm_min_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(2,3,0,1)));
+    v = _mm_min_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(1,0,3,2)));
+    return _mm_cvtss_f32(v);
+}
+
+inline float horizontalMax(__m128 v)
+{
+    v = _mm_max_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(2,3,0,1)));
+    v = _mm_max_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(1,0,3,2)));
+    return _mm_cvtss_f32(v);
+}
+
+inline float horizontalAdd(__m128 v)
+{
+    v = _mm_add_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(2,3,0,1)));
+    v = _mm_add_ps(v,_mm_shuffle_ps(v,v,_MM_SHUFFLE(1,0,3,2)));
+    return _mm_cvtss_f32(v);
+}
+
+inline uint8_t horizontalMinU8(__m128i v)
+{
+    v = _mm_min_epu8(v,_mm_srli_si128(v,8));
+    v = _mm_min_epu8(v,_mm_srli_si128(v,4));
+    v = _mm_min_epu8(v,_mm_srli_si128(v,2));
+    v = _mm_min_epu8(v,_mm_srli_si128(v,1));
+    return uint8_t(_mm_cvtsi128_si32(v));
+}
+
+inline uint8_t horizontalMaxU8(__m128i v)
+{
+    v = _mm_max_epu8(v,_mm_srli_si128(v,8));
+    v = _mm_max_epu8(v,_mm_srli_si128(v,4));
+    v = _mm_max_epu8(v,_mm_srli_si128(v,2));
+    v = _mm_max_epu8(v,_mm_srli_si128(v,1));
+    return uint8_t(_mm_cvtsi128_si32(v));
+}
+
+inline uint32_t sumOfSquaresU8(const __m128i& v)
+{
+    __m128i lo = _mm_unpacklo_epi8(v,_mm_setzero_si128());
+    __m128i hi = _mm_unpackhi_epi8(v,_mm_setzero_si128());
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo,lo),_mm_madd_epi16(hi,hi));
+    sum = _mm_add_epi32(sum,_mm_shuffle_epi32(sum,_MM_SHUFFLE(2,3,0,1)));
+    sum = _mm_add_epi32(sum,_mm_shuffle_epi32(sum,_MM_SHUFFLE(1,0,3,2)));
+    return uint32_t(_mm_cvtsi128_si32(sum));
+}
+
+
+
+//! BC4 style interpolated single channel block (also used for BC3 alpha and both BC5 channels)
+inline void buildBC4Palette(const uint8_t& a0, const uint8_t& a1, uint8_t palette[8])
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0>a1)
+    {
+        for (uint32_t i=1; i<7; i++)
+            palette[i+1] = uint8_t(((7u-i)*a0+i*a1+3u)/7u);
+    }
+    else
+    {
+        for (uint32_t i=1; i<5; i++)
+            palette[i+1] = uint8_t(((5u-i)*a0+i*a1+2u)/5u);
+        palette[6] = 0u;
+        palette[7] = 0xffu;
+    }
+}
+
+//! Picks the closest palette entry for all 16 texels at once, returns the squared error.
+inline uint32_t selectBC4Indices(const __m128i& texels, const uint8_t palette[8], uint8_t outIndices[16])
+{
+    __m128i best = _mm_set1_epi8(-1);
+    __m128i bestIx = _mm_setzero_si128();
+    for (uint32_t i=0; i<8; i++)
+    {
+        const __m128i entry = _mm_set1_epi8(char(palette[i]));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(texels,entry),_mm_subs_epu8(entry,texels));
+        // diff<best
+        const __m128i better = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(best,diff),_mm_setzero_si128()),_mm_set1_epi8(-1));
+        bestIx = _mm_or_si128(_mm_andnot_si128(better,bestIx),_mm_and_si128(better,_mm_set1_epi8(char(i))));
+        best = _mm_min_epu8(best,diff);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outIndices),bestIx);
+    return sumOfSquaresU8(best);
+}
+
+inline void writeBC4Block(const uint8_t& a0, const uint8_t& a1, const uint8_t indices[16], uint8_t* out)
+{
+    out[0] = a0;
+    out[1] = a1;
+    uint64_t bits = 0ull;
+    for (uint32_t i=0; i<16; i++)
+        bits |= uint64_t(indices[i])<<(i*3u);
+    for (uint32_t i=0; i<6; i++)
+        out[2+i] = uint8_t(bits>>(i*8u));
+}
+
+uint32_t encodeBC4Block(const uint8_t channel[16], const CBlockCompressor::E_COMPRESSION_QUALITY& quality, uint8_t* out)
+{
+    const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channel));
+    const uint8_t mn = horizontalMinU8(texels);
+    const uint8_t mx = horizontalMaxU8(texels);
+
+    uint8_t indices[16];
+    if (mn==mx)
+    {
+        memset(indices,0,16);
+        writeBC4Block(mx,mn,indices,out);
+        return 0u;
+    }
+
+    uint8_t palette[8];
+    buildBC4Palette(mx,mn,palette);
+    uint32_t bestError = selectBC4Indices(texels,palette,indices);
+    uint8_t bestA0 = mx, bestA1 = mn;
+
+    if (quality==CBlockCompressor::ECQ_HIGH && bestError)
+    {
+        uint8_t candidateIx[16];
+        // shrink the interpolation range a bit, extremes often are outliers
+        for (uint32_t i=0; i<3u; i++)
+        for (uint32_t j=0; j<3u; j++)
+        {
+            if (i==0&&j==0)
+                continue;
+            const int32_t a0 = int32_t(mx)-int32_t(i);
+            const int32_t a1 = int32_t(mn)+int32_t(j);
+            if (a0<=a1)
+                continue;
+
+            buildBC4Palette(a0,a1,palette);
+            const uint32_t error = selectBC4Indices(texels,palette,candidateIx);
+            if (error<bestError)
+            {
+                bestError = error;
+                bestA0 = a0;
+                bestA1 = a1;
+                memcpy(indices,candidateIx,16);
+            }
+        }
+
+        // 6 interpolated value mode with explicit 0 and 255, endpoints from the texels in between
+        const __m128i isExtreme = _mm_or_si128(_mm_cmpeq_epi8(texels,_mm_setzero_si128()),_mm_cmpeq_epi8(texels,_mm_set1_epi8(-1)));
+        const uint8_t innerMin = horizontalMinU8(_mm_or_si128(texels,isExtreme));
+        const uint8_t innerMax = horizontalMaxU8(_mm_andnot_si128(isExtreme,texels));
+        if (innerMin<=innerMax)
+        {
+            buildBC4Palette(innerMin,innerMax,palette);
+            const uint32_t error = selectBC4Indices(texels,palette,candidateIx);
+            if (error<bestError)
+            {
+                bestError = error;
+                bestA0 = innerMin;
+                bestA1 = innerMax;
+                memcpy(indices,candidateIx,16);
+            }
+        }
+    }
+
+    writeBC4Block(bestA0,bestA1,indices,out);
+    return bestError;
+}
+
+void decodeBC4Block(const uint8_t* in, uint8_t out[16])
+{
+    uint8_t palette[8];
+    buildBC4Palette(in[0],in[1],palette);
+    uint64_t bits = 0ull;
+    for (uint32_t i=0; i<6; i++)
+        bits |= uint64_t(in[2+i])<<(i*8u);
+    for (uint32_t i=0; i<16; i++)
+        out[i] = palette[(bits>>(i*3u))&0x7u];
+}
+
+
+
+inline uint16_t packRGB565(const float color[3])
+{
+    int32_t r = int32_t(core::clamp(color[0],0.f,255.f)*31.f/255.f+0.5f);
+    int32_t g = int32_t(core::clamp(color[1],0.f,255.f)*63.f/255.f+0.5f);
+    int32_t b = int32_t(core::clamp(color[2],0.f,255.f)*31.f/255.f+0.5f);
+    return uint16_t((r<<11)|(g<<5)|b);
+}
+
+inline void unpackRGB565(const uint16_t& color, int32_t out[3])
+{
+    const int32_t r = (color>>11)&0x1f;
+    const int32_t g = (color>>5)&0x3f;
+    const int32_t b = color&0x1f;
+    out[0] = (r<<3)|(r>>2);
+    out[1] = (g<<2)|(g>>4);
+    out[2] = (b<<3)|(b>>2);
+}
+
+//! The palette is 4 colors in 4 color mode, else 3 colors + black/transparent.
+inline void buildBC1Palette(const uint16_t& c0, const uint16_t& c1, const bool& fourColorMode, int32_t palette[4][3])
+{
+    unpackRGB565(c0,palette[0]);
+    unpackRGB565(c1,palette[1]);
+    for (uint32_t k=0; k<3; k++)
+    {
+        if (fourColorMode)
+        {
+            palette[2][k] = (2*palette[0][k]+palette[1][k])/3;
+            palette[3][k] = (palette[0][k]+2*palette[1][k])/3;
+        }
+        else
+        {
+            palette[2][k] = (palette[0][k]+palette[1][k])/2;
+            palette[3][k] = 0;
+        }
+    }
+}
+
+//! Color part of a block in float planes, ready for SSE.
+struct SColorBlock
+{
+    float rgb[3][16];
+    //! texels which must get index 3 in 3 color mode
+    uint32_t transparentMask;
+};
+
+//! Chooses the closest of the first `paletteSize` entries for every texel, returns the squared error of the non-transparent texels.
+float selectBC1Indices(const SColorBlock& block, const int32_t palette[4][3], const uint32_t& paletteSize, uint32_t& outIndices)
+{
+    __m128 pal[4][3];
+    for (uint32_t i=0; i<paletteSize; i++)
+    for (uint32_t k=0; k<3; k++)
+        pal[i][k] = _mm_set1_ps(float(palette[i][k]));
+
+    float error = 0.f;
+    outIndices = 0u;
+    for (uint32_t t=0; t<16; t+=4)
+    {
+        const __m128 r = _mm_loadu_ps(block.rgb[0]+t);
+        const __m128 g = _mm_loadu_ps(block.rgb[1]+t);
+        const __m128 b = _mm_loadu_ps(block.rgb[2]+t);
+
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 bestIx = _mm_setzero_ps();
+        for (uint32_t i=0; i<paletteSize; i++)
+        {
+            const __m128 dr = _mm_sub_ps(r,pal[i][0]);
+            const __m128 dg = _mm_sub_ps(g,pal[i][1]);
+            const __m128 db = _mm_sub_ps(b,pal[i][2]);
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr,dr),_mm_mul_ps(dg,dg)),_mm_mul_ps(db,db));
+            const __m128 better = _mm_cmplt_ps(dist,best);
+            best = _mm_min_ps(dist,best);
+            bestIx = _mm_or_ps(_mm_andnot_ps(better,bestIx),_mm_and_ps(better,_mm_set1_ps(float(i))));
+        }
+
+        float bestOut[4];
+        int32_t ixOut[4];
+        _mm_storeu_ps(bestOut,best);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ixOut),_mm_cvttps_epi32(bestIx));
+        for (uint32_t j=0; j<4; j++)
+        {
+            const uint32_t texel = t+j;
+            if (block.transparentMask&(0x1u<<texel))
+                outIndices |= 0x3u<<(texel*2u);
+            else
+            {
+                outIndices |= uint32_t(ixOut[j])<<(texel*2u);
+                error += bestOut[j];
+            }
+        }
+    }
+    return error;
+}
+
+struct SColorCandidate
+{
+    uint16_t c0,c1;
+    uint32_t indices;
+    float error;
+};
+
+//! Quantizes the endpoints, orders them for the requested mode, and picks indices.
+SColorCandidate evaluateBC1Endpoints(const SColorBlock& block, const float e0[3], const float e1[3], const bool& threeColorMode)
+{
+    SColorCandidate retval;
+    retval.c0 = packRGB565(e0);
+    retval.c1 = packRGB565(e1);
+    // 4 color mode needs c0>c1, 3 color mode c0<=c1
+    if ((retval.c0<retval.c1)!=threeColorMode && retval.c0!=retval.c1)
+        std::swap(retval.c0,retval.c1);
+
+    int32_t palette[4][3];
+    if (retval.c0==retval.c1 && !threeColorMode)
+    {
+        // cannot express 4 color mode, all texels use c0 then
+        buildBC1Palette(retval.c0,retval.c1,true,palette);
+        retval.error = selectBC1Indices(block,palette,1u,retval.indices);
+        return retval;
+    }
+
+    buildBC1Palette(retval.c0,retval.c1,!threeColorMode,palette);
+    retval.error = selectBC1Indices(block,palette,threeColorMode ? 3u:4u,retval.indices);
+    return retval;
+}
+
+//! Least squares fit of the endpoints to the texels given their current index assignment.
+bool refineBC1Endpoints(const SColorBlock& block, const uint32_t& indices, const bool& threeColorMode, float e0[3], float e1[3])
+{
+    static const float weights4[4] = {1.f,0.f,2.f/3.f,1.f/3.f};
+    static const float weights3[4] = {1.f,0.f,0.5f,0.f};
+    const float* weights = threeColorMode ? weights3:weights4;
+
+    float alpha2 = 0.f, beta2 = 0.f, alphaBeta = 0.f;
+    float alphaX[3] = {0.f,0.f,0.f};
+    float betaX[3] = {0.f,0.f,0.f};
+    for (uint32_t t=0; t<16; t++)
+    {
+        if (block.transparentMask&(0x1u<<t))
+            continue;
+
+        const float alpha = weights[(indices>>(t*2u))&0x3u];
+        const float beta = 1.f-alpha;
+        alpha2 += alpha*alpha;
+        beta2 += beta*beta;
+        alphaBeta += alpha*beta;
+        for (uint32_t k=0; k<3; k++)
+        {
+            alphaX[k] += alpha*block.rgb[k][t];
+            betaX[k] += beta*block.rgb[k][t];
+        }
+    }
+
+    const float det = alpha2*beta2-alphaBeta*alphaBeta;
+    if (fabsf(det)<0.0001f)
+        return false;
+
+    const float invDet = 1.f/det;
+    for (uint32_t k=0; k<3; k++)
+    {
+        e0[k] = core::clamp((alphaX[k]*beta2-betaX[k]*alphaBeta)*invDet,0.f,255.f);
+        e1[k] = core::clamp((betaX[k]*alpha2-alphaX[k]*alphaBeta)*invDet,0.f,255.f);
+    }
+    return true;
+}
+
+//! Bounding box of the block colors, with the diagonal flipped to follow the sign of the channel correlations.
+void computeBoundingBoxEndpoints(const SColorBlock& block, float e0[3], float e1[3])
+{
+    __m128 chMin[3],chMax[3],chSum[3];
+    float mean[3];
+    for (uint32_t k=0; k<3; k++)
+    {
+        chMin[k] = chMax[k] = chSum[k] = _mm_loadu_ps(block.rgb[k]);
+        for (uint32_t t=4; t<16; t+=4)
+        {
+            const __m128 v = _mm_loadu_ps(block.rgb[k]+t);
+            chMin[k] = _mm_min_ps(chMin[k],v);
+            chMax[k] = _mm_max_ps(chMax[k],v);
+            chSum[k] = _mm_add_ps(chSum[k],v);
+        }
+        e0[k] = horizontalMax(chMax[k]);
+        e1[k] = horizontalMin(chMin[k]);
+        mean[k] = horizontalAdd(chSum[k])/16.f;
+    }
+
+    // covariance of R and B against G decides which diagonal of the box we take
+    __m128 covRG = _mm_setzero_ps();
+    __m128 covBG = _mm_setzero_ps();
+    for (uint32_t t=0; t<16; t+=4)
+    {
+        const __m128 g = _mm_sub_ps(_mm_loadu_ps(block.rgb[1]+t),_mm_set1_ps(mean[1]));
+        covRG = _mm_add_ps(covRG,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.rgb[0]+t),_mm_set1_ps(mean[0])),g));
+        covBG = _mm_add_ps(covBG,_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.rgb[2]+t),_mm_set1_ps(mean[2])),g));
+    }
+    if (horizontalAdd(covRG)<0.f)
+        std::swap(e0[0],e1[0]);
+    if (horizontalAdd(covBG)<0.f)
+        std::swap(e0[2],e1[2]);
+
+    // inset by 1/16th of the range to reduce the error of the common case
+    for (uint32_t k=0; k<3; k++)
+    {
+        const float inset = (e0[k]-e1[k])/16.f;
+        e0[k] -= inset;
+        e1[k] += inset;
+    }
+}
+
+//! Endpoints at the extremes of the block projected onto its principal axis.
+void computePrincipalAxisEndpoints(const SColorBlock& block, float e0[3], float e1[3])
+{
+    float mean[3];
+    for (uint32_t k=0; k<3; k++)
+    {
+        __m128 sum = _mm_loadu_ps(block.rgb[k]);
+        for (uint32_t t=4; t<16; t+=4)
+            sum = _mm_add_ps(sum,_mm_loadu_ps(block.rgb[k]+t));
+        mean[k] = horizontalAdd(sum)/16.f;
+    }
+
+    // covariance matrix, symmetric so 6 unique entries
+    __m128 cov[6];
+    for (uint32_t i=0; i<6; i++)
+        cov[i] = _mm_setzero_ps();
+    for (uint32_t t=0; t<16; t+=4)
+    {
+        const __m128 r = _mm_sub_ps(_mm_loadu_ps(block.rgb[0]+t),_mm_set1_ps(mean[0]));
+        const __m128 g = _mm_sub_ps(_mm_loadu_ps(block.rgb[1]+t),_mm_set1_ps(mean[1]));
+        const __m128 b = _mm_sub_ps(_mm_loadu_ps(block.rgb[2]+t),_mm_set1_ps(mean[2]));
+        cov[0] = _mm_add_ps(cov[0],_mm_mul_ps(r,r));
+        cov[1] = _mm_add_ps(cov[1],_mm_mul_ps(r,g));
+        cov[2] = _mm_add_ps(cov[2],_mm_mul_ps(r,b));
+        cov[3] = _mm_add_ps(cov[3],_mm_mul_ps(g,g));
+        cov[4] = _mm_add_ps(cov[4],_mm_mul_ps(g,b));
+        cov[5] = _mm_add_ps(cov[5],_mm_mul_ps(b,b));
+    }
+    float c[6];
+    for (uint32_t i=0; i<6; i++)
+        c[i] = horizontalAdd(cov[i]);
+
+    // power iteration
+    float axis[3] = {1.f,1.f,1.f};
+    for (uint32_t it=0; it<8; it++)
+    {
+        const float x = c[0]*axis[0]+c[1]*axis[1]+c[2]*axis[2];
+        const float y = c[1]*axis[0]+c[3]*axis[1]+c[4]*axis[2];
+        const float z = c[2]*axis[0]+c[4]*axis[1]+c[5]*axis[2];
+        const float norm = std::max(std::max(fabsf(x),fabsf(y)),fabsf(z));
+        if (norm<FLT_MIN)
+            break;
+        axis[0] = x/norm;
+        axis[1] = y/norm;
+        axis[2] = z/norm;
+    }
+
+    float minProj = FLT_MAX, maxProj = -FLT_MAX;
+    uint32_t minTexel = 0, maxTexel = 0;
+    for (uint32_t t=0; t<16; t++)
+    {
+        const float proj = block.rgb[0][t]*axis[0]+block.rgb[1][t]*axis[1]+block.rgb[2][t]*axis[2];
+        if (proj<minProj)
+        {
+            minProj = proj;
+            minTexel = t;
+        }
+        if (proj>maxProj)
+        {
+            maxProj = proj;
+            maxTexel = t;
+        }
+    }
+    for (uint32_t k=0; k<3; k++)
+    {
+        e0[k] = block.rgb[k][maxTexel];
+        e1[k] = block.rgb[k][minTexel];
+    }
+}
+
+//! Encodes the 8 byte color part, `threeColorMode` is only allowed for BC1.
+uint32_t encodeBC1Block(const SBlockTexels& texels, const bool& punchThroughAlpha, const CBlockCompressor::E_COMPRESSION_QUALITY& quality, uint8_t* out)
+{
+    SColorBlock block;
+    block.transparentMask = 0u;
+    if (punchThroughAlpha)
+    {
+        for (uint32_t t=0; t<16; t++)
+        if (texels.plane[3][t]<128u)
+            block.transparentMask |= 0x1u<<t;
+    }
+
+    if (block.transparentMask==0xffffu)
+    {
+        // all transparent, c0==c1 triggers 3 color mode
+        memset(out,0,4);
+        memset(out+4,0xff,4);
+        return 0u;
+    }
+
+    // transparent texels take the value of an opaque one so they don't skew the endpoint search
+    uint32_t firstOpaque = 0u;
+    while (block.transparentMask&(0x1u<<firstOpaque))
+        firstOpaque++;
+    for (uint32_t k=0; k<3; k++)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels.plane[k]));
+        const __m128i lo = _mm_unpacklo_epi8(v,_mm_setzero_si128());
+        const __m128i hi = _mm_unpackhi_epi8(v,_mm_setzero_si128());
+        _mm_storeu_ps(block.rgb[k]+0,_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo,_mm_setzero_si128())));
+        _mm_storeu_ps(block.rgb[k]+4,_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo,_mm_setzero_si128())));
+        _mm_storeu_ps(block.rgb[k]+8,_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi,_mm_setzero_si128())));
+        _mm_storeu_ps(block.rgb[k]+12,_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi,_mm_setzero_si128())));
+        for (uint32_t t=0; t<16; t++)
+        if (block.transparentMask&(0x1u<<t))
+            block.rgb[k][t] = block.rgb[k][firstOpaque];
+    }
+    const bool threeColorMode = block.transparentMask!=0u;
+
+    float e0[3],e1[3];
+    computeBoundingBoxEndpoints(block,e0,e1);
+    SColorCandidate best = evaluateBC1Endpoints(block,e0,e1,threeColorMode);
+
+    if (quality==CBlockCompressor::ECQ_HIGH && best.error>0.f)
+    {
+        computePrincipalAxisEndpoints(block,e0,e1);
+        SColorCandidate candidate = evaluateBC1Endpoints(block,e0,e1,threeColorMode);
+        if (candidate.error<best.error)
+            best = candidate;
+
+        for (uint32_t it=0; it<2u && best.error>0.f; it++)
+        {
+            if (!refineBC1Endpoints(block,best.indices,threeColorMode,e0,e1))
+                break;
+            candidate = evaluateBC1Endpoints(block,e0,e1,threeColorMode);
+            if (candidate.error>=best.error)
+                break;
+            best = candidate;
+        }
+    }
+
+    out[0] = best.c0&0xffu;
+    out[1] = best.c0>>8;
+    out[2] = best.c1&0xffu;
+    out[3] = best.c1>>8;
+    for (uint32_t i=0; i<4; i++)
+        out[4+i] = uint8_t(best.indices>>(i*8u));
+    return uint32_t(best.error+0.5f);
+}
+
+//! Decodes the 8 byte color part into RGBA planes.
+void decodeBC1Block(const uint8_t* in, const bool& forceFourColorMode, uint8_t outRGBA[4][16])
+{
+    const uint16_t c0 = uint16_t(in[0])|(uint16_t(in[1])<<8);
+    const uint16_t c1 = uint16_t(in[2])|(uint16_t(in[3])<<8);
+    const bool fourColorMode = forceFourColorMode||c0>c1;
+    int32_t palette[4][3];
+    buildBC1Palette(c0,c1,fourColorMode,palette);
+
+    const uint32_t indices = uint32_t(in[4])|(uint32_t(in[5])<<8)|(uint32_t(in[6])<<16)|(uint32_t(in[7])<<24);
+    for (uint32_t t=0; t<16; t++)
+    {
+        const uint32_t ix = (indices>>(t*2u))&0x3u;
+        for (uint32_t k=0; k<3; k++)
+            outRGBA[k][t] = palette[ix][k];
+        outRGBA[3][t] = (!fourColorMode&&ix==3u) ? 0u:0xffu;
+    }
+}
+
+//! BC2 explicit 4bit alpha
+uint32_t encodeBC2Alpha(const uint8_t alpha[16], uint8_t* out)
+{
+    uint32_t error = 0u;
+    memset(out,0,8);
+    for (uint32_t t=0; t<16; t++)
+    {
+        const uint32_t quantized = (uint32_t(alpha[t])*15u+127u)/255u;
+        const int32_t diff = int32_t(quantized*17u)-int32_t(alpha[t]);
+        error += diff*diff;
+        out[t/2u] |= quantized<<((t&1u)*4u);
+    }
+    return error;
+}
+
+
+//! Encodes one block of `format` from the gathered texels, returns the summed squared error.
+uint32_t encodeBlock(const SBlockTexels& texels, const ECOLOR_FORMAT& format, const CBlockCompressor::E_COMPRESSION_QUALITY& quality, uint8_t* out)
+{
+    switch (format)
+    {
+        case ECF_RGB_BC1:
+            return encodeBC1Block(texels,false,quality,out);
+        case ECF_RGBA_BC1:
+            return encodeBC1Block(texels,true,quality,out);
+        case ECF_RGBA_BC2:
+            return encodeBC2Alpha(texels.plane[3],out)+encodeBC1Block(texels,false,quality,out+8);
+        case ECF_RGBA_BC3:
+            return encodeBC4Block(texels.plane[3],quality,out)+encodeBC1Block(texels,false,quality,out+8);
+        case ECF_R_BC4:
+            return encodeBC4Block(texels.plane[0],quality,out);
+        case ECF_RG_BC5:
+            return encodeBC4Block(texels.plane[0],quality,out)+encodeBC4Block(texels.plane[1],quality,out+8);
+        default:
+            return 0u;
+    }
+}
+
+void decodeBlock(const uint8_t* in, const ECOLOR_FORMAT& format, uint8_t outRGBA[4][16])
+{
+    switch (format)
+    {
+        case ECF_RGB_BC1:
+            decodeBC1Block(in,false,outRGBA);
+            memset(outRGBA[3],0xff,16);
+            break;
+        case ECF_RGBA_BC1:
+            decodeBC1Block(in,false,outRGBA);
+            break;
+        case ECF_RGBA_BC2:
+            decodeBC1Block(in+8,true,outRGBA);
+            for (uint32_t t=0; t<16; t++)
+                outRGBA[3][t] = ((in[t/2u]>>((t&1u)*4u))&0xfu)*17u;
+            break;
+        case ECF_RGBA_BC3:
+            decodeBC1Block(in+8,true,outRGBA);
+            decodeBC4Block(in,outRGBA[3]);
+            break;
+        case ECF_R_BC4:
+            decodeBC4Block(in,outRGBA[0]);
+            memset(outRGBA[1],0,16);
+            memset(outRGBA[2],0,16);
+            memset(outRGBA[3],0xff,16);
+            break;
+        case ECF_RG_BC5:
+            decodeBC4Block(in,outRGBA[0]);
+            decodeBC4Block(in+8,outRGBA[1]);
+            memset(outRGBA[2],0,16);
+            memset(outRGBA[3],0xff,16);
+            break;
+        default:
+            break;
+    }
+}
+
+//! Channels (from the front of RGBA) which the format actually stores, used for the PSNR.
+inline void getStoredChannels(const ECOLOR_FORMAT& format, bool stored[4])
+{
+    stored[0] = true;
+    stored[1] = format!=ECF_R_BC4;
+    stored[2] = format!=ECF_R_BC4&&format!=ECF_RG_BC5;
+    stored[3] = format==ECF_RGBA_BC1||format==ECF_RGBA_BC2||format==ECF_RGBA_BC3;
+}
+
+//! Gathers a row of blocks worth of source texels as interleaved RGBA8, edges get clamped.
+void gatherBlockRow(const uint8_t* srcData, const ECOLOR_FORMAT& srcFormat, const uint32_t& width, const uint32_t& height, const uint32_t& srcPitch,
+                    const uint32_t& blockRow, const uint32_t& paddedWidth, uint8_t* scratch)
+{
+    for (uint32_t y=0; y<4u; y++)
+    {
+        const uint32_t srcY = std::min(blockRow*4u+y,height-1u);
+        uint8_t* dstRow = scratch+y*paddedWidth*4u;
+        convertRowToRGBA8(srcData+size_t(srcY)*srcPitch,srcFormat,width,dstRow);
+        for (uint32_t x=width; x<paddedWidth; x++)
+            memcpy(dstRow+x*4u,dstRow+(width-1u)*4u,4u);
+    }
+}
+
+//! Transposes a 4x4 texel tile of interleaved RGBA8 into planes.
+inline void loadBlockTexels(const uint8_t* scratch, const uint32_t& paddedWidth, const uint32_t& blockX, SBlockTexels& out)
+{
+    for (uint32_t y=0; y<4u; y++)
+    {
+        const uint8_t* row = scratch+(y*paddedWidth+blockX*4u)*4u;
+        for (uint32_t x=0; x<4u; x++)
+        for (uint32_t k=0; k<4u; k++)
+            out.plane[k][y*4u+x] = row[x*4u+k];
+    }
+}
+
+//! Sum of squared differences between the source and the decoded blocks over the stored channels.
+uint64_t measureSquaredError(const uint8_t* src, const ECOLOR_FORMAT& srcFormat, const uint32_t& width, const uint32_t& height, const uint32_t& srcPitch,
+                             const uint8_t* blocks, const ECOLOR_FORMAT& blockFormat, const uint32_t& threadCount)
+{
+    const uint32_t blocksX = (width+3u)/4u;
+    const uint32_t blocksY = (height+3u)/4u;
+    const uint32_t paddedWidth = blocksX*4u;
+    const uint32_t blockBytes = getBlockByteSize(blockFormat);
+    const size_t rowBytes = size_t(blocksX)*blockBytes;
+
+    bool stored[4];
+    getStoredChannels(blockFormat,stored);
+
+    // error per block row, summed in order afterwards so the result doesn't depend on the thread count
+    std::vector<uint64_t> rowErrors(blocksY,0ull);
+    CJobSystem::getGlobal()->parallelFor(blocksY,[&](const uint32_t& blockRow)
+    {
+        std::vector<uint8_t> scratch(paddedWidth*16u);
+        gatherBlockRow(src,srcFormat,width,height,srcPitch,blockRow,paddedWidth,scratch.data());
+
+        SBlockTexels texels;
+        uint8_t decoded[4][16];
+        const uint8_t* inBlock = blocks+blockRow*rowBytes;
+        uint64_t error = 0ull;
+        for (uint32_t blockX=0; blockX<blocksX; blockX++,inBlock+=blockBytes)
+        {
+            loadBlockTexels(scratch.data(),paddedWidth,blockX,texels);
+            decodeBlock(inBlock,blockFormat,decoded);
+            for (uint32_t t=0; t<16u; t++)
+            {
+                // skip the padding texels
+                if (blockX*4u+(t&3u)>=width||blockRow*4u+t/4u>=height)
+                    continue;
+                for (uint32_t k=0; k<4u; k++)
+                {
+                    if (!stored[k])
+                        continue;
+                    const int32_t diff = int32_t(texels.plane[k][t])-int32_t(decoded[k][t]);
+                    error += uint64_t(diff*diff);
+                }
+            }
+        }
+        rowErrors[blockRow] = error;
+    },threadCount);
+
+    uint64_t totalError = 0ull;
+    for (auto it=rowErrors.begin(); it!=rowErrors.end(); it++)
+        totalError += *it;
+    return totalError;
+}
+
+inline double computePSNR(const uint64_t& squaredError, const uint64_t& texelCount, const ECOLOR_FORMAT& blockFormat)
+{
+    if (squaredError==0ull)
+        return std::numeric_limits<double>::infinity();
+
+    bool stored[4];
+    getStoredChannels(blockFormat,stored);
+    uint32_t channelCount = 0u;
+    for (uint32_t k=0; k<4u; k++)
+        channelCount += stored[k] ? 1u:0u;
+
+    const double mse = double(squaredError)/(double(texelCount)*channelCount);
+    return 10.0*log10(255.0*255.0/mse);
+}
+
+} // end anonymous namespace
+
+
+bool CBlockCompressor::isEncodableFormat(const ECOLOR_FORMAT& format)
+{
+    switch (format)
+    {
+        case ECF_RGB_BC1:
+        case ECF_RGBA_BC1:
+        case ECF_RGBA_BC2:
+        case ECF_RGBA_BC3:
+        case ECF_R_BC4:
+        case ECF_RG_BC5:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool CBlockCompressor::isSourceFormatSupported(const ECOLOR_FORMAT& format)
+{
+    switch (format)
+    {
+        case ECF_A1R5G5B5:
+        case ECF_R5G6B5:
+        case ECF_R8G8B8:
+        case ECF_A8R8G8B8:
+        case ECF_R8:
+        case ECF_R8G8:
+        case ECF_R8G8B8A8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t CBlockCompressor::getCompressedSize(const ECOLOR_FORMAT& format, const uint32_t& width, const uint32_t& height)
+{
+    if (!isEncodableFormat(format))
+        return 0u;
+
+    return size_t((width+3u)/4u)*size_t((height+3u)/4u)*getBlockByteSize(format);
+}
+
+bool CBlockCompressor::compress(const void* srcData, const ECOLOR_FORMAT& srcFormat, const uint32_t& width, const uint32_t& height, const uint32_t& srcPitch,
+                                void* outBlocks, const ECOLOR_FORMAT& blockFormat, const E_COMPRESSION_QUALITY& quality,
+                                const uint32_t& threadCount, SCompressionStatistics* outStats)
+{
+    if (!srcData||!outBlocks||!isSourceFormatSupported(srcFormat)||!isEncodableFormat(blockFormat))
+        return false;
+    if (width==0u||height==0u)
+        return false;
+
+    const uint32_t blocksX = (width+3u)/4u;
+    const uint32_t blocksY = (height+3u)/4u;
+    const uint32_t paddedWidth = blocksX*4u;
+    const uint32_t blockBytes = getBlockByteSize(blockFormat);
+    const size_t rowBytes = size_t(blocksX)*blockBytes;
+
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(srcData);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(outBlocks);
+
+    const uint64_t startTime = FW_GetTimestampNs();
+    CJobSystem::getGlobal()->parallelFor(blocksY,[&](const uint32_t& blockRow)
+    {
+        std::vector<uint8_t> scratch(paddedWidth*16u);
+        gatherBlockRow(src,srcFormat,width,height,srcPitch,blockRow,paddedWidth,scratch.data());
+
+        SBlockTexels texels;
+        uint8_t* outBlock = dst+blockRow*rowBytes;
+        for (uint32_t blockX=0; blockX<blocksX; blockX++,outBlock+=blockBytes)
+        {
+            loadBlockTexels(scratch.data(),paddedWidth,blockX,texels);
+            encodeBlock(texels,blockFormat,quality,outBlock);
+        }
+    },threadCount);
+    const uint64_t endTime = FW_GetTimestampNs();
+
+    if (outStats)
+    {
+        outStats->texelCount = uint64_t(width)*height;
+        outStats->seconds = double(endTime-startTime)*0.000000001;
+        outStats->megaTexelsPerSecond = outStats->seconds>0.0 ? double(outStats->texelCount)/outStats->seconds*0.000001:0.0;
+        const uint64_t squaredError = measureSquaredError(src,srcFormat,width,height,srcPitch,dst,blockFormat,threadCount);
+        outStats->PSNR = computePSNR(squaredError,outStats->texelCount,blockFormat);
+    }
+
+    return true;
+}
+
+CImageData* CBlockCompressor::compress(const CImageData* image, const ECOLOR_FORMAT& blockFormat, const E_COMPRESSION_QUALITY& quality,
+                                       const uint32_t& threadCount, SCompressionStatistics* outStats)
+{
+    if (!image||!isSourceFormatSupported(image->getColorFormat())||!isEncodableFormat(blockFormat))
+        return NULL;
+
+    uint32_t minCoord[3],maxCoord[3];
+    memcpy(minCoord,image->getSliceMin(),sizeof(minCoord));
+    memcpy(maxCoord,image->getSliceMax(),sizeof(maxCoord));
+    const uint32_t width = maxCoord[0]-minCoord[0];
+    const uint32_t height = maxCoord[1]-minCoord[1];
+    const uint32_t depth = maxCoord[2]-minCoord[2];
+    if (width==0u||height==0u||depth==0u)
+        return NULL;
+
+    CImageData* retval = new CImageData(NULL,minCoord,maxCoord,image->getSupposedMipLevel(),blockFormat,1);
+
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(image->getData());
+    uint8_t* dst = reinterpret_cast<uint8_t*>(retval->getData());
+    const uint32_t srcPitch = image->getPitchIncludingAlignment();
+    const size_t srcSliceBytes = size_t(srcPitch)*height;
+    const size_t dstSliceBytes = getCompressedSize(blockFormat,width,height);
+
+    const uint64_t startTime = FW_GetTimestampNs();
+    for (uint32_t z=0; z<depth; z++)
+    {
+        if (!compress(src+z*srcSliceBytes,image->getColorFormat(),width,height,srcPitch,dst+z*dstSliceBytes,blockFormat,quality,threadCount))
+        {
+            retval->drop();
+            return NULL;
+        }
+    }
+    const uint64_t endTime = FW_GetTimestampNs();
+
+    if (outStats)
+    {
+        outStats->texelCount = uint64_t(width)*height*depth;
+        outStats->seconds = double(endTime-startTime)*0.000000001;
+        outStats->megaTexelsPerSecond = outStats->seconds>0.0 ? double(outStats->texelCount)/outStats->seconds*0.000001:0.0;
+
+        uint64_t squaredError = 0ull;
+        for (uint32_t z=0; z<depth; z++)
+            squaredError += measureSquaredError(src+z*srcSliceBytes,image->getColorFormat(),width,height,srcPitch,dst+z*dstSliceBytes,blockFormat,threadCount);
+        outStats->PSNR = computePSNR(squaredError,outStats->texelCount,blockFormat);
+    }
+
+    return retval;
+}
+
+bool CBlockCompressor::decompress(const void* blocks, const ECOLOR_FORMAT& blockFormat, const uint32_t& width, const uint32_t& height,
+                                  uint8_t* outRGBA, const uint32_t& outPitch)
+{
+    if (!blocks||!outRGBA||!isEncodableFormat(blockFormat))
+        return false;
+
+    const uint32_t blocksX = (width+3u)/4u;
+    const uint32_t blocksY = (height+3u)/4u;
+    const uint32_t blockBytes = getBlockByteSize(blockFormat);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(blocks);
+
+    uint8_t decoded[4][16];
+    for (uint32_t blockY=0; blockY<blocksY; blockY++)
+    for (uint32_t blockX=0; blockX<blocksX; blockX++,in+=blockBytes)
+    {
+        decodeBlock(in,blockFormat,decoded);
+        for (uint32_t t=0; t<16u; t++)
+        {
+            const uint32_t x = blockX*4u+(t&3u);
+            const uint32_t y = blockY*4u+t/4u;
+            if (x>=width||y>=height)
+                continue;
+
+            uint8_t* outTexel = outRGBA+size_t(y)*outPitch+x*4u;
+            for (uint32_t k=0; k<4u; k++)
+                outTexel[k] = decoded[k][t];
+        }
+    }
+    return true;
+}
+
+} // end namespace video
+} // end namespace irr
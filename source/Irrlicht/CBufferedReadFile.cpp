@@ -0,0 +1,133 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBufferedReadFile.h"
+
+namespace irr
+{
+namespace io
+{
+
+
+CBufferedReadFile::CBufferedReadFile(IReadFile* file, const size_t& windowSize)
+    : File(file), FileSize(file->getSize()), Window(new uint8_t[windowSize]), WindowSize(windowSize),
+    WindowStart(file->getPos()), WindowFilled(0), WindowEnd(0), WindowPos(0), Limit(FileSize)
+{
+	#ifdef _DEBUG
+	setDebugName("CBufferedReadFile");
+	#endif
+
+    File->grab();
+}
+
+
+CBufferedReadFile::~CBufferedReadFile()
+{
+    File->seek(getPos());
+    File->drop();
+    delete [] Window;
+}
+
+
+int32_t CBufferedReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+    const size_t toRead = core::min_<size_t>(sizeToRead,getChunkRemaining());
+    uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+
+    size_t done = core::min_(toRead,WindowEnd-WindowPos);
+    memcpy(out,Window+WindowPos,done);
+    WindowPos += done;
+    if (done==toRead)
+        return int32_t(done);
+
+    const size_t rest = toRead-done;
+    if (rest>=WindowSize)
+    {
+        // would not fit anyway, no point in copying it twice
+        const size_t got = File->readAt(getPos(),out+done,rest);
+        WindowStart = getPos()+got;
+        done += got;
+        WindowFilled = WindowEnd = WindowPos = 0;
+    }
+    else if (fill())
+    {
+        const size_t more = core::min_(rest,WindowEnd);
+        memcpy(out+done,Window,more);
+        WindowPos = more;
+        done += more;
+    }
+    return int32_t(done);
+}
+
+
+size_t CBufferedReadFile::readAt(const size_t& offset, void* buffer, const size_t& sizeToRead)
+{
+    if (offset>=WindowStart && offset+sizeToRead<=WindowStart+WindowFilled)
+    {
+        memcpy(buffer,Window+offset-WindowStart,sizeToRead);
+        return sizeToRead;
+    }
+    return File->readAt(offset,buffer,sizeToRead);
+}
+
+
+bool CBufferedReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+    // relative movements can be negative, they come in wrapped around
+    const int64_t target = int64_t(finalPos)+(relativeMovement ? int64_t(getPos()):0);
+    if (target<0 || size_t(target)>Limit)
+        return false;
+
+    if (size_t(target)>=WindowStart && size_t(target)<=WindowStart+WindowEnd)
+        WindowPos = size_t(target)-WindowStart;
+    else
+    {
+        WindowStart = size_t(target);
+        WindowFilled = WindowEnd = WindowPos = 0;
+    }
+    return true;
+}
+
+
+bool CBufferedReadFile::pushChunk(const size_t& size)
+{
+    if (size>getChunkRemaining())
+        return false;
+
+    ChunkEnds.push_back(Limit);
+    Limit = getPos()+size;
+    WindowEnd = core::min_(WindowFilled,Limit-WindowStart);
+    return true;
+}
+
+
+void CBufferedReadFile::popChunk()
+{
+    if (ChunkEnds.empty())
+        return;
+
+    const size_t chunkEnd = Limit;
+    Limit = ChunkEnds.back();
+    ChunkEnds.pop_back();
+    WindowEnd = core::min_(WindowFilled,Limit-WindowStart);
+    seek(chunkEnd);
+}
+
+
+bool CBufferedReadFile::fill(const size_t& atLeast)
+{
+    const size_t pos = getPos();
+    if (Limit-pos<atLeast)
+        return false;
+
+    WindowStart = pos;
+    WindowPos = 0;
+    WindowFilled = File->readAt(pos,Window,core::min_(WindowSize,FileSize-pos));
+    WindowEnd = core::min_(WindowFilled,Limit-pos);
+    return WindowEnd>=atLeast;
+}
+
+
+} // end namespace io
+} // end namespace irr
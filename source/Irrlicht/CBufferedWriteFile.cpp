@@ -0,0 +1,167 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBufferedWriteFile.h"
+#include <stdio.h>
+#include <math.h>
+
+namespace irr
+{
+namespace io
+{
+
+
+CBufferedWriteFile::CBufferedWriteFile(IWriteFile* file, const size_t& bufferSize)
+    : File(file), BufferSize(bufferSize>size_t(MAX_NUMBER_CHARS) ? bufferSize:size_t(MAX_NUMBER_CHARS)), Used(0), Failed(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CBufferedWriteFile");
+	#endif
+
+    Buffer = new char[BufferSize];
+    File->grab();
+}
+
+
+CBufferedWriteFile::~CBufferedWriteFile()
+{
+    flush();
+    File->drop();
+    delete [] Buffer;
+}
+
+
+int32_t CBufferedWriteFile::write(const void* buffer, uint32_t sizeToWrite)
+{
+    const char* in = reinterpret_cast<const char*>(buffer);
+    size_t rest = sizeToWrite;
+    if (Used+rest>BufferSize)
+    {
+        flush();
+        if (rest>=BufferSize)
+        {
+            // would not fit anyway, no point in copying it
+            if (File->write(in,sizeToWrite)!=int32_t(sizeToWrite))
+                Failed = true;
+            return int32_t(sizeToWrite);
+        }
+    }
+    memcpy(Buffer+Used,in,rest);
+    Used += rest;
+    return int32_t(sizeToWrite);
+}
+
+
+bool CBufferedWriteFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+    flush();
+    return File->seek(finalPos,relativeMovement);
+}
+
+
+bool CBufferedWriteFile::flush()
+{
+    if (!Used)
+        return true;
+
+    const bool success = File->write(Buffer,Used)==int32_t(Used);
+    Used = 0;
+    if (!success)
+        Failed = true;
+    return success;
+}
+
+
+namespace
+{
+    //! %g with the default precision keeps 6 significant digits
+    const int32_t kPrecision = 6;
+    //! exponents %g prints in fixed notation
+    const int32_t kMinFixedExponent = -4;
+    const int32_t kMaxFixedExponent = kPrecision-1;
+
+    const double kPowersOf10[] = {1e-4,1e-3,1e-2,1e-1,1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9};
+}
+
+char* CBufferedWriteFile::formatFloat(char* out, const float& value)
+{
+    // the engine builds with fast math, so NaN and infinities can only be told apart by their bits
+    uint32_t bits;
+    memcpy(&bits,&value,4);
+    if ((bits&0x7f800000u)==0x7f800000u || (bits&0x7fffffffu)==0u) // NaN, infinities and zeroes (to keep the sign of -0)
+        return out+snprintf(out,MAX_NUMBER_CHARS,"%g",double(value));
+
+    char* const start = out;
+    double v = value;
+    if (bits>>31u)
+    {
+        *(out++) = '-';
+        v = -v;
+    }
+    if (v<kPowersOf10[0] || v>=kPowersOf10[kMaxFixedExponent+1-kMinFixedExponent])
+        return start+snprintf(start,MAX_NUMBER_CHARS,"%g",double(value));
+
+    int32_t exponent = kMinFixedExponent;
+    while (v>=kPowersOf10[exponent+1-kMinFixedExponent])
+        exponent++;
+
+    // A float has 24 significant bits and 10^9 fits in 30, so this product is exact
+    // and rounding it half to even gives the same digits as printf does.
+    const double scaled = v*kPowersOf10[kMaxFixedExponent-exponent-kMinFixedExponent];
+    const double whole = floor(scaled);
+    const double fraction = scaled-whole;
+    uint32_t digits = uint32_t(whole);
+    if (fraction>0.5 || (fraction==0.5 && (digits&1u)))
+        digits++;
+    if (digits>=1000000u)
+    {
+        digits /= 10u;
+        if (++exponent>kMaxFixedExponent)
+            return start+snprintf(start,MAX_NUMBER_CHARS,"%g",double(value));
+    }
+
+    // %g drops trailing zeroes of the fraction
+    int32_t digitCount = kPrecision;
+    while (digitCount>1 && digits%10u==0u)
+    {
+        digits /= 10u;
+        digitCount--;
+    }
+
+    char digitChars[kPrecision];
+    for (int32_t i=digitCount-1; i>=0; i--)
+    {
+        digitChars[i] = char('0'+digits%10u);
+        digits /= 10u;
+    }
+
+    if (exponent<0)
+    {
+        *(out++) = '0';
+        *(out++) = '.';
+        for (int32_t i=-1; i>exponent; i--)
+            *(out++) = '0';
+        memcpy(out,digitChars,digitCount);
+        return out+digitCount;
+    }
+
+    const int32_t integerDigits = exponent+1;
+    if (digitCount<=integerDigits)
+    {
+        memcpy(out,digitChars,digitCount);
+        out += digitCount;
+        for (int32_t i=digitCount; i<integerDigits; i++)
+            *(out++) = '0';
+        return out;
+    }
+    memcpy(out,digitChars,integerDigits);
+    out += integerDigits;
+    *(out++) = '.';
+    memcpy(out,digitChars+integerDigits,digitCount-integerDigits);
+    return out+digitCount-integerDigits;
+}
+
+
+} // end namespace io
+} // end namespace irr
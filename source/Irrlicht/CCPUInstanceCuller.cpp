@@ -0,0 +1,317 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CCPUInstanceCuller.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "IrrCompileConfig.h"
+#include "CJobSystem.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+//! Instance slots processed by one job, a multiple of the SIMD width.
+const uint32_t kSlotsPerJob = 4096u;
+
+void* alignedMalloc(const size_t& size)
+{
+#ifdef _IRR_WINDOWS_
+    return _aligned_malloc(size,SIMD_ALIGNMENT);
+#else
+    void* retval = NULL;
+    if (posix_memalign(&retval,SIMD_ALIGNMENT,size))
+        return NULL;
+    return retval;
+#endif
+}
+
+void alignedFree(void* ptr)
+{
+#ifdef _IRR_WINDOWS_
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+//! Four instance matrices multiplied by a matrix shared by all of them, one register per element.
+/** Same order of operations as core::concatenateBFollowedByA. `rows` is the number of rows of `a` (3 for a core::matrix4x3
+and 4 for a core::matrix4), `a` holds the elements of the shared matrix already broadcast, column after column. */
+inline void concatenateSoA(__m128* out, const __m128* a, const uint32_t& rows, const __m128* instance)
+{
+    for (uint32_t c=0; c<4; c++)
+    for (uint32_t r=0; r<rows; r++)
+    {
+        __m128 tmp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[r],instance[c*3+0]),_mm_mul_ps(a[rows+r],instance[c*3+1])),_mm_mul_ps(a[2*rows+r],instance[c*3+2]));
+        if (c==3)
+            tmp = _mm_add_ps(tmp,a[3*rows+r]);
+        out[c*rows+r] = tmp;
+    }
+}
+
+}
+
+const size_t CCPUInstanceCuller::OutputSizePerInstance;
+
+CCPUInstanceCuller::CCPUInstanceCuller() : SlotCount(0), PaddedSlotCount(0), Transforms(NULL)
+{
+}
+
+CCPUInstanceCuller::~CCPUInstanceCuller()
+{
+    if (Transforms)
+        alignedFree(Transforms);
+}
+
+void CCPUInstanceCuller::setLoDs(const float* lodDistances, const size_t& lodCount, const core::aabbox3df& lodInvariantBBox)
+{
+    LoDDistancesSQ.resize(lodCount);
+    for (size_t i=0; i<lodCount; i++)
+        LoDDistancesSQ[i] = lodDistances[i]*lodDistances[i];
+    LoDInvariantBBox = lodInvariantBBox;
+}
+
+void CCPUInstanceCuller::reallocateTransforms(const size_t& newPaddedCount)
+{
+    float* newTransforms = newPaddedCount ? reinterpret_cast<float*>(alignedMalloc(newPaddedCount*12*sizeof(float))):NULL;
+    if (Transforms)
+    {
+        const size_t keep = std::min(newPaddedCount,PaddedSlotCount);
+        for (size_t k=0; k<12; k++)
+            memcpy(newTransforms+k*newPaddedCount,Transforms+k*PaddedSlotCount,keep*sizeof(float));
+        alignedFree(Transforms);
+    }
+    Transforms = newTransforms;
+    PaddedSlotCount = newPaddedCount;
+}
+
+void CCPUInstanceCuller::setSlotCount(const size_t& slotCount)
+{
+    const size_t newPaddedCount = (slotCount+3u)&(~size_t(3u));
+    if (newPaddedCount!=PaddedSlotCount)
+        reallocateTransforms(newPaddedCount);
+
+    //! the padding lanes always stay unused
+    for (size_t i=slotCount; i<std::min(SlotCount,newPaddedCount); i++)
+        SlotStates[i] = 0u;
+    SlotStates.resize(newPaddedCount,0u);
+    SlotLoDs.resize(newPaddedCount);
+    SlotCount = slotCount;
+}
+
+void CCPUInstanceCuller::setInstance(const size_t& slot, const core::matrix4x3& relativeTransform)
+{
+    setInstanceTransform(slot,relativeTransform);
+    SlotStates[slot] = ESS_USED|ESS_VISIBLE;
+}
+
+void CCPUInstanceCuller::setInstanceTransform(const size_t& slot, const core::matrix4x3& relativeTransform)
+{
+    const float* in = relativeTransform.pointer();
+    for (size_t k=0; k<12; k++)
+        Transforms[k*PaddedSlotCount+slot] = in[k];
+}
+
+void CCPUInstanceCuller::setInstanceVisible(const size_t& slot, const bool& visible)
+{
+    if (visible)
+        SlotStates[slot] |= ESS_VISIBLE;
+    else
+        SlotStates[slot] &= ~uint32_t(ESS_VISIBLE);
+}
+
+void CCPUInstanceCuller::removeInstance(const size_t& slot)
+{
+    SlotStates[slot] = 0u;
+}
+
+size_t CCPUInstanceCuller::cull(uint8_t** outputPtrs, const size_t& outputStride, const core::matrix4& ProjView, const core::matrix4x3& View,
+                                const core::matrix4x3& World, const uint32_t& threadCount)
+{
+    const size_t lodCount = LoDDistancesSQ.size();
+    if (SlotCount==0||lodCount==0||lodCount>0xffu||outputStride<OutputSizePerInstance)
+        return 0;
+
+    const core::matrix4 ProjViewWorld = core::concatenateBFollowedByA(ProjView,World);
+    const core::matrix4x3 ViewWorld = core::concatenateBFollowedByA(View,World);
+    core::matrix4x3 ViewInverse;
+    View.getInverse(ViewInverse);
+    const core::vector3df eyePos = ViewInverse.getTranslation();
+
+    //! everything shared by all the instances gets broadcast once up front
+    __m128 pvw[16], vw[12], w[12], eye[3], center[3], lodLimits[0xffu];
+    for (size_t k=0; k<16; k++)
+        pvw[k] = _mm_set1_ps(ProjViewWorld.pointer()[k]);
+    for (size_t k=0; k<12; k++)
+    {
+        vw[k] = _mm_set1_ps(ViewWorld.pointer()[k]);
+        w[k] = _mm_set1_ps(World.pointer()[k]);
+    }
+    const core::vector3df boxCenter = LoDInvariantBBox.getCenter();
+    for (size_t k=0; k<3; k++)
+    {
+        eye[k] = _mm_set1_ps((&eyePos.X)[k]);
+        center[k] = _mm_set1_ps((&boxCenter.X)[k]);
+    }
+    for (size_t j=0; j<lodCount; j++)
+        lodLimits[j] = _mm_set1_ps(LoDDistancesSQ[j]);
+    const __m128 boxMin[3] = {_mm_set1_ps(LoDInvariantBBox.MinEdge.X),_mm_set1_ps(LoDInvariantBBox.MinEdge.Y),_mm_set1_ps(LoDInvariantBBox.MinEdge.Z)};
+    const __m128 boxMax[3] = {_mm_set1_ps(LoDInvariantBBox.MaxEdge.X),_mm_set1_ps(LoDInvariantBBox.MaxEdge.Y),_mm_set1_ps(LoDInvariantBBox.MaxEdge.Z)};
+
+    const uint32_t jobCount = (PaddedSlotCount+kSlotsPerJob-1u)/kSlotsPerJob;
+    std::vector<uint32_t> jobLoDCounts(jobCount*lodCount,0u);
+
+    //! first pass picks the LoD of every slot and counts the visible instances of every job
+    CJobSystem::getGlobal()->parallelFor(jobCount,[&](const uint32_t& job)
+    {
+        uint32_t* counts = jobLoDCounts.data()+job*lodCount;
+        const size_t end = std::min(size_t(job+1u)*kSlotsPerJob,PaddedSlotCount);
+        for (size_t base=size_t(job)*kSlotsPerJob; base<end; base+=4)
+        {
+            __m128i used = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(SlotStates.data()+base)),_mm_set1_epi32(ESS_USED|ESS_VISIBLE));
+            if (_mm_movemask_epi8(used)==0)
+            {
+                memset(SlotLoDs.data()+base,0xff,4);
+                continue;
+            }
+
+            __m128 instance[12];
+            for (size_t k=0; k<12; k++)
+                instance[k] = _mm_load_ps(Transforms+k*PaddedSlotCount+base);
+
+            //! LoD from the distance between the eye and the instance's box center in world space
+            __m128 localCenter[3];
+            for (uint32_t r=0; r<3; r++)
+                localCenter[r] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(instance[r],center[0]),_mm_mul_ps(instance[3+r],center[1])),_mm_mul_ps(instance[6+r],center[2])),instance[9+r]);
+            __m128 distanceSQ = _mm_setzero_ps();
+            for (uint32_t r=0; r<3; r++)
+            {
+                __m128 worldPos = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w[r],localCenter[0]),_mm_mul_ps(w[3+r],localCenter[1])),_mm_mul_ps(w[6+r],localCenter[2])),w[9+r]);
+                __m128 diff = _mm_sub_ps(worldPos,eye[r]);
+                distanceSQ = _mm_add_ps(distanceSQ,_mm_mul_ps(diff,diff));
+            }
+            __m128i lod = _mm_setzero_si128();
+            for (size_t j=0; j<lodCount; j++)
+                lod = _mm_sub_epi32(lod,_mm_castps_si128(_mm_cmpge_ps(distanceSQ,lodLimits[j])));
+            __m128i visible = _mm_andnot_si128(_mm_cmpeq_epi32(lod,_mm_set1_epi32(lodCount)),used);
+            if (_mm_movemask_epi8(visible)==0)
+            {
+                memset(SlotLoDs.data()+base,0xff,4);
+                continue;
+            }
+
+            //! same plane tests as core::matrix4::isBoxInsideFrustum, the extreme box corner is picked by min/max instead of by sign
+            __m128 mvp[16];
+            concatenateSoA(mvp,pvw,4,instance);
+            __m128 inside = _mm_castsi128_ps(visible);
+            for (uint32_t p=0; p<3; p++)
+            {
+                __m128 tmp = _mm_setzero_ps();
+                for (uint32_t c=0; c<3; c++)
+                {
+                    __m128 coeff = p<2 ? _mm_add_ps(mvp[c*4+p],mvp[c*4+3]):mvp[c*4+3];
+                    tmp = _mm_add_ps(tmp,_mm_max_ps(_mm_mul_ps(coeff,boxMin[c]),_mm_mul_ps(coeff,boxMax[c])));
+                }
+                __m128 d = p<2 ? _mm_add_ps(mvp[12+p],mvp[15]):mvp[15];
+                inside = _mm_andnot_ps(_mm_cmple_ps(tmp,_mm_sub_ps(_mm_setzero_ps(),d)),inside);
+            }
+            for (uint32_t p=0; p<3; p++)
+            {
+                __m128 tmp = _mm_setzero_ps();
+                for (uint32_t c=0; c<3; c++)
+                {
+                    __m128 coeff = _mm_sub_ps(mvp[c*4+p],mvp[c*4+3]);
+                    tmp = _mm_add_ps(tmp,_mm_min_ps(_mm_mul_ps(coeff,boxMin[c]),_mm_mul_ps(coeff,boxMax[c])));
+                }
+                inside = _mm_andnot_ps(_mm_cmpge_ps(tmp,_mm_sub_ps(mvp[15],mvp[12+p])),inside);
+            }
+
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes),_mm_or_si128(_mm_and_si128(_mm_castps_si128(inside),lod),_mm_andnot_si128(_mm_castps_si128(inside),_mm_set1_epi32(0xff))));
+            for (uint32_t l=0; l<4; l++)
+            {
+                SlotLoDs[base+l] = lanes[l];
+                if (lanes[l]!=0xffu)
+                    counts[lanes[l]]++;
+            }
+        }
+    },threadCount);
+
+    //! exclusive prefix sum over jobs gives every job its own output range in every LoD
+    std::vector<uint32_t> lodTotals(lodCount,0u);
+    size_t total = 0;
+    for (size_t j=0; j<lodCount; j++)
+    {
+        for (uint32_t job=0; job<jobCount; job++)
+        {
+            uint32_t tmp = jobLoDCounts[job*lodCount+j];
+            jobLoDCounts[job*lodCount+j] = lodTotals[j];
+            lodTotals[j] += tmp;
+        }
+        total += lodTotals[j];
+    }
+
+    //! second pass writes the matrices of the visible instances
+    CJobSystem::getGlobal()->parallelFor(jobCount,[&](const uint32_t& job)
+    {
+        uint8_t* outputs[256];
+        for (size_t j=0; j<lodCount; j++)
+            outputs[j] = outputPtrs[j]+size_t(jobLoDCounts[job*lodCount+j])*outputStride;
+
+        const size_t end = std::min(size_t(job+1u)*kSlotsPerJob,PaddedSlotCount);
+        for (size_t base=size_t(job)*kSlotsPerJob; base<end; base+=4)
+        {
+            const uint8_t* lods = SlotLoDs.data()+base;
+            if ((lods[0]&lods[1]&lods[2]&lods[3])==0xffu)
+                continue;
+
+            __m128 instance[12];
+            for (size_t k=0; k<12; k++)
+                instance[k] = _mm_load_ps(Transforms+k*PaddedSlotCount+base);
+
+            __m128 result[28];
+            concatenateSoA(result,pvw,4,instance);
+            concatenateSoA(result+16,vw,3,instance);
+            _MM_TRANSPOSE4_PS(result[0],result[1],result[2],result[3]);
+            _MM_TRANSPOSE4_PS(result[4],result[5],result[6],result[7]);
+            _MM_TRANSPOSE4_PS(result[8],result[9],result[10],result[11]);
+            _MM_TRANSPOSE4_PS(result[12],result[13],result[14],result[15]);
+
+            alignas(16) float worldView[12][4];
+            for (size_t k=0; k<12; k++)
+                _mm_store_ps(worldView[k],result[16+k]);
+
+            for (uint32_t l=0; l<4; l++)
+            {
+                if (lods[l]==0xffu)
+                    continue;
+
+                float* out = reinterpret_cast<float*>(outputs[lods[l]]);
+                //! after the transposes result[c*4+l] holds column c of lane l's WorldViewProj
+                for (uint32_t c=0; c<4; c++)
+                    _mm_storeu_ps(out+c*4,result[c*4+l]);
+                for (uint32_t k=0; k<12; k++)
+                    out[16+k] = worldView[k][l];
+                outputs[lods[l]] += outputStride;
+            }
+        }
+    },threadCount);
+
+    for (size_t j=0; j<lodCount; j++)
+        outputPtrs[j] += size_t(lodTotals[j])*outputStride;
+
+    return total;
+}
+
+} // end namespace scene
+} // end namespace irr
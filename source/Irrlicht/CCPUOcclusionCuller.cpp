@@ -0,0 +1,554 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CCPUOcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <emmintrin.h>
+
+#include "IMeshBuffer.h"
+#include "CJobSystem.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+//! Rows of the depth buffer rasterized by one job.
+const uint32_t kRowsPerBand = 8u;
+//! Pixels across the tiles of a band, triangles hidden in all the tiles they overlap are skipped.
+const int32_t kTileWidth = 32;
+//! Boxes tested by one job of testBoxes().
+const size_t kBoxesPerJob = 256u;
+
+//! Clip space outcodes, a triangle with all corners outside of the same plane is not rasterized.
+enum E_OUTCODE
+{
+    EO_LEFT = 0x1u,
+    EO_RIGHT = 0x2u,
+    EO_BOTTOM = 0x4u,
+    EO_TOP = 0x8u,
+    EO_NEAR = 0x10u
+};
+
+inline uint32_t outcode(const float* clip, const float& nearValue)
+{
+    uint32_t retval = 0u;
+    if (clip[0]<-clip[2])
+        retval |= EO_LEFT;
+    if (clip[0]>clip[2])
+        retval |= EO_RIGHT;
+    if (clip[1]<-clip[2])
+        retval |= EO_BOTTOM;
+    if (clip[1]>clip[2])
+        retval |= EO_TOP;
+    if (clip[2]<nearValue)
+        retval |= EO_NEAR;
+    return retval;
+}
+
+//! x, y and w of a point in clip space, w is the view depth
+inline void transformToClip(float* out, const core::matrix4& m, const float& x, const float& y, const float& z)
+{
+    const float* e = m.pointer();
+    out[0] = e[0]*x+e[4]*y+e[8]*z+e[12];
+    out[1] = e[1]*x+e[5]*y+e[9]*z+e[13];
+    out[2] = e[3]*x+e[7]*y+e[11]*z+e[15];
+}
+
+}
+
+const uint32_t CCPUOcclusionCuller::InvalidOccluder;
+
+CCPUOcclusionCuller::CCPUOcclusionCuller(const core::dimension2d<uint32_t>& resolution) : Resolution(resolution), OccluderCount(0), Pitch(0), NearValue(0.f), HasDepth(false)
+{
+}
+
+CCPUOcclusionCuller::~CCPUOcclusionCuller()
+{
+}
+
+void CCPUOcclusionCuller::setResolution(const core::dimension2d<uint32_t>& resolution)
+{
+    Resolution = resolution;
+    HasDepth = false;
+}
+
+uint32_t CCPUOcclusionCuller::addOccluder(const core::vectorSIMDf* positions, const uint32_t& vertexCount, const uint32_t* indices, const uint32_t& indexCount,
+                                          const core::matrix4x3& transform)
+{
+    if (!positions||!indices||indexCount<3u)
+        return InvalidOccluder;
+    for (uint32_t i=0; i<indexCount; i++)
+    {
+        if (indices[i]>=vertexCount)
+            return InvalidOccluder;
+    }
+
+    uint32_t id = 0u;
+    while (id<Occluders.size()&&Occluders[id].used)
+        id++;
+    if (id==Occluders.size())
+        Occluders.push_back(SOccluder());
+
+    SOccluder& occluder = Occluders[id];
+    occluder.used = true;
+    occluder.positions.assign(positions,positions+vertexCount);
+    occluder.indices.assign(indices,indices+indexCount-indexCount%3u);
+    occluder.transform = transform;
+    OccluderCount++;
+    return id;
+}
+
+uint32_t CCPUOcclusionCuller::addOccluder(const ICPUMeshBuffer* meshbuffer, const core::matrix4x3& transform)
+{
+    if (!meshbuffer||!meshbuffer->getMeshDataAndFormat()||!meshbuffer->getMeshDataAndFormat()->getMappedBuffer(meshbuffer->getPositionAttributeIx()))
+        return InvalidOccluder;
+
+    //! 32bit indices of whatever is drawn, 0,1,2,3,... if nothing's mapped
+    const size_t idxCount = meshbuffer->getIndexCount();
+    std::vector<uint32_t> drawn(idxCount);
+    if (!meshbuffer->getIndices())
+        std::iota(drawn.begin(),drawn.end(),0u);
+    else if (meshbuffer->getIndexType()==video::EIT_16BIT)
+        std::copy((const uint16_t*)meshbuffer->getIndices(),(const uint16_t*)meshbuffer->getIndices()+idxCount,drawn.begin());
+    else if (meshbuffer->getIndexType()==video::EIT_32BIT)
+        std::copy((const uint32_t*)meshbuffer->getIndices(),(const uint32_t*)meshbuffer->getIndices()+idxCount,drawn.begin());
+    else
+        return InvalidOccluder;
+
+    //! occluders are double sided, so the winding of strips and fans does not matter
+    std::vector<uint32_t> triangles;
+    switch (meshbuffer->getPrimitiveType())
+    {
+        case EPT_TRIANGLES:
+            triangles.swap(drawn);
+            break;
+        case EPT_TRIANGLE_STRIP:
+            for (size_t i=2; i<idxCount; i++)
+            {
+                const uint32_t triangle[3] = {drawn[i-2],drawn[i-1],drawn[i]};
+                triangles.insert(triangles.end(),triangle,triangle+3);
+            }
+            break;
+        case EPT_TRIANGLE_FAN:
+            for (size_t i=2; i<idxCount; i++)
+            {
+                const uint32_t triangle[3] = {drawn[0],drawn[i-1],drawn[i]};
+                triangles.insert(triangles.end(),triangle,triangle+3);
+            }
+            break;
+        default:
+            return InvalidOccluder;
+    }
+    if (triangles.size()<3u)
+        return InvalidOccluder;
+
+    //! getAttribute() applies the base vertex, same as the indices do when drawing
+    const size_t vertexCount = *std::max_element(triangles.begin(),triangles.end())+1u;
+    std::vector<core::vectorSIMDf> positions(vertexCount);
+    for (size_t i=0; i<vertexCount; i++)
+        meshbuffer->getAttribute(positions[i],meshbuffer->getPositionAttributeIx(),i);
+
+    return addOccluder(positions.data(),uint32_t(vertexCount),triangles.data(),uint32_t(triangles.size()),transform);
+}
+
+void CCPUOcclusionCuller::setOccluderTransform(const uint32_t& id, const core::matrix4x3& transform)
+{
+    if (id<Occluders.size())
+        Occluders[id].transform = transform;
+}
+
+void CCPUOcclusionCuller::removeOccluder(const uint32_t& id)
+{
+    if (id>=Occluders.size()||!Occluders[id].used)
+        return;
+
+    Occluders[id] = SOccluder();
+    OccluderCount--;
+}
+
+void CCPUOcclusionCuller::setupTriangle(const float (*clip)[3])
+{
+    double sx[3], sy[3], depth[3];
+    for (uint32_t k=0; k<3; k++)
+    {
+        depth[k] = 1.0/double(clip[k][2]);
+        sx[k] = (double(clip[k][0])*depth[k]*0.5+0.5)*double(Resolution.Width);
+        sy[k] = (0.5-double(clip[k][1])*depth[k]*0.5)*double(Resolution.Height);
+    }
+
+    STriangle triangle;
+    //! pixels with their centers inside the bounding box, triangles between pixel centers cover nothing
+    triangle.minX = std::max(int32_t(std::ceil(std::min(sx[0],std::min(sx[1],sx[2]))-0.5)),0);
+    triangle.maxX = std::min(int32_t(std::floor(std::max(sx[0],std::max(sx[1],sx[2]))-0.5)),int32_t(Resolution.Width)-1);
+    triangle.minY = std::max(int32_t(std::ceil(std::min(sy[0],std::min(sy[1],sy[2]))-0.5)),0);
+    triangle.maxY = std::min(int32_t(std::floor(std::max(sy[0],std::max(sy[1],sy[2]))-0.5)),int32_t(Resolution.Height)-1);
+    if (triangle.minX>triangle.maxX||triangle.minY>triangle.maxY)
+        return;
+
+    const double area = (sx[1]-sx[0])*(sy[2]-sy[0])-(sx[2]-sx[0])*(sy[1]-sy[0]);
+    if (std::abs(area)<1e-9)
+        return;
+
+    //! everything relative to the center of the first pixel of the bounding box, in doubles, so the constants keep their precision for triangles reaching far off screen
+    const double originX = double(triangle.minX)+0.5;
+    const double originY = double(triangle.minY)+0.5;
+    const double inside = area>0.0 ? 1.0:-1.0;
+    for (uint32_t k=0; k<3; k++)
+    {
+        const uint32_t l = (k+1u)%3u;
+        const double a = (sy[k]-sy[l])*inside;
+        const double b = (sx[l]-sx[k])*inside;
+        triangle.edge[k][0] = float(a);
+        triangle.edge[k][1] = float(b);
+        triangle.edge[k][2] = float(a*(originX-sx[k])+b*(originY-sy[k]));
+        triangle.crossing[k][0] = a!=0.0 ? float(-b/a):0.f;
+        triangle.crossing[k][1] = a!=0.0 ? float(-double(triangle.edge[k][2])/a):0.f;
+    }
+
+    const double depthX = ((depth[1]-depth[0])*(sy[2]-sy[0])-(depth[2]-depth[0])*(sy[1]-sy[0]))/area;
+    const double depthY = ((sx[1]-sx[0])*(depth[2]-depth[0])-(sx[2]-sx[0])*(depth[1]-depth[0]))/area;
+    triangle.depth[0] = float(depthX);
+    triangle.depth[1] = float(depthY);
+    //! the plane at a pixel's center moved by half a pixel in the direction it gets farther in
+    triangle.depth[2] = float(depth[0]+depthX*(originX-sx[0])+depthY*(originY-sy[0])-0.5*(std::abs(depthX)+std::abs(depthY)));
+    triangle.farthest = float(std::min(depth[0],std::min(depth[1],depth[2])));
+    triangle.nearest = float(std::max(depth[0],std::max(depth[1],depth[2])));
+
+    Triangles.push_back(triangle);
+}
+
+void CCPUOcclusionCuller::rasterize(const core::matrix4& projView, const float& nearValue, const uint32_t& threadCount)
+{
+    ProjView = projView;
+    NearValue = nearValue;
+    Triangles.clear();
+    HasDepth = OccluderCount&&Resolution.Width&&Resolution.Height;
+    if (!HasDepth)
+        return;
+
+    //! transform every occluder, those entirely outside of the frustum are dropped and the others get set up nearest first,
+    //! so the triangles hidden behind what got rasterized already can be skipped
+    std::vector<float> clipVertices;
+    std::vector<uint32_t> outcodeVertices;
+    std::vector<size_t> firstVertex(Occluders.size());
+    std::vector<std::pair<float,uint32_t> > nearestOccluders;
+    for (size_t i=0; i<Occluders.size(); i++)
+    {
+        const SOccluder& occluder = Occluders[i];
+        if (!occluder.used)
+            continue;
+
+        const core::matrix4 projViewWorld = core::concatenateBFollowedByA(ProjView,occluder.transform);
+        firstVertex[i] = outcodeVertices.size();
+        clipVertices.resize((firstVertex[i]+occluder.positions.size())*3u);
+        outcodeVertices.resize(firstVertex[i]+occluder.positions.size());
+        float* clip = clipVertices.data()+firstVertex[i]*3u;
+        uint32_t allOutside = ~0u;
+        float nearest = FLT_MAX;
+        for (size_t v=0; v<occluder.positions.size(); v++)
+        {
+            const core::vectorSIMDf& pos = occluder.positions[v];
+            transformToClip(clip+v*3u,projViewWorld,pos.X,pos.Y,pos.Z);
+            outcodeVertices[firstVertex[i]+v] = outcode(clip+v*3u,NearValue);
+            allOutside &= outcodeVertices[firstVertex[i]+v];
+            nearest = std::min(nearest,clip[v*3u+2u]);
+        }
+        if (!allOutside)
+            nearestOccluders.push_back(std::pair<float,uint32_t>(nearest,uint32_t(i)));
+    }
+    std::sort(nearestOccluders.begin(),nearestOccluders.end());
+
+    for (size_t i=0; i<nearestOccluders.size(); i++)
+    {
+        const SOccluder& occluder = Occluders[nearestOccluders[i].second];
+        const float* clip = clipVertices.data()+firstVertex[nearestOccluders[i].second]*3u;
+        const uint32_t* outcodes = outcodeVertices.data()+firstVertex[nearestOccluders[i].second];
+        for (size_t t=0; t<occluder.indices.size(); t+=3u)
+        {
+            const uint32_t* ix = occluder.indices.data()+t;
+            if (outcodes[ix[0]]&outcodes[ix[1]]&outcodes[ix[2]])
+                continue;
+
+            float corners[3][3];
+            for (uint32_t k=0; k<3; k++)
+                memcpy(corners[k],clip+ix[k]*3u,sizeof(corners[k]));
+            if (((outcodes[ix[0]]|outcodes[ix[1]]|outcodes[ix[2]])&EO_NEAR)==0u)
+            {
+                setupTriangle(corners);
+                continue;
+            }
+
+            //! the part in front of the near plane is a triangle or a quad
+            float polygon[4][3];
+            uint32_t polygonSize = 0u;
+            for (uint32_t k=0; k<3; k++)
+            {
+                const float* a = corners[k];
+                const float* b = corners[(k+1u)%3u];
+                if (a[2]>=NearValue)
+                    memcpy(polygon[polygonSize++],a,sizeof(polygon[0]));
+                if ((a[2]>=NearValue)!=(b[2]>=NearValue))
+                {
+                    const float f = (NearValue-a[2])/(b[2]-a[2]);
+                    for (uint32_t c=0; c<3; c++)
+                        polygon[polygonSize][c] = a[c]+(b[c]-a[c])*f;
+                    polygon[polygonSize++][2] = NearValue;
+                }
+            }
+            for (uint32_t k=2; k<polygonSize; k++)
+            {
+                const float fan[3][3] = {{polygon[0][0],polygon[0][1],polygon[0][2]},{polygon[k-1][0],polygon[k-1][1],polygon[k-1][2]},{polygon[k][0],polygon[k][1],polygon[k][2]}};
+                setupTriangle(fan);
+            }
+        }
+    }
+
+    const uint32_t bandCount = (Resolution.Height+kRowsPerBand-1u)/kRowsPerBand;
+    Bins.resize(bandCount);
+    for (uint32_t band=0; band<bandCount; band++)
+        Bins[band].clear();
+    for (size_t t=0; t<Triangles.size(); t++)
+    {
+        for (int32_t band=Triangles[t].minY/int32_t(kRowsPerBand); band<=Triangles[t].maxY/int32_t(kRowsPerBand); band++)
+            Bins[band].push_back(uint32_t(t));
+    }
+
+    Pitch = (Resolution.Width+3u)&(~3u);
+    PaddedDepth.resize(size_t(Pitch)*Resolution.Height);
+
+    //! every band gets cleared and rasterized by one job, bands share no pixels
+    CJobSystem::getGlobal()->parallelFor(bandCount,[&](const uint32_t& band)
+    {
+        const int32_t bandMinY = int32_t(band*kRowsPerBand);
+        const int32_t bandMaxY = std::min(bandMinY+int32_t(kRowsPerBand),int32_t(Resolution.Height))-1;
+        memset(PaddedDepth.data()+size_t(bandMinY)*Pitch,0,size_t(bandMaxY-bandMinY+1)*Pitch*sizeof(float));
+
+        //! farthest depth in every tile of the band, recomputed when needed after a triangle got drawn into it
+        const int32_t tileCount = (int32_t(Resolution.Width)+kTileWidth-1)/kTileWidth;
+        std::vector<float> tileFarthest(tileCount,0.f);
+        std::vector<uint8_t> tileDirty(tileCount,0u);
+
+        const __m128 laneOffsets = _mm_setr_ps(0.f,1.f,2.f,3.f);
+        const __m128 four = _mm_set1_ps(4.f);
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t i=0; i<Bins[band].size(); i++)
+        {
+            const STriangle& triangle = Triangles[Bins[band][i]];
+            bool hidden = true;
+            for (int32_t tile=triangle.minX/kTileWidth; tile<=triangle.maxX/kTileWidth&&hidden; tile++)
+            {
+                if (tileDirty[tile])
+                {
+                    const int32_t tileEndX = std::min((tile+1)*kTileWidth,int32_t(Resolution.Width));
+                    float farthest = FLT_MAX;
+                    for (int32_t y=bandMinY; y<=bandMaxY; y++)
+                    for (int32_t x=tile*kTileWidth; x<tileEndX; x++)
+                        farthest = std::min(farthest,PaddedDepth[size_t(y)*Pitch+x]);
+                    tileFarthest[tile] = farthest;
+                    tileDirty[tile] = 0u;
+                }
+                hidden = triangle.nearest<tileFarthest[tile];
+            }
+            if (hidden)
+                continue;
+            for (int32_t tile=triangle.minX/kTileWidth; tile<=triangle.maxX/kTileWidth; tile++)
+                tileDirty[tile] = 1u;
+
+            const __m128 edgeX[3] = {_mm_set1_ps(triangle.edge[0][0]),_mm_set1_ps(triangle.edge[1][0]),_mm_set1_ps(triangle.edge[2][0])};
+            const __m128 depthX = _mm_set1_ps(triangle.depth[0]);
+            const __m128 farthest = _mm_set1_ps(triangle.farthest);
+
+            const int32_t minY = std::max(triangle.minY,bandMinY);
+            const int32_t maxY = std::min(triangle.maxY,bandMaxY);
+            for (int32_t y=minY; y<=maxY; y++)
+            {
+                const float dy = float(y-triangle.minY);
+                float rowEdge[3];
+                //! the span of the row between the edges, widened by a pixel so the per pixel test alone decides at its ends
+                float spanMin = 0.f, spanMax = float(triangle.maxX-triangle.minX);
+                for (uint32_t k=0; k<3; k++)
+                {
+                    rowEdge[k] = triangle.edge[k][1]*dy+triangle.edge[k][2];
+                    const float crossing = triangle.crossing[k][0]*dy+triangle.crossing[k][1];
+                    if (triangle.edge[k][0]>0.f)
+                        spanMin = std::max(spanMin,crossing-1.f);
+                    else if (triangle.edge[k][0]<0.f)
+                        spanMax = std::min(spanMax,crossing+1.f);
+                    else if (rowEdge[k]<0.f)
+                        spanMax = -1.f;
+                }
+                if (spanMin>spanMax)
+                    continue;
+
+                const __m128 edgeRow[3] = {_mm_set1_ps(rowEdge[0]),_mm_set1_ps(rowEdge[1]),_mm_set1_ps(rowEdge[2])};
+                const __m128 depthRow = _mm_set1_ps(triangle.depth[1]*dy+triangle.depth[2]);
+                float* row = PaddedDepth.data()+size_t(y)*Pitch;
+                const int32_t startX = (triangle.minX+int32_t(spanMin))&(~3);
+                const int32_t endX = triangle.minX+int32_t(spanMax);
+                __m128 dx = _mm_add_ps(_mm_set1_ps(float(startX-triangle.minX)),laneOffsets);
+                for (int32_t x=startX; x<=endX; x+=4, dx=_mm_add_ps(dx,four))
+                {
+                    __m128 covered = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[0],dx),edgeRow[0]),zero);
+                    covered = _mm_and_ps(covered,_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[1],dx),edgeRow[1]),zero));
+                    covered = _mm_and_ps(covered,_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[2],dx),edgeRow[2]),zero));
+                    if (_mm_movemask_ps(covered)==0)
+                        continue;
+
+                    //! nearer (larger reciprocal depth) wins, uncovered lanes are 0 which never does
+                    const __m128 depth = _mm_max_ps(_mm_add_ps(_mm_mul_ps(depthX,dx),depthRow),farthest);
+                    _mm_storeu_ps(row+x,_mm_max_ps(_mm_loadu_ps(row+x),_mm_and_ps(covered,depth)));
+                }
+            }
+        }
+    },threadCount);
+
+    buildHierarchy();
+}
+
+void CCPUOcclusionCuller::buildHierarchy()
+{
+    uint32_t levelCount = 1u;
+    for (uint32_t w=Resolution.Width, h=Resolution.Height; w>1u||h>1u; w=(w+1u)/2u, h=(h+1u)/2u)
+        levelCount++;
+    Levels.resize(levelCount);
+
+    SLevel& base = Levels[0];
+    base.width = Resolution.Width;
+    base.height = Resolution.Height;
+    base.farthest.resize(size_t(base.width)*base.height);
+    for (uint32_t y=0; y<base.height; y++)
+        memcpy(base.farthest.data()+size_t(y)*base.width,PaddedDepth.data()+size_t(y)*Pitch,base.width*sizeof(float));
+    base.nearest = base.farthest;
+
+    for (uint32_t l=1u; l<levelCount; l++)
+    {
+        const SLevel& child = Levels[l-1u];
+        SLevel& level = Levels[l];
+        level.width = (child.width+1u)/2u;
+        level.height = (child.height+1u)/2u;
+        level.farthest.resize(size_t(level.width)*level.height);
+        level.nearest.resize(level.farthest.size());
+        for (uint32_t y=0; y<level.height; y++)
+        for (uint32_t x=0; x<level.width; x++)
+        {
+            //! odd sizes leave the last texels with fewer children
+            const uint32_t childMaxX = std::min(x*2u+1u,child.width-1u);
+            const uint32_t childMaxY = std::min(y*2u+1u,child.height-1u);
+            float farthest = FLT_MAX;
+            float nearest = 0.f;
+            for (uint32_t cy=y*2u; cy<=childMaxY; cy++)
+            for (uint32_t cx=x*2u; cx<=childMaxX; cx++)
+            {
+                farthest = std::min(farthest,child.farthest[size_t(cy)*child.width+cx]);
+                nearest = std::max(nearest,child.nearest[size_t(cy)*child.width+cx]);
+            }
+            level.farthest[size_t(y)*level.width+x] = farthest;
+            level.nearest[size_t(y)*level.width+x] = nearest;
+        }
+    }
+}
+
+bool CCPUOcclusionCuller::isRectOccluded(const uint32_t& level, const int32_t& x, const int32_t& y, const int32_t& minX, const int32_t& maxX,
+                                         const int32_t& minY, const int32_t& maxY, const float& boxNearest) const
+{
+    const SLevel& texels = Levels[level];
+    const size_t texel = size_t(y)*texels.width+x;
+    if (boxNearest<texels.farthest[texel])
+        return true;
+    //! nothing to gain from looking closer when the box is in front of everything in the texel
+    if (level==0u||boxNearest>=texels.nearest[texel])
+        return false;
+
+    const uint32_t childLevel = level-1u;
+    const int32_t childMinX = std::max(x*2,minX>>childLevel);
+    const int32_t childMaxX = std::min(x*2+1,maxX>>childLevel);
+    const int32_t childMinY = std::max(y*2,minY>>childLevel);
+    const int32_t childMaxY = std::min(y*2+1,maxY>>childLevel);
+    for (int32_t cy=childMinY; cy<=childMaxY; cy++)
+    for (int32_t cx=childMinX; cx<=childMaxX; cx++)
+    {
+        if (!isRectOccluded(childLevel,cx,cy,minX,maxX,minY,maxY,boxNearest))
+            return false;
+    }
+    return true;
+}
+
+bool CCPUOcclusionCuller::isBoxOccludedProjected(const core::aabbox3df& box, const core::matrix4& ProjViewWorld) const
+{
+    float minSX = FLT_MAX, maxSX = -FLT_MAX, minSY = FLT_MAX, maxSY = -FLT_MAX;
+    float boxNearest = 0.f;
+    for (uint32_t k=0; k<8; k++)
+    {
+        float clip[3];
+        transformToClip(clip,ProjViewWorld,(k&1u) ? box.MaxEdge.X:box.MinEdge.X,(k&2u) ? box.MaxEdge.Y:box.MinEdge.Y,(k&4u) ? box.MaxEdge.Z:box.MinEdge.Z);
+        if (clip[2]<NearValue)
+            return false;
+
+        const float depth = 1.f/clip[2];
+        const float sx = (clip[0]*depth*0.5f+0.5f)*float(Resolution.Width);
+        const float sy = (0.5f-clip[1]*depth*0.5f)*float(Resolution.Height);
+        minSX = std::min(minSX,sx);
+        maxSX = std::max(maxSX,sx);
+        minSY = std::min(minSY,sy);
+        maxSY = std::max(maxSY,sy);
+        boxNearest = std::max(boxNearest,depth);
+    }
+    if (maxSX<0.f||maxSY<0.f||minSX>=float(Resolution.Width)||minSY>=float(Resolution.Height))
+        return false;
+
+    //! every pixel the screen rectangle of the box touches
+    const int32_t minX = std::max(int32_t(minSX),0);
+    const int32_t maxX = std::min(int32_t(maxSX),int32_t(Resolution.Width)-1);
+    const int32_t minY = std::max(int32_t(minSY),0);
+    const int32_t maxY = std::min(int32_t(maxSY),int32_t(Resolution.Height)-1);
+
+    //! start at the finest level where the rectangle touches at most 2x2 texels
+    uint32_t level = 0u;
+    while ((maxX>>level)-(minX>>level)>1||(maxY>>level)-(minY>>level)>1)
+        level++;
+    for (int32_t y=minY>>level; y<=(maxY>>level); y++)
+    for (int32_t x=minX>>level; x<=(maxX>>level); x++)
+    {
+        if (!isRectOccluded(level,x,y,minX,maxX,minY,maxY,boxNearest))
+            return false;
+    }
+    return true;
+}
+
+bool CCPUOcclusionCuller::isBoxOccluded(const core::aabbox3df& box, const core::matrix4x3& transform) const
+{
+    if (!HasDepth)
+        return false;
+
+    return isBoxOccludedProjected(box,core::concatenateBFollowedByA(ProjView,transform));
+}
+
+void CCPUOcclusionCuller::testBoxes(uint8_t* outOccluded, const core::aabbox3df* boxes, const core::matrix4x3* transforms, const size_t& count, const uint32_t& threadCount) const
+{
+    if (!HasDepth)
+    {
+        memset(outOccluded,0,count);
+        return;
+    }
+
+    const uint32_t jobCount = uint32_t((count+kBoxesPerJob-1u)/kBoxesPerJob);
+    CJobSystem::getGlobal()->parallelFor(jobCount,[&](const uint32_t& job)
+    {
+        const size_t end = std::min(size_t(job+1u)*kBoxesPerJob,count);
+        for (size_t i=size_t(job)*kBoxesPerJob; i<end; i++)
+            outOccluded[i] = isBoxOccludedProjected(boxes[i],transforms ? core::concatenateBFollowedByA(ProjView,transforms[i]):ProjView) ? 1u:0u;
+    },threadCount);
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,165 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CCPUSkinner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <emmintrin.h>
+
+#include "CJobSystem.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+    //! bone IDs are bytes, so with a table of all 256 possible bones no ID needs a range check
+    const size_t kBoneTableSize = 256u;
+    //! 4 position columns and 3 normal columns, each padded to 4 floats
+    const size_t kFloatsPerBone = 7u*4u;
+    const uint32_t kVerticesPerJob = 0x1000u;
+
+    struct SAttributeStream
+    {
+        const uint8_t* data;
+        size_t stride;
+        E_COMPONENT_TYPE type;
+        E_COMPONENTS_PER_ATTRIBUTE components;
+    };
+
+    //! false if the attribute is missing or does not have `vertexEnd` vertices
+    bool getAttributeStream(SAttributeStream& stream, const SCPUSkinMeshBuffer* meshbuffer, const E_VERTEX_ATTRIBUTE_ID& attrId, const size_t& vertexEnd)
+    {
+        const IMeshDataFormatDesc<core::ICPUBuffer>* desc = meshbuffer->getMeshDataAndFormat();
+        stream.data = meshbuffer->getAttribPointer(attrId);
+        if (!stream.data)
+            return false;
+
+        stream.stride = desc->getMappedBufferStride(attrId);
+        stream.type = desc->getAttribType(attrId);
+        stream.components = desc->getAttribComponentCount(attrId);
+        const core::ICPUBuffer* buffer = desc->getMappedBuffer(attrId);
+        const uint8_t* bufferEnd = reinterpret_cast<const uint8_t*>(buffer->getPointer())+buffer->getSize();
+        return vertexEnd==0u || stream.data+(vertexEnd-1u)*stream.stride+vertexAttrSize[stream.type][stream.components]<=bufferEnd;
+    }
+
+    inline __m128 loadVector(const SAttributeStream& stream, const size_t& vertex)
+    {
+        const uint8_t* src = stream.data+vertex*stream.stride;
+        if (stream.type==ECT_FLOAT&&stream.components>=ECPA_THREE)
+        {
+            float tmp[4];
+            memcpy(tmp,src,12);
+            tmp[3] = 0.f;
+            return _mm_loadu_ps(tmp);
+        }
+
+        core::vectorSIMDf out(0.f);
+        ICPUMeshBuffer::getAttribute(out,src,stream.type,stream.components);
+        out.w = 0.f;
+        return out.getAsRegister();
+    }
+
+    inline void storeVector(float* out, const __m128& v)
+    {
+        float tmp[4];
+        _mm_storeu_ps(tmp,v);
+        memcpy(out,tmp,12);
+    }
+}
+
+bool CCPUSkinner::skin(float* outPositions, float* outNormals, const size_t& outputStride, const SCPUSkinMeshBuffer* meshbuffer,
+                        const ISkinningStateManager::FinalBoneData* boneData, const size_t& boneCount,
+                        const uint32_t& firstVertex, const uint32_t& vertexCount, const uint32_t& threadCount)
+{
+    if (!outPositions||!meshbuffer||!meshbuffer->getMeshDataAndFormat()||(boneCount&&!boneData)||outputStride<3u*sizeof(float))
+        return false;
+
+    const size_t vertexEnd = size_t(firstVertex)+vertexCount;
+    SAttributeStream positions,normals,boneIDs,boneWeights;
+    if (!getAttributeStream(positions,meshbuffer,meshbuffer->getPositionAttributeIx(),vertexEnd)||
+        !getAttributeStream(boneIDs,meshbuffer,EVAI_ATTR5,vertexEnd)||
+        !getAttributeStream(boneWeights,meshbuffer,EVAI_ATTR6,vertexEnd))
+        return false;
+    if (outNormals&&!getAttributeStream(normals,meshbuffer,EVAI_ATTR3,vertexEnd))
+        return false;
+    if (boneIDs.type!=ECT_INTEGER_UNSIGNED_BYTE||boneIDs.components!=ECPA_FOUR||
+        boneWeights.type!=ECT_NORMALIZED_UNSIGNED_INT_2_10_10_10_REV||boneWeights.components!=ECPA_FOUR)
+        return false;
+    if (!vertexCount)
+        return true;
+
+    //! columns of the skinning and normal matrices of every bone, the bones past boneCount stay zero
+    std::vector<float> boneTable(kBoneTableSize*kFloatsPerBone,0.f);
+    for (size_t i=0; i<std::min(boneCount,kBoneTableSize); i++)
+    {
+        float* bone = boneTable.data()+i*kFloatsPerBone;
+        for (size_t k=0; k<4; k++)
+            memcpy(bone+k*4u,&boneData[i].SkinningTransform.getColumn(k).X,12);
+        for (size_t k=0; k<3; k++)
+            memcpy(bone+16u+k*4u,boneData[i].SkinningNormalMatrix+k*3u,12);
+    }
+
+    const uint32_t jobCount = (vertexCount+kVerticesPerJob-1u)/kVerticesPerJob;
+    CJobSystem::getGlobal()->parallelFor(jobCount,[&](const uint32_t& job)
+    {
+        const __m128 weightScale = _mm_set1_ps(1.f/1023.f);
+        const __m128i weightMask = _mm_set1_epi32(0x3ff);
+        const size_t jobStart = size_t(job)*kVerticesPerJob;
+        const size_t jobEnd = std::min(jobStart+kVerticesPerJob,size_t(vertexCount));
+        for (size_t i=jobStart; i<jobEnd; i++)
+        {
+            const size_t vertex = firstVertex+i;
+            const uint8_t* ids = boneIDs.data+vertex*boneIDs.stride;
+            uint32_t packedWeights;
+            memcpy(&packedWeights,boneWeights.data+vertex*boneWeights.stride,4);
+            const uint32_t influences = (packedWeights>>30u)+1u;
+
+            //! same weights as the shaders see, the 4th one is whatever the first three leave
+            const __m128i quantized = _mm_and_si128(_mm_setr_epi32(packedWeights,packedWeights>>10u,packedWeights>>20u,0),weightMask);
+            float weights[4];
+            _mm_storeu_ps(weights,_mm_mul_ps(_mm_cvtepi32_ps(quantized),weightScale));
+            weights[3] = 1.f-weights[0]-weights[1]-weights[2];
+
+            //! blend the matrices first, then transform the vertex once
+            __m128 blended[7];
+            {
+                const __m128 weight = _mm_set1_ps(weights[0]);
+                const float* bone = boneTable.data()+size_t(ids[0])*kFloatsPerBone;
+                for (size_t k=0; k<7; k++)
+                    blended[k] = _mm_mul_ps(_mm_loadu_ps(bone+k*4u),weight);
+            }
+            for (uint32_t j=1; j<influences; j++)
+            {
+                const __m128 weight = _mm_set1_ps(weights[j]);
+                const float* bone = boneTable.data()+size_t(ids[j])*kFloatsPerBone;
+                for (size_t k=0; k<7; k++)
+                    blended[k] = _mm_add_ps(blended[k],_mm_mul_ps(_mm_loadu_ps(bone+k*4u),weight));
+            }
+
+            const __m128 pos = loadVector(positions,vertex);
+            __m128 skinned = _mm_add_ps(blended[3],_mm_mul_ps(blended[0],_mm_shuffle_ps(pos,pos,_MM_SHUFFLE(0,0,0,0))));
+            skinned = _mm_add_ps(skinned,_mm_mul_ps(blended[1],_mm_shuffle_ps(pos,pos,_MM_SHUFFLE(1,1,1,1))));
+            skinned = _mm_add_ps(skinned,_mm_mul_ps(blended[2],_mm_shuffle_ps(pos,pos,_MM_SHUFFLE(2,2,2,2))));
+            storeVector(reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(outPositions)+i*outputStride),skinned);
+
+            if (outNormals)
+            {
+                const __m128 normal = loadVector(normals,vertex);
+                __m128 skinnedNormal = _mm_mul_ps(blended[4],_mm_shuffle_ps(normal,normal,_MM_SHUFFLE(0,0,0,0)));
+                skinnedNormal = _mm_add_ps(skinnedNormal,_mm_mul_ps(blended[5],_mm_shuffle_ps(normal,normal,_MM_SHUFFLE(1,1,1,1))));
+                skinnedNormal = _mm_add_ps(skinnedNormal,_mm_mul_ps(blended[6],_mm_shuffle_ps(normal,normal,_MM_SHUFFLE(2,2,2,2))));
+                storeVector(reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(outNormals)+i*outputStride),skinnedNormal);
+            }
+        }
+    },threadCount);
+    return true;
+}
+
+} // end namespace scene
+} // end namespace irr
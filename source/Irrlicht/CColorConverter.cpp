@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CColorConverter.h"
+#include "CColorConverterSIMD.h"
 #include "SColor.h"
 #include "os.h"
 #include "irrString.h"
@@ -313,10 +314,11 @@ void CColorConverter::convert32BitTo32Bit(const int32_t* in, int32_t* out, int32
 
 void CColorConverter::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = CColorConverterSIMD::convert_A1R5G5B5toR8G8B8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[2] = (*sB & 0x7c00) >> 7;
 		dB[1] = (*sB & 0x03e0) >> 2;
@@ -329,10 +331,11 @@ void CColorConverter::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = CColorConverterSIMD::convert_A1R5G5B5toB8G8R8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = (*sB & 0x7c00) >> 7;
 		dB[1] = (*sB & 0x03e0) >> 2;
@@ -345,10 +348,11 @@ void CColorConverter::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A1R5G5B5toA8R8G8B8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -359,19 +363,21 @@ void CColorConverter::convert_A1R5G5B5toA1R5G5B5(const void* sP, int32_t sN, voi
 
 void CColorConverter::convert_A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A1R5G5B5toR5G6B5(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toR5G6B5(*sB++);
 }
 
 void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A8R8G8B8toR8G8B8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -385,10 +391,11 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_A8R8G8B8toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A8R8G8B8toB8G8R8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[0];
@@ -407,19 +414,21 @@ void CColorConverter::convert_A8R8G8B8toA8R8G8B8(const void* sP, int32_t sN, voi
 
 void CColorConverter::convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint32_t* sB = (uint32_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A8R8G8B8toA1R5G5B5(sP, sN, dP);
+	uint32_t* sB = (uint32_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = A8R8G8B8toA1R5G5B5(*sB++);
 }
 
 void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_A8R8G8B8toR5G6B5(sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*4;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[2] >> 3;
 		int32_t g = sB[1] >> 2;
@@ -457,10 +466,11 @@ void CColorConverter::convert_R8G8B8toR8G8B8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t*  sB = (uint8_t* )sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8toA8R8G8B8(sP, sN, dP);
+	uint8_t*  sB = (uint8_t* )sP + done*3;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -471,10 +481,11 @@ void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8toA1R5G5B5(sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*3;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[0] >> 3;
 		int32_t g = sB[1] >> 3;
@@ -489,10 +500,11 @@ void CColorConverter::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t*  sB = (uint8_t* )sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_B8G8R8toA8R8G8B8(sP, sN, dP);
+	uint8_t*  sB = (uint8_t* )sP + done*3;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -503,10 +515,11 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void*
 
 void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t* sB = (uint8_t*)sP;
-	uint8_t* dB = (uint8_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_B8G8R8A8toA8R8G8B8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*4;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -519,12 +532,90 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, voi
 
 }
 
+void CColorConverter::convert_A8R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP)
+{
+	const int32_t done = CColorConverterSIMD::convert_A8R8G8B8toR8G8B8A8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*4;
+
+	for (int32_t x = done; x < sN; ++x)
+	{
+		dB[0] = sB[2];
+		dB[1] = sB[1];
+		dB[2] = sB[0];
+		dB[3] = sB[3];
+
+		sB += 4;
+		dB += 4;
+	}
+}
+
+void CColorConverter::convert_R8G8B8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8A8toA8R8G8B8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*4;
+
+	for (int32_t x = done; x < sN; ++x)
+	{
+		dB[0] = sB[2];
+		dB[1] = sB[1];
+		dB[2] = sB[0];
+		dB[3] = sB[3];
+
+		sB += 4;
+		dB += 4;
+	}
+}
+
+void CColorConverter::convert_R8G8B8A8toR8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8A8toR8G8B8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*4;
+	uint8_t* dB = (uint8_t*)dP + done*3;
+
+	for (int32_t x = done; x < sN; ++x)
+	{
+		// sB[3] is alpha
+		dB[0] = sB[0];
+		dB[1] = sB[1];
+		dB[2] = sB[2];
+
+		sB += 4;
+		dB += 3;
+	}
+}
+
+void CColorConverter::convert_R8G8B8A8toR8G8B8A8(const void* sP, int32_t sN, void* dP)
+{
+	memcpy(dP, sP, sN * 4);
+}
+
+void CColorConverter::convert_R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP)
+{
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8toR8G8B8A8(sP, sN, dP);
+	uint8_t* sB = (uint8_t*)sP + done*3;
+	uint8_t* dB = (uint8_t*)dP + done*4;
+
+	for (int32_t x = done; x < sN; ++x)
+	{
+		dB[0] = sB[0];
+		dB[1] = sB[1];
+		dB[2] = sB[2];
+		dB[3] = 0xff;
+
+		sB += 3;
+		dB += 4;
+	}
+}
+
 void CColorConverter::convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
 {
-	uint8_t * sB = (uint8_t *)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_R8G8B8toR5G6B5(sP, sN, dP);
+	uint8_t * sB = (uint8_t *)sP + done*3;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		int32_t r = sB[0] >> 3;
 		int32_t g = sB[1] >> 2;
@@ -544,10 +635,11 @@ void CColorConverter::convert_R5G6B5toR5G6B5(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = CColorConverterSIMD::convert_R5G6B5toR8G8B8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[0] = (*sB & 0xf800) >> 8;
 		dB[1] = (*sB & 0x07e0) >> 3;
@@ -560,10 +652,11 @@ void CColorConverter::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint8_t * dB = (uint8_t *)dP;
+	const int32_t done = CColorConverterSIMD::convert_R5G6B5toB8G8R8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint8_t * dB = (uint8_t *)dP + done*3;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 	{
 		dB[2] = (*sB & 0xf800) >> 8;
 		dB[1] = (*sB & 0x07e0) >> 3;
@@ -576,19 +669,21 @@ void CColorConverter::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* d
 
 void CColorConverter::convert_R5G6B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint32_t* dB = (uint32_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_R5G6B5toA8R8G8B8(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint32_t* dB = (uint32_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA8R8G8B8(*sB++);
 }
 
 void CColorConverter::convert_R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP)
 {
-	uint16_t* sB = (uint16_t*)sP;
-	uint16_t* dB = (uint16_t*)dP;
+	const int32_t done = CColorConverterSIMD::convert_R5G6B5toA1R5G5B5(sP, sN, dP);
+	uint16_t* sB = (uint16_t*)sP + done;
+	uint16_t* dB = (uint16_t*)dP + done;
 
-	for (int32_t x = 0; x < sN; ++x)
+	for (int32_t x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA1R5G5B5(*sB++);
 }
 
@@ -655,6 +750,9 @@ void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, int32_
 				case ECF_R8G8B8:
 					convert_A8R8G8B8toR8G8B8(sP, sN, dP);
 				break;
+				case ECF_R8G8B8A8:
+					convert_A8R8G8B8toR8G8B8A8(sP, sN, dP);
+				break;
 #ifndef _DEBUG
 				default:
 					break;
@@ -676,6 +774,27 @@ void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, int32_
 				case ECF_R8G8B8:
 					convert_R8G8B8toR8G8B8(sP, sN, dP);
 				break;
+				case ECF_R8G8B8A8:
+					convert_R8G8B8toR8G8B8A8(sP, sN, dP);
+				break;
+#ifndef _DEBUG
+				default:
+					break;
+#endif
+			}
+		break;
+		case ECF_R8G8B8A8:
+			switch (dF)
+			{
+				case ECF_A8R8G8B8:
+					convert_R8G8B8A8toA8R8G8B8(sP, sN, dP);
+				break;
+				case ECF_R8G8B8:
+					convert_R8G8B8A8toR8G8B8(sP, sN, dP);
+				break;
+				case ECF_R8G8B8A8:
+					convert_R8G8B8A8toR8G8B8A8(sP, sN, dP);
+				break;
 #ifndef _DEBUG
 				default:
 					break;
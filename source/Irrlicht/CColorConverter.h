@@ -67,6 +67,7 @@ public:
 	static void convert_A8R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
 	static void convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP);
 	static void convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP);
+	static void convert_A8R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP);
 
 	static void convert_A8R8G8B8toR3G3B2(const void* sP, int32_t sN, void* dP);
 	static void convert_R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP);
@@ -75,6 +76,11 @@ public:
 	static void convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP);
 	static void convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
 	static void convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static void convert_R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP);
+
+	static void convert_R8G8B8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static void convert_R8G8B8A8toR8G8B8(const void* sP, int32_t sN, void* dP);
+	static void convert_R8G8B8A8toR8G8B8A8(const void* sP, int32_t sN, void* dP);
 
 	static void convert_R5G6B5toR5G6B5(const void* sP, int32_t sN, void* dP);
 	static void convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP);
@@ -0,0 +1,670 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CColorConverterSIMD.h"
+#include "IrrCompileConfig.h"
+#include "SCPUFeatures.h"
+
+//! The engine is only compiled for SSE3, the wider kernels get enabled per function and are only called after a CPUID check.
+#if defined(__GNUC__)||defined(__clang__)
+#define IRR_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define IRR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IRR_TARGET_SSSE3
+#define IRR_TARGET_AVX2
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+namespace
+{
+
+//! pshufb masks, applied to every 16 byte lane, -1 zeroes the byte
+//! 4 byte to 3 byte pixels, taking bytes 2,1,0 of every pixel
+const int8_t kShuffle4to3_210[16] = {2,1,0, 6,5,4, 10,9,8, 14,13,12, -1,-1,-1,-1};
+//! 4 byte to 3 byte pixels, taking bytes 0,1,2 of every pixel
+const int8_t kShuffle4to3_012[16] = {0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1};
+//! 3 byte to 4 byte pixels, reversing the byte order
+const int8_t kShuffle3to4_210[16] = {2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1};
+//! 3 byte to 4 byte pixels, keeping the byte order
+const int8_t kShuffle3to4_012[16] = {0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1};
+//! full byte reversal of 4 byte pixels
+const int8_t kShuffle4to4_3210[16] = {3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12};
+//! swap of byte 0 and 2 of 4 byte pixels
+const int8_t kShuffle4to4_2103[16] = {2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15};
+
+const uint32_t kOpaque = 0xff000000u;
+
+
+template<int S>
+inline __m128i maskShl(const __m128i& c, const uint32_t& mask)
+{
+	return _mm_slli_epi32(_mm_and_si128(c,_mm_set1_epi32(int(mask))),S);
+}
+
+template<int S>
+inline __m128i maskShr(const __m128i& c, const uint32_t& mask)
+{
+	return _mm_srli_epi32(_mm_and_si128(c,_mm_set1_epi32(int(mask))),S);
+}
+
+//! Same as SColor.h's A1R5G5B5toA8R8G8B8 on four 32bit lanes
+inline __m128i lanesA1R5G5B5toA8R8G8B8(const __m128i& c)
+{
+	const __m128i alpha = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c,16),31),_mm_set1_epi32(int(kOpaque)));
+	const __m128i r = _mm_or_si128(maskShl<9>(c,0x7c00u),maskShl<4>(c,0x7000u));
+	const __m128i g = _mm_or_si128(maskShl<6>(c,0x3e0u),maskShl<1>(c,0x380u));
+	const __m128i b = _mm_or_si128(maskShl<3>(c,0x1fu),maskShr<2>(c,0x1cu));
+	return _mm_or_si128(_mm_or_si128(alpha,r),_mm_or_si128(g,b));
+}
+
+//! Same as SColor.h's R5G6B5toA8R8G8B8 on four 32bit lanes
+inline __m128i lanesR5G6B5toA8R8G8B8(const __m128i& c)
+{
+	const __m128i rg = _mm_or_si128(maskShl<8>(c,0xf800u),maskShl<5>(c,0x7e0u));
+	return _mm_or_si128(_mm_or_si128(rg,maskShl<3>(c,0x1fu)),_mm_set1_epi32(int(kOpaque)));
+}
+
+//! Same as SColor.h's A8R8G8B8toA1R5G5B5 on four 32bit lanes
+inline __m128i lanesA8R8G8B8toA1R5G5B5(const __m128i& c)
+{
+	const __m128i ar = _mm_or_si128(maskShr<16>(c,0x80000000u),maskShr<9>(c,0xf80000u));
+	const __m128i gb = _mm_or_si128(maskShr<6>(c,0xf800u),maskShr<3>(c,0xf8u));
+	return _mm_or_si128(ar,gb);
+}
+
+//! Same as CColorConverter::convert_A8R8G8B8toR5G6B5 on four 32bit lanes
+inline __m128i lanesA8R8G8B8toR5G6B5(const __m128i& c)
+{
+	const __m128i rg = _mm_or_si128(maskShr<8>(c,0xf80000u),maskShr<5>(c,0xfc00u));
+	return _mm_or_si128(rg,maskShr<3>(c,0xf8u));
+}
+
+//! R5G6B5 to the byte order of CColorConverter::convert_R5G6B5toR8G8B8 in the low 3 bytes
+inline __m128i lanesR5G6B5toR8G8B8(const __m128i& c)
+{
+	const __m128i rg = _mm_or_si128(maskShr<8>(c,0xf800u),maskShl<5>(c,0x7e0u));
+	return _mm_or_si128(rg,maskShl<19>(c,0x1fu));
+}
+
+//! R5G6B5 to the byte order of CColorConverter::convert_R5G6B5toB8G8R8 in the low 3 bytes
+inline __m128i lanesR5G6B5toB8G8R8(const __m128i& c)
+{
+	const __m128i bg = _mm_or_si128(maskShl<3>(c,0x1fu),maskShl<5>(c,0x7e0u));
+	return _mm_or_si128(bg,maskShl<8>(c,0xf800u));
+}
+
+//! A1R5G5B5 to the byte order of CColorConverter::convert_A1R5G5B5toR8G8B8 in the low 3 bytes
+inline __m128i lanesA1R5G5B5toR8G8B8(const __m128i& c)
+{
+	const __m128i bg = _mm_or_si128(maskShl<3>(c,0x1fu),maskShl<6>(c,0x3e0u));
+	return _mm_or_si128(bg,maskShl<9>(c,0x7c00u));
+}
+
+//! A1R5G5B5 to the byte order of CColorConverter::convert_A1R5G5B5toB8G8R8 in the low 3 bytes
+inline __m128i lanesA1R5G5B5toB8G8R8(const __m128i& c)
+{
+	const __m128i rg = _mm_or_si128(maskShr<7>(c,0x7c00u),maskShl<6>(c,0x3e0u));
+	return _mm_or_si128(rg,maskShl<19>(c,0x1fu));
+}
+
+//! Packs the low 16 bits of eight 32bit lanes, without the signed saturation of packs_epi32 getting in the way
+inline __m128i pack32to16(const __m128i& lo, const __m128i& hi)
+{
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo,16),16),_mm_srai_epi32(_mm_slli_epi32(hi,16),16));
+}
+
+//! Stores 16 pixels of 3 bytes, every input register holding 4 pixels in its low 12 bytes
+inline void store4x12bytes(uint8_t* dst, const __m128i& c0, const __m128i& c1, const __m128i& c2, const __m128i& c3)
+{
+	_mm_storeu_si128((__m128i*)dst,_mm_or_si128(c0,_mm_slli_si128(c1,12)));
+	_mm_storeu_si128((__m128i*)(dst+16),_mm_or_si128(_mm_srli_si128(c1,4),_mm_slli_si128(c2,8)));
+	_mm_storeu_si128((__m128i*)(dst+32),_mm_or_si128(_mm_srli_si128(c2,8),_mm_slli_si128(c3,4)));
+}
+
+//! Loads 16 pixels of 3 bytes, every output register gets 4 pixels in its low 12 bytes
+IRR_TARGET_SSSE3 inline void load4x12bytes(const uint8_t* src, __m128i& c0, __m128i& c1, __m128i& c2, __m128i& c3)
+{
+	const __m128i r0 = _mm_loadu_si128((const __m128i*)src);
+	const __m128i r1 = _mm_loadu_si128((const __m128i*)(src+16));
+	const __m128i r2 = _mm_loadu_si128((const __m128i*)(src+32));
+	c0 = r0;
+	c1 = _mm_alignr_epi8(r1,r0,12);
+	c2 = _mm_alignr_epi8(r2,r1,8);
+	c3 = _mm_srli_si128(r2,4);
+}
+
+
+//! SSE2 kernels
+
+template<__m128i (*lanes)(const __m128i&)>
+int32_t expand16to32_SSE2(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i zero = _mm_setzero_si128();
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s++,d+=2)
+	{
+		const __m128i c = _mm_loadu_si128(s);
+		_mm_storeu_si128(d,lanes(_mm_unpacklo_epi16(c,zero)));
+		_mm_storeu_si128(d+1,lanes(_mm_unpackhi_epi16(c,zero)));
+	}
+	return done;
+}
+
+template<__m128i (*lanes)(const __m128i&)>
+int32_t reduce32to16_SSE2(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m128i* d = (__m128i*)dP;
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s+=2,d++)
+		_mm_storeu_si128(d,pack32to16(lanes(_mm_loadu_si128(s)),lanes(_mm_loadu_si128(s+1))));
+	return done;
+}
+
+int32_t A1R5G5B5toR5G6B5_SSE2(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i rgMask = _mm_set1_epi16(0x7fe0);
+	const __m128i bMask = _mm_set1_epi16(0x1f);
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s++,d++)
+	{
+		const __m128i c = _mm_loadu_si128(s);
+		_mm_storeu_si128(d,_mm_or_si128(_mm_slli_epi16(_mm_and_si128(c,rgMask),1),_mm_and_si128(c,bMask)));
+	}
+	return done;
+}
+
+int32_t R5G6B5toA1R5G5B5_SSE2(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i rgMask = _mm_set1_epi16(int16_t(0xffc0));
+	const __m128i bMask = _mm_set1_epi16(0x1f);
+	const __m128i alpha = _mm_set1_epi16(int16_t(0x8000));
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s++,d++)
+	{
+		const __m128i c = _mm_loadu_si128(s);
+		const __m128i rgb = _mm_or_si128(_mm_srli_epi16(_mm_and_si128(c,rgMask),1),_mm_and_si128(c,bMask));
+		_mm_storeu_si128(d,_mm_or_si128(rgb,alpha));
+	}
+	return done;
+}
+
+
+//! SSSE3 kernels
+
+IRR_TARGET_SSSE3 int32_t shuffle4to4_SSSE3(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i shuf = _mm_loadu_si128((const __m128i*)mask);
+	const __m128i orBits = _mm_set1_epi32(int(orMask));
+
+	int32_t done = 0;
+	for (; done+4<=sN; done+=4,s++,d++)
+		_mm_storeu_si128(d,_mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(s),shuf),orBits));
+	return done;
+}
+
+IRR_TARGET_SSSE3 int32_t shuffle4to3_SSSE3(const void* sP, int32_t sN, void* dP, const int8_t* mask)
+{
+	const __m128i* s = (const __m128i*)sP;
+	uint8_t* d = (uint8_t*)dP;
+	const __m128i shuf = _mm_loadu_si128((const __m128i*)mask);
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=4,d+=48)
+	{
+		store4x12bytes(d,_mm_shuffle_epi8(_mm_loadu_si128(s),shuf),_mm_shuffle_epi8(_mm_loadu_si128(s+1),shuf),
+						_mm_shuffle_epi8(_mm_loadu_si128(s+2),shuf),_mm_shuffle_epi8(_mm_loadu_si128(s+3),shuf));
+	}
+	return done;
+}
+
+IRR_TARGET_SSSE3 int32_t shuffle3to4_SSSE3(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask)
+{
+	const uint8_t* s = (const uint8_t*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i shuf = _mm_loadu_si128((const __m128i*)mask);
+	const __m128i orBits = _mm_set1_epi32(int(orMask));
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=48,d+=4)
+	{
+		__m128i c[4];
+		load4x12bytes(s,c[0],c[1],c[2],c[3]);
+		for (uint32_t i=0; i<4; i++)
+			_mm_storeu_si128(d+i,_mm_or_si128(_mm_shuffle_epi8(c[i],shuf),orBits));
+	}
+	return done;
+}
+
+template<__m128i (*lanes)(const __m128i&)>
+IRR_TARGET_SSSE3 int32_t expand16to24_SSSE3(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	uint8_t* d = (uint8_t*)dP;
+	const __m128i shuf = _mm_loadu_si128((const __m128i*)kShuffle4to3_012);
+	const __m128i zero = _mm_setzero_si128();
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=2,d+=48)
+	{
+		const __m128i c0 = _mm_loadu_si128(s);
+		const __m128i c1 = _mm_loadu_si128(s+1);
+		store4x12bytes(d,_mm_shuffle_epi8(lanes(_mm_unpacklo_epi16(c0,zero)),shuf),_mm_shuffle_epi8(lanes(_mm_unpackhi_epi16(c0,zero)),shuf),
+						_mm_shuffle_epi8(lanes(_mm_unpacklo_epi16(c1,zero)),shuf),_mm_shuffle_epi8(lanes(_mm_unpackhi_epi16(c1,zero)),shuf));
+	}
+	return done;
+}
+
+//! R8G8B8 gets rearranged into A8R8G8B8 lanes with `orMask` as alpha before reducing
+template<__m128i (*lanes)(const __m128i&)>
+IRR_TARGET_SSSE3 int32_t reduce24to16_SSSE3(const void* sP, int32_t sN, void* dP, const uint32_t& orMask)
+{
+	const uint8_t* s = (const uint8_t*)sP;
+	__m128i* d = (__m128i*)dP;
+	const __m128i shuf = _mm_loadu_si128((const __m128i*)kShuffle3to4_210);
+	const __m128i orBits = _mm_set1_epi32(int(orMask));
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=48,d+=2)
+	{
+		__m128i c[4];
+		load4x12bytes(s,c[0],c[1],c[2],c[3]);
+		for (uint32_t i=0; i<4; i++)
+			c[i] = lanes(_mm_or_si128(_mm_shuffle_epi8(c[i],shuf),orBits));
+		_mm_storeu_si128(d,pack32to16(c[0],c[1]));
+		_mm_storeu_si128(d+1,pack32to16(c[2],c[3]));
+	}
+	return done;
+}
+
+
+//! AVX2 kernels
+
+template<int S>
+IRR_TARGET_AVX2 inline __m256i maskShl(const __m256i& c, const uint32_t& mask)
+{
+	return _mm256_slli_epi32(_mm256_and_si256(c,_mm256_set1_epi32(int(mask))),S);
+}
+
+template<int S>
+IRR_TARGET_AVX2 inline __m256i maskShr(const __m256i& c, const uint32_t& mask)
+{
+	return _mm256_srli_epi32(_mm256_and_si256(c,_mm256_set1_epi32(int(mask))),S);
+}
+
+IRR_TARGET_AVX2 inline __m256i lanesA1R5G5B5toA8R8G8B8(const __m256i& c)
+{
+	const __m256i alpha = _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(c,16),31),_mm256_set1_epi32(int(kOpaque)));
+	const __m256i r = _mm256_or_si256(maskShl<9>(c,0x7c00u),maskShl<4>(c,0x7000u));
+	const __m256i g = _mm256_or_si256(maskShl<6>(c,0x3e0u),maskShl<1>(c,0x380u));
+	const __m256i b = _mm256_or_si256(maskShl<3>(c,0x1fu),maskShr<2>(c,0x1cu));
+	return _mm256_or_si256(_mm256_or_si256(alpha,r),_mm256_or_si256(g,b));
+}
+
+IRR_TARGET_AVX2 inline __m256i lanesR5G6B5toA8R8G8B8(const __m256i& c)
+{
+	const __m256i rg = _mm256_or_si256(maskShl<8>(c,0xf800u),maskShl<5>(c,0x7e0u));
+	return _mm256_or_si256(_mm256_or_si256(rg,maskShl<3>(c,0x1fu)),_mm256_set1_epi32(int(kOpaque)));
+}
+
+IRR_TARGET_AVX2 inline __m256i lanesA8R8G8B8toA1R5G5B5(const __m256i& c)
+{
+	const __m256i ar = _mm256_or_si256(maskShr<16>(c,0x80000000u),maskShr<9>(c,0xf80000u));
+	const __m256i gb = _mm256_or_si256(maskShr<6>(c,0xf800u),maskShr<3>(c,0xf8u));
+	return _mm256_or_si256(ar,gb);
+}
+
+IRR_TARGET_AVX2 inline __m256i lanesA8R8G8B8toR5G6B5(const __m256i& c)
+{
+	const __m256i rg = _mm256_or_si256(maskShr<8>(c,0xf80000u),maskShr<5>(c,0xfc00u));
+	return _mm256_or_si256(rg,maskShr<3>(c,0xf8u));
+}
+
+template<__m256i (*lanes)(const __m256i&)>
+IRR_TARGET_AVX2 int32_t expand16to32_AVX2(const void* sP, int32_t sN, void* dP)
+{
+	const __m128i* s = (const __m128i*)sP;
+	__m256i* d = (__m256i*)dP;
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=2,d+=2)
+	{
+		_mm256_storeu_si256(d,lanes(_mm256_cvtepu16_epi32(_mm_loadu_si128(s))));
+		_mm256_storeu_si256(d+1,lanes(_mm256_cvtepu16_epi32(_mm_loadu_si128(s+1))));
+	}
+	return done;
+}
+
+template<__m256i (*lanes)(const __m256i&)>
+IRR_TARGET_AVX2 int32_t reduce32to16_AVX2(const void* sP, int32_t sN, void* dP)
+{
+	const __m256i* s = (const __m256i*)sP;
+	__m256i* d = (__m256i*)dP;
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s+=2,d++)
+	{
+		const __m256i lo = _mm256_srai_epi32(_mm256_slli_epi32(lanes(_mm256_loadu_si256(s)),16),16);
+		const __m256i hi = _mm256_srai_epi32(_mm256_slli_epi32(lanes(_mm256_loadu_si256(s+1)),16),16);
+		// packs works per 128bit lane, so the 64bit quarters come out as lo0,hi0,lo1,hi1
+		_mm256_storeu_si256(d,_mm256_permute4x64_epi64(_mm256_packs_epi32(lo,hi),0xd8));
+	}
+	return done;
+}
+
+IRR_TARGET_AVX2 int32_t A1R5G5B5toR5G6B5_AVX2(const void* sP, int32_t sN, void* dP)
+{
+	const __m256i* s = (const __m256i*)sP;
+	__m256i* d = (__m256i*)dP;
+	const __m256i rgMask = _mm256_set1_epi16(0x7fe0);
+	const __m256i bMask = _mm256_set1_epi16(0x1f);
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s++,d++)
+	{
+		const __m256i c = _mm256_loadu_si256(s);
+		_mm256_storeu_si256(d,_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(c,rgMask),1),_mm256_and_si256(c,bMask)));
+	}
+	return done;
+}
+
+IRR_TARGET_AVX2 int32_t R5G6B5toA1R5G5B5_AVX2(const void* sP, int32_t sN, void* dP)
+{
+	const __m256i* s = (const __m256i*)sP;
+	__m256i* d = (__m256i*)dP;
+	const __m256i rgMask = _mm256_set1_epi16(int16_t(0xffc0));
+	const __m256i bMask = _mm256_set1_epi16(0x1f);
+	const __m256i alpha = _mm256_set1_epi16(int16_t(0x8000));
+
+	int32_t done = 0;
+	for (; done+16<=sN; done+=16,s++,d++)
+	{
+		const __m256i c = _mm256_loadu_si256(s);
+		const __m256i rgb = _mm256_or_si256(_mm256_srli_epi16(_mm256_and_si256(c,rgMask),1),_mm256_and_si256(c,bMask));
+		_mm256_storeu_si256(d,_mm256_or_si256(rgb,alpha));
+	}
+	return done;
+}
+
+IRR_TARGET_AVX2 int32_t shuffle4to4_AVX2(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask)
+{
+	const __m256i* s = (const __m256i*)sP;
+	__m256i* d = (__m256i*)dP;
+	const __m256i shuf = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)mask));
+	const __m256i orBits = _mm256_set1_epi32(int(orMask));
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s++,d++)
+		_mm256_storeu_si256(d,_mm256_or_si256(_mm256_shuffle_epi8(_mm256_loadu_si256(s),shuf),orBits));
+	return done;
+}
+
+IRR_TARGET_AVX2 int32_t shuffle4to3_AVX2(const void* sP, int32_t sN, void* dP, const int8_t* mask)
+{
+	const __m256i* s = (const __m256i*)sP;
+	uint8_t* d = (uint8_t*)dP;
+	const __m256i shuf = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)mask));
+	// gathers the 12 valid bytes of both lanes into the low 24 bytes
+	const __m256i compact = _mm256_setr_epi32(0,1,2,4,5,6,3,7);
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s++,d+=24)
+	{
+		const __m256i v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(s),shuf),compact);
+		_mm_storeu_si128((__m128i*)d,_mm256_castsi256_si128(v));
+		_mm_storel_epi64((__m128i*)(d+16),_mm256_extracti128_si256(v,1));
+	}
+	return done;
+}
+
+IRR_TARGET_AVX2 int32_t shuffle3to4_AVX2(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask)
+{
+	const uint8_t* s = (const uint8_t*)sP;
+	__m256i* d = (__m256i*)dP;
+	const __m256i shuf = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)mask));
+	const __m256i orBits = _mm256_set1_epi32(int(orMask));
+	// spreads 24 bytes so each lane gets 4 pixels in its low 12 bytes
+	const __m256i spread = _mm256_setr_epi32(0,1,2,0,3,4,5,0);
+
+	int32_t done = 0;
+	for (; done+8<=sN; done+=8,s+=24,d++)
+	{
+		__m256i v = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s));
+		v = _mm256_inserti128_si256(v,_mm_loadl_epi64((const __m128i*)(s+16)),1);
+		v = _mm256_permutevar8x32_epi32(v,spread);
+		_mm256_storeu_si256(d,_mm256_or_si256(_mm256_shuffle_epi8(v,shuf),orBits));
+	}
+	return done;
+}
+
+
+//! Dispatchers
+
+int32_t shuffle4to4(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask=0u)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return shuffle4to4_AVX2(sP,sN,dP,mask,orMask);
+	if (cpu.SSSE3)
+		return shuffle4to4_SSSE3(sP,sN,dP,mask,orMask);
+	return 0;
+}
+
+int32_t shuffle4to3(const void* sP, int32_t sN, void* dP, const int8_t* mask)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return shuffle4to3_AVX2(sP,sN,dP,mask);
+	if (cpu.SSSE3)
+		return shuffle4to3_SSSE3(sP,sN,dP,mask);
+	return 0;
+}
+
+int32_t shuffle3to4(const void* sP, int32_t sN, void* dP, const int8_t* mask, const uint32_t& orMask)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return shuffle3to4_AVX2(sP,sN,dP,mask,orMask);
+	if (cpu.SSSE3)
+		return shuffle3to4_SSSE3(sP,sN,dP,mask,orMask);
+	return 0;
+}
+
+template<__m128i (*lanes)(const __m128i&), __m256i (*lanesAVX2)(const __m256i&)>
+int32_t expand16to32(const void* sP, int32_t sN, void* dP)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return expand16to32_AVX2<lanesAVX2>(sP,sN,dP);
+	if (cpu.SSE2)
+		return expand16to32_SSE2<lanes>(sP,sN,dP);
+	return 0;
+}
+
+template<__m128i (*lanes)(const __m128i&), __m256i (*lanesAVX2)(const __m256i&)>
+int32_t reduce32to16(const void* sP, int32_t sN, void* dP)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return reduce32to16_AVX2<lanesAVX2>(sP,sN,dP);
+	if (cpu.SSE2)
+		return reduce32to16_SSE2<lanes>(sP,sN,dP);
+	return 0;
+}
+
+template<__m128i (*lanes)(const __m128i&)>
+int32_t expand16to24(const void* sP, int32_t sN, void* dP)
+{
+	return core::SCPUFeatures::get().SSSE3 ? expand16to24_SSSE3<lanes>(sP,sN,dP):0;
+}
+
+template<__m128i (*lanes)(const __m128i&)>
+int32_t reduce24to16(const void* sP, int32_t sN, void* dP, const uint32_t& orMask)
+{
+	return core::SCPUFeatures::get().SSSE3 ? reduce24to16_SSSE3<lanes>(sP,sN,dP,orMask):0;
+}
+
+} // end anonymous namespace
+
+
+int32_t CColorConverterSIMD::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to24<lanesA1R5G5B5toR8G8B8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to24<lanesA1R5G5B5toB8G8R8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_A1R5G5B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to32<lanesA1R5G5B5toA8R8G8B8,lanesA1R5G5B5toA8R8G8B8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return A1R5G5B5toR5G6B5_AVX2(sP,sN,dP);
+	if (cpu.SSE2)
+		return A1R5G5B5toR5G6B5_SSE2(sP,sN,dP);
+	return 0;
+}
+
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to3(sP,sN,dP,kShuffle4to3_210);
+}
+
+int32_t CColorConverterSIMD::convert_A8R8G8B8toB8G8R8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to3(sP,sN,dP,kShuffle4to3_012);
+}
+
+int32_t CColorConverterSIMD::convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
+{
+	return reduce32to16<lanesA8R8G8B8toA1R5G5B5,lanesA8R8G8B8toA1R5G5B5>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
+{
+	return reduce32to16<lanesA8R8G8B8toR5G6B5,lanesA8R8G8B8toR5G6B5>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to4(sP,sN,dP,kShuffle4to4_2103);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle3to4(sP,sN,dP,kShuffle3to4_210,kOpaque);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP)
+{
+	return reduce24to16<lanesA8R8G8B8toA1R5G5B5>(sP,sN,dP,kOpaque);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP)
+{
+	return reduce24to16<lanesA8R8G8B8toR5G6B5>(sP,sN,dP,0u);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle3to4(sP,sN,dP,kShuffle3to4_012,kOpaque);
+}
+
+int32_t CColorConverterSIMD::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle3to4(sP,sN,dP,kShuffle3to4_012,kOpaque);
+}
+
+int32_t CColorConverterSIMD::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to4(sP,sN,dP,kShuffle4to4_3210);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to4(sP,sN,dP,kShuffle4to4_2103);
+}
+
+int32_t CColorConverterSIMD::convert_R8G8B8A8toR8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return shuffle4to3(sP,sN,dP,kShuffle4to3_012);
+}
+
+int32_t CColorConverterSIMD::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to24<lanesR5G6B5toR8G8B8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to24<lanesR5G6B5toB8G8R8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_R5G6B5toA8R8G8B8(const void* sP, int32_t sN, void* dP)
+{
+	return expand16to32<lanesR5G6B5toA8R8G8B8,lanesR5G6B5toA8R8G8B8>(sP,sN,dP);
+}
+
+int32_t CColorConverterSIMD::convert_R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP)
+{
+	const core::SCPUFeatures& cpu = core::SCPUFeatures::get();
+	if (cpu.AVX2)
+		return R5G6B5toA1R5G5B5_AVX2(sP,sN,dP);
+	if (cpu.SSE2)
+		return R5G6B5toA1R5G5B5_SSE2(sP,sN,dP);
+	return 0;
+}
+
+#else
+
+int32_t CColorConverterSIMD::convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A1R5G5B5toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A8R8G8B8toB8G8R8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_A8R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R8G8B8A8toR8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R5G6B5toA8R8G8B8(const void* sP, int32_t sN, void* dP) {return 0;}
+int32_t CColorConverterSIMD::convert_R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP) {return 0;}
+
+#endif // __IRR_COMPILE_WITH_X86_SIMD_
+
+} // end namespace video
+} // end namespace irr
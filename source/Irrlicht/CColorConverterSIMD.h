@@ -0,0 +1,52 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_COLOR_CONVERTER_SIMD_H_INCLUDED__
+#define __C_COLOR_CONVERTER_SIMD_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Vectorized bodies of the CColorConverter::convert_* functions.
+/** Every function converts as many leading pixels as fit in whole SIMD iterations, using the widest
+instruction set core::SCPUFeatures::get() allows (AVX2, SSSE3, or plain SSE2), and returns how many it did.
+The caller converts the remaining pixels with its scalar loop, so the results are bit-exact with it. */
+class CColorConverterSIMD
+{
+public:
+	static int32_t convert_A1R5G5B5toR8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A1R5G5B5toB8G8R8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A1R5G5B5toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A1R5G5B5toR5G6B5(const void* sP, int32_t sN, void* dP);
+
+	static int32_t convert_A8R8G8B8toR8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A8R8G8B8toB8G8R8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A8R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A8R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_A8R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP);
+
+	static int32_t convert_R8G8B8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R8G8B8toA1R5G5B5(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R8G8B8toR5G6B5(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R8G8B8toR8G8B8A8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_B8G8R8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_B8G8R8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+
+	static int32_t convert_R8G8B8A8toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R8G8B8A8toR8G8B8(const void* sP, int32_t sN, void* dP);
+
+	static int32_t convert_R5G6B5toR8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R5G6B5toB8G8R8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R5G6B5toA8R8G8B8(const void* sP, int32_t sN, void* dP);
+	static int32_t convert_R5G6B5toA1R5G5B5(const void* sP, int32_t sN, void* dP);
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
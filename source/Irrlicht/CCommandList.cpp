@@ -0,0 +1,247 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CCommandList.h"
+#include <string.h>
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+    struct SSetMaterialCommand
+    {
+        uint32_t materialIx;
+    };
+
+    struct SSetTransform4x3Command
+    {
+        E_4X3_TRANSFORMATION_STATE state;
+        core::matrix4x3 matrix;
+    };
+
+    struct SSetTransformProjectionCommand
+    {
+        E_PROJECTION_TRANSFORMATION_STATE state;
+        core::matrix4 matrix;
+    };
+
+    struct SDrawMeshBufferCommand
+    {
+        const scene::IGPUMeshBuffer* meshbuffer;
+        IOcclusionQuery* query;
+    };
+
+    struct SDrawIndirectCommand
+    {
+        const scene::IMeshDataFormatDesc<video::IGPUBuffer>* vao;
+        scene::E_PRIMITIVE_TYPE mode;
+        E_INDEX_TYPE type;
+        const IGPUBuffer* indirectDrawBuff;
+        size_t offset;
+        size_t count;
+        size_t stride;
+        IOcclusionQuery* query;
+    };
+
+    //! followed by `size` bytes of data
+    struct SUpdateBufferCommand
+    {
+        IGPUBuffer* buffer;
+        size_t offset;
+        size_t size;
+    };
+
+    //! What the lists being executed last set, to skip setting it again
+    struct SReplayState
+    {
+        SReplayState() : material(NULL), transformsSet(0) {}
+
+        const SMaterial* material;
+        //! bit per E_4X3_TRANSFORMATION_STATE followed by a bit per E_PROJECTION_TRANSFORMATION_STATE
+        uint32_t transformsSet;
+        core::matrix4x3 transforms4x3[E4X3TS_COUNT];
+        core::matrix4 transformsProjection[EPTS_COUNT];
+    };
+}
+
+
+void CCommandList::setMaterial(const SMaterial& material)
+{
+    // nothing between the two could have changed the material
+    if (!Materials.empty()&&!(Materials.back()!=material))
+        return;
+
+    SSetMaterialCommand command;
+    command.materialIx = uint32_t(Materials.size());
+    Materials.push_back(material);
+    record(ECT_SET_MATERIAL,command);
+}
+
+void CCommandList::setTransform(const E_4X3_TRANSFORMATION_STATE& state, const core::matrix4x3& mat)
+{
+    SSetTransform4x3Command command;
+    command.state = state;
+    command.matrix = mat;
+    record(ECT_SET_TRANSFORM_4X3,command);
+}
+
+void CCommandList::setTransform(const E_PROJECTION_TRANSFORMATION_STATE& state, const core::matrix4& mat)
+{
+    SSetTransformProjectionCommand command;
+    command.state = state;
+    command.matrix = mat;
+    record(ECT_SET_TRANSFORM_PROJECTION,command);
+}
+
+void CCommandList::drawMeshBuffer(const scene::IGPUMeshBuffer* mb, IOcclusionQuery* query)
+{
+    if (!mb)
+        return;
+
+    SDrawMeshBufferCommand command;
+    command.meshbuffer = mb;
+    command.query = query;
+    record(ECT_DRAW_MESH_BUFFER,command);
+}
+
+void CCommandList::drawArraysIndirect(const scene::IMeshDataFormatDesc<video::IGPUBuffer>* vao, const scene::E_PRIMITIVE_TYPE& mode,
+                                      const IGPUBuffer* indirectDrawBuff, const size_t& offset, const size_t& count, const size_t& stride,
+                                      IOcclusionQuery* query)
+{
+    SDrawIndirectCommand command;
+    command.vao = vao;
+    command.mode = mode;
+    command.type = EIT_UNKNOWN;
+    command.indirectDrawBuff = indirectDrawBuff;
+    command.offset = offset;
+    command.count = count;
+    command.stride = stride;
+    command.query = query;
+    record(ECT_DRAW_ARRAYS_INDIRECT,command);
+}
+
+void CCommandList::drawIndexedIndirect(const scene::IMeshDataFormatDesc<video::IGPUBuffer>* vao, const scene::E_PRIMITIVE_TYPE& mode, const E_INDEX_TYPE& type,
+                                       const IGPUBuffer* indirectDrawBuff, const size_t& offset, const size_t& count, const size_t& stride,
+                                       IOcclusionQuery* query)
+{
+    SDrawIndirectCommand command;
+    command.vao = vao;
+    command.mode = mode;
+    command.type = type;
+    command.indirectDrawBuff = indirectDrawBuff;
+    command.offset = offset;
+    command.count = count;
+    command.stride = stride;
+    command.query = query;
+    record(ECT_DRAW_INDEXED_INDIRECT,command);
+}
+
+void CCommandList::updateBuffer(IGPUBuffer* buffer, const size_t& offset, const size_t& size, const void* data)
+{
+    if (!buffer||!size)
+        return;
+
+    SUpdateBufferCommand command;
+    command.buffer = buffer;
+    command.offset = offset;
+    command.size = size;
+    record(ECT_UPDATE_BUFFER,command,data,size);
+}
+
+
+CCommandList::SExecuteStatistics CCommandList::execute(IVideoDriver* driver, const CCommandList* const* lists, const uint32_t& listCount)
+{
+    SExecuteStatistics stats;
+    SReplayState state;
+    for (uint32_t i=0; i<listCount; i++)
+    {
+        const CCommandList* list = lists[i];
+        const uint8_t* it = list->Commands.data();
+        const uint8_t* const end = it+list->CommandsSize;
+        while (it<end)
+        {
+            uint32_t header[2];
+            memcpy(header,it,sizeof(header));
+            const uint8_t* params = it+sizeof(header);
+            it = params+header[1];
+
+            stats.commandsExecuted++;
+            switch (header[0])
+            {
+                case ECT_SET_MATERIAL:
+                    {
+                        const SSetMaterialCommand& command = *reinterpret_cast<const SSetMaterialCommand*>(params);
+                        const SMaterial& material = list->Materials[command.materialIx];
+                        if (state.material&&!(*state.material!=material))
+                        {
+                            stats.materialsSkipped++;
+                            break;
+                        }
+                        driver->setMaterial(material);
+                        state.material = &material;
+                    }
+                    break;
+                case ECT_SET_TRANSFORM_4X3:
+                    {
+                        const SSetTransform4x3Command& command = *reinterpret_cast<const SSetTransform4x3Command*>(params);
+                        const uint32_t bit = 0x1u<<command.state;
+                        if ((state.transformsSet&bit)&&memcmp(&state.transforms4x3[command.state],&command.matrix,sizeof(command.matrix))==0)
+                        {
+                            stats.transformsSkipped++;
+                            break;
+                        }
+                        driver->setTransform(command.state,command.matrix);
+                        state.transformsSet |= bit;
+                        state.transforms4x3[command.state] = command.matrix;
+                    }
+                    break;
+                case ECT_SET_TRANSFORM_PROJECTION:
+                    {
+                        const SSetTransformProjectionCommand& command = *reinterpret_cast<const SSetTransformProjectionCommand*>(params);
+                        const uint32_t bit = 0x1u<<(E4X3TS_COUNT+command.state);
+                        if ((state.transformsSet&bit)&&memcmp(&state.transformsProjection[command.state],&command.matrix,sizeof(command.matrix))==0)
+                        {
+                            stats.transformsSkipped++;
+                            break;
+                        }
+                        driver->setTransform(command.state,command.matrix);
+                        state.transformsSet |= bit;
+                        state.transformsProjection[command.state] = command.matrix;
+                    }
+                    break;
+                case ECT_DRAW_MESH_BUFFER:
+                    {
+                        const SDrawMeshBufferCommand& command = *reinterpret_cast<const SDrawMeshBufferCommand*>(params);
+                        driver->drawMeshBuffer(command.meshbuffer,command.query);
+                    }
+                    break;
+                case ECT_DRAW_ARRAYS_INDIRECT:
+                    {
+                        const SDrawIndirectCommand& command = *reinterpret_cast<const SDrawIndirectCommand*>(params);
+                        driver->drawArraysIndirect(command.vao,command.mode,command.indirectDrawBuff,command.offset,command.count,command.stride,command.query);
+                    }
+                    break;
+                case ECT_DRAW_INDEXED_INDIRECT:
+                    {
+                        const SDrawIndirectCommand& command = *reinterpret_cast<const SDrawIndirectCommand*>(params);
+                        driver->drawIndexedIndirect(command.vao,command.mode,command.type,command.indirectDrawBuff,command.offset,command.count,command.stride,command.query);
+                    }
+                    break;
+                case ECT_UPDATE_BUFFER:
+                    {
+                        const SUpdateBufferCommand& command = *reinterpret_cast<const SUpdateBufferCommand*>(params);
+                        command.buffer->updateSubRange(command.offset,command.size,params+sizeof(command));
+                    }
+                    break;
+            }
+        }
+    }
+    return stats;
+}
+
+} // end namespace video
+} // end namespace irr
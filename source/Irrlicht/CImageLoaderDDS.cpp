@@ -117,12 +117,10 @@ void DDSDecodePixelFormat( ddsBuffer *dds, eDDSPixelFormat *pf )
 	}
 	else if( fourCC == *((uint32_t*) "DXT1") )
 	{ // sodan was here
-//	    if (dds->pixelFormat.privateFormatBitCount==24)
-            *pf = DDS_PF_DXT1;
-/*        else if (dds->pixelFormat.privateFormatBitCount==32)
+        if (dds->pixelFormat.flags&0x1) //DDPF_ALPHAPIXELS
             *pf = DDS_PF_DXT1_ALPHA;
         else
-            printf("IRRLICHT BUUUUUUUUGGGGG!!!!!!!!!!\n SHOOT SOMEONE!\n");*/
+            *pf = DDS_PF_DXT1;
 	}
 	else if( fourCC == *((uint32_t*) "DXT2") )
 		*pf = DDS_PF_DXT2;
@@ -132,6 +130,10 @@ void DDSDecodePixelFormat( ddsBuffer *dds, eDDSPixelFormat *pf )
 		*pf = DDS_PF_DXT4;
 	else if( fourCC == *((uint32_t*) "DXT5") )
 		*pf = DDS_PF_DXT5;
+	else if( fourCC == *((uint32_t*) "ATI1") || fourCC == *((uint32_t*) "BC4U") )
+		*pf = DDS_PF_ATI1;
+	else if( fourCC == *((uint32_t*) "ATI2") || fourCC == *((uint32_t*) "BC5U") )
+		*pf = DDS_PF_ATI2;
 	else
 		*pf = DDS_PF_UNKNOWN;
 }
@@ -225,10 +227,13 @@ std::vector<CImageData*> CImageLoaderDDS::loadImage(io::IReadFile* file) const
             switch( pixelFormat )
             {
                 case DDS_PF_DXT1:
+                case DDS_PF_DXT1_ALPHA:
                 case DDS_PF_DXT2:
                 case DDS_PF_DXT3:
                 case DDS_PF_DXT4:
                 case DDS_PF_DXT5:
+                case DDS_PF_ATI1:
+                case DDS_PF_ATI2:
                     tmpWidth = width;
                     break;
                 default:
@@ -313,10 +318,13 @@ std::vector<CImageData*> CImageLoaderDDS::loadImage(io::IReadFile* file) const
                     break;
 
                 case DDS_PF_DXT1:
+                case DDS_PF_DXT1_ALPHA:
                 case DDS_PF_DXT2:
                 case DDS_PF_DXT3:
                 case DDS_PF_DXT4:
                 case DDS_PF_DXT5:
+                case DDS_PF_ATI1:
+                case DDS_PF_ATI2:
                     {
                         if (pixelFormat==video::DDS_PF_DXT2||pixelFormat==video::DDS_PF_DXT3)
                             colorFormat = video::ECF_RGBA_BC2;
@@ -326,6 +334,10 @@ std::vector<CImageData*> CImageLoaderDDS::loadImage(io::IReadFile* file) const
                             colorFormat = video::ECF_RGBA_BC1;
                         else if (pixelFormat==video::DDS_PF_DXT1)
                             colorFormat = video::ECF_RGB_BC1;
+                        else if (pixelFormat==video::DDS_PF_ATI1)
+                            colorFormat = video::ECF_R_BC4;
+                        else if (pixelFormat==video::DDS_PF_ATI2)
+                            colorFormat = video::ECF_RG_BC5;
 
                         CImageData* data = new CImageData(NULL,zeroDummy,mipSize,i,colorFormat,1);
                         file->read(data->getData(),data->getImageDataSizeInBytes());
@@ -34,6 +34,8 @@ enum eDDSPixelFormat
 	DDS_PF_DXT3,
 	DDS_PF_DXT4,
 	DDS_PF_DXT5,
+	DDS_PF_ATI1,
+	DDS_PF_ATI2,
 	DDS_PF_UNKNOWN
 };
 
@@ -16,11 +16,6 @@ namespace irr
 namespace video
 {
 
-#ifdef _IRR_COMPILE_WITH_LIBJPEG_
-// Static members
-io::path CImageLoaderJPG::Filename;
-#endif // _IRR_COMPILE_WITH_LIBJPEG_
-
 //! constructor
 CImageLoaderJPG::CImageLoaderJPG()
 {
@@ -56,6 +51,9 @@ bool CImageLoaderJPG::isALoadableFileExtension(const io::path& filename) const
 
         // for longjmp, to return to caller on a fatal error
         jmp_buf setjmp_buffer;
+
+        // per decode rather than static, images may be loaded on several threads
+        const char* filename;
     };
 
 void CImageLoaderJPG::init_source (j_decompress_ptr cinfo)
@@ -113,7 +111,7 @@ void CImageLoaderJPG::output_message(j_common_ptr cinfo)
 	char temp1[JMSG_LENGTH_MAX];
 	(*cinfo->err->format_message)(cinfo, temp1);
 	std::string errMsg("JPEG FATAL ERROR in ");
-	errMsg += std::string(Filename.c_str());
+	errMsg += std::string(((irr_jpeg_error_mgr*)cinfo->err)->filename);
 	os::Printer::log(errMsg,temp1, ELL_ERROR);
 }
 #endif // _IRR_COMPILE_WITH_LIBJPEG_
@@ -147,8 +145,6 @@ std::vector<CImageData*> CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	if (!file)
 		return retval;
 
-	Filename = file->getFileName();
-
 	uint8_t **rowPtr=0;
 	uint8_t* input = new uint8_t[file->getSize()];
 	file->read(input, file->getSize());
@@ -165,6 +161,7 @@ std::vector<CImageData*> CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	cinfo.err = jpeg_std_error(&jerr.pub);
 	cinfo.err->error_exit = error_exit;
 	cinfo.err->output_message = output_message;
+	jerr.filename = file->getFileName().c_str();
 
 	// compatibility fudge:
 	// we need to use setjmp/longjmp for error handling as gcc-linux
@@ -7,6 +7,7 @@
 #ifdef _IRR_COMPILE_WITH_PCX_LOADER_
 
 #include "IReadFile.h"
+#include "CBufferedReadFile.h"
 #include "SColor.h"
 #include "CColorConverter.h"
 #include "CImage.h"
@@ -111,11 +112,14 @@ std::vector<CImageData*> CImageLoaderPCX::loadImage(io::IReadFile* file) const
 	const int32_t imagebytes = header.BytesPerLine * header.Planes * header.BitsPerPixel * height / 8;
 	uint8_t* PCXData = new uint8_t[imagebytes];
 
+	// one or two bytes per run
+	io::CBufferedReadFile buffered(file);
 	uint8_t cnt, value;
 	int32_t lineoffset=0, linestart=0, nextmode=1;
 	for(int32_t offset = 0; offset < imagebytes; offset += cnt)
 	{
-		file->read(&cnt, 1);
+		if (!buffered.readByte(cnt))
+			break;
 		if( !((cnt & 0xc0) == 0xc0) )
 		{
 			value = cnt;
@@ -124,7 +128,8 @@ std::vector<CImageData*> CImageLoaderPCX::loadImage(io::IReadFile* file) const
 		else
 		{
 			cnt &= 0x3f;
-			file->read(&value, 1);
+			if (!buffered.readByte(value))
+				break;
 		}
 		if (header.Planes==1)
 			memset(PCXData+offset, value, cnt);
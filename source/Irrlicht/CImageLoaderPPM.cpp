@@ -46,8 +46,12 @@ bool CImageLoaderPPM::isALoadableFileFormat(io::IReadFile* file) const
 
 
 //! creates a surface from the file
-std::vector<CImageData*> CImageLoaderPPM::loadImage(io::IReadFile* file) const
+std::vector<CImageData*> CImageLoaderPPM::loadImage(io::IReadFile* _file) const
 {
+	// the header and the ascii variants are read a character at a time
+	io::CBufferedReadFile buffered(_file);
+	io::CBufferedReadFile* file = &buffered;
+
     std::vector<CImageData*> retval;
 	if (file->getSize() < 12)
 		return retval;
@@ -212,17 +216,15 @@ std::vector<CImageData*> CImageLoaderPPM::loadImage(io::IReadFile* file) const
 
 
 //! read the next token from file
-void CImageLoaderPPM::getNextToken(io::IReadFile* file, std::string& token) const
+void CImageLoaderPPM::getNextToken(io::CBufferedReadFile* file, std::string& token) const
 {
 	token = "";
-	int8_t c;
-	while(file->getPos()<file->getSize())
+	uint8_t c;
+	while(file->readByte(c))
 	{
-		file->read(&c, 1);
 		if (c=='#')
 		{
-			while (c!='\n' && c!='\r' && (file->getPos()<file->getSize()))
-				file->read(&c, 1);
+			while (c!='\n' && c!='\r' && file->readByte(c)) {}
 		}
 		else if (!core::isspace(c))
 		{
@@ -230,13 +232,11 @@ void CImageLoaderPPM::getNextToken(io::IReadFile* file, std::string& token) cons
 			break;
 		}
 	}
-	while(file->getPos()<file->getSize())
+	while(file->readByte(c))
 	{
-		file->read(&c, 1);
 		if (c=='#')
 		{
-			while (c!='\n' && c!='\r' && (file->getPos()<file->getSize()))
-				file->read(&c, 1);
+			while (c!='\n' && c!='\r' && file->readByte(c)) {}
 		}
 		else if (!core::isspace(c))
 			token.push_back(c);
@@ -247,21 +247,16 @@ void CImageLoaderPPM::getNextToken(io::IReadFile* file, std::string& token) cons
 
 
 //! skip to next token (skip whitespace)
-void CImageLoaderPPM::skipToNextToken(io::IReadFile* file) const
+void CImageLoaderPPM::skipToNextToken(io::CBufferedReadFile* file) const
 {
-	int8_t c;
-	while(file->getPos()<file->getSize())
+	uint8_t c;
+	// stops in front of the first character of the token
+	while(file->peekByte(c) && (c=='#' || core::isspace(c)))
 	{
-		file->read(&c, 1);
+		file->readByte(c);
 		if (c=='#')
 		{
-			while (c!='\n' && c!='\r' && (file->getPos()<file->getSize()))
-				file->read(&c, 1);
-		}
-		else if (!core::isspace(c))
-		{
-			file->seek(-1, true); // put back
-			break;
+			while (c!='\n' && c!='\r' && file->readByte(c)) {}
 		}
 	}
 }
@@ -10,6 +10,7 @@
 #ifdef _IRR_COMPILE_WITH_PPM_LOADER_
 
 #include "IImageLoader.h"
+#include "CBufferedReadFile.h"
 #include <string>
 
 
@@ -41,9 +42,9 @@ public:
 
 private:
 	//! read the next token from file
-	void getNextToken(io::IReadFile* file, std::string& token) const;
+	void getNextToken(io::CBufferedReadFile* file, std::string& token) const;
 	//! skip to next token (skip whitespace)
-	void skipToNextToken(io::IReadFile* file) const;
+	void skipToNextToken(io::CBufferedReadFile* file) const;
 };
 
 } // end namespace video
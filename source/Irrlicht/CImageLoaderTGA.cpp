@@ -28,7 +28,7 @@ bool CImageLoaderTGA::isALoadableFileExtension(const io::path& filename) const
 
 
 //! loads a compressed tga.
-uint8_t *CImageLoaderTGA::loadCompressedImage(io::IReadFile *file, const STGAHeader& header) const
+uint8_t *CImageLoaderTGA::loadCompressedImage(io::CBufferedReadFile *file, const STGAHeader& header) const
 {
 	// This was written and sent in by Jon Pry, thank you very much!
 	// I only changed the formatting a little bit.
@@ -41,7 +41,7 @@ uint8_t *CImageLoaderTGA::loadCompressedImage(io::IReadFile *file, const STGAHea
 	while(currentByte < imageSize)
 	{
 		uint8_t chunkheader = 0;
-		file->read(&chunkheader, sizeof(uint8_t)); // Read The Chunk's Header
+		file->readByte(chunkheader); // Read The Chunk's Header
 
 		if(chunkheader < 128) // If The Chunk Is A 'RAW' Chunk
 		{
@@ -154,8 +154,9 @@ std::vector<CImageData*> CImageLoaderTGA::loadImage(io::IReadFile* file) const
 	else
 	if(header.ImageType == 10)
 	{
-		// Runlength encoded RGB images
-		data = loadCompressedImage(file, header);
+		// Runlength encoded RGB images, a byte of header and a pixel or a few per chunk
+		io::CBufferedReadFile buffered(file);
+		data = loadCompressedImage(&buffered, header);
 	}
 	else
 	{
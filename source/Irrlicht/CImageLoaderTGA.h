@@ -8,6 +8,7 @@
 #include "IrrCompileConfig.h"
 
 #include "IImageLoader.h"
+#include "CBufferedReadFile.h"
 
 
 namespace irr
@@ -70,7 +71,7 @@ public:
 private:
 
 	//! loads a compressed tga. Was written and sent in by Jon Pry, thank you very much!
-	uint8_t* loadCompressedImage(io::IReadFile *file, const STGAHeader& header) const;
+	uint8_t* loadCompressedImage(io::CBufferedReadFile *file, const STGAHeader& header) const;
 };
 
 #endif // compiled with loader
@@ -0,0 +1,187 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageWriterDDS.h"
+
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+
+#include "CImageLoaderDDS.h"
+#include "CBlockCompressor.h"
+#include "EImageWriterEnums.h"
+#include "IWriteFile.h"
+#include "os.h"
+
+#include <string.h>
+#include <stdio.h>
+
+namespace irr
+{
+namespace video
+{
+
+IImageWriter* createImageWriterDDS()
+{
+	return new CImageWriterDDS;
+}
+
+CImageWriterDDS::CImageWriterDDS()
+{
+#ifdef _DEBUG
+	setDebugName("CImageWriterDDS");
+#endif
+}
+
+bool CImageWriterDDS::isAWriteableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension ( filename, "dds" );
+}
+
+namespace
+{
+    ECOLOR_FORMAT pickBlockFormat(const ECOLOR_FORMAT& srcFormat, const uint32_t& param)
+    {
+        switch (param&EDWF_FORMAT_MASK)
+        {
+            case EDWF_BC1:
+                return ECF_RGB_BC1;
+            case EDWF_BC1_ALPHA:
+                return ECF_RGBA_BC1;
+            case EDWF_BC2:
+                return ECF_RGBA_BC2;
+            case EDWF_BC3:
+                return ECF_RGBA_BC3;
+            case EDWF_BC4:
+                return ECF_R_BC4;
+            case EDWF_BC5:
+                return ECF_RG_BC5;
+            default:
+                break;
+        }
+
+        switch (srcFormat)
+        {
+            case ECF_R8:
+                return ECF_R_BC4;
+            case ECF_R8G8:
+                return ECF_RG_BC5;
+            case ECF_A1R5G5B5:
+            case ECF_A8R8G8B8:
+            case ECF_R8G8B8A8:
+                return ECF_RGBA_BC3;
+            default:
+                return ECF_RGB_BC1;
+        }
+    }
+
+    bool getFourCC(const ECOLOR_FORMAT& blockFormat, char outFourCC[4])
+    {
+        const char* fourCC;
+        switch (blockFormat)
+        {
+            case ECF_RGB_BC1:
+            case ECF_RGBA_BC1:
+                fourCC = "DXT1";
+                break;
+            case ECF_RGBA_BC2:
+                fourCC = "DXT3";
+                break;
+            case ECF_RGBA_BC3:
+                fourCC = "DXT5";
+                break;
+            case ECF_R_BC4:
+                fourCC = "ATI1";
+                break;
+            case ECF_RG_BC5:
+                fourCC = "ATI2";
+                break;
+            default:
+                return false;
+        }
+        memcpy(outFourCC,fourCC,4);
+        return true;
+    }
+}
+
+bool CImageWriterDDS::writeImage(io::IWriteFile *file, IImage *image,uint32_t param) const
+{
+    if (!file || !image)
+        return false;
+
+    const core::dimension2d<uint32_t>& dim = image->getDimension();
+    if (dim.Width==0 || dim.Height==0)
+        return false;
+
+    const ECOLOR_FORMAT srcFormat = image->getColorFormat();
+
+    ECOLOR_FORMAT blockFormat;
+    const uint8_t* blocks;
+    uint8_t* compressed = NULL;
+    size_t blockDataSize;
+    if (isFormatCompressed(srcFormat))
+    {
+        blockFormat = srcFormat;
+        blocks = reinterpret_cast<const uint8_t*>(image->getData());
+        blockDataSize = CBlockCompressor::getCompressedSize(blockFormat,dim.Width,dim.Height);
+    }
+    else
+    {
+        blockFormat = pickBlockFormat(srcFormat,param);
+        if (!CBlockCompressor::isSourceFormatSupported(srcFormat))
+        {
+            os::Printer::log("DDS writer: unsupported source color format", ELL_ERROR);
+            return false;
+        }
+
+        blockDataSize = CBlockCompressor::getCompressedSize(blockFormat,dim.Width,dim.Height);
+        compressed = (uint8_t*)malloc(blockDataSize);
+
+        const CBlockCompressor::E_COMPRESSION_QUALITY quality = (param&EDWF_HIGH_QUALITY) ? CBlockCompressor::ECQ_HIGH:CBlockCompressor::ECQ_FAST;
+        const bool logStatistics = (param&EDWF_LOG_STATISTICS)!=0u;
+        CBlockCompressor::SCompressionStatistics stats;
+        if (!CBlockCompressor::compress(image->getData(),srcFormat,dim.Width,dim.Height,image->getPitch(),compressed,blockFormat,quality,0,logStatistics ? &stats:NULL))
+        {
+            free(compressed);
+            return false;
+        }
+        blocks = compressed;
+
+        if (logStatistics)
+        {
+            char tmpbuf[256];
+            sprintf(tmpbuf,"DDS writer: compressed %ux%u image at %.2f MTexels/s, PSNR %.2f dB",dim.Width,dim.Height,stats.megaTexelsPerSecond,stats.PSNR);
+            os::Printer::log(tmpbuf, ELL_INFORMATION);
+        }
+    }
+
+    ddsBuffer header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,"DDS ",4);
+    header.size = 124;
+    header.flags = 0x1|0x2|0x4|0x1000|0x80000; //DDSD_CAPS|DDSD_HEIGHT|DDSD_WIDTH|DDSD_PIXELFORMAT|DDSD_LINEARSIZE
+    header.height = dim.Height;
+    header.width = dim.Width;
+    header.linearSize = blockDataSize;
+    header.pixelFormat.size = 32;
+    header.pixelFormat.flags = 0x4; //DDPF_FOURCC
+    if (blockFormat==ECF_RGBA_BC1)
+        header.pixelFormat.flags |= 0x1; //DDPF_ALPHAPIXELS
+    header.caps.caps1 = 0x1000; //DDSCAPS_TEXTURE
+
+    bool success = getFourCC(blockFormat,reinterpret_cast<char*>(&header.pixelFormat.fourCC));
+    if (success)
+    {
+        const size_t headerSize = sizeof(header)-sizeof(header.data);
+        success = file->write(&header,headerSize)==int32_t(headerSize);
+        success = success && file->write(blocks,blockDataSize)==int32_t(blockDataSize);
+    }
+
+    if (compressed)
+        free(compressed);
+    return success;
+}
+
+} // namespace video
+} // namespace irr
+
+#endif // _IRR_COMPILE_WITH_DDS_WRITER_
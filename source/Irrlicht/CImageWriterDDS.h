@@ -0,0 +1,38 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef _C_IMAGE_WRITER_DDS_H_INCLUDED__
+#define _C_IMAGE_WRITER_DDS_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+
+#include "IImageWriter.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Writes block compressed DDS files, uncompressed images get encoded with CBlockCompressor.
+/** The `param` is an E_DDS_WRITER_FORMAT OR-ed with E_DDS_WRITER_FLAGS. */
+class CImageWriterDDS : public IImageWriter
+{
+public:
+	//! constructor
+	CImageWriterDDS();
+
+	//! return true if this writer can write a file with the given extension
+	virtual bool isAWriteableFileExtension(const io::path& filename) const;
+
+	//! write image to file
+	virtual bool writeImage(io::IWriteFile *file, IImage *image,uint32_t param) const;
+};
+
+} // namespace video
+} // namespace irr
+
+#endif // _IRR_COMPILE_WITH_DDS_WRITER_
+#endif
@@ -26,8 +26,9 @@
 #include <time.h>
 #endif
 
-// for now we assume all other terminal types are VT100
-#ifndef _IRR_WINDOWS_NT_CONSOLE_
+// for now we assume all other terminal types are VT100,
+// the server build writes plain output since it usually goes to a log
+#if !defined(_IRR_WINDOWS_NT_CONSOLE_) && !defined(BAW_SERVER)
 #define _IRR_VT100_CONSOLE_
 #endif
 
@@ -10,6 +10,7 @@
 #include "IrrCompileConfig.h"
 #include "CTimer.h"
 #include "CLogger.h"
+#include "CJobSystem.h"
 #include "irrString.h"
 
 namespace irr
@@ -17,7 +18,7 @@ namespace irr
 //! constructor
 CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 : IrrlichtDevice(), VideoDriver(0), SceneManager(0),
-	Timer(0), CursorControl(0), UserReceiver(params.EventReceiver),
+	Timer(0), JobSystem(0), CursorControl(0), UserReceiver(params.EventReceiver),
 	Logger(0), Operator(0), FileSystem(0),
 	InputReceivingSceneManager(0), VideoModeList(0),
 	CreationParams(params), Close(false)
@@ -38,6 +39,9 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 
 	os::Printer::Logger = Logger;
 
+	JobSystem = new CJobSystem(params.JobWorkerCount);
+	CJobSystem::setGlobal(JobSystem);
+
 	FileSystem = io::createFileSystem();
 	VideoModeList = new video::CVideoModeList();
 
@@ -60,6 +64,11 @@ CIrrDeviceStub::~CIrrDeviceStub()
 	if (Timer)
 		Timer->drop();
 
+	//! let the job system go only if no newer device replaced it already
+	if (CJobSystem::peekGlobal()==JobSystem)
+		CJobSystem::setGlobal(NULL);
+	JobSystem->drop();
+
 	if (Logger->drop())
 		os::Printer::Logger = 0;
 }
@@ -106,6 +115,13 @@ ITimer* CIrrDeviceStub::getTimer()
 }
 
 
+//! Returns the job system created with the device.
+CJobSystem* CIrrDeviceStub::getJobSystem()
+{
+	return JobSystem;
+}
+
+
 //! Returns the version of the engine.
 const char* CIrrDeviceStub::getVersion() const
 {
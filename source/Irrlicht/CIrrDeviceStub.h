@@ -66,6 +66,9 @@ namespace irr
             //! Returns a pointer to the ITimer object. With it the current Time can be received.
             virtual ITimer* getTimer();
 
+            //! Returns the job system created with the device.
+            virtual CJobSystem* getJobSystem();
+
             //! Returns the version of the engine.
             virtual const char* getVersion() const;
 
@@ -125,6 +128,7 @@ namespace irr
             video::IVideoDriver* VideoDriver;
             scene::ISceneManager* SceneManager;
             ITimer* Timer;
+            CJobSystem* JobSystem;
             gui::ICursorControl* CursorControl;
             IEventReceiver* UserReceiver;
             CLogger* Logger;
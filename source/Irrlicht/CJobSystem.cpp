@@ -0,0 +1,329 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CJobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace irr
+{
+
+namespace
+{
+
+//! set on worker threads only
+thread_local const CJobSystem* tlsWorkerOwner = NULL;
+thread_local uint32_t tlsWorkerIndex = 0;
+
+std::mutex globalJobSystemLock;
+CJobSystem* globalJobSystem = NULL;
+
+uint64_t nanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+}
+
+const uint32_t CJobSystem::AutoWorkerCount;
+
+CJobSystem::CJobSystem(uint32_t workerCount)
+    :   QueuedJobs(0u), Stopping(false), SleepingWorkers(0u), WaitingThreads(0u),
+        StatJobsSubmitted(0u), StatJobsExecuted(0u), StatJobsStolen(0u), StatFailedSteals(0u),
+        StatWorkerSleeps(0u), StatParallelForCalls(0u), StatQueueLatencyNs(0u)
+{
+    #ifdef _DEBUG
+    setDebugName("CJobSystem");
+    #endif
+
+    if (workerCount==AutoWorkerCount)
+        workerCount = std::max(std::thread::hardware_concurrency(),1u)-1u;
+    WorkerCount = workerCount;
+
+    for (uint32_t i=0; i<=WorkerCount; i++)
+        Queues.push_back(new SQueue());
+
+    Workers.reserve(WorkerCount);
+    for (uint32_t i=0; i<WorkerCount; i++)
+        Workers.push_back(std::thread(&CJobSystem::workerMain,this,i));
+}
+
+CJobSystem::~CJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> guard(SleepLock);
+        Stopping = true;
+    }
+    WorkAvailable.notify_all();
+    for (auto it=Workers.begin(); it!=Workers.end(); it++)
+        it->join();
+
+    //! without workers nobody may have waited for some of the jobs
+    while (CJob* job = findJob(WorkerCount))
+        execute(job);
+
+    for (size_t i=0; i<Queues.size(); i++)
+        delete Queues[i];
+}
+
+CJobSystem::CJob* CJobSystem::submit(const JobFunc& func, CJob* const* dependencies, const uint32_t& dependencyCount)
+{
+    CJob* job = new CJob(func);
+    StatJobsSubmitted.fetch_add(1u,std::memory_order_relaxed);
+
+    for (uint32_t i=0; i<dependencyCount; i++)
+    {
+        CJob* dependency = dependencies[i];
+        if (!dependency)
+            continue;
+
+        std::lock_guard<std::mutex> guard(dependency->ContinuationLock);
+        if (dependency->Done.load(std::memory_order_relaxed))
+            continue;
+        job->grab();
+        job->PendingDependencies++;
+        dependency->Continuations.push_back(job);
+    }
+
+    if (--job->PendingDependencies==0u)
+        enqueue(job);
+    return job;
+}
+
+void CJobSystem::wait(CJob* job)
+{
+    const uint32_t queueIndex = getQueueIndex();
+    while (!job->isDone())
+    {
+        CJob* other = findJob(queueIndex);
+        if (other)
+        {
+            execute(other);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(WaitLock);
+        WaitingThreads++;
+        JobFinished.wait(lock,[&]() {return job->Done.load()||QueuedJobs.load()>0u;});
+        WaitingThreads--;
+    }
+}
+
+void CJobSystem::parallelFor_impl(const uint32_t& count, const uint32_t& maxThreads, void (*func)(void*,const uint32_t&), void* functor)
+{
+    StatParallelForCalls.fetch_add(1u,std::memory_order_relaxed);
+
+    uint32_t threadCount = WorkerCount+1u;
+    if (maxThreads&&maxThreads<threadCount)
+        threadCount = maxThreads;
+    if (threadCount>count)
+        threadCount = count;
+
+    if (threadCount<=1u)
+    {
+        for (uint32_t i=0; i<count; i++)
+            func(functor,i);
+        return;
+    }
+
+    std::atomic<uint32_t> nextIndex(0u);
+    auto loop = [&]()
+    {
+        for (uint32_t i=nextIndex++; i<count; i=nextIndex++)
+            func(functor,i);
+    };
+
+    //! helpers which start after the caller took the last index return straight away
+    std::vector<CJob*> helpers(threadCount-1u);
+    for (size_t i=0; i<helpers.size(); i++)
+        helpers[i] = submit(loop);
+    loop();
+    for (size_t i=0; i<helpers.size(); i++)
+    {
+        wait(helpers[i]);
+        helpers[i]->drop();
+    }
+}
+
+CJobSystem::SStatistics CJobSystem::getStatistics() const
+{
+    SStatistics retval;
+    retval.jobsSubmitted = StatJobsSubmitted.load(std::memory_order_relaxed);
+    retval.jobsExecuted = StatJobsExecuted.load(std::memory_order_relaxed);
+    retval.jobsStolen = StatJobsStolen.load(std::memory_order_relaxed);
+    retval.failedSteals = StatFailedSteals.load(std::memory_order_relaxed);
+    retval.workerSleeps = StatWorkerSleeps.load(std::memory_order_relaxed);
+    retval.parallelForCalls = StatParallelForCalls.load(std::memory_order_relaxed);
+    retval.queueLatencyNs = StatQueueLatencyNs.load(std::memory_order_relaxed);
+    return retval;
+}
+
+void CJobSystem::resetStatistics()
+{
+    StatJobsSubmitted = 0u;
+    StatJobsExecuted = 0u;
+    StatJobsStolen = 0u;
+    StatFailedSteals = 0u;
+    StatWorkerSleeps = 0u;
+    StatParallelForCalls = 0u;
+    StatQueueLatencyNs = 0u;
+}
+
+CJobSystem* CJobSystem::getGlobal()
+{
+    std::lock_guard<std::mutex> guard(globalJobSystemLock);
+    if (!globalJobSystem)
+        globalJobSystem = new CJobSystem();
+    return globalJobSystem;
+}
+
+CJobSystem* CJobSystem::peekGlobal()
+{
+    std::lock_guard<std::mutex> guard(globalJobSystemLock);
+    return globalJobSystem;
+}
+
+void CJobSystem::setGlobal(CJobSystem* jobSystem)
+{
+    if (jobSystem)
+        jobSystem->grab();
+
+    CJobSystem* previous;
+    {
+        std::lock_guard<std::mutex> guard(globalJobSystemLock);
+        previous = globalJobSystem;
+        globalJobSystem = jobSystem;
+    }
+    //! outside the lock, destroying it runs the jobs still queued which may need getGlobal()
+    if (previous)
+        previous->drop();
+}
+
+uint32_t CJobSystem::getQueueIndex() const
+{
+    return tlsWorkerOwner==this ? tlsWorkerIndex:WorkerCount;
+}
+
+void CJobSystem::enqueue(CJob* job)
+{
+    job->grab();
+    job->ReadyTime = nanoseconds();
+
+    SQueue* queue = Queues[getQueueIndex()];
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->jobs.push_back(job);
+    }
+    QueuedJobs++;
+
+    if (SleepingWorkers.load()>0u)
+    {
+        std::lock_guard<std::mutex> guard(SleepLock);
+        WorkAvailable.notify_one();
+    }
+    if (WaitingThreads.load()>0u)
+    {
+        std::lock_guard<std::mutex> guard(WaitLock);
+        JobFinished.notify_all();
+    }
+}
+
+CJobSystem::CJob* CJobSystem::findJob(const uint32_t& queueIndex)
+{
+    if (QueuedJobs.load()==0u)
+        return NULL;
+
+    if (queueIndex<WorkerCount)
+    {
+        SQueue* own = Queues[queueIndex];
+        std::lock_guard<std::mutex> guard(own->lock);
+        if (!own->jobs.empty())
+        {
+            CJob* job = own->jobs.back();
+            own->jobs.pop_back();
+            QueuedJobs--;
+            return job;
+        }
+    }
+
+    //! the shared queue first, then the other workers' queues starting after our own
+    for (uint32_t i=0; i<=WorkerCount; i++)
+    {
+        const uint32_t victimIndex = i ? (queueIndex+i)%WorkerCount:WorkerCount;
+        if (victimIndex==queueIndex&&queueIndex<WorkerCount)
+            continue;
+
+        SQueue* victim = Queues[victimIndex];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (victim->jobs.empty())
+            continue;
+
+        CJob* job = victim->jobs.front();
+        victim->jobs.pop_front();
+        QueuedJobs--;
+        if (victimIndex<WorkerCount)
+            StatJobsStolen.fetch_add(1u,std::memory_order_relaxed);
+        return job;
+    }
+
+    StatFailedSteals.fetch_add(1u,std::memory_order_relaxed);
+    return NULL;
+}
+
+void CJobSystem::execute(CJob* job)
+{
+    StatQueueLatencyNs.fetch_add(nanoseconds()-job->ReadyTime,std::memory_order_relaxed);
+
+    job->Func();
+    //! let go of whatever the function captured before anyone sees the job as done
+    job->Func = JobFunc();
+
+    std::vector<CJob*> continuations;
+    {
+        std::lock_guard<std::mutex> guard(job->ContinuationLock);
+        job->Done.store(true);
+        continuations.swap(job->Continuations);
+    }
+    for (size_t i=0; i<continuations.size(); i++)
+    {
+        if (--continuations[i]->PendingDependencies==0u)
+            enqueue(continuations[i]);
+        continuations[i]->drop();
+    }
+    StatJobsExecuted.fetch_add(1u,std::memory_order_relaxed);
+
+    if (WaitingThreads.load()>0u)
+    {
+        std::lock_guard<std::mutex> guard(WaitLock);
+        JobFinished.notify_all();
+    }
+    job->drop();
+}
+
+void CJobSystem::workerMain(const uint32_t index)
+{
+    tlsWorkerOwner = this;
+    tlsWorkerIndex = index;
+
+    while (true)
+    {
+        CJob* job = findJob(index);
+        if (job)
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(SleepLock);
+        SleepingWorkers++;
+        StatWorkerSleeps.fetch_add(1u,std::memory_order_relaxed);
+        WorkAvailable.wait(lock,[&]() {return QueuedJobs.load()>0u||Stopping.load();});
+        SleepingWorkers--;
+        if (Stopping.load()&&QueuedJobs.load()==0u)
+            return;
+    }
+}
+
+} // end namespace irr
@@ -39,55 +39,28 @@ CLimitReadFile::~CLimitReadFile()
 //! returns how much was read
 int32_t CLimitReadFile::read(void* buffer, uint32_t sizeToRead)
 {
-#if 1
-	if (0 == File)
-		return 0;
-
-	int32_t r = AreaStart + Pos;
-	int32_t toRead = core::s32_min(AreaEnd, r + sizeToRead) - core::s32_max(AreaStart, r);
-	if (toRead < 0)
-		return 0;
-	File->seek(r);
-	r = File->read(buffer, toRead);
+	const size_t r = readAt(Pos, buffer, sizeToRead);
 	Pos += r;
-	return r;
-#else
-	const size_t pos = File->getPos();
+	return int32_t(r);
+}
 
-	if (pos >= AreaEnd)
-		return 0;
 
-	if (pos + (size_t)sizeToRead >= AreaEnd)
-		sizeToRead = AreaEnd - pos;
+size_t CLimitReadFile::readAt(const size_t& offset, void* buffer, const size_t& sizeToRead)
+{
+	if (0 == File || offset >= getSize())
+		return 0;
 
-	return File->read(buffer, sizeToRead);
-#endif
+	return File->readAt(AreaStart + offset, buffer, core::min_(sizeToRead, getSize() - offset));
 }
 
 
 //! changes position in file, returns true if successful
 bool CLimitReadFile::seek(const size_t& finalPos, bool relativeMovement)
 {
-#if 1
-	Pos = core::s32_clamp(finalPos + (relativeMovement ? Pos : 0 ), 0, AreaEnd - AreaStart);
+	// relative movements can be negative, they come in wrapped around
+	const int64_t target = int64_t(finalPos) + (relativeMovement ? int64_t(Pos) : 0);
+	Pos = target < 0 ? 0 : core::min_(size_t(target), getSize());
 	return true;
-#else
-	const size_t pos = File->getPos();
-
-	if (relativeMovement)
-	{
-		if (pos + finalPos > AreaEnd)
-			finalPos = AreaEnd - pos;
-	}
-	else
-	{
-		finalPos += AreaStart;
-		if (finalPos > AreaEnd)
-			return false;
-	}
-
-	return File->seek(finalPos, relativeMovement);
-#endif
 }
 
 
@@ -101,11 +74,7 @@ size_t CLimitReadFile::getSize() const
 //! returns where in the file we are.
 size_t CLimitReadFile::getPos() const
 {
-#if 1
 	return Pos;
-#else
-	return File->getPos() - AreaStart;
-#endif
 }
 
 
@@ -20,6 +20,8 @@ namespace io
 		and may only read until a certain file position.
 		This can be useful, for example for reading uncompressed files
 		in an archive (zip, tar).
+		It only ever reads the archive with readAt, so every file handed
+		out for the same archive can be read from a different thread.
 	!*/
 	class CLimitReadFile : public IReadFile
 	{
@@ -32,6 +34,9 @@ namespace io
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
 
+            //! reads relative to the start of the area, does not touch the position
+            virtual size_t readAt(const size_t& offset, void* buffer, const size_t& sizeToRead);
+
             //! changes position in file, returns true if successful
             //! if relativeMovement==true, the pos is changed relative to current pos,
             //! otherwise from begin of file
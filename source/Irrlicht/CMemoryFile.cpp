@@ -37,18 +37,18 @@ CMemoryReadFile::CMemoryReadFile(const void* memory, const size_t& len, const io
 //! returns how much was read
 int32_t CMemoryReadFile::read(void* buffer, uint32_t sizeToRead)
 {
-	int32_t amount = static_cast<int32_t>(sizeToRead);
-	if (Pos + amount > Len)
-		amount -= Pos + amount - Len;
+	const size_t amount = readAt(Pos, buffer, sizeToRead);
+	Pos += amount;
+	return static_cast<int32_t>(amount);
+}
 
-	if (amount <= 0)
+size_t CMemoryReadFile::readAt(const size_t& offset, void* buffer, const size_t& sizeToRead)
+{
+	if (offset >= Len)
 		return 0;
 
-	int8_t* p = (int8_t*)Buffer;
-	memcpy(buffer, p + Pos, amount);
-
-	Pos += amount;
-
+	const size_t amount = core::min_(sizeToRead, Len - offset);
+	memcpy(buffer, (const int8_t*)Buffer + offset, amount);
 	return amount;
 }
 
@@ -88,6 +88,9 @@ namespace io
 
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
+
+            //! copies from anywhere in the memory without moving the position
+            virtual size_t readAt(const size_t& offset, void* buffer, const size_t& sizeToRead);
 	};
 
 	class CMemoryWriteFile : public IWriteFile, public CMemoryFile<void*>
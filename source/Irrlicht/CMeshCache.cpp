@@ -5,12 +5,40 @@
 #include "CMeshCache.h"
 #include "IAnimatedMesh.h"
 #include "IMesh.h"
+#include <algorithm>
+#include <unordered_set>
 
 namespace irr
 {
 namespace scene
 {
 
+//! sums the sizes of the distinct buffers the mesh's buffers read from
+template<class T>
+static uint64_t calcMeshByteSize(const T* mesh)
+{
+	std::unordered_set<const core::IBuffer*> buffers;
+	for (uint32_t i=0; i<mesh->getMeshBufferCount(); i++)
+	{
+		const auto* meshbuffer = mesh->getMeshBuffer(i);
+		if (!meshbuffer||!meshbuffer->getMeshDataAndFormat())
+			continue;
+
+		const auto* layout = meshbuffer->getMeshDataAndFormat();
+		if (layout->getIndexBuffer())
+			buffers.insert(layout->getIndexBuffer());
+		for (size_t j=0; j<EVAI_COUNT; j++)
+		{
+			if (layout->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)j))
+				buffers.insert(layout->getMappedBuffer((E_VERTEX_ATTRIBUTE_ID)j));
+		}
+	}
+
+	uint64_t size = 0;
+	for (auto it=buffers.begin(); it!=buffers.end(); it++)
+		size += (*it)->getSize();
+	return size;
+}
 
 
 //! adds a mesh to the list
@@ -18,12 +46,18 @@ template<class T>
 void CMeshCache<T>::addMesh(const io::path& filename, T* mesh)
 {
 	mesh->grab();
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	addEntry(filename, mesh);
+	evictToBudget();
+}
 
-	MeshEntry<T> e ( filename );
-	e.Mesh = mesh;
 
-	Meshes.push_back(e);
-	Meshes.sort();
+//! adds a mesh to the list with the caller's reference, leaving the budget to the next addMesh()
+template<class T>
+void CMeshCache<T>::adoptMeshWithoutEviction(const io::path& filename, T* mesh)
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	addEntry(filename, mesh);
 }
 
 
@@ -34,13 +68,13 @@ void CMeshCache<T>::removeMesh(const T* const mesh)
 	if ( !mesh )
 		return;
 
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 
 	for (uint32_t i=0; i<Meshes.size(); ++i)
 	{
 		if (Meshes[i].Mesh == mesh)
 		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
+			removeEntry(i);
 			return;
 		}
 	}
@@ -51,6 +85,7 @@ void CMeshCache<T>::removeMesh(const T* const mesh)
 template<class T>
 uint32_t CMeshCache<T>::getMeshCount() const
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	return Meshes.size();
 }
 
@@ -59,6 +94,7 @@ uint32_t CMeshCache<T>::getMeshCount() const
 template<class T>
 int32_t CMeshCache<T>::getMeshIndex(const T* const mesh) const
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	for (uint32_t i=0; i<Meshes.size(); ++i)
 	{
 		if (Meshes[i].Mesh == mesh)
@@ -73,6 +109,7 @@ int32_t CMeshCache<T>::getMeshIndex(const T* const mesh) const
 template<class T>
 T* CMeshCache<T>::getMeshByIndex(uint32_t number)
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	if (number >= Meshes.size())
 		return 0;
 
@@ -84,9 +121,17 @@ T* CMeshCache<T>::getMeshByIndex(uint32_t number)
 template<class T>
 T* CMeshCache<T>::getMeshByName(const io::path& name)
 {
-	MeshEntry<T> e ( name );
-	int32_t id = Meshes.binary_search(e);
-	return (id != -1) ? Meshes[id].Mesh : 0;
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	int32_t id = findEntry(name);
+	if (id == -1)
+	{
+		Statistics.Misses++;
+		return 0;
+	}
+
+	Statistics.Hits++;
+	Meshes[id].LastUsed = UseCounter++;
+	return Meshes[id].Mesh;
 }
 
 
@@ -94,6 +139,7 @@ T* CMeshCache<T>::getMeshByName(const io::path& name)
 template<class T>
 const char* CMeshCache<T>::getMeshName(uint32_t index) const
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	if (index >= Meshes.size())
 		return NULL;
 
@@ -108,6 +154,7 @@ const char* CMeshCache<T>::getMeshName(const T* const mesh) const
 	if (!mesh)
 		return NULL;
 
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	for (uint32_t i=0; i<Meshes.size(); ++i)
 	{
 		if (Meshes[i].Mesh == mesh)
@@ -121,11 +168,16 @@ const char* CMeshCache<T>::getMeshName(const T* const mesh) const
 template<class T>
 bool CMeshCache<T>::renameMesh(uint32_t index, const io::path& name)
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	if (index >= Meshes.size())
 		return false;
 
+	const std::string oldName = Meshes[index].NamedPath.getInternalName().c_str();
 	Meshes[index].NamedPath.setPath(name);
-	Meshes.sort();
+	auto found = MeshIndices.find(oldName);
+	if (found!=MeshIndices.end() && found->second==index)
+		indexNewestEntry(oldName);
+	MeshIndices[Meshes[index].NamedPath.getInternalName().c_str()] = index;
 	return true;
 }
 
@@ -134,17 +186,11 @@ bool CMeshCache<T>::renameMesh(uint32_t index, const io::path& name)
 template<class T>
 bool CMeshCache<T>::renameMesh(const T* const mesh, const io::path& name)
 {
-	for (uint32_t i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh)
-		{
-			Meshes[i].NamedPath.setPath(name);
-			Meshes.sort();
-			return true;
-		}
-	}
+	int32_t index = getMeshIndex(mesh);
+	if (index == -1)
+		return false;
 
-	return false;
+	return renameMesh(index,name);
 }
 
 
@@ -152,7 +198,8 @@ bool CMeshCache<T>::renameMesh(const T* const mesh, const io::path& name)
 template<class T>
 bool CMeshCache<T>::isMeshLoaded(const io::path& name)
 {
-	return getMeshByName(name) != 0;
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	return findEntry(name) != -1;
 }
 
 
@@ -160,26 +207,179 @@ bool CMeshCache<T>::isMeshLoaded(const io::path& name)
 template<class T>
 void CMeshCache<T>::clear()
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
 	for (uint32_t i=0; i<Meshes.size(); ++i)
 		Meshes[i].Mesh->drop();
 
 	Meshes.clear();
+	MeshIndices.clear();
+	MemoryUsage = 0;
 }
 
 //! Clears all meshes that are held in the mesh cache but not used anywhere else.
 template<class T>
 void CMeshCache<T>::clearUnusedMeshes()
 {
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	// backwards, so the entries moved into the holes have been checked already
+	for (uint32_t i=Meshes.size(); i>0; --i)
+	{
+		if (Meshes[i-1].Mesh->getReferenceCount() == 1)
+			removeEntry(i-1);
+	}
+}
+
+
+//! Sets how many bytes of buffer data the cached meshes may hold, 0 for unlimited.
+template<class T>
+void CMeshCache<T>::setMemoryBudget(const uint64_t& bytes)
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	MemoryBudget = bytes;
+	evictToBudget();
+}
+
+
+//! Returns the budget set with setMemoryBudget(), 0 if unlimited.
+template<class T>
+uint64_t CMeshCache<T>::getMemoryBudget() const
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	return MemoryBudget;
+}
+
+
+//! Returns the summed size of all cached meshes in bytes.
+template<class T>
+uint64_t CMeshCache<T>::getMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	return MemoryUsage;
+}
+
+
+//! Returns the hit, miss and eviction counters.
+template<class T>
+SMeshCacheStatistics CMeshCache<T>::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	return Statistics;
+}
+
+
+//! Zeroes the hit, miss and eviction counters.
+template<class T>
+void CMeshCache<T>::resetStatistics()
+{
+	std::lock_guard<std::mutex> lock(MeshesMutex);
+	Statistics = SMeshCacheStatistics();
+}
+
+
+//! appends an entry for the mesh, holding a reference the caller already took, MeshesMutex must be held
+template<class T>
+void CMeshCache<T>::addEntry(const io::path& filename, T* mesh)
+{
+	MeshEntry<T> e ( filename );
+	e.Mesh = mesh;
+	e.LastUsed = UseCounter++;
+	e.ByteSize = calcMeshByteSize(mesh);
+
+	// the name lookup returns the newest mesh added under a name
+	MeshIndices[e.NamedPath.getInternalName().c_str()] = Meshes.size();
+	Meshes.push_back(e);
+	MemoryUsage += e.ByteSize;
+}
+
+
+//! index of the entry or -1, MeshesMutex must be held
+template<class T>
+int32_t CMeshCache<T>::findEntry(const io::path& name) const
+{
+	auto found = MeshIndices.find(io::SNamedPath::PathToName(name).c_str());
+	return found!=MeshIndices.end() ? (int32_t)found->second : -1;
+}
+
+
+//! drops the mesh and fills the hole with the last entry, MeshesMutex must be held
+template<class T>
+void CMeshCache<T>::removeEntry(uint32_t index)
+{
+	const std::string name = Meshes[index].NamedPath.getInternalName().c_str();
+	auto found = MeshIndices.find(name);
+	const bool wasIndexed = found!=MeshIndices.end() && found->second==index;
+	MemoryUsage -= Meshes[index].ByteSize;
+	Meshes[index].Mesh->drop();
+
+	const uint32_t last = Meshes.size()-1u;
+	if (index!=last)
+	{
+		Meshes[index] = Meshes[last];
+		found = MeshIndices.find(Meshes[index].NamedPath.getInternalName().c_str());
+		if (found!=MeshIndices.end() && found->second==last)
+			found->second = index;
+	}
+	Meshes.erase(last);
+
+	// older meshes added under the same name become findable again
+	if (wasIndexed)
+		indexNewestEntry(name);
+}
+
+
+//! points the name at the most recently used entry still carrying it, MeshesMutex must be held
+template<class T>
+void CMeshCache<T>::indexNewestEntry(const std::string& name)
+{
+	int32_t newest = -1;
+	for (uint32_t i=0; i<Meshes.size(); ++i)
+	{
+		if (name!=Meshes[i].NamedPath.getInternalName().c_str())
+			continue;
+		if (newest==-1 || Meshes[i].LastUsed>Meshes[newest].LastUsed)
+			newest = i;
+	}
+
+	if (newest==-1)
+		MeshIndices.erase(name);
+	else
+		MeshIndices[name] = newest;
+}
+
+
+//! drops least recently used unreferenced meshes until MemoryUsage fits MemoryBudget, MeshesMutex must be held
+template<class T>
+void CMeshCache<T>::evictToBudget()
+{
+	if (!MemoryBudget || MemoryUsage<=MemoryBudget)
+		return;
+
+	core::array<uint32_t> candidates;
 	for (uint32_t i=0; i<Meshes.size(); ++i)
 	{
 		if (Meshes[i].Mesh->getReferenceCount() == 1)
-		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			--i;
-		}
+			candidates.push_back(i);
+	}
+	std::sort(candidates.pointer(),candidates.pointer()+candidates.size(),
+		[&](const uint32_t& a, const uint32_t& b) {return Meshes[a].LastUsed<Meshes[b].LastUsed;});
+
+	uint64_t usage = MemoryUsage;
+	uint32_t evictCount = 0;
+	while (evictCount<candidates.size() && usage>MemoryBudget)
+		usage -= Meshes[candidates[evictCount++]].ByteSize;
+	candidates.set_used(evictCount);
+
+	// highest index first, so no pending entry gets moved by removeEntry
+	std::sort(candidates.pointer(),candidates.pointer()+candidates.size());
+	for (uint32_t i=evictCount; i>0; --i)
+	{
+		Statistics.Evictions++;
+		Statistics.EvictedBytes += Meshes[candidates[i-1]].ByteSize;
+		removeEntry(candidates[i-1]);
 	}
 }
+
+
 // Instantiate CMeshCache for the supported template type parameters
 template class CMeshCache<ICPUMesh>;
 template class CMeshCache<IGPUMesh>;
@@ -7,6 +7,9 @@
 
 #include "IMeshCache.h"
 #include "irrArray.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace irr
 {
@@ -24,6 +27,7 @@ class CMeshCache : public IMeshCache<T>
         }
 
 	public:
+		CMeshCache() : MemoryBudget(0), MemoryUsage(0), UseCounter(0) {}
 
 		//! Adds a mesh to the internal list of loaded meshes.
 		/** Usually, ISceneManager::getMesh() is called to load a mesh from file.
@@ -38,6 +42,12 @@ class CMeshCache : public IMeshCache<T>
 		\param mesh: Pointer to a mesh which will now be referenced by this name. */
 		virtual void addMesh(const io::path& filename, /*IAnimatedMesh*/T* mesh);
 
+		//! Same as addMesh(), except that the cache takes over the caller's reference instead of grabbing the mesh,
+		//! and meshes over the memory budget are left for the next addMesh() or setMemoryBudget() to evict.
+		/** Lets threads other than the one using the cache publish meshes nobody else has seen yet,
+		reference counting is not thread safe so they must not grab or drop anything the cache holds. */
+		void adoptMeshWithoutEviction(const io::path& filename, T* mesh);
+
 		//! Removes a mesh from the cache.
 		/** After loading a mesh with getMesh(), the mesh can be removed from the cache
 		using this method, freeing a lot of memory. */
@@ -100,7 +110,36 @@ class CMeshCache : public IMeshCache<T>
 		//! Clears all meshes that are held in the mesh cache but not used anywhere else.
 		virtual void clearUnusedMeshes();
 
+		//! Sets how many bytes of buffer data the cached meshes may hold, 0 for unlimited.
+		virtual void setMemoryBudget(const uint64_t& bytes);
+
+		//! Returns the budget set with setMemoryBudget(), 0 if unlimited.
+		virtual uint64_t getMemoryBudget() const;
+
+		//! Returns the summed size of all cached meshes in bytes.
+		virtual uint64_t getMemoryUsage() const;
+
+		//! Returns the hit, miss and eviction counters.
+		virtual SMeshCacheStatistics getStatistics() const;
+
+		//! Zeroes the hit, miss and eviction counters.
+		virtual void resetStatistics();
+
 	protected:
+		//! appends an entry for the mesh, holding a reference the caller already took, MeshesMutex must be held
+		void addEntry(const io::path& filename, T* mesh);
+
+		//! index of the entry or -1, MeshesMutex must be held
+		int32_t findEntry(const io::path& name) const;
+
+		//! drops the mesh and fills the hole with the last entry, MeshesMutex must be held
+		void removeEntry(uint32_t index);
+
+		//! points the name at the most recently used entry still carrying it, MeshesMutex must be held
+		void indexNewestEntry(const std::string& name);
+
+		//! drops least recently used unreferenced meshes until MemoryUsage fits MemoryBudget, MeshesMutex must be held
+		void evictToBudget();
 
         template <class U>
 		struct MeshEntry
@@ -111,6 +150,10 @@ class CMeshCache : public IMeshCache<T>
 			}
 			io::SNamedPath NamedPath;
 			/*IAnimatedMesh*/U* Mesh;
+			//! value of UseCounter when the entry was last added or looked up
+			uint64_t LastUsed;
+			//! bytes of distinct vertex and index buffers, measured on addMesh()
+			uint64_t ByteSize;
 
 			bool operator < (const MeshEntry& other) const
 			{
@@ -118,8 +161,17 @@ class CMeshCache : public IMeshCache<T>
 			}
 		};
 
-		//! loaded meshes
+		//! loaded meshes, unordered
 		core::array< MeshEntry<T> > Meshes;
+		//! internal name to index in Meshes
+		std::unordered_map<std::string,uint32_t> MeshIndices;
+
+		uint64_t MemoryBudget;
+		uint64_t MemoryUsage;
+		uint64_t UseCounter;
+		SMeshCacheStatistics Statistics;
+		//! guards Meshes, asynchronous loads publish into the cache from worker threads
+		mutable std::mutex MeshesMutex;
 };
 
 } // end namespace scene
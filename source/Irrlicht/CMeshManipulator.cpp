@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CMeshManipulator.h"
+#include "CProfiler.h"
 
 #include <vector>
 #include <numeric>
@@ -17,6 +18,8 @@
 #include "os.h"
 #include "CForsythVertexCacheOptimizer.h"
 #include "COverdrawMeshOptimizer.h"
+#include "CQuadricMeshSimplifier.h"
+#include "CJobSystem.h"
 #include "SSkinMeshBuffer.h"
 
 namespace irr
@@ -57,6 +60,7 @@ static inline core::vector3df getAngleWeight(const core::vector3df& v1,
 //! \param mesh: Mesh on which the operation is performed.
 void CMeshManipulator::flipSurfaces(scene::ICPUMeshBuffer* inbuffer) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::flipSurfaces");
 	if (!inbuffer)
 		return;
 
@@ -213,6 +217,7 @@ void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
 /** \param buffer: Mesh buffer on which the operation is performed. */
 void CMeshManipulator::recalculateNormals(IMeshBuffer* buffer, bool smooth, bool angleWeighted) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::recalculateNormals");
 	if (!buffer)
 		return;
 
@@ -495,6 +500,7 @@ void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smo
 //! Recalculates tangents for a tangent mesh buffer
 void CMeshManipulator::recalculateTangents(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::recalculateTangents");
 	if (buffer && (buffer->getVertexType() == video::EVT_TANGENTS))
 	{
 		if (buffer->getIndexType() == video::EIT_16BIT)
@@ -521,6 +527,7 @@ void CMeshManipulator::recalculateTangents(IMesh* mesh, bool recalculateNormals,
 
 ICPUMeshBuffer* CMeshManipulator::createMeshBufferFetchOptimized(const ICPUMeshBuffer* _inbuffer) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshBufferFetchOptimized");
 	if (!_inbuffer || !_inbuffer->getMeshDataAndFormat() || !_inbuffer->getIndices())
 		return NULL;
 
@@ -631,6 +638,7 @@ ICPUMeshBuffer* CMeshManipulator::createMeshBufferFetchOptimized(const ICPUMeshB
 //! Creates a copy of the mesh, which will only consist of unique primitives
 ICPUMeshBuffer* CMeshManipulator::createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshBufferUniquePrimitives");
 	if (!inbuffer)
 		return 0;
     IMeshDataFormatDesc<core::ICPUBuffer>* oldDesc = inbuffer->getMeshDataAndFormat();
@@ -728,6 +736,7 @@ int cmpfunc (const void * a, const void * b)
 //! Creates a copy of a mesh, which will have identical vertices welded together
 ICPUMeshBuffer* CMeshManipulator::createMeshBufferWelded(ICPUMeshBuffer *inbuffer, const bool& reduceIdxBufSize, const bool& makeNewMesh, float tolerance) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshBufferWelded");
     if (!inbuffer)
         return 0;
     IMeshDataFormatDesc<core::ICPUBuffer>* oldDesc = inbuffer->getMeshDataAndFormat();
@@ -943,6 +952,7 @@ ICPUMeshBuffer* CMeshManipulator::createMeshBufferWelded(ICPUMeshBuffer *inbuffe
 
 ICPUMeshBuffer* CMeshManipulator::createOptimizedMeshBuffer(const ICPUMeshBuffer* _inbuffer, const SErrorMetric* _requantErrMetric) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::createOptimizedMeshBuffer");
 	if (!_inbuffer)
 		return NULL;
 	ICPUMeshBuffer* outbuffer = createMeshBufferDuplicate(_inbuffer);
@@ -1125,6 +1135,7 @@ ICPUMeshBuffer* CMeshManipulator::createOptimizedMeshBuffer(const ICPUMeshBuffer
 
 void CMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const SErrorMetric* _errMetric) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::requantizeMeshBuffer");
 	SAttrib newAttribs[EVAI_COUNT];
 	for (size_t i = 0u; i < EVAI_COUNT; ++i)
 		newAttribs[i].vaid = (E_VERTEX_ATTRIBUTE_ID)i;
@@ -1207,6 +1218,7 @@ void CMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const S
 
 ICPUMeshBuffer* CMeshManipulator::createMeshBufferDuplicate(const ICPUMeshBuffer* _src) const
 {
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshBufferDuplicate");
 	if (!_src)
 		return NULL;
 
@@ -1274,6 +1286,173 @@ ICPUMeshBuffer* CMeshManipulator::createMeshBufferDuplicate(const ICPUMeshBuffer
 	return dst;
 }
 
+ICPUMeshBuffer* CMeshManipulator::createMeshBufferSimplified(const ICPUMeshBuffer* _inbuffer, const uint32_t& _targetTriangleCount, const float& _maxError, float* _outError) const
+{
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshBufferSimplified");
+	std::vector<uint32_t> indices;
+	float error = 0.f;
+	if (!simplifyMeshBufferIndices(indices, error, _inbuffer, _targetTriangleCount, _maxError))
+		return NULL;
+
+	if (_outError)
+		*_outError = error;
+	return createMeshBufferSharingVertices(_inbuffer, indices);
+}
+
+bool CMeshManipulator::createMeshLoDChain(ICPUMesh** _outLoDs, float* _outErrors, const ICPUMesh* _mesh, const float* _triangleRatios, const uint32_t& _lodCount, const float& _maxError) const
+{
+	_IRR_PROFILE_ZONE("IMeshManipulator::createMeshLoDChain");
+	if (!_outLoDs || !_mesh || (_lodCount && !_triangleRatios))
+		return false;
+
+	const uint32_t mbCount = _mesh->getMeshBufferCount();
+	const uint32_t jobCount = _lodCount*mbCount;
+	std::vector<std::vector<uint32_t> > indices(jobCount);
+	std::vector<float> errors(jobCount, 0.f);
+	std::vector<uint8_t> succeeded(jobCount, 0u);
+
+	// NULL meshbuffers and ones not made of triangles go into every level unchanged
+	auto passesThrough = [](const ICPUMeshBuffer* mb) -> bool
+	{
+		if (!mb)
+			return true;
+		const E_PRIMITIVE_TYPE primitiveType = mb->getPrimitiveType();
+		return primitiveType != EPT_TRIANGLES && primitiveType != EPT_TRIANGLE_STRIP && primitiveType != EPT_TRIANGLE_FAN;
+	};
+
+	// only the index computation runs on the workers, meshbuffers get created after since reference counting is not thread safe
+	CJobSystem::getGlobal()->parallelFor(jobCount, [&](const uint32_t& job)
+	{
+		const uint32_t lod = job/mbCount;
+		const ICPUMeshBuffer* mb = _mesh->getMeshBuffer(job%mbCount);
+		if (passesThrough(mb))
+		{
+			succeeded[job] = 1u;
+			return;
+		}
+
+		const size_t idxCount = mb->getIndexCount();
+		const size_t triangleCount = mb->getPrimitiveType() == EPT_TRIANGLES ? idxCount/3u : (idxCount > 2u ? idxCount-2u : 0u);
+		const float ratio = core::clamp(_triangleRatios[lod], 0.f, 1.f);
+		succeeded[job] = simplifyMeshBufferIndices(indices[job], errors[job], mb, uint32_t(float(triangleCount)*ratio+0.5f), _maxError);
+	});
+
+	if (std::find(succeeded.begin(), succeeded.end(), 0u) != succeeded.end())
+		return false;
+
+	for (uint32_t lod = 0; lod < _lodCount; ++lod)
+	{
+		SCPUMesh* lodMesh = new SCPUMesh();
+		float lodError = 0.f;
+		for (uint32_t i = 0; i < mbCount; ++i)
+		{
+			const uint32_t job = lod*mbCount+i;
+			ICPUMeshBuffer* original = _mesh->getMeshBuffer(i);
+			if (passesThrough(original))
+			{
+				lodMesh->addMeshBuffer(original);
+				continue;
+			}
+			ICPUMeshBuffer* mb = createMeshBufferSharingVertices(original, indices[job]);
+			lodMesh->addMeshBuffer(mb);
+			mb->drop();
+			lodError = std::max(lodError, errors[job]);
+		}
+		lodMesh->recalculateBoundingBox();
+		_outLoDs[lod] = lodMesh;
+		if (_outErrors)
+			_outErrors[lod] = lodError;
+	}
+	return true;
+}
+
+bool CMeshManipulator::simplifyMeshBufferIndices(std::vector<uint32_t>& _outIndices, float& _outError, const ICPUMeshBuffer* _inbuffer, uint32_t _targetTriangleCount, float _maxError) const
+{
+	if (!_inbuffer || !_inbuffer->getMeshDataAndFormat() || !_inbuffer->getMeshDataAndFormat()->getMappedBuffer(_inbuffer->getPositionAttributeIx()))
+		return false;
+
+	const E_PRIMITIVE_TYPE primitiveType = _inbuffer->getPrimitiveType();
+	if (primitiveType != EPT_TRIANGLES && primitiveType != EPT_TRIANGLE_STRIP && primitiveType != EPT_TRIANGLE_FAN)
+		return false;
+
+	// 32bit indices of whatever is drawn, 0,1,2,3,... if nothing's mapped
+	const size_t idxCount = _inbuffer->getIndexCount();
+	std::vector<uint32_t> indices(idxCount);
+	if (!_inbuffer->getIndices())
+		std::iota(indices.begin(), indices.end(), 0u);
+	else if (_inbuffer->getIndexType() == video::EIT_16BIT)
+		std::copy((const uint16_t*)_inbuffer->getIndices(), (const uint16_t*)_inbuffer->getIndices()+idxCount, indices.begin());
+	else if (_inbuffer->getIndexType() == video::EIT_32BIT)
+		std::copy((const uint32_t*)_inbuffer->getIndices(), (const uint32_t*)_inbuffer->getIndices()+idxCount, indices.begin());
+	else
+		return false;
+
+	if (primitiveType != EPT_TRIANGLES && idxCount >= 3u)
+	{
+		core::ICPUBuffer* triangles = primitiveType == EPT_TRIANGLE_STRIP ?
+			idxBufferFromTriangleStripsToTriangles(indices.data(), idxCount, video::EIT_32BIT) :
+			idxBufferFromTrianglesFanToTriangles(indices.data(), idxCount, video::EIT_32BIT);
+		indices.assign((const uint32_t*)triangles->getPointer(), (const uint32_t*)triangles->getPointer()+triangles->getSize()/4u);
+		triangles->drop();
+	}
+
+	// getAttribute() applies the base vertex, same as the indices do when drawing
+	const size_t vertexCount = indices.empty() ? 0u : *std::max_element(indices.begin(), indices.end())+1u;
+	std::vector<core::vectorSIMDf> positions(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i)
+		_inbuffer->getAttribute(positions[i], _inbuffer->getPositionAttributeIx(), i);
+
+	_outError = CQuadricMeshSimplifier::simplify(_outIndices, indices.data(), indices.size(), positions.data(), vertexCount, size_t(_targetTriangleCount)*3u, _maxError);
+	return true;
+}
+
+ICPUMeshBuffer* CMeshManipulator::createMeshBufferSharingVertices(const ICPUMeshBuffer* _src, const std::vector<uint32_t>& _indices) const
+{
+	ICPUMeshBuffer* dst = NULL;
+	if (const SCPUSkinMeshBuffer* smb = dynamic_cast<const SCPUSkinMeshBuffer*>(_src))
+		dst = new SCPUSkinMeshBuffer(*smb);
+	else
+		dst = new ICPUMeshBuffer(*_src);
+
+	ICPUMeshDataFormatDesc* newDesc = new ICPUMeshDataFormatDesc();
+	const IMeshDataFormatDesc<core::ICPUBuffer>* oldDesc = _src->getMeshDataAndFormat();
+	for (size_t i = 0; i < EVAI_COUNT; ++i)
+	{
+		const E_VERTEX_ATTRIBUTE_ID attrId = (E_VERTEX_ATTRIBUTE_ID)i;
+		core::ICPUBuffer* buf = const_cast<core::ICPUBuffer*>(oldDesc->getMappedBuffer(attrId));
+		if (!buf)
+			continue;
+
+		newDesc->mapVertexAttrBuffer(buf, attrId, oldDesc->getAttribComponentCount(attrId), oldDesc->getAttribType(attrId),
+			oldDesc->getMappedBufferStride(attrId), oldDesc->getMappedBufferOffset(attrId), oldDesc->getAttribDivisor(attrId));
+	}
+
+	// the simplified triangles use a subset of the original vertices, so 16bit indices still fit when they did before
+	const bool use16Bit = std::find_if(_indices.begin(), _indices.end(), [](uint32_t ix) { return ix > 0xffffu; }) == _indices.end();
+	core::ICPUBuffer* idxBuffer = new core::ICPUBuffer(_indices.size() * (use16Bit ? 2u : 4u));
+	if (use16Bit)
+		std::copy(_indices.begin(), _indices.end(), (uint16_t*)idxBuffer->getPointer());
+	else
+		memcpy(idxBuffer->getPointer(), _indices.data(), idxBuffer->getSize());
+	newDesc->mapIndexBuffer(idxBuffer);
+	idxBuffer->drop();
+
+	dst->setIndexType(use16Bit ? video::EIT_16BIT : video::EIT_32BIT);
+	dst->setIndexBufferOffset(0);
+	dst->setIndexCount(_indices.size());
+	dst->setPrimitiveType(EPT_TRIANGLES);
+
+	oldDesc->grab(); // dst points to the desc of _src until setMeshDataAndFormat drops it, same as in createMeshBufferDuplicate
+	dst->setMeshDataAndFormat(newDesc);
+	newDesc->drop();
+
+	while (dst->getReferenceCount() > 1) // reference counter was also copied, so we're reducing it to 1
+		dst->drop();
+
+	dst->recalculateBoundingBox();
+	return dst;
+}
+
 core::ICPUBuffer* CMeshManipulator::create32BitFrom16BitIdxBufferSubrange(const uint16_t* _in, size_t _idxCount) const
 {
 	if (!_in)
@@ -76,10 +76,19 @@ public:
 
 	virtual ICPUMeshBuffer* createMeshBufferDuplicate(const ICPUMeshBuffer* _src) const;
 
+	virtual ICPUMeshBuffer* createMeshBufferSimplified(const ICPUMeshBuffer* inbuffer, const uint32_t& targetTriangleCount, const float& maxError=FLT_MAX, float* outError=NULL) const;
+
+	virtual bool createMeshLoDChain(ICPUMesh** outLoDs, float* outErrors, const ICPUMesh* mesh, const float* triangleRatios, const uint32_t& lodCount, const float& maxError=FLT_MAX) const;
+
 private:
 	//! Meant to create 32bit index buffer from subrange of index buffer containing 16bit indices. Remember to set to index buffer offset to 0 after mapping buffer resulting from this function.
 	core::ICPUBuffer* create32BitFrom16BitIdxBufferSubrange(const uint16_t* _in, size_t _idxCount) const;
 
+	//! Simplified triangle list indices of a meshbuffer, does not create or grab anything so it can run on many threads at once.
+	bool simplifyMeshBufferIndices(std::vector<uint32_t>& _outIndices, float& _outError, const ICPUMeshBuffer* _inbuffer, uint32_t _targetTriangleCount, float _maxError) const;
+	//! Meshbuffer drawing `_indices` as a triangle list from the vertex buffers of `_src`.
+	ICPUMeshBuffer* createMeshBufferSharingVertices(const ICPUMeshBuffer* _src, const std::vector<uint32_t>& _indices) const;
+
 	std::vector<core::vectorSIMDf> findBetterFormatF(E_COMPONENT_TYPE* _outType, size_t* _outSize, E_COMPONENTS_PER_ATTRIBUTE* _outCpa, E_COMPONENT_TYPE* _outPrevType, const ICPUMeshBuffer* _meshbuffer, E_VERTEX_ATTRIBUTE_ID _attrId, const SErrorMetric& _errMetric) const;
 	
 	struct SIntegerAttr
@@ -21,7 +21,7 @@ uint32_t CMeshSceneNodeInstanced::recullOrder;
 CMeshSceneNodeInstanced::CMeshSceneNodeInstanced(IDummyTransformationSceneNode* parent, ISceneManager* mgr, int32_t id,
         const core::vector3df& position, const core::vector3df& rotation, const core::vector3df& scale)
     : IMeshSceneNodeInstanced(parent, mgr, id, position, rotation, scale),
-    cpuCullingFunction(NULL), cpuCullingScratchSpace(NULL),
+    cpuCullingFunction(NULL), cpuCullingScratchSpace(NULL), builtinCPUCulling(false), builtinCPUCullingThreads(0),
     instanceDataBufferChanged(false), instanceDataBuffer(NULL), instanceBBoxes(NULL), instanceBBoxesCount(0),
     flagQueryForRetrieval(false),
     gpuCulledLodInstanceDataBuffer(NULL), cpuCulledLodInstanceDataBuffer(NULL), dataPerInstanceOutputSize(0),
@@ -34,7 +34,8 @@ CMeshSceneNodeInstanced::CMeshSceneNodeInstanced(IDummyTransformationSceneNode*
 #ifdef _IRR_COMPILE_WITH_OPENGL_
     instanceCountThresholdForGPU = static_cast<video::COpenGLDriver*>(SceneManager->getVideoDriver())->getMaxConcurrentShaderInvocations();
 #else
-    instanceCountThresholdForGPU = 0;
+    //! without a GPU to cull on, every instance count goes to the CPU culling
+    instanceCountThresholdForGPU = 0xffffffffu;
 #endif // _IRR_COMPILE_WITH_OPENGL_
 
     renderPriority = 0x80000000u;
@@ -79,7 +80,7 @@ void CMeshSceneNodeInstanced::setGPUCullingThresholdMultiplier(const double& mul
 #ifdef _IRR_COMPILE_WITH_OPENGL_
     instanceCountThresholdForGPU = double(static_cast<video::COpenGLDriver*>(SceneManager->getVideoDriver())->getMaxConcurrentShaderInvocations())*multiplier;
 #else
-    instanceCountThresholdForGPU = 0;
+    instanceCountThresholdForGPU = 0xffffffffu;
 #endif // _IRR_COMPILE_WITH_OPENGL_
 }
 
@@ -119,7 +120,9 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(std::vector<MeshLoD> levelsOfDetail,
     cpuCulledLodInstanceDataBuffer = NULL;
     cpuCullingFunction = NULL;
     cpuCullingScratchSpace = NULL;
+    builtinCPUCulling = false;
     extraDataInstanceSize = 0;
+    builtinCuller.setSlotCount(0);
 
     lodCullingPointMesh->setMeshDataAndFormat(NULL);
     lodCullingPointMesh->setIndexCount(0);
@@ -155,24 +158,15 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(std::vector<MeshLoD> levelsOfDetail,
 
     xfb.resize((levelsOfDetail.size()+gpuLoDsPerPass-1)/gpuLoDsPerPass);
 
+	builtinCuller.setSlotCount(instanceBBoxesCount);
+
 	gpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createGPUBuffer(dataSizePerInstanceOutput*instanceBBoxesCount*gpuLoDsPerPass*xfb.size(),NULL);
 	instanceDataBufferChanged = false;
 
     if (cpuCullFunc)
     {
-#ifdef _IRR_COMPILE_WITH_OPENGL_
-        instanceCountThresholdForGPU = static_cast<video::COpenGLDriver*>(SceneManager->getVideoDriver())->getMaxConcurrentShaderInvocations();
-#else
-        instanceCountThresholdForGPU = 0;
-#endif // _IRR_COMPILE_WITH_OPENGL_
         cpuCullingFunction = cpuCullFunc;
-
-        cpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createGPUBuffer(gpuCulledLodInstanceDataBuffer->getSize(),NULL,true);
-#ifdef _IRR_WINDOWS_
-        cpuCullingScratchSpace = (uint8_t*)_aligned_malloc(gpuCulledLodInstanceDataBuffer->getSize(),SIMD_ALIGNMENT);
-#else
-        posix_memalign((void**)&cpuCullingScratchSpace,SIMD_ALIGNMENT,gpuCulledLodInstanceDataBuffer->getSize());
-#endif
+        createCPUCullingBuffers();
     }
     else
         instanceCountThresholdForGPU = 0;
@@ -267,6 +261,48 @@ bool CMeshSceneNodeInstanced::setLoDMeshes(std::vector<MeshLoD> levelsOfDetail,
 
     lodCullingPointMesh->getMaterial() = lodSelectionShader;
 
+    std::vector<float> lodDistances(levelsOfDetail.size());
+    for (size_t i=0; i<levelsOfDetail.size(); i++)
+        lodDistances[i] = levelsOfDetail[i].lodDistance;
+    builtinCuller.setLoDs(lodDistances.data(),lodDistances.size(),LoDInvariantBox);
+
+    return true;
+}
+
+void CMeshSceneNodeInstanced::createCPUCullingBuffers()
+{
+#ifdef _IRR_COMPILE_WITH_OPENGL_
+    instanceCountThresholdForGPU = static_cast<video::COpenGLDriver*>(SceneManager->getVideoDriver())->getMaxConcurrentShaderInvocations();
+#else
+    instanceCountThresholdForGPU = 0xffffffffu;
+#endif // _IRR_COMPILE_WITH_OPENGL_
+    if (cpuCulledLodInstanceDataBuffer)
+        return;
+
+    cpuCulledLodInstanceDataBuffer = SceneManager->getVideoDriver()->createGPUBuffer(gpuCulledLodInstanceDataBuffer->getSize(),NULL,true);
+#ifdef _IRR_WINDOWS_
+    cpuCullingScratchSpace = (uint8_t*)_aligned_malloc(gpuCulledLodInstanceDataBuffer->getSize(),SIMD_ALIGNMENT);
+#else
+    posix_memalign((void**)&cpuCullingScratchSpace,SIMD_ALIGNMENT,gpuCulledLodInstanceDataBuffer->getSize());
+#endif
+}
+
+bool CMeshSceneNodeInstanced::setBuiltinCPUCulling(const bool& enable, const uint32_t& threadCount)
+{
+    if (!enable)
+    {
+        builtinCPUCulling = false;
+        if (!cpuCullingFunction)
+            instanceCountThresholdForGPU = 0;
+        return true;
+    }
+
+    if (LoD.size()==0||dataPerInstanceOutputSize<CCPUInstanceCuller::OutputSizePerInstance)
+        return false;
+
+    builtinCPUCulling = true;
+    builtinCPUCullingThreads = threadCount;
+    createCPUCullingBuffers();
     return true;
 }
 
@@ -297,6 +333,7 @@ bool CMeshSceneNodeInstanced::addInstances(uint32_t* instanceIDs, const size_t&
             instanceBBoxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
         }
         instanceBBoxesCount = newCount;
+        builtinCuller.setSlotCount(newCount);
     }
     needsBBoxRecompute = true;
     instanceDataBufferChanged = true;
@@ -309,6 +346,7 @@ bool CMeshSceneNodeInstanced::addInstances(uint32_t* instanceIDs, const size_t&
             instanceBBoxes[instanceIDs[i]] = LoDInvariantBox;
             relativeTransforms[i].transformBoxEx(instanceBBoxes[instanceIDs[i]]);
         }
+        builtinCuller.setInstance(instanceIDs[i],relativeTransforms[i]);
         uint8_t* ptr = base_pointer+redirect*(extraDataInstanceSize+12*4+36+visibilityPadding);
         memcpy(ptr,relativeTransforms+i,48);
 
@@ -341,6 +379,7 @@ void CMeshSceneNodeInstanced::setInstanceTransform(const uint32_t& instanceID, c
         instanceBBoxes[instanceID] = LoDInvariantBox;
         relativeTransform.transformBoxEx(instanceBBoxes[instanceID]);
     }
+    builtinCuller.setInstanceTransform(instanceID,relativeTransform);
 
     uint8_t* ptr = reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer())+redirect*(extraDataInstanceSize+12*4+36+visibilityPadding);
     memcpy(ptr,relativeTransform.pointer(),48);
@@ -380,6 +419,7 @@ core::matrix4x3 CMeshSceneNodeInstanced::getInstanceTransform(const uint32_t& in
 void CMeshSceneNodeInstanced::setInstanceVisible(const uint32_t& instanceID, const bool& visible)
 {
     reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer())[instanceDataBuffer->getRedirectFromID(instanceID)*(extraDataInstanceSize+12*4+36+visibilityPadding)+36+48+extraDataInstanceSize] = visible;
+    builtinCuller.setInstanceVisible(instanceID,visible);
     instanceDataBufferChanged = true;
     /// update BBox?
 }
@@ -406,6 +446,7 @@ void CMeshSceneNodeInstanced::removeInstances(const size_t& instanceCount, const
         size_t redirect = instanceDataBuffer->getRedirectFromID(instanceIDs[i]);
         instanceBBoxes[instanceIDs[i]].MinEdge.set( FLT_MAX, FLT_MAX, FLT_MAX);
         instanceBBoxes[instanceIDs[i]].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+        builtinCuller.removeInstance(instanceIDs[i]);
     }
 
     instanceDataBuffer->Free(instanceIDs,instanceCount);
@@ -419,6 +460,7 @@ void CMeshSceneNodeInstanced::removeInstances(const size_t& instanceCount, const
             instanceBBoxes[i].MaxEdge.set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
         }
         instanceBBoxesCount = newCount;
+        builtinCuller.setSlotCount(newCount);
     }
     needsBBoxRecompute = true;
     instanceDataBufferChanged = true;
@@ -442,7 +484,7 @@ void CMeshSceneNodeInstanced::RecullInstances()
 
     video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
-    if (cpuCullingFunction&&(lodCullingPointMesh->getIndexCount()<instanceCountThresholdForGPU))
+    if ((cpuCullingFunction||builtinCPUCulling)&&(lodCullingPointMesh->getIndexCount()<instanceCountThresholdForGPU))
     {
         size_t outputSizePerLoD = dataPerInstanceOutputSize*instanceDataBuffer->getCapacity();
         if (cpuCulledLodInstanceDataBuffer->getSize()!=LoD.size()*outputSizePerLoD)
@@ -467,8 +509,11 @@ void CMeshSceneNodeInstanced::RecullInstances()
                 LoD[j].mesh->getMeshBuffer(i)->setBaseInstance(j*outputSizePerLoD/dataPerInstanceOutputSize);
         }
 
-        cpuCullingFunction(pseudoStreamPointers,dataPerInstanceOutputSize,getLoDInvariantBBox(),instanceDataBuffer->getAllocatedCount(),AbsoluteTransformation,
-                           reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer()),(extraDataInstanceSize+12*4+36+visibilityPadding),SceneManager,cpuCullingUserData);
+        if (builtinCPUCulling)
+            builtinCuller.cull(pseudoStreamPointers,dataPerInstanceOutputSize,driver->getTransform(video::EPTS_PROJ_VIEW),driver->getTransform(video::E4X3TS_VIEW),AbsoluteTransformation,builtinCPUCullingThreads);
+        else
+            cpuCullingFunction(pseudoStreamPointers,dataPerInstanceOutputSize,getLoDInvariantBBox(),instanceDataBuffer->getAllocatedCount(),AbsoluteTransformation,
+                               reinterpret_cast<uint8_t*>(instanceDataBuffer->getBackBufferPointer()),(extraDataInstanceSize+12*4+36+visibilityPadding),SceneManager,cpuCullingUserData);
 
         //! DO WE NEED TO DO THIS FOR CPU CULLING FRAMES?
         if (instanceDataBufferChanged)
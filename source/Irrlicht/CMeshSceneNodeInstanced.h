@@ -11,6 +11,7 @@
 #include "ITransformFeedback.h"
 #include "IQueryObject.h"
 #include "ISceneManager.h"
+#include "CCPUInstanceCuller.h"
 
 namespace irr
 {
@@ -75,6 +76,10 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
 
         virtual const core::aabbox3df& getLoDInvariantBBox() const {return LoDInvariantBox;}
 
+        virtual bool setBuiltinCPUCulling(const bool& enable, const uint32_t& threadCount=0);
+
+        virtual bool isBuiltinCPUCullingEnabled() const {return builtinCPUCulling;}
+
 
         virtual const size_t& getInstanceCount() const { return instanceDataBuffer->getAllocatedCount(); }
 
@@ -149,7 +154,12 @@ class CMeshSceneNodeInstanced : public IMeshSceneNodeInstanced
         bool lastTimeUsedGPU;
         CPUCullingFunc cpuCullingFunction;
         uint8_t* cpuCullingScratchSpace;
+        bool builtinCPUCulling;
+        uint32_t builtinCPUCullingThreads;
+        //! mirror of the instance transforms in SoA, indexed by instance ID
+        CCPUInstanceCuller builtinCuller;
 
+        void createCPUCullingBuffers();
         void RecullInstances();
         core::aabbox3d<float> Box;
         core::aabbox3d<float> LoDInvariantBox;
@@ -0,0 +1,576 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMipMapGenerator.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "coreutil.h"
+#include "CJobSystem.h"
+#include "os.h"
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+
+//! Rows of a level processed by one job.
+const uint32_t kRowsPerJob = 16u;
+
+inline float sRGBToLinear(const float& c)
+{
+    return c<=0.04045f ? (c/12.92f):powf((c+0.055f)/1.055f,2.4f);
+}
+
+//! Lookup tables for 8bit sRGB, encoding picks the nearest code in linear space so it round-trips exactly.
+struct SGammaTables
+{
+    float toLinear[256];
+    //! Linear value halfway between sRGB codes i and i+1.
+    float thresholds[255];
+
+    SGammaTables()
+    {
+        for (uint32_t i=0; i<256; i++)
+            toLinear[i] = sRGBToLinear(float(i)/255.f);
+        for (uint32_t i=0; i<255; i++)
+            thresholds[i] = sRGBToLinear((float(i)+0.5f)/255.f);
+    }
+
+    inline uint8_t encode(const float& linear) const
+    {
+        uint32_t code = 0;
+        for (uint32_t step=128; step; step>>=1)
+        {
+            if (code+step<=255u && linear>=thresholds[code+step-1u])
+                code += step;
+        }
+        return code;
+    }
+};
+
+const SGammaTables& getGammaTables()
+{
+    static const SGammaTables tables;
+    return tables;
+}
+
+inline uint32_t expandTo8bit(const uint32_t& value, const uint32_t& bits)
+{
+    return (value<<(8u-bits))|(value>>(2u*bits-8u));
+}
+
+inline uint32_t reduceFrom8bit(const uint32_t& value, const uint32_t& bits)
+{
+    const uint32_t maxVal = (1u<<bits)-1u;
+    return (value*maxVal+127u)/255u;
+}
+
+//! Whether the format stores an alpha channel.
+bool hasAlpha(const ECOLOR_FORMAT& format)
+{
+    switch (format)
+    {
+        case ECF_A1R5G5B5:
+        case ECF_A8R8G8B8:
+        case ECF_R8G8B8A8:
+        case ECF_A16B16G16R16F:
+        case ECF_A32B32G32R32F:
+            return true;
+        default:
+            return false;
+    }
+}
+
+//! Whether the format stores normalized integers, the only ones sRGB applies to.
+bool isNormalizedInteger(const ECOLOR_FORMAT& format)
+{
+    switch (format)
+    {
+        case ECF_A1R5G5B5:
+        case ECF_R5G6B5:
+        case ECF_R8G8B8:
+        case ECF_A8R8G8B8:
+        case ECF_R8:
+        case ECF_R8G8:
+        case ECF_R8G8B8A8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+//! Converts `count` texels to linear float RGBA, missing channels become 0 and missing alpha 1.
+void decodeRow(const uint8_t* src, const ECOLOR_FORMAT& format, const uint32_t& count, const bool& sRGB, float* out)
+{
+    const SGammaTables& gamma = getGammaTables();
+    // normalized integer formats get unpacked to 8bit RGBA first
+    uint8_t unorm[4];
+    for (uint32_t i=0; i<count; i++,out+=4)
+    {
+        switch (format)
+        {
+            case ECF_A1R5G5B5:
+                {
+                    const uint32_t c = reinterpret_cast<const uint16_t*>(src)[i];
+                    unorm[0] = expandTo8bit((c>>10)&0x1fu,5);
+                    unorm[1] = expandTo8bit((c>>5)&0x1fu,5);
+                    unorm[2] = expandTo8bit(c&0x1fu,5);
+                    unorm[3] = (c&0x8000u) ? 0xffu:0u;
+                }
+                break;
+            case ECF_R5G6B5:
+                {
+                    const uint32_t c = reinterpret_cast<const uint16_t*>(src)[i];
+                    unorm[0] = expandTo8bit(c>>11,5);
+                    unorm[1] = expandTo8bit((c>>5)&0x3fu,6);
+                    unorm[2] = expandTo8bit(c&0x1fu,5);
+                    unorm[3] = 0xffu;
+                }
+                break;
+            case ECF_R8G8B8:
+                unorm[0] = src[i*3+0];
+                unorm[1] = src[i*3+1];
+                unorm[2] = src[i*3+2];
+                unorm[3] = 0xffu;
+                break;
+            case ECF_A8R8G8B8:
+                {
+                    const uint32_t c = reinterpret_cast<const uint32_t*>(src)[i];
+                    unorm[0] = (c>>16)&0xffu;
+                    unorm[1] = (c>>8)&0xffu;
+                    unorm[2] = c&0xffu;
+                    unorm[3] = c>>24;
+                }
+                break;
+            case ECF_R8:
+                unorm[0] = src[i];
+                unorm[1] = 0u;
+                unorm[2] = 0u;
+                unorm[3] = 0xffu;
+                break;
+            case ECF_R8G8:
+                unorm[0] = src[i*2+0];
+                unorm[1] = src[i*2+1];
+                unorm[2] = 0u;
+                unorm[3] = 0xffu;
+                break;
+            case ECF_R8G8B8A8:
+                memcpy(unorm,src+i*4,4);
+                break;
+            case ECF_R11G11B10F:
+                {
+                    const uint32_t c = reinterpret_cast<const uint32_t*>(src)[i];
+                    out[0] = core::unpack11bitFloat(c);
+                    out[1] = core::unpack11bitFloat(c>>11);
+                    out[2] = core::unpack10bitFloat(c>>22);
+                    out[3] = 1.f;
+                }
+                continue;
+            case ECF_R16F:
+            case ECF_G16R16F:
+            case ECF_A16B16G16R16F:
+                {
+                    const uint32_t channels = format==ECF_R16F ? 1u:(format==ECF_G16R16F ? 2u:4u);
+                    const uint16_t* halfs = reinterpret_cast<const uint16_t*>(src)+i*channels;
+                    out[0] = 0.f;
+                    out[1] = 0.f;
+                    out[2] = 0.f;
+                    out[3] = 1.f;
+                    for (uint32_t j=0; j<channels; j++)
+                        out[j] = core::Float16Compressor::decompress(halfs[j]);
+                }
+                continue;
+            case ECF_R32F:
+            case ECF_G32R32F:
+            case ECF_A32B32G32R32F:
+                {
+                    const uint32_t channels = format==ECF_R32F ? 1u:(format==ECF_G32R32F ? 2u:4u);
+                    const float* floats = reinterpret_cast<const float*>(src)+i*channels;
+                    out[0] = 0.f;
+                    out[1] = 0.f;
+                    out[2] = 0.f;
+                    out[3] = 1.f;
+                    for (uint32_t j=0; j<channels; j++)
+                        out[j] = floats[j];
+                }
+                continue;
+            default:
+                continue;
+        }
+
+        for (uint32_t j=0; j<3; j++)
+            out[j] = sRGB ? gamma.toLinear[unorm[j]]:(float(unorm[j])/255.f);
+        out[3] = float(unorm[3])/255.f;
+    }
+}
+
+inline uint8_t encodeUnorm8(const float& value)
+{
+    return uint8_t(core::clamp(value,0.f,1.f)*255.f+0.5f);
+}
+
+//! Converts `count` linear float RGBA texels into `format`.
+void encodeRow(const float* in, const ECOLOR_FORMAT& format, const uint32_t& count, const bool& sRGB, uint8_t* dst)
+{
+    const SGammaTables& gamma = getGammaTables();
+    for (uint32_t i=0; i<count; i++,in+=4)
+    {
+        uint32_t unorm[4];
+        if (isNormalizedInteger(format))
+        {
+            for (uint32_t j=0; j<3; j++)
+                unorm[j] = sRGB ? gamma.encode(in[j]):encodeUnorm8(in[j]);
+            unorm[3] = encodeUnorm8(in[3]);
+        }
+
+        switch (format)
+        {
+            case ECF_A1R5G5B5:
+                reinterpret_cast<uint16_t*>(dst)[i] = (in[3]>=0.5f ? 0x8000u:0u)|(reduceFrom8bit(unorm[0],5)<<10)|
+                                                        (reduceFrom8bit(unorm[1],5)<<5)|reduceFrom8bit(unorm[2],5);
+                break;
+            case ECF_R5G6B5:
+                reinterpret_cast<uint16_t*>(dst)[i] = (reduceFrom8bit(unorm[0],5)<<11)|(reduceFrom8bit(unorm[1],6)<<5)|reduceFrom8bit(unorm[2],5);
+                break;
+            case ECF_R8G8B8:
+                dst[i*3+0] = unorm[0];
+                dst[i*3+1] = unorm[1];
+                dst[i*3+2] = unorm[2];
+                break;
+            case ECF_A8R8G8B8:
+                reinterpret_cast<uint32_t*>(dst)[i] = (unorm[3]<<24)|(unorm[0]<<16)|(unorm[1]<<8)|unorm[2];
+                break;
+            case ECF_R8:
+                dst[i] = unorm[0];
+                break;
+            case ECF_R8G8:
+                dst[i*2+0] = unorm[0];
+                dst[i*2+1] = unorm[1];
+                break;
+            case ECF_R8G8B8A8:
+                for (uint32_t j=0; j<4; j++)
+                    dst[i*4+j] = unorm[j];
+                break;
+            case ECF_R11G11B10F:
+                reinterpret_cast<uint32_t*>(dst)[i] = core::to11bitFloat(std::max(in[0],0.f))|(core::to11bitFloat(std::max(in[1],0.f))<<11)|
+                                                        (core::to10bitFloat(std::max(in[2],0.f))<<22);
+                break;
+            case ECF_R16F:
+            case ECF_G16R16F:
+            case ECF_A16B16G16R16F:
+                {
+                    const uint32_t channels = format==ECF_R16F ? 1u:(format==ECF_G16R16F ? 2u:4u);
+                    uint16_t* halfs = reinterpret_cast<uint16_t*>(dst)+i*channels;
+                    for (uint32_t j=0; j<channels; j++)
+                        halfs[j] = core::Float16Compressor::compress(in[j]);
+                }
+                break;
+            case ECF_R32F:
+            case ECF_G32R32F:
+            case ECF_A32B32G32R32F:
+                {
+                    const uint32_t channels = format==ECF_R32F ? 1u:(format==ECF_G32R32F ? 2u:4u);
+                    memcpy(dst+i*channels*sizeof(float),in,channels*sizeof(float));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+//! Modified Bessel function of the first kind, order 0.
+double besselI0(const double& x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfXSq = x*x*0.25;
+    for (uint32_t k=1; k<32; k++)
+    {
+        term *= halfXSq/double(k*k);
+        sum += term;
+        if (term<sum*1e-12)
+            break;
+    }
+    return sum;
+}
+
+//! Per destination texel source indices and weights along one axis, `tapCount` taps each.
+struct SFilterTaps
+{
+    uint32_t tapCount;
+    std::vector<uint32_t> index;
+    std::vector<float> weight;
+};
+
+void buildFilterTaps(const uint32_t& srcSize, const uint32_t& dstSize, const CMipMapGenerator::SParameters& params, SFilterTaps& out)
+{
+    if (srcSize==dstSize)
+    {
+        out.tapCount = 1u;
+        out.index.resize(dstSize);
+        out.weight.assign(dstSize,1.f);
+        for (uint32_t i=0; i<dstSize; i++)
+            out.index[i] = i;
+        return;
+    }
+
+    const float scale = float(srcSize)/float(dstSize);
+    const bool kaiser = params.filter==CMipMapGenerator::EMGF_KAISER;
+    const float radius = kaiser ? (params.kaiserRadius*scale):(0.5f*scale);
+    const double windowNorm = 1.0/besselI0(params.kaiserAlpha);
+
+    out.tapCount = uint32_t(ceilf(2.f*radius))+1u;
+    out.index.resize(dstSize*out.tapCount);
+    out.weight.resize(dstSize*out.tapCount);
+    for (uint32_t i=0; i<dstSize; i++)
+    {
+        const float center = (float(i)+0.5f)*scale;
+        const int32_t first = int32_t(floorf(center-radius));
+
+        uint32_t* indices = &out.index[i*out.tapCount];
+        float* weights = &out.weight[i*out.tapCount];
+        float sum = 0.f;
+        for (uint32_t t=0; t<out.tapCount; t++)
+        {
+            const int32_t s = first+int32_t(t);
+            float w;
+            if (kaiser)
+            {
+                const double d = (double(s)+0.5-center)/scale;
+                const double x = d/params.kaiserRadius;
+                if (x*x<1.0)
+                {
+                    const double sinc = fabs(d)>1e-6 ? sin(core::PI64*d)/(core::PI64*d):1.0;
+                    w = sinc*besselI0(params.kaiserAlpha*sqrt(1.0-x*x))*windowNorm;
+                }
+                else
+                    w = 0.f;
+            }
+            else
+                w = std::max(std::min(float(s+1),center+radius)-std::max(float(s),center-radius),0.f);
+
+            indices[t] = core::clamp<int32_t>(s,0,srcSize-1);
+            weights[t] = w;
+            sum += w;
+        }
+
+        for (uint32_t t=0; t<out.tapCount; t++)
+            weights[t] /= sum;
+    }
+}
+
+//! Resamples one row of float RGBA texels horizontally.
+void filterRow(const float* in, const SFilterTaps& taps, const uint32_t& dstWidth, float* out)
+{
+    const uint32_t* indices = &taps.index[0];
+    const float* weights = &taps.weight[0];
+    for (uint32_t x=0; x<dstWidth; x++,out+=4)
+    {
+        __m128 acc = _mm_setzero_ps();
+        for (uint32_t t=0; t<taps.tapCount; t++,indices++,weights++)
+            acc = _mm_add_ps(acc,_mm_mul_ps(_mm_set1_ps(*weights),_mm_loadu_ps(in+(*indices)*4u)));
+        _mm_storeu_ps(out,acc);
+    }
+}
+
+//! Computes destination row `y` as a weighted sum of whole source rows.
+void filterColumn(const float* in, const uint32_t& rowFloats, const SFilterTaps& taps, const uint32_t& y, float* out)
+{
+    const uint32_t* indices = &taps.index[y*taps.tapCount];
+    const float* weights = &taps.weight[y*taps.tapCount];
+
+    const __m128 w0 = _mm_set1_ps(weights[0]);
+    const float* row = in+indices[0]*rowFloats;
+    for (uint32_t i=0; i<rowFloats; i+=4)
+        _mm_storeu_ps(out+i,_mm_mul_ps(w0,_mm_loadu_ps(row+i)));
+
+    for (uint32_t t=1; t<taps.tapCount; t++)
+    {
+        if (weights[t]==0.f)
+            continue;
+
+        const __m128 w = _mm_set1_ps(weights[t]);
+        row = in+indices[t]*rowFloats;
+        for (uint32_t i=0; i<rowFloats; i+=4)
+            _mm_storeu_ps(out+i,_mm_add_ps(_mm_loadu_ps(out+i),_mm_mul_ps(w,_mm_loadu_ps(row+i))));
+    }
+}
+
+inline void premultiplyRow(float* texels, const uint32_t& count)
+{
+    for (uint32_t x=0; x<count; x++,texels+=4)
+    {
+        const float alpha = texels[3];
+        _mm_storeu_ps(texels,_mm_mul_ps(_mm_loadu_ps(texels),_mm_set1_ps(alpha)));
+        texels[3] = alpha;
+    }
+}
+
+inline void unpremultiplyRow(const float* texels, const uint32_t& count, float* out)
+{
+    for (uint32_t x=0; x<count; x++,texels+=4,out+=4)
+    {
+        const float alpha = texels[3];
+        const float scale = alpha>0.f ? (1.f/alpha):0.f;
+        for (uint32_t j=0; j<3; j++)
+            out[j] = texels[j]*scale;
+        out[3] = std::max(alpha,0.f);
+    }
+}
+
+}
+
+bool CMipMapGenerator::isFormatSupported(const ECOLOR_FORMAT& format)
+{
+    switch (format)
+    {
+        case ECF_A1R5G5B5:
+        case ECF_R5G6B5:
+        case ECF_R8G8B8:
+        case ECF_A8R8G8B8:
+        case ECF_R11G11B10F:
+        case ECF_R16F:
+        case ECF_G16R16F:
+        case ECF_A16B16G16R16F:
+        case ECF_R32F:
+        case ECF_G32R32F:
+        case ECF_A32B32G32R32F:
+        case ECF_R8:
+        case ECF_R8G8:
+        case ECF_R8G8B8A8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t CMipMapGenerator::getFullMipChainLength(const uint32_t& width, const uint32_t& height)
+{
+    uint32_t levels = 1;
+    for (uint32_t maxSide=std::max(width,height); maxSide>1u; maxSide>>=1)
+        levels++;
+    return levels;
+}
+
+std::vector<CImageData*> CMipMapGenerator::generateMipChain(CImageData* baseLevel, const SParameters& params)
+{
+    std::vector<CImageData*> retval;
+    if (!baseLevel)
+        return retval;
+
+    const ECOLOR_FORMAT format = baseLevel->getColorFormat();
+    if (!isFormatSupported(format))
+    {
+        os::Printer::log("CMipMapGenerator: unsupported color format", ELL_ERROR);
+        return retval;
+    }
+    if (baseLevel->getSliceMin()[0]!=0u||baseLevel->getSliceMin()[1]!=0u)
+    {
+        os::Printer::log("CMipMapGenerator: base level must start at texel (0,0)", ELL_ERROR);
+        return retval;
+    }
+
+    uint32_t width = baseLevel->getSliceMax()[0];
+    uint32_t height = baseLevel->getSliceMax()[1];
+    const uint32_t layers = baseLevel->getSliceMax()[2]-baseLevel->getSliceMin()[2];
+    if (width==0u||height==0u||layers==0u)
+        return retval;
+
+    uint32_t levelCount = getFullMipChainLength(width,height)-1u;
+    if (params.levelCount)
+        levelCount = std::min(levelCount,params.levelCount);
+
+    baseLevel->grab();
+    retval.push_back(baseLevel);
+    if (levelCount==0u)
+        return retval;
+
+    const bool sRGB = params.sRGB&&isNormalizedInteger(format);
+    const bool premultiply = params.premultipliedAlpha&&hasAlpha(format);
+
+    //! decode the base level
+    std::vector<float> level(size_t(width)*height*layers*4u);
+    {
+        const uint8_t* srcData = reinterpret_cast<const uint8_t*>(baseLevel->getData());
+        const size_t srcPitch = baseLevel->getPitchIncludingAlignment();
+        const uint32_t rows = height*layers;
+        CJobSystem::getGlobal()->parallelFor((rows+kRowsPerJob-1u)/kRowsPerJob,[&](const uint32_t& job)
+        {
+            const uint32_t end = std::min((job+1u)*kRowsPerJob,rows);
+            for (uint32_t r=job*kRowsPerJob; r<end; r++)
+            {
+                float* out = &level[size_t(r)*width*4u];
+                decodeRow(srcData+r*srcPitch,format,width,sRGB,out);
+                if (premultiply)
+                    premultiplyRow(out,width);
+            }
+        },params.threadCount);
+    }
+
+    std::vector<float> horizontal, next;
+    SFilterTaps tapsX, tapsY;
+    for (uint32_t i=1; i<=levelCount; i++)
+    {
+        const uint32_t dstWidth = std::max(width>>1,1u);
+        const uint32_t dstHeight = std::max(height>>1,1u);
+        buildFilterTaps(width,dstWidth,params,tapsX);
+        buildFilterTaps(height,dstHeight,params,tapsY);
+
+        uint32_t minCoord[3] = {0,0,baseLevel->getSliceMin()[2]};
+        uint32_t maxCoord[3] = {dstWidth,dstHeight,baseLevel->getSliceMax()[2]};
+        CImageData* mip = new CImageData(NULL,minCoord,maxCoord,baseLevel->getSupposedMipLevel()+i,format,1);
+        uint8_t* dstData = reinterpret_cast<uint8_t*>(mip->getData());
+        const size_t dstPitch = mip->getPitchIncludingAlignment();
+
+        //! horizontal pass over all source rows
+        horizontal.resize(size_t(dstWidth)*height*layers*4u);
+        const uint32_t srcRows = height*layers;
+        CJobSystem::getGlobal()->parallelFor((srcRows+kRowsPerJob-1u)/kRowsPerJob,[&](const uint32_t& job)
+        {
+            const uint32_t end = std::min((job+1u)*kRowsPerJob,srcRows);
+            for (uint32_t r=job*kRowsPerJob; r<end; r++)
+                filterRow(&level[size_t(r)*width*4u],tapsX,dstWidth,&horizontal[size_t(r)*dstWidth*4u]);
+        },params.threadCount);
+
+        //! vertical pass, output is kept for the next level and encoded
+        next.resize(size_t(dstWidth)*dstHeight*layers*4u);
+        const uint32_t dstRows = dstHeight*layers;
+        CJobSystem::getGlobal()->parallelFor((dstRows+kRowsPerJob-1u)/kRowsPerJob,[&](const uint32_t& job)
+        {
+            std::vector<float> straight(premultiply ? dstWidth*4u:0u);
+            const uint32_t end = std::min((job+1u)*kRowsPerJob,dstRows);
+            for (uint32_t r=job*kRowsPerJob; r<end; r++)
+            {
+                const uint32_t layer = r/dstHeight;
+                const uint32_t y = r-layer*dstHeight;
+                float* out = &next[size_t(r)*dstWidth*4u];
+                filterColumn(&horizontal[size_t(layer)*height*dstWidth*4u],dstWidth*4u,tapsY,y,out);
+
+                const float* encodeSrc = out;
+                if (premultiply)
+                {
+                    unpremultiplyRow(out,dstWidth,&straight[0]);
+                    encodeSrc = &straight[0];
+                }
+                encodeRow(encodeSrc,format,dstWidth,sRGB,dstData+r*dstPitch);
+            }
+        },params.threadCount);
+
+        retval.push_back(mip);
+        level.swap(next);
+        width = dstWidth;
+        height = dstHeight;
+    }
+
+    return retval;
+}
+
+} // end namespace video
+} // end namespace irr
@@ -15,6 +15,9 @@
 #include "CMeshManipulator.h"
 #include "CMeshSceneNodeInstanced.h"
 #include "FW_Mutex.h"
+#include "CJobSystem.h"
+#include "CProfiler.h"
+
 
 
 namespace irr
@@ -92,6 +95,9 @@ IImageWriter* createImageWriterPNG();
 //! creates a writer which is able to save ppm images
 IImageWriter* createImageWriterPPM();
 
+//! creates a writer which is able to save block compressed dds images
+IImageWriter* createImageWriterDDS();
+
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<uint32_t>& screenSize)
 : FileSystem(io), ViewPort(0,0,0,0), ScreenSize(screenSize), boxLineMesh(0),
@@ -167,6 +173,9 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<uint32_t>&
 #ifdef _IRR_COMPILE_WITH_BMP_WRITER_
 	SurfaceWriter.push_back(video::createImageWriterBMP());
 #endif
+#ifdef _IRR_COMPILE_WITH_DDS_WRITER_
+	SurfaceWriter.push_back(video::createImageWriterDDS());
+#endif
 
     MaxTextureSizes[ITexture::ETT_1D][0] = 0x80u;
     MaxTextureSizes[ITexture::ETT_1D][1] = 0x1u;
@@ -329,6 +338,7 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 bool CNullDriver::endScene()
 {
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	core::CProfiler::endFrame();
 
 	return true;
 }
@@ -804,13 +814,11 @@ ITexture* CNullDriver::addTexture(const ITexture::E_TEXTURE_TYPE& type, const st
 	if ( 0 == name.size () )
 		return 0;
 
-    if (format==ECF_UNKNOWN)
-        format = ECF_A1R5G5B5;
-
-    //better safe than sorry
-    if (type!=ITexture::ETT_2D||format!=ECF_A1R5G5B5)
+    //! ETT_COUNT means the type is deduced from the images, which we don't keep anyway
+    if (type!=ITexture::ETT_2D&&type!=ITexture::ETT_COUNT)
         return NULL;
 
+    //! only the name matters, so headless tools which load and re-export meshes keep their texture references
 	ITexture* t = new SDummyTexture(name);
 	addToTextureCache(t);
 
@@ -1260,6 +1268,7 @@ std::vector<CImageData*> CNullDriver::createImageDataFromFile(io::IReadFile* fil
 		{
 			// reset file position which might have changed due to previous loadImage calls
 			file->seek(0);
+			_IRR_PROFILE_ZONE("IImageLoader::loadImage");
 			std::vector<CImageData*> imageData = SurfaceLoader[i]->loadImage(file);
 			if (imageData.size())
 				return imageData;
@@ -1274,6 +1283,7 @@ std::vector<CImageData*> CNullDriver::createImageDataFromFile(io::IReadFile* fil
 		if (SurfaceLoader[i]->isALoadableFileFormat(file))
 		{
 			file->seek(0);
+			_IRR_PROFILE_ZONE("IImageLoader::loadImage");
 			std::vector<CImageData*> imageData = SurfaceLoader[i]->loadImage(file);
 			if (imageData.size())
 				return imageData;
@@ -1284,6 +1294,57 @@ std::vector<CImageData*> CNullDriver::createImageDataFromFile(io::IReadFile* fil
 }
 
 
+//! Loads many image files at once, spread over a pool of threads.
+std::vector<std::vector<CImageData*> > CNullDriver::createImageDataFromFiles(const std::vector<io::path>& filenames, const uint32_t& threadCount,
+																			const ImageDecodedCallback& callback)
+{
+	// opening and dropping files grabs and drops the file system and archives, whose reference counting is not thread safe,
+	// so it stays on this thread and the workers only read the open files
+	std::vector<io::IReadFile*> files(filenames.size());
+	for (size_t i=0; i<filenames.size(); i++)
+		files[i] = filenames[i].size() ? FileSystem->createAndOpenFile(filenames[i]):NULL;
+
+	std::vector<std::vector<CImageData*> > retval = createImageDataFromFiles(files,threadCount,callback);
+
+	for (size_t i=0; i<files.size(); i++)
+	{
+		if (files[i])
+			files[i]->drop();
+	}
+	return retval;
+}
+
+
+//! Loads many already opened image files at once, spread over a pool of threads.
+std::vector<std::vector<CImageData*> > CNullDriver::createImageDataFromFiles(const std::vector<io::IReadFile*>& files, const uint32_t& threadCount,
+																			const ImageDecodedCallback& callback)
+{
+	std::vector<std::vector<CImageData*> > retval(files.size());
+	// what the loaders log has to reach the Logger from this thread, so it is kept per file and passed on in the order of files
+	std::vector<os::Printer::LogCapture> logs(files.size());
+
+	// the loaders keep all decoder state on the stack and touch no shared reference counted objects, so they can run side by side,
+	// files inside archives read the archive with readAt() which does not disturb the others
+	CJobSystem::getGlobal()->parallelFor(files.size(),[&](const uint32_t& i)
+	{
+		logs[i].begin();
+		retval[i] = createImageDataFromFile(files[i]);
+		logs[i].end();
+		if (callback)
+			callback(i,retval[i]);
+	},threadCount);
+
+	for (size_t i=0; i<logs.size(); i++)
+	{
+		logs[i].replay();
+		if (files[i] && retval[i].empty())
+			os::Printer::log("Could not load image file", files[i]->getFileName().c_str(), ELL_WARNING);
+	}
+
+	return retval;
+}
+
+
 //! Writes the provided image to disk file
 bool CNullDriver::writeImageToFile(IImage* image, const io::path& filename,uint32_t param)
 {
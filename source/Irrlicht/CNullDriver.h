@@ -400,6 +400,14 @@ namespace video
 		//! Creates a software image from a file.
 		virtual std::vector<CImageData*> createImageDataFromFile(io::IReadFile* file);
 
+		//! Loads many image files at once, spread over a pool of threads.
+		virtual std::vector<std::vector<CImageData*> > createImageDataFromFiles(const std::vector<io::path>& filenames, const uint32_t& threadCount=0,
+																				const ImageDecodedCallback& callback=ImageDecodedCallback());
+
+		//! Loads many already opened image files at once, spread over a pool of threads.
+		virtual std::vector<std::vector<CImageData*> > createImageDataFromFiles(const std::vector<io::IReadFile*>& files, const uint32_t& threadCount=0,
+																				const ImageDecodedCallback& callback=ImageDecodedCallback());
+
 		//! Creates a software image from a byte array.
 		/** \param useForeignMemory: If true, the image will use the data pointer
 		directly and own it from now on, which means it will also try to delete [] the
@@ -0,0 +1,278 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "IWriteFile.h"
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+
+const char* const kFrameEventName = "Frame";
+
+//! an event in a ring, atomic since exporting reads it while its thread may be overwriting it
+struct SEventSlot
+{
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> startNs;
+    std::atomic<uint64_t> endNs;
+};
+
+//! written by the thread owning it only, read by whoever exports
+struct SThreadBuffer
+{
+    SThreadBuffer(const uint32_t& index) : threadIndex(index), written(0u) {}
+
+    uint32_t threadIndex;
+    //! total number of events ever written, the last EventsPerThread of them are still in the ring
+    std::atomic<uint64_t> written;
+    SEventSlot events[CProfiler::EventsPerThread];
+};
+
+struct SProfilerState
+{
+    SProfilerState() : currentFrameStartNs(0u), lastFrameNumber(0u), lastFrameStartNs(0u), lastFrameEndNs(0u) {}
+
+    //! guards the buffer list and the frame boundaries, never taken when recording an event
+    std::mutex lock;
+    //! buffers of exited threads are kept, their events can still be exported
+    std::vector<SThreadBuffer*> buffers;
+    //! buffers of exited threads, handed to the next new thread which goes on writing into the same ring
+    std::vector<SThreadBuffer*> freeBuffers;
+
+    uint64_t currentFrameStartNs;
+    uint64_t lastFrameNumber;
+    uint64_t lastFrameStartNs;
+    uint64_t lastFrameEndNs;
+};
+
+SProfilerState& getState()
+{
+    //! never freed, threads may still record during static destruction
+    static SProfilerState* state = new SProfilerState();
+    return *state;
+}
+
+thread_local SThreadBuffer* tlsBuffer = NULL;
+
+//! gives the thread's buffer back on thread exit, so the number of buffers only grows with the threads alive at once
+struct SThreadBufferOwner
+{
+    ~SThreadBufferOwner()
+    {
+        if (!tlsBuffer)
+            return;
+
+        SProfilerState& state = getState();
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.freeBuffers.push_back(tlsBuffer);
+        tlsBuffer = NULL;
+    }
+};
+
+thread_local SThreadBufferOwner tlsBufferOwner;
+
+SThreadBuffer* getThreadBuffer()
+{
+    if (!tlsBuffer)
+    {
+        SProfilerState& state = getState();
+        std::lock_guard<std::mutex> guard(state.lock);
+        if (state.freeBuffers.empty())
+        {
+            tlsBuffer = new SThreadBuffer(state.buffers.size());
+            state.buffers.push_back(tlsBuffer);
+        }
+        else
+        {
+            tlsBuffer = state.freeBuffers.back();
+            state.freeBuffers.pop_back();
+        }
+        //! odr-use the owner so it gets constructed, and with that destroyed on thread exit
+        (void)&tlsBufferOwner;
+    }
+    return tlsBuffer;
+}
+
+void appendJSONString(std::string& out, const char* str)
+{
+    out += '"';
+    for (; *str; str++)
+    {
+        if (*str=='"'||*str=='\\')
+            out += '\\';
+        if (uint8_t(*str)>=0x20u)
+            out += *str;
+    }
+    out += '"';
+}
+
+}
+
+std::atomic<bool> CProfiler::Recording(false);
+const size_t CProfiler::EventsPerThread;
+
+void CProfiler::recordEvent(const char* name, const uint64_t& startNs, const uint64_t& endNs)
+{
+    SThreadBuffer* buffer = getThreadBuffer();
+    const uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    //! an exporter which reads any of the stores below also sees `written` at least at index, and so knows the slot is being overwritten
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SEventSlot& event = buffer->events[index%EventsPerThread];
+    event.name.store(name,std::memory_order_relaxed);
+    event.startNs.store(startNs,std::memory_order_relaxed);
+    event.endNs.store(endNs,std::memory_order_relaxed);
+    buffer->written.store(index+1u,std::memory_order_release);
+}
+
+void CProfiler::endFrame()
+{
+    const uint64_t now = getTimestampNs();
+    const bool recording = isRecording();
+
+    SProfilerState& state = getState();
+    uint64_t frameStart;
+    {
+        std::lock_guard<std::mutex> guard(state.lock);
+        frameStart = state.currentFrameStartNs;
+        state.currentFrameStartNs = now;
+        if (!recording||!frameStart)
+            return;
+
+        state.lastFrameNumber++;
+        state.lastFrameStartNs = frameStart;
+        state.lastFrameEndNs = now;
+    }
+    recordEvent(kFrameEventName,frameStart,now);
+}
+
+bool CProfiler::getLastFrameSummary(SFrameSummary& outSummary)
+{
+    {
+        SProfilerState& state = getState();
+        std::lock_guard<std::mutex> guard(state.lock);
+        if (!state.lastFrameNumber)
+            return false;
+        outSummary.frameNumber = state.lastFrameNumber;
+        outSummary.startNs = state.lastFrameStartNs;
+        outSummary.endNs = state.lastFrameEndNs;
+    }
+
+    std::vector<SEvent> events;
+    getEvents(events);
+
+    outSummary.zones.clear();
+    for (size_t i=0; i<events.size(); i++)
+    {
+        const SEvent& event = events[i];
+        if (event.name==kFrameEventName||event.startNs<outSummary.startNs||event.endNs>outSummary.endNs)
+            continue;
+
+        //! the same literal can have a different address in every translation unit
+        auto found = outSummary.zones.begin();
+        for (; found!=outSummary.zones.end(); found++)
+        {
+            if (found->name==event.name||strcmp(found->name,event.name)==0)
+                break;
+        }
+        if (found==outSummary.zones.end())
+        {
+            SZoneSummary zone = {event.name,0u,0u};
+            found = outSummary.zones.insert(found,zone);
+        }
+        found->calls++;
+        found->totalNs += event.endNs-event.startNs;
+    }
+
+    std::sort(outSummary.zones.begin(),outSummary.zones.end(),[](const SZoneSummary& a, const SZoneSummary& b) {return a.totalNs>b.totalNs;});
+    return true;
+}
+
+void CProfiler::getEvents(std::vector<SEvent>& outEvents, std::vector<uint32_t>* outThreadIndices)
+{
+    std::vector<SThreadBuffer*> buffers;
+    {
+        SProfilerState& state = getState();
+        std::lock_guard<std::mutex> guard(state.lock);
+        buffers = state.buffers;
+    }
+
+    outEvents.clear();
+    if (outThreadIndices)
+        outThreadIndices->clear();
+    for (size_t i=0; i<buffers.size(); i++)
+    {
+        SThreadBuffer* buffer = buffers[i];
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t first = written>EventsPerThread ? (written-EventsPerThread):0u;
+
+        //! only the events published before the acquire above are copied
+        const size_t copyStart = outEvents.size();
+        for (uint64_t j=first; j<written; j++)
+        {
+            const SEventSlot& slot = buffer->events[j%EventsPerThread];
+            SEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.startNs = slot.startNs.load(std::memory_order_relaxed);
+            event.endNs = slot.endNs.load(std::memory_order_relaxed);
+            outEvents.push_back(event);
+        }
+
+        //! the thread may have kept recording while we copied, drop what it could have overwritten meanwhile,
+        //! including the slot it may be in the middle of writing
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t writtenAfter = buffer->written.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = writtenAfter>=EventsPerThread ? (writtenAfter+1u-EventsPerThread):0u;
+        if (firstIntact>first)
+            outEvents.erase(outEvents.begin()+copyStart,outEvents.begin()+copyStart+std::min(firstIntact-first,written-first));
+
+        if (outThreadIndices)
+            outThreadIndices->resize(outEvents.size(),buffer->threadIndex);
+    }
+}
+
+bool CProfiler::writeChromeTrace(io::IWriteFile* file)
+{
+    if (!file)
+        return false;
+
+    std::vector<SEvent> events;
+    std::vector<uint32_t> threadIndices;
+    getEvents(events,&threadIndices);
+
+    uint64_t origin = ~0ull;
+    for (size_t i=0; i<events.size(); i++)
+        origin = std::min(origin,events[i].startNs);
+
+    std::string json("{\"traceEvents\":[");
+    char numbers[128];
+    for (size_t i=0; i<events.size(); i++)
+    {
+        if (i)
+            json += ',';
+        json += "\n{\"name\":";
+        appendJSONString(json,events[i].name);
+        sprintf(numbers,",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",threadIndices[i],
+                double(events[i].startNs-origin)*0.001,double(events[i].endNs-events[i].startNs)*0.001);
+        json += numbers;
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return file->write(json.data(),json.size())==int32_t(json.size());
+}
+
+} // end namespace core
+} // end namespace irr
@@ -0,0 +1,509 @@
+#include "CQuadricMeshSimplifier.h"
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+namespace irr { namespace scene
+{
+
+namespace
+{
+	const uint32_t INVALID_VERTEX = 0xffffffffu;
+	// marks a vertex with more than one open edge going out of (or into) it, only used during classification
+	const uint32_t MULTIPLE_EDGES = 0xfffffffeu;
+
+	// border edges keep silhouettes, they weigh more than seams which only keep the attribute discontinuity in place
+	const float BORDER_EDGE_WEIGHT = 10.f;
+	const float SEAM_EDGE_WEIGHT = 1.f;
+
+	// indexed by the E_VERTEX_KIND of the vertex moving, and the one it moves onto
+	const bool canCollapse[4][4] =
+	{
+		{true, true, true, false},
+		{false, true, false, false},
+		{false, false, true, false},
+		{false, false, false, false}
+	};
+	// whether an edge between two kinds always has a triangle on each side, so that it is seen twice
+	const bool hasOpposite[4][4] =
+	{
+		{true, true, true, true},
+		{true, false, true, false},
+		{true, true, true, true},
+		{true, false, true, false}
+	};
+}
+
+
+float CQuadricMeshSimplifier::simplify(std::vector<uint32_t>& _outIndices, const uint32_t* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, size_t _vertexCount, size_t _targetIdxCount, float _maxError)
+{
+	_idxCount -= _idxCount%3u;
+	_targetIdxCount -= _targetIdxCount%3u;
+	_outIndices.assign(_indices, _indices+_idxCount);
+	if (_idxCount <= _targetIdxCount || !_vertexCount)
+		return 0.f;
+
+	// work in a unit cube so the quadrics keep their precision whatever the scale of the mesh
+	core::vectorSIMDf minPos(FLT_MAX), maxPos(-FLT_MAX);
+	for (size_t i = 0; i < _vertexCount; ++i)
+	{
+		minPos = core::min_(minPos, _positions[i]);
+		maxPos = core::max_(maxPos, _positions[i]);
+	}
+	const core::vectorSIMDf extent = maxPos-minPos;
+	const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+	const float scale = maxExtent > 0.f ? 1.f/maxExtent : 1.f;
+
+	std::vector<core::vectorSIMDf> positions(_vertexCount);
+	for (size_t i = 0; i < _vertexCount; ++i)
+	{
+		positions[i] = (_positions[i]-minPos)*scale;
+		positions[i].w = 0.f;
+	}
+
+	std::vector<uint32_t> remap, wedge;
+	buildPositionRemap(remap, wedge, positions);
+
+	std::vector<uint8_t> kinds;
+	std::vector<uint32_t> loop, loopback;
+	std::vector<Quadric> quadrics;
+	{
+		Adjacency edges;
+		buildEdgeAdjacency(edges, _outIndices, _vertexCount);
+		classifyVertices(kinds, loop, loopback, edges, remap, wedge);
+		fillQuadrics(quadrics, _outIndices, positions, edges, remap, wedge);
+	}
+
+	const float scaledMaxError = _maxError*scale;
+	const float errorLimit = scaledMaxError < sqrtf(FLT_MAX) ? scaledMaxError*scaledMaxError : FLT_MAX;
+	float resultError = 0.f;
+
+	Adjacency triangles;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> collapseOrder;
+	std::vector<uint32_t> collapseRemap(_vertexCount);
+	std::vector<uint8_t> collapseLocked(_vertexCount);
+	while (_outIndices.size() > _targetIdxCount)
+	{
+		pickEdgeCollapses(collapses, _outIndices, remap, kinds, loop);
+		if (collapses.empty())
+			break;
+		rankEdgeCollapses(collapses, positions, quadrics, remap);
+
+		collapseOrder.resize(collapses.size());
+		std::iota(collapseOrder.begin(), collapseOrder.end(), 0u);
+		std::sort(collapseOrder.begin(), collapseOrder.end(), [&collapses](uint32_t a, uint32_t b) { return collapses[a].error < collapses[b].error; });
+
+		buildTriangleAdjacency(triangles, _outIndices, _vertexCount);
+		std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+		std::fill(collapseLocked.begin(), collapseLocked.end(), 0u);
+
+		// every pass collapses a set of independent edges, stopping early once the cheap ones are gone so the next pass can re-rank
+		const size_t triangleCollapseGoal = (_outIndices.size()-_targetIdxCount)/3u;
+		const size_t edgeCollapseGoal = triangleCollapseGoal/2u;
+		const float errorGoal = edgeCollapseGoal < collapses.size() ? 1.5f*collapses[collapseOrder[edgeCollapseGoal]].error : FLT_MAX;
+
+		size_t edgeCollapses = 0u, triangleCollapses = 0u;
+		for (size_t i = 0; i < collapseOrder.size(); ++i)
+		{
+			const Collapse& c = collapses[collapseOrder[i]];
+			const uint32_t r0 = remap[c.v0];
+			const uint32_t r1 = remap[c.v1];
+			if (collapseLocked[r0] || collapseLocked[r1])
+				continue;
+			if (c.error > errorLimit || triangleCollapses >= triangleCollapseGoal)
+				break;
+			if (c.error > errorGoal && triangleCollapses > triangleCollapseGoal/10u)
+				break;
+
+			// a seam vertex takes its sibling along, onto the sibling of the target on the other side of the seam
+			uint32_t s0 = INVALID_VERTEX, s1 = INVALID_VERTEX;
+			if (kinds[c.v0] == EVK_SEAM)
+			{
+				s0 = wedge[c.v0];
+				s1 = loop[c.v0] == c.v1 ? loopback[s0] : loop[s0];
+				if (s1 == INVALID_VERTEX || remap[s1] != r1)
+					continue;
+			}
+
+			if (hasTriangleFlips(triangles, _outIndices, positions, collapseRemap, c.v0, c.v1))
+				continue;
+			if (s0 != INVALID_VERTEX && hasTriangleFlips(triangles, _outIndices, positions, collapseRemap, s0, s1))
+				continue;
+
+			collapseRemap[c.v0] = c.v1;
+			if (s0 != INVALID_VERTEX)
+				collapseRemap[s0] = s1;
+			quadricAdd(quadrics[r1], quadrics[r0]);
+			collapseLocked[r0] = collapseLocked[r1] = 1u;
+
+			// an edge inside the surface has a triangle on both sides
+			triangleCollapses += kinds[c.v0] == EVK_BORDER ? 1u : 2u;
+			edgeCollapses++;
+			resultError = std::max(resultError, c.error);
+		}
+		if (!edgeCollapses)
+			break;
+
+		size_t writeIx = 0u;
+		for (size_t i = 0; i < _outIndices.size(); i += 3u)
+		{
+			const uint32_t a = collapseRemap[_outIndices[i+0]];
+			const uint32_t b = collapseRemap[_outIndices[i+1]];
+			const uint32_t c = collapseRemap[_outIndices[i+2]];
+			if (a == b || a == c || b == c)
+				continue;
+			_outIndices[writeIx++] = a;
+			_outIndices[writeIx++] = b;
+			_outIndices[writeIx++] = c;
+		}
+		_outIndices.resize(writeIx);
+
+		remapEdgeLoops(loop, collapseRemap);
+		remapEdgeLoops(loopback, collapseRemap);
+	}
+
+	return sqrtf(resultError)/scale;
+}
+
+void CQuadricMeshSimplifier::buildPositionRemap(std::vector<uint32_t>& _remap, std::vector<uint32_t>& _wedge, const std::vector<core::vectorSIMDf>& _positions)
+{
+	const size_t vertexCount = _positions.size();
+	std::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&_positions](uint32_t a, uint32_t b)
+	{
+		const core::vectorSIMDf& pa = _positions[a];
+		const core::vectorSIMDf& pb = _positions[b];
+		if (pa.x != pb.x)
+			return pa.x < pb.x;
+		if (pa.y != pb.y)
+			return pa.y < pb.y;
+		if (pa.z != pb.z)
+			return pa.z < pb.z;
+		return a < b;
+	});
+
+	// all vertices of one position point to the first of them, and form a circular list through _wedge
+	_remap.resize(vertexCount);
+	_wedge.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; )
+	{
+		size_t end = i+1u;
+		const core::vectorSIMDf& p = _positions[order[i]];
+		while (end < vertexCount && _positions[order[end]].x == p.x && _positions[order[end]].y == p.y && _positions[order[end]].z == p.z)
+			++end;
+
+		for (size_t j = i; j < end; ++j)
+		{
+			_remap[order[j]] = order[i];
+			_wedge[order[j]] = order[j+1u < end ? j+1u : i];
+		}
+		i = end;
+	}
+}
+
+void CQuadricMeshSimplifier::buildEdgeAdjacency(Adjacency& _adjacency, const std::vector<uint32_t>& _indices, size_t _vertexCount)
+{
+	// half-edges going out of every vertex, in winding order
+	_adjacency.offsets.assign(_vertexCount+1u, 0u);
+	for (size_t i = 0; i < _indices.size(); ++i)
+		_adjacency.offsets[_indices[i]+1u]++;
+	for (size_t i = 0; i < _vertexCount; ++i)
+		_adjacency.offsets[i+1u] += _adjacency.offsets[i];
+
+	std::vector<uint32_t> fill(_adjacency.offsets.begin(), _adjacency.offsets.end()-1);
+	_adjacency.data.resize(_indices.size());
+	for (size_t i = 0; i < _indices.size(); i += 3u)
+	{
+		const uint32_t a = _indices[i+0], b = _indices[i+1], c = _indices[i+2];
+		_adjacency.data[fill[a]++] = b;
+		_adjacency.data[fill[b]++] = c;
+		_adjacency.data[fill[c]++] = a;
+	}
+}
+
+void CQuadricMeshSimplifier::buildTriangleAdjacency(Adjacency& _adjacency, const std::vector<uint32_t>& _indices, size_t _vertexCount)
+{
+	_adjacency.offsets.assign(_vertexCount+1u, 0u);
+	for (size_t i = 0; i < _indices.size(); ++i)
+		_adjacency.offsets[_indices[i]+1u]++;
+	for (size_t i = 0; i < _vertexCount; ++i)
+		_adjacency.offsets[i+1u] += _adjacency.offsets[i];
+
+	std::vector<uint32_t> fill(_adjacency.offsets.begin(), _adjacency.offsets.end()-1);
+	_adjacency.data.resize(_indices.size());
+	for (size_t i = 0; i < _indices.size(); ++i)
+		_adjacency.data[fill[_indices[i]]++] = uint32_t(i/3u);
+}
+
+bool CQuadricMeshSimplifier::hasEdge(const Adjacency& _adjacency, uint32_t _a, uint32_t _b)
+{
+	for (uint32_t i = _adjacency.offsets[_a]; i < _adjacency.offsets[_a+1u]; ++i)
+		if (_adjacency.data[i] == _b)
+			return true;
+	return false;
+}
+
+void CQuadricMeshSimplifier::classifyVertices(std::vector<uint8_t>& _kinds, std::vector<uint32_t>& _loop, std::vector<uint32_t>& _loopback, const Adjacency& _adjacency, const std::vector<uint32_t>& _remap, const std::vector<uint32_t>& _wedge)
+{
+	const size_t vertexCount = _remap.size();
+
+	// an open half-edge has no half-edge going back, _loop follows them forward and _loopback backward
+	_loop.assign(vertexCount, INVALID_VERTEX);
+	_loopback.assign(vertexCount, INVALID_VERTEX);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		for (uint32_t i = _adjacency.offsets[v]; i < _adjacency.offsets[v+1u]; ++i)
+		{
+			const uint32_t target = _adjacency.data[i];
+			bool duplicate = false;
+			for (uint32_t j = _adjacency.offsets[v]; j < i; ++j)
+				duplicate = duplicate || _adjacency.data[j] == target;
+
+			// the same half-edge twice means a non-manifold edge, lock both ends
+			if (duplicate)
+			{
+				_loop[v] = MULTIPLE_EDGES;
+				_loopback[target] = MULTIPLE_EDGES;
+			}
+			else if (!hasEdge(_adjacency, target, v))
+			{
+				_loop[v] = _loop[v] == INVALID_VERTEX ? target : MULTIPLE_EDGES;
+				_loopback[target] = _loopback[target] == INVALID_VERTEX ? v : MULTIPLE_EDGES;
+			}
+		}
+	}
+
+	_kinds.resize(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		const bool singleLoop = _loop[v] < MULTIPLE_EDGES && _loopback[v] < MULTIPLE_EDGES;
+		if (_wedge[v] == v)
+		{
+			if (_loop[v] == INVALID_VERTEX && _loopback[v] == INVALID_VERTEX)
+				_kinds[v] = EVK_MANIFOLD;
+			else
+				_kinds[v] = singleLoop ? EVK_BORDER : EVK_LOCKED;
+		}
+		else if (_wedge[_wedge[v]] == v)
+		{
+			// both siblings are on one open edge loop each, running opposite ways along the same positions
+			const uint32_t w = _wedge[v];
+			const bool seam = singleLoop && _loop[w] < MULTIPLE_EDGES && _loopback[w] < MULTIPLE_EDGES &&
+				_remap[_loop[v]] == _remap[_loopback[w]] && _remap[_loopback[v]] == _remap[_loop[w]];
+			_kinds[v] = seam ? EVK_SEAM : EVK_LOCKED;
+		}
+		else
+			_kinds[v] = EVK_LOCKED;
+	}
+
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		if (_kinds[v] != EVK_BORDER && _kinds[v] != EVK_SEAM)
+			_loop[v] = _loopback[v] = INVALID_VERTEX;
+	}
+}
+
+void CQuadricMeshSimplifier::fillQuadrics(std::vector<Quadric>& _quadrics, const std::vector<uint32_t>& _indices, const std::vector<core::vectorSIMDf>& _positions, const Adjacency& _adjacency, const std::vector<uint32_t>& _remap, const std::vector<uint32_t>& _wedge)
+{
+	Quadric zero;
+	memset(&zero, 0, sizeof(zero));
+	_quadrics.assign(_positions.size(), zero);
+
+	for (size_t i = 0; i < _indices.size(); i += 3u)
+	{
+		const uint32_t tri[3] = {_indices[i+0], _indices[i+1], _indices[i+2]};
+		const core::vectorSIMDf& p0 = _positions[tri[0]];
+		const core::vectorSIMDf& p1 = _positions[tri[1]];
+		const core::vectorSIMDf& p2 = _positions[tri[2]];
+
+		// the plane of the triangle, weighted by its area
+		core::vectorSIMDf normal = core::cross(p1-p0, p2-p0);
+		const float doubleArea = normal.getLengthAsFloat();
+		if (doubleArea > 0.f)
+			normal /= doubleArea;
+
+		Quadric q;
+		quadricFromPlane(q, normal, -normal.dotProductAsFloat(p0), doubleArea*0.5f);
+		for (size_t k = 0; k < 3u; ++k)
+			quadricAdd(_quadrics[_remap[tri[k]]], q);
+
+		// open edges also get the plane through the edge, perpendicular to the triangle, so they resist moving sideways
+		for (size_t k = 0; k < 3u; ++k)
+		{
+			const uint32_t i0 = tri[k], i1 = tri[(k+1u)%3u], i2 = tri[(k+2u)%3u];
+			if (hasEdge(_adjacency, i1, i0))
+				continue;
+
+			// a seam has an open edge back between the same positions on the other side
+			bool seam = false;
+			for (uint32_t s = _wedge[i1]; s != i1 && !seam; s = _wedge[s])
+			{
+				for (uint32_t j = _adjacency.offsets[s]; j < _adjacency.offsets[s+1u] && !seam; ++j)
+					seam = _remap[_adjacency.data[j]] == _remap[i0];
+			}
+
+			const core::vectorSIMDf edge = _positions[i1]-_positions[i0];
+			const float edgeLengthSq = edge.dotProductAsFloat(edge);
+			if (edgeLengthSq <= 0.f)
+				continue;
+			const core::vectorSIMDf toThird = _positions[i2]-_positions[i0];
+			core::vectorSIMDf edgeNormal = toThird-edge*(toThird.dotProductAsFloat(edge)/edgeLengthSq);
+			const float edgeNormalLength = edgeNormal.getLengthAsFloat();
+			if (edgeNormalLength <= 0.f)
+				continue;
+			edgeNormal /= edgeNormalLength;
+
+			quadricFromPlane(q, edgeNormal, -edgeNormal.dotProductAsFloat(_positions[i0]), edgeLengthSq*(seam ? SEAM_EDGE_WEIGHT : BORDER_EDGE_WEIGHT));
+			quadricAdd(_quadrics[_remap[i0]], q);
+			quadricAdd(_quadrics[_remap[i1]], q);
+		}
+	}
+}
+
+void CQuadricMeshSimplifier::pickEdgeCollapses(std::vector<Collapse>& _collapses, const std::vector<uint32_t>& _indices, const std::vector<uint32_t>& _remap, const std::vector<uint8_t>& _kinds, const std::vector<uint32_t>& _loop)
+{
+	_collapses.clear();
+	for (size_t i = 0; i < _indices.size(); i += 3u)
+	{
+		for (size_t k = 0; k < 3u; ++k)
+		{
+			const uint32_t i0 = _indices[i+k];
+			const uint32_t i1 = _indices[i+(k+1u)%3u];
+			// zero length edge, or a manifold vertex which was moved onto one sibling next to the other
+			if (_remap[i0] == _remap[i1])
+				continue;
+
+			const uint8_t k0 = _kinds[i0];
+			const uint8_t k1 = _kinds[i1];
+			if (!canCollapse[k0][k1] && !canCollapse[k1][k0])
+				continue;
+			// only look at one of the two half-edges
+			if (hasOpposite[k0][k1] && _remap[i1] > _remap[i0])
+				continue;
+			// two border or seam vertices connected across the surface and not along their loop
+			if (k0 == k1 && (k0 == EVK_BORDER || k0 == EVK_SEAM) && _loop[i0] != i1)
+				continue;
+
+			Collapse c;
+			c.bidirectional = canCollapse[k0][k1] && canCollapse[k1][k0];
+			c.v0 = canCollapse[k0][k1] ? i0 : i1;
+			c.v1 = canCollapse[k0][k1] ? i1 : i0;
+			c.error = 0.f;
+			_collapses.push_back(c);
+		}
+	}
+}
+
+void CQuadricMeshSimplifier::rankEdgeCollapses(std::vector<Collapse>& _collapses, const std::vector<core::vectorSIMDf>& _positions, const std::vector<Quadric>& _quadrics, const std::vector<uint32_t>& _remap)
+{
+	for (size_t i = 0; i < _collapses.size(); ++i)
+	{
+		Collapse& c = _collapses[i];
+		const float forward = quadricError(_quadrics[_remap[c.v0]], _positions[c.v1]);
+		if (c.bidirectional)
+		{
+			const float backward = quadricError(_quadrics[_remap[c.v1]], _positions[c.v0]);
+			if (backward < forward)
+			{
+				std::swap(c.v0, c.v1);
+				c.error = backward;
+				continue;
+			}
+		}
+		c.error = forward;
+	}
+}
+
+bool CQuadricMeshSimplifier::hasTriangleFlips(const Adjacency& _triangles, const std::vector<uint32_t>& _indices, const std::vector<core::vectorSIMDf>& _positions, const std::vector<uint32_t>& _collapseRemap, uint32_t _v0, uint32_t _v1)
+{
+	const core::vectorSIMDf& p0 = _positions[_v0];
+	const core::vectorSIMDf& p1 = _positions[_v1];
+	for (uint32_t i = _triangles.offsets[_v0]; i < _triangles.offsets[_v0+1u]; ++i)
+	{
+		const uint32_t* tri = _indices.data()+_triangles.data[i]*3u;
+		// the other two corners, in winding order, where this pass' earlier collapses moved them
+		const uint32_t k = tri[0] == _v0 ? 0u : (tri[1] == _v0 ? 1u : 2u);
+		const uint32_t a = _collapseRemap[tri[(k+1u)%3u]];
+		const uint32_t b = _collapseRemap[tri[(k+2u)%3u]];
+
+		// triangles around the collapsed edge disappear, and so do ones already degenerate
+		if (a == _v1 || b == _v1 || a == b)
+			continue;
+
+		const core::vectorSIMDf& pa = _positions[a];
+		const core::vectorSIMDf& pb = _positions[b];
+		const core::vectorSIMDf before = core::cross(pa-p0, pb-p0);
+		const core::vectorSIMDf after = core::cross(pa-p1, pb-p1);
+		if (before.dotProductAsFloat(after) < 0.f)
+			return true;
+	}
+	return false;
+}
+
+void CQuadricMeshSimplifier::remapEdgeLoops(std::vector<uint32_t>& _loop, const std::vector<uint32_t>& _collapseRemap)
+{
+	for (size_t i = 0; i < _loop.size(); ++i)
+	{
+		if (_loop[i] == INVALID_VERTEX)
+			continue;
+
+		const uint32_t next = _loop[i];
+		const uint32_t target = _collapseRemap[next];
+		// the next vertex collapsed onto this one, against the direction of the loop, so the one after it comes next
+		if (target == i)
+			_loop[i] = _loop[next] != INVALID_VERTEX ? _collapseRemap[_loop[next]] : INVALID_VERTEX;
+		else
+			_loop[i] = target;
+	}
+}
+
+void CQuadricMeshSimplifier::quadricFromPlane(Quadric& _q, const core::vectorSIMDf& _normal, float _distance, float _weight)
+{
+	const double a = _normal.x, b = _normal.y, c = _normal.z, d = _distance, w = _weight;
+	_q.a00 = a*a*w;
+	_q.a11 = b*b*w;
+	_q.a22 = c*c*w;
+	_q.a10 = a*b*w;
+	_q.a20 = a*c*w;
+	_q.a21 = b*c*w;
+	_q.b0 = a*d*w;
+	_q.b1 = b*d*w;
+	_q.b2 = c*d*w;
+	_q.c = d*d*w;
+	_q.w = w;
+}
+
+void CQuadricMeshSimplifier::quadricAdd(Quadric& _q, const Quadric& _r)
+{
+	_q.a00 += _r.a00;
+	_q.a11 += _r.a11;
+	_q.a22 += _r.a22;
+	_q.a10 += _r.a10;
+	_q.a20 += _r.a20;
+	_q.a21 += _r.a21;
+	_q.b0 += _r.b0;
+	_q.b1 += _r.b1;
+	_q.b2 += _r.b2;
+	_q.c += _r.c;
+	_q.w += _r.w;
+}
+
+float CQuadricMeshSimplifier::quadricError(const Quadric& _q, const core::vectorSIMDf& _v)
+{
+	// v^T*A*v + 2*b.v + c, divided by the weight to get a mean squared distance
+	const double x = _v.x, y = _v.y, z = _v.z;
+	const double rx = 2.0*(_q.b0 + _q.a10*y) + _q.a00*x;
+	const double ry = 2.0*(_q.b1 + _q.a21*z) + _q.a11*y;
+	const double rz = 2.0*(_q.b2 + _q.a20*x) + _q.a22*z;
+
+	const double r = _q.c + rx*x + ry*y + rz*z;
+	return _q.w > 0.0 ? float(fabs(r)/_q.w) : 0.f;
+}
+
+}}
@@ -0,0 +1,92 @@
+#ifndef __C_QUADRIC_MESH_SIMPLIFIER_H_INCLUDED__
+#define __C_QUADRIC_MESH_SIMPLIFIER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IMeshBuffer.h"
+#include <vector>
+
+// Based on zeux's meshoptimizer (https://github.com/zeux/meshoptimizer) available under MIT license
+
+namespace irr { namespace scene
+{
+
+//! Triangle list simplification by half-edge collapses ordered by quadric error (Garland and Heckbert).
+/** A vertex is only ever moved onto one of its neighbours, so no attribute needs interpolating and the simplified
+triangles index into the original vertices. Vertices sharing a position with different attributes (UV or normal seams)
+may only slide along their seam, together with their sibling, and vertices on an open border only along the border.
+*/
+class CQuadricMeshSimplifier
+{
+	enum E_VERTEX_KIND
+	{
+		EVK_MANIFOLD = 0, // no open edges and no siblings, can go anywhere
+		EVK_BORDER, // on exactly one open border
+		EVK_SEAM, // on exactly one seam, with exactly one sibling
+		EVK_LOCKED, // anything else (corners, seam junctions, non-manifold), never moves
+		EVK_COUNT
+	};
+
+	//! Symmetric 4x4 matrix of a sum of weighted squared plane distances, in doubles since the distances being told apart are tiny compared to the plane offsets
+	struct Quadric
+	{
+		double a00, a11, a22;
+		double a10, a20, a21;
+		double b0, b1, b2;
+		double c;
+		double w;
+	};
+
+	struct Collapse
+	{
+		uint32_t v0;
+		uint32_t v1;
+		bool bidirectional;
+		float error;
+	};
+
+	//! Compressed lists of what each vertex is connected to
+	struct Adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> data;
+	};
+
+	// private, undefined constructor
+	CQuadricMeshSimplifier();
+
+public:
+	//! Collapses edges of a triangle list until it has at most `_targetIdxCount` indices or the next collapse would exceed `_maxError`.
+	/**
+	@param _outIndices Receives the remaining triangles, referencing the same vertices as `_indices`.
+	@param _indices Triangle list indices.
+	@param _idxCount Number of indices, a multiple of 3.
+	@param _positions Positions of all vertices the indices reference.
+	@param _vertexCount Number of positions, larger than any index.
+	@param _targetIdxCount Index count to stop at.
+	@param _maxError Largest distance the simplified surface may deviate from the original, in the units of the positions.
+	@returns The error reached, as a distance in the units of the positions.
+	*/
+	static float simplify(std::vector<uint32_t>& _outIndices, const uint32_t* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, size_t _vertexCount, size_t _targetIdxCount, float _maxError);
+
+private:
+	static void buildPositionRemap(std::vector<uint32_t>& _remap, std::vector<uint32_t>& _wedge, const std::vector<core::vectorSIMDf>& _positions);
+	static void buildEdgeAdjacency(Adjacency& _adjacency, const std::vector<uint32_t>& _indices, size_t _vertexCount);
+	static void buildTriangleAdjacency(Adjacency& _adjacency, const std::vector<uint32_t>& _indices, size_t _vertexCount);
+	static bool hasEdge(const Adjacency& _adjacency, uint32_t _a, uint32_t _b);
+
+	static void classifyVertices(std::vector<uint8_t>& _kinds, std::vector<uint32_t>& _loop, std::vector<uint32_t>& _loopback, const Adjacency& _adjacency, const std::vector<uint32_t>& _remap, const std::vector<uint32_t>& _wedge);
+	static void fillQuadrics(std::vector<Quadric>& _quadrics, const std::vector<uint32_t>& _indices, const std::vector<core::vectorSIMDf>& _positions, const Adjacency& _adjacency, const std::vector<uint32_t>& _remap, const std::vector<uint32_t>& _wedge);
+
+	static void pickEdgeCollapses(std::vector<Collapse>& _collapses, const std::vector<uint32_t>& _indices, const std::vector<uint32_t>& _remap, const std::vector<uint8_t>& _kinds, const std::vector<uint32_t>& _loop);
+	static void rankEdgeCollapses(std::vector<Collapse>& _collapses, const std::vector<core::vectorSIMDf>& _positions, const std::vector<Quadric>& _quadrics, const std::vector<uint32_t>& _remap);
+	static bool hasTriangleFlips(const Adjacency& _triangles, const std::vector<uint32_t>& _indices, const std::vector<core::vectorSIMDf>& _positions, const std::vector<uint32_t>& _collapseRemap, uint32_t _v0, uint32_t _v1);
+	static void remapEdgeLoops(std::vector<uint32_t>& _loop, const std::vector<uint32_t>& _collapseRemap);
+
+	static void quadricFromPlane(Quadric& _q, const core::vectorSIMDf& _normal, float _distance, float _weight);
+	static void quadricAdd(Quadric& _q, const Quadric& _r);
+	static float quadricError(const Quadric& _q, const core::vectorSIMDf& _v);
+};
+
+}}
+
+#endif
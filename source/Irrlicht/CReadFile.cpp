@@ -4,6 +4,13 @@
 
 #include "CReadFile.h"
 
+#ifdef _IRR_WINDOWS_API_
+#include <windows.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
 namespace irr
 {
 namespace io
@@ -11,7 +18,11 @@ namespace io
 
 
 CReadFile::CReadFile(const io::path& fileName)
-: File(0), FileSize(0), Filename(fileName)
+: File(0),
+#ifdef _IRR_WINDOWS_API_
+PositionalHandle(INVALID_HANDLE_VALUE),
+#endif
+FileSize(0), Filename(fileName)
 {
 	#ifdef _DEBUG
 	setDebugName("CReadFile");
@@ -25,6 +36,10 @@ CReadFile::~CReadFile()
 {
 	if (File)
 		fclose(File);
+#ifdef _IRR_WINDOWS_API_
+	if (PositionalHandle!=INVALID_HANDLE_VALUE)
+		CloseHandle(PositionalHandle);
+#endif
 }
 
 
@@ -38,6 +53,36 @@ int32_t CReadFile::read(void* buffer, uint32_t sizeToRead)
 }
 
 
+size_t CReadFile::readAt(const size_t& offset, void* buffer, const size_t& sizeToRead)
+{
+	if (!isOpen() || offset>=FileSize)
+		return 0;
+
+	const size_t toRead = core::min_(sizeToRead,FileSize-offset);
+	size_t done = 0;
+	while (done<toRead)
+	{
+#ifdef _IRR_WINDOWS_API_
+		const uint64_t position = offset+done;
+		OVERLAPPED overlapped = {0};
+		overlapped.Offset = DWORD(position);
+		overlapped.OffsetHigh = DWORD(position>>32);
+		DWORD chunk = 0;
+		if (!ReadFile(PositionalHandle,reinterpret_cast<uint8_t*>(buffer)+done,DWORD(core::min_<size_t>(toRead-done,0x40000000u)),&chunk,&overlapped) || chunk==0)
+			break;
+#else
+		const ssize_t chunk = pread(fileno(File),reinterpret_cast<uint8_t*>(buffer)+done,toRead-done,off_t(offset+done));
+		if (chunk<0 && errno==EINTR)
+			continue;
+		if (chunk<=0)
+			break;
+#endif
+		done += chunk;
+	}
+	return done;
+}
+
+
 //! changes position in file, returns true if successful
 //! if relativeMovement==true, the pos is changed relative to current pos,
 //! otherwise from begin of file
@@ -46,7 +91,12 @@ bool CReadFile::seek(const size_t& finalPos, bool relativeMovement)
 	if (!isOpen())
 		return false;
 
-	return fseek(File, finalPos, relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
+	// relative movements can be negative, they come in wrapped around
+#ifdef _IRR_WINDOWS_API_
+	return _fseeki64(File, int64_t(finalPos), relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
+#else
+	return fseeko(File, off_t(finalPos), relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
+#endif
 }
 
 
@@ -60,7 +110,11 @@ size_t CReadFile::getSize() const
 //! returns where in the file we are.
 size_t CReadFile::getPos() const
 {
-	return ftell(File);
+#ifdef _IRR_WINDOWS_API_
+	return _ftelli64(File);
+#else
+	return ftello(File);
+#endif
 }
 
 
@@ -83,9 +137,19 @@ void CReadFile::openFile()
 	{
 		// get FileSize
 
-		fseek(File, 0, SEEK_END);
-		FileSize = getPos();
-		fseek(File, 0, SEEK_SET);
+#ifdef _IRR_WINDOWS_API_
+		if (_fseeki64(File, 0, SEEK_END) == 0)
+			FileSize = getPos();
+	#if defined ( _IRR_WCHAR_FILESYSTEM )
+		PositionalHandle = CreateFileW(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#else
+		PositionalHandle = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	#endif
+#else
+		if (fseeko(File, 0, SEEK_END) == 0)
+			FileSize = getPos();
+#endif
+		seek(0);
 	}
 }
 
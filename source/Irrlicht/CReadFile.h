@@ -6,6 +6,7 @@
 #define __C_READ_FILE_H_INCLUDED__
 
 #include <stdio.h>
+#include "IrrCompileConfig.h"
 #include "IReadFile.h"
 #include "irrString.h"
 
@@ -29,6 +30,9 @@ namespace io
             //! returns how much was read
             virtual int32_t read(void* buffer, uint32_t sizeToRead);
 
+            //! pread on posix, an overlapped ReadFile on a handle of its own on windows
+            virtual size_t readAt(const size_t& offset, void* buffer, const size_t& sizeToRead);
+
             //! changes position in file, returns true if successful
             virtual bool seek(const size_t& finalPos, bool relativeMovement = false);
 
@@ -53,6 +57,10 @@ namespace io
             void openFile();
 
             FILE* File;
+#ifdef _IRR_WINDOWS_API_
+            //! the CRT reads through the file pointer of File's handle, which positioned reads would move
+            void* PositionalHandle;
+#endif
             size_t FileSize;
             io::path Filename;
 	};
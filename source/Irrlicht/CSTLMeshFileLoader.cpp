@@ -55,8 +55,12 @@ inline void addTriangleToMesh(std::vector<STLVertex> &verticesOut, const core::v
 //! \return Pointer to the created mesh. Returns 0 if loading failed.
 //! If you no longer need the mesh, you should call ICPUMesh::drop().
 //! See IReferenceCounted::drop() for more information.
-ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
+ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* _file)
 {
+	// the ascii variant goes through the file a character at a time, the binary one a float at a time
+	io::CBufferedReadFile buffered(_file);
+	io::CBufferedReadFile* file = &buffered;
+
 	const long filesize = file->getSize();
 	if (filesize < 6) // we need a header
 		return 0;
@@ -83,7 +87,7 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 	if (binary)
 	{
 		file->seek(80);
-		file->read(&binFaceCount, 4);
+		file->readLE(binFaceCount);
         vertices.reserve(binFaceCount);
 	}
 	else
@@ -150,7 +154,7 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 		}
 		else
 		{
-			file->read(&attrib, 2);
+			file->readLE(attrib);
 		}
 
 		video::SColor color(0xffffffff);
@@ -175,13 +179,13 @@ ICPUMesh* CSTLMeshFileLoader::createMesh(io::IReadFile* file)
 
 
 //! Read 3d vector of floats
-void CSTLMeshFileLoader::getNextVector(io::IReadFile* file, core::vectorSIMDf& vec, bool binary) const
+void CSTLMeshFileLoader::getNextVector(io::CBufferedReadFile* file, core::vectorSIMDf& vec, bool binary) const
 {
 	if (binary)
 	{
-		file->read(&vec.X, 4);
-		file->read(&vec.Y, 4);
-		file->read(&vec.Z, 4);
+		file->readLE(vec.X);
+		file->readLE(vec.Y);
+		file->readLE(vec.Z);
 	}
 	else
 	{
@@ -200,14 +204,13 @@ void CSTLMeshFileLoader::getNextVector(io::IReadFile* file, core::vectorSIMDf& v
 
 
 //! Read next word
-const core::stringc& CSTLMeshFileLoader::getNextToken(io::IReadFile* file, core::stringc& token) const
+const core::stringc& CSTLMeshFileLoader::getNextToken(io::CBufferedReadFile* file, core::stringc& token) const
 {
 	goNextWord(file);
 	uint8_t c;
 	token = "";
-	while(file->getPos() != file->getSize())
+	while(file->readByte(c))
 	{
-		file->read(&c, 1);
 		// found it, so leave
 		if (core::isspace(c))
 			break;
@@ -218,30 +221,22 @@ const core::stringc& CSTLMeshFileLoader::getNextToken(io::IReadFile* file, core:
 
 
 //! skip to next word
-void CSTLMeshFileLoader::goNextWord(io::IReadFile* file) const
+void CSTLMeshFileLoader::goNextWord(io::CBufferedReadFile* file) const
 {
 	uint8_t c;
-	while(file->getPos() != file->getSize())
-	{
-		file->read(&c, 1);
-		// found it, so leave
-		if (!core::isspace(c))
-		{
-			file->seek(-1, true);
-			break;
-		}
-	}
+	// found it when it is not a space, so leave it there
+	while(file->peekByte(c) && core::isspace(c))
+		file->readByte(c);
 }
 
 
 //! Read until line break is reached and stop at the next non-space character
-void CSTLMeshFileLoader::goNextLine(io::IReadFile* file) const
+void CSTLMeshFileLoader::goNextLine(io::CBufferedReadFile* file) const
 {
 	uint8_t c;
 	// look for newline characters
-	while(file->getPos() != file->getSize())
+	while(file->readByte(c))
 	{
-		file->read(&c, 1);
 		// found it, so leave
 		if (c=='\n' || c=='\r')
 			break;
@@ -6,6 +6,7 @@
 #define __C_STL_MESH_FILE_LOADER_H_INCLUDED__
 
 #include "IMeshLoader.h"
+#include "CBufferedReadFile.h"
 #include "irrString.h"
 #include "vectorSIMD.h"
 
@@ -29,17 +30,20 @@ public:
 	//! See IReferenceCounted::drop() for more information.
 	virtual ICPUMesh* createMesh(io::IReadFile* file);
 
+	//! the loader keeps no state between files
+	virtual bool isReentrant() const { return true; }
+
 private:
 
 	// skips to the first non-space character available
-	void goNextWord(io::IReadFile* file) const;
+	void goNextWord(io::CBufferedReadFile* file) const;
 	// returns the next word
-	const core::stringc& getNextToken(io::IReadFile* file, core::stringc& token) const;
+	const core::stringc& getNextToken(io::CBufferedReadFile* file, core::stringc& token) const;
 	// skip to next printable character after the first line break
-	void goNextLine(io::IReadFile* file) const;
+	void goNextLine(io::CBufferedReadFile* file) const;
 
 	//! Read 3d vector of floats
-	void getNextVector(io::IReadFile* file, core::vectorSIMDf& vec, bool binary) const;
+	void getNextVector(io::CBufferedReadFile* file, core::vectorSIMDf& vec, bool binary) const;
 };
 
 } // end namespace scene
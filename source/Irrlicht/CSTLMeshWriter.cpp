@@ -14,7 +14,9 @@
 #include "IMeshCache.h"
 #include "IWriteFile.h"
 #include "IFileSystem.h"
-#include <sstream>
+#include "CBufferedWriteFile.h"
+#include "CJobSystem.h"
+#include <vector>
 
 namespace irr
 {
@@ -55,61 +57,157 @@ bool CSTLMeshWriter::writeMesh(io::IWriteFile* file, scene::ICPUMesh* mesh, int3
 
 	os::Printer::log("Writing mesh", file->getFileName().c_str());
 
-	if (flags & scene::EMWF_WRITE_COMPRESSED)
-		return writeMeshBinary(file, mesh, flags);
-	else
-		return writeMeshASCII(file, mesh, flags);
+	io::CBufferedWriteFile buffered(file);
+	const bool binary = flags&(scene::EMWF_WRITE_BINARY|scene::EMWF_WRITE_COMPRESSED);
+	if (binary ? !writeMeshBinary(&buffered,mesh,flags):!writeMeshASCII(&buffered,mesh,flags))
+		return false;
+	return buffered.flush()&&!buffered.hasFailed();
 }
 
 
-template <class I>
-inline void writePositions(ICPUMeshBuffer* buffer, const bool& noIndices, io::IWriteFile* file)
+namespace
 {
-    const uint32_t indexCount = buffer->getIndexCount();
-    const uint16_t attributes = 0;
-    for (uint32_t j=0; j<indexCount; j+=3)
+    //! faces formatted together into one chunk, by one job when there is more than one chunk to do
+    const uint32_t kFacesPerChunk = 0x1000u;
+    //! mesh buffers with fewer faces are formatted on the calling thread
+    const uint32_t kMinFacesForParallel = 4u*kFacesPerChunk;
+
+    struct SBinaryFacet
     {
-        core::vectorSIMDf v1,v2,v3;
-        if (noIndices)
+        //! normal, 3 vertices and a 16bit attribute count
+        enum E_SIZE {MAX_SIZE = 50u};
+
+        static inline char* format(char* out, const core::vector3df& normal, const core::vectorSIMDf* v)
         {
-            v1 = buffer->getPosition(j);
-            v1 = buffer->getPosition(j+1);
-            v1 = buffer->getPosition(j+2);
+            memcpy(out,&normal,12);
+            for (uint32_t k=0; k<3; k++)
+                memcpy(out+12u+k*12u,v[k].pointer,12);
+            out[48] = out[49] = 0;
+            return out+MAX_SIZE;
         }
-        else
-        {
-            v1 = buffer->getPosition(((I*)buffer->getIndices())[j]);
-            v2 = buffer->getPosition(((I*)buffer->getIndices())[j+1]);
-            v3 = buffer->getPosition(((I*)buffer->getIndices())[j+2]);
+    };
+
+    struct SASCIIFacet
+    {
+        //! the fixed text plus 12 numbers each followed by a separator
+        enum E_SIZE {MAX_SIZE = 64u+12u*(io::CBufferedWriteFile::MAX_NUMBER_CHARS+1u)};
+
+        static inline char* formatVector(char* out, const float* v)
+        {
+            out = io::CBufferedWriteFile::formatFloat(out,v[0]);
+            *(out++) = ' ';
+            out = io::CBufferedWriteFile::formatFloat(out,v[1]);
+            *(out++) = ' ';
+            out = io::CBufferedWriteFile::formatFloat(out,v[2]);
+            *(out++) = '\n';
+            return out;
+        }
+
+        template<size_t N>
+        static inline char* formatLiteral(char* out, const char (&str)[N])
+        {
+            memcpy(out,str,N-1u);
+            return out+N-1u;
         }
-        const core::plane3df tmpplane(v1.getAsVector3df(),v2.getAsVector3df(),v3.getAsVector3df());
-        file->write(&tmpplane.Normal, 12);
-        file->write(&v1, 12);
-        file->write(&v2, 12);
-        file->write(&v3, 12);
-        file->write(&attributes, 2);
+
+        static inline char* format(char* out, const core::vector3df& normal, const core::vectorSIMDf* v)
+        {
+            out = formatLiteral(out,"facet normal ");
+            out = formatVector(out,&normal.X);
+            out = formatLiteral(out,"  outer loop\n");
+            for (uint32_t k=0; k<3; k++)
+            {
+                out = formatLiteral(out,"    vertex ");
+                out = formatVector(out,v[k].pointer);
+            }
+            return formatLiteral(out,"  endloop\nendfacet\n");
+        }
+    };
+
+    template<class I, class Facet>
+    char* formatFacets(char* out, const ICPUMeshBuffer* buffer, const I* indices, const uint32_t& firstFace, const uint32_t& faceEnd)
+    {
+        for (uint32_t face=firstFace; face<faceEnd; face++)
+        {
+            core::vectorSIMDf v[3];
+            for (uint32_t k=0; k<3; k++)
+                v[k] = buffer->getPosition(indices ? size_t(indices[face*3u+k]):size_t(face*3u+k));
+            const core::plane3df tmpplane(v[0].getAsVector3df(),v[1].getAsVector3df(),v[2].getAsVector3df());
+            out = Facet::format(out,tmpplane.Normal,v);
+        }
+        return out;
+    }
+
+    //! Formats the faces of a mesh buffer chunk by chunk, a few chunks at a time in parallel for large buffers, and writes them out in order.
+    template<class I, class Facet>
+    void writeFacets(io::CBufferedWriteFile* file, const ICPUMeshBuffer* buffer, const I* indices)
+    {
+        const uint32_t faceCount = uint32_t(buffer->getIndexCount()/3u);
+        const uint32_t chunkCount = (faceCount+kFacesPerChunk-1u)/kFacesPerChunk;
+        uint32_t chunksAtOnce = 1u;
+        if (faceCount>=kMinFacesForParallel)
+            chunksAtOnce = core::min_(chunkCount,2u*(CJobSystem::getGlobal()->getWorkerCount()+1u));
+
+        std::vector<char> text(size_t(chunksAtOnce)*kFacesPerChunk*Facet::MAX_SIZE);
+        std::vector<size_t> textSizes(chunksAtOnce);
+        for (uint32_t firstChunk=0; firstChunk<chunkCount; firstChunk+=chunksAtOnce)
+        {
+            const uint32_t chunks = core::min_(chunksAtOnce,chunkCount-firstChunk);
+            auto formatChunk = [&](const uint32_t& i)
+            {
+                char* const start = text.data()+size_t(i)*kFacesPerChunk*Facet::MAX_SIZE;
+                const uint32_t firstFace = (firstChunk+i)*kFacesPerChunk;
+                const uint32_t faceEnd = core::min_(firstFace+kFacesPerChunk,faceCount);
+                textSizes[i] = formatFacets<I,Facet>(start,buffer,indices,firstFace,faceEnd)-start;
+            };
+            if (chunks>1u)
+                CJobSystem::getGlobal()->parallelFor(chunks,formatChunk);
+            else
+                formatChunk(0u);
+
+            for (uint32_t i=0; i<chunks; i++)
+                file->append(text.data()+size_t(i)*kFacesPerChunk*Facet::MAX_SIZE,textSizes[i]);
+        }
+    }
+
+    template<class Facet>
+    void writeMeshBufferFacets(io::CBufferedWriteFile* file, const ICPUMeshBuffer* buffer)
+    {
+        video::E_INDEX_TYPE type = buffer->getIndexType();
+        if (!buffer->getMeshDataAndFormat()->getIndexBuffer())
+            type = video::EIT_UNKNOWN;
+        if (type==video::EIT_16BIT)
+            writeFacets<uint16_t,Facet>(file,buffer,reinterpret_cast<const uint16_t*>(buffer->getIndices()));
+        else if (type==video::EIT_32BIT)
+            writeFacets<uint32_t,Facet>(file,buffer,reinterpret_cast<const uint32_t*>(buffer->getIndices()));
+        else
+            writeFacets<uint32_t,Facet>(file,buffer,NULL);
     }
 }
 
-bool CSTLMeshWriter::writeMeshBinary(io::IWriteFile* file, scene::ICPUMesh* mesh, int32_t flags)
+bool CSTLMeshWriter::writeMeshBinary(io::CBufferedWriteFile* file, scene::ICPUMesh* mesh, int32_t flags)
 {
 	// write STL MESH header
 
-	file->write("binary ",7);
+	file->appendLiteral("binary ");
 	const core::stringc name(io::IFileSystem::getFileBasename(file->getFileName(),false));
 	const int32_t sizeleft = 73-name.size(); // 80 byte header
 	if (sizeleft<0)
-		file->write(name.c_str(),73);
+		file->append(name.c_str(),73);
 	else
 	{
 		const char buf[80] = {0};
-		file->write(name.c_str(),name.size());
-		file->write(buf,sizeleft);
+		file->append(name.c_str(),name.size());
+		file->append(buf,sizeleft);
 	}
 	uint32_t facenum = 0;
 	for (uint32_t j=0; j<mesh->getMeshBufferCount(); ++j)
-		facenum += mesh->getMeshBuffer(j)->getIndexCount()/3;
-	file->write(&facenum,4);
+	{
+		const ICPUMeshBuffer* buffer = mesh->getMeshBuffer(j);
+		if (buffer&&buffer->getMeshDataAndFormat())
+			facenum += buffer->getIndexCount()/3;
+	}
+	file->append(&facenum,4);
 
 	// write mesh buffers
 
@@ -117,39 +215,20 @@ bool CSTLMeshWriter::writeMeshBinary(io::IWriteFile* file, scene::ICPUMesh* mesh
 	{
 		ICPUMeshBuffer* buffer = mesh->getMeshBuffer(i);
 		if (buffer&&buffer->getMeshDataAndFormat())
-		{
-			video::E_INDEX_TYPE type = buffer->getIndexType();
-			if (!buffer->getMeshDataAndFormat()->getIndexBuffer())
-                type = video::EIT_UNKNOWN;
-			if (type==video::EIT_16BIT)
-            {
-                //os::Printer::log("Writing mesh with 16bit indices");
-                writePositions<uint16_t>(buffer,false,file);
-            }
-			else if (type==video::EIT_32BIT)
-            {
-                //os::Printer::log("Writing mesh with 32bit indices");
-                writePositions<uint32_t>(buffer,false,file);
-            }
-			else
-            {
-                //os::Printer::log("Writing mesh with 32bit indices");
-                writePositions<uint64_t>(buffer,true,file); //uint64_t dummy
-            }
-		}
+			writeMeshBufferFacets<SBinaryFacet>(file,buffer);
 	}
 	return true;
 }
 
 
-bool CSTLMeshWriter::writeMeshASCII(io::IWriteFile* file, scene::ICPUMesh* mesh, int32_t flags)
+bool CSTLMeshWriter::writeMeshASCII(io::CBufferedWriteFile* file, scene::ICPUMesh* mesh, int32_t flags)
 {
 	// write STL MESH header
 
-	file->write("solid ",6);
+	file->appendLiteral("solid ");
 	const core::stringc name(io::IFileSystem::getFileBasename(file->getFileName(),false));
-	file->write(name.c_str(),name.size());
-	file->write("\n\n",2);
+	file->append(name.c_str(),name.size());
+	file->appendLiteral("\n\n");
 
 	// write mesh buffers
 
@@ -158,85 +237,17 @@ bool CSTLMeshWriter::writeMeshASCII(io::IWriteFile* file, scene::ICPUMesh* mesh,
 		ICPUMeshBuffer* buffer = mesh->getMeshBuffer(i);
 		if (buffer&&buffer->getMeshDataAndFormat())
 		{
-			video::E_INDEX_TYPE type = buffer->getIndexType();
-			if (!buffer->getMeshDataAndFormat()->getIndexBuffer())
-                type = video::EIT_UNKNOWN;
-			const uint32_t indexCount = buffer->getIndexCount();
-			if (type==video::EIT_16BIT)
-			{
-                //os::Printer::log("Writing mesh with 16bit indices");
-                for (uint32_t j=0; j<indexCount; j+=3)
-                {
-                    writeFace(file,
-                        buffer->getPosition(((uint16_t*)buffer->getIndices())[j]).getAsVector3df(),
-                        buffer->getPosition(((uint16_t*)buffer->getIndices())[j+1]).getAsVector3df(),
-                        buffer->getPosition(((uint16_t*)buffer->getIndices())[j+2]).getAsVector3df());
-                }
-			}
-			else if (type==video::EIT_32BIT)
-			{
-                //os::Printer::log("Writing mesh with 32bit indices");
-                for (uint32_t j=0; j<indexCount; j+=3)
-                {
-                    writeFace(file,
-                        buffer->getPosition(((uint32_t*)buffer->getIndices())[j]).getAsVector3df(),
-                        buffer->getPosition(((uint32_t*)buffer->getIndices())[j+1]).getAsVector3df(),
-                        buffer->getPosition(((uint32_t*)buffer->getIndices())[j+2]).getAsVector3df());
-                }
-			}
-			else
-            {
-                //os::Printer::log("Writing mesh with no indices");
-                for (uint32_t j=0; j<indexCount; j+=3)
-                {
-                    writeFace(file,
-                        buffer->getPosition(j).getAsVector3df(),
-                        buffer->getPosition(j+1).getAsVector3df(),
-                        buffer->getPosition(j+2).getAsVector3df());
-                }
-            }
-			file->write("\n",1);
+			writeMeshBufferFacets<SASCIIFacet>(file,buffer);
+			file->appendChar('\n');
 		}
 	}
 
-	file->write("endsolid ",9);
-	file->write(name.c_str(),name.size());
+	file->appendLiteral("endsolid ");
+	file->append(name.c_str(),name.size());
 
 	return true;
 }
 
-
-void CSTLMeshWriter::getVectorAsStringLine(const core::vector3df& v, core::stringc& s) const
-{
-    std::ostringstream tmp;
-    tmp << v.X << " " << v.Y << " " << v.Z << "\n";
-    s = core::stringc(tmp.str().c_str());
-}
-
-
-void CSTLMeshWriter::writeFace(io::IWriteFile* file,
-		const core::vector3df& v1,
-		const core::vector3df& v2,
-		const core::vector3df& v3)
-{
-	core::stringc tmp;
-	file->write("facet normal ",13);
-	getVectorAsStringLine(core::plane3df(v1,v2,v3).Normal, tmp);
-	file->write(tmp.c_str(),tmp.size());
-	file->write("  outer loop\n",13);
-	file->write("    vertex ",11);
-	getVectorAsStringLine(v1, tmp);
-	file->write(tmp.c_str(),tmp.size());
-	file->write("    vertex ",11);
-	getVectorAsStringLine(v2, tmp);
-	file->write(tmp.c_str(),tmp.size());
-	file->write("    vertex ",11);
-	getVectorAsStringLine(v3, tmp);
-	file->write(tmp.c_str(),tmp.size());
-	file->write("  endloop\n",10);
-	file->write("endfacet\n",9);
-}
-
 } // end namespace
 } // end namespace
 
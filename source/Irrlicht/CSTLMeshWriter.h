@@ -7,6 +7,7 @@
 
 #include "IMeshWriter.h"
 #include "irrString.h"
+#include "CBufferedWriteFile.h"
 
 namespace irr
 {
@@ -31,18 +32,10 @@ namespace scene
 
         protected:
             // write binary format
-            bool writeMeshBinary(io::IWriteFile* file, scene::ICPUMesh* mesh, int32_t flags);
+            bool writeMeshBinary(io::CBufferedWriteFile* file, scene::ICPUMesh* mesh, int32_t flags);
 
             // write text format
-            bool writeMeshASCII(io::IWriteFile* file, scene::ICPUMesh* mesh, int32_t flags);
-
-            // create vector output with line end into string
-            void getVectorAsStringLine(const core::vector3df& v,
-                    core::stringc& s) const;
-
-            // write face information to file
-            void writeFace(io::IWriteFile* file, const core::vector3df& v1,
-                    const core::vector3df& v2, const core::vector3df& v3);
+            bool writeMeshASCII(io::CBufferedWriteFile* file, scene::ICPUMesh* mesh, int32_t flags);
 
             scene::ISceneManager* SceneManager;
 	};
@@ -11,8 +11,11 @@
 #include "IMaterialRenderer.h"
 #include "IReadFile.h"
 #include "IWriteFile.h"
+#include "CReadFile.h"
+#include "CMemoryFile.h"
 
 #include "os.h"
+#include "CProfiler.h"
 
 // We need this include for the case of skinned mesh support without
 // any such loader
@@ -145,7 +148,8 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	CursorControl(cursorControl),
 	ActiveCamera(0), AmbientLight(0,0,0,0),
 	MeshCache(0), CurrentRendertime(ESNRP_NONE), LightManager(0),
-	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
+	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type"),
+	PendingAsyncLoads(0u), AsyncLoadersExit(false)
 {
 	#ifdef _DEBUG
 	ISceneManager::setDebugName("CSceneManager ISceneManager");
@@ -171,6 +175,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	// create geometry creator
 	GeometryCreator = new CGeometryCreator();
 	MeshManipulator = new CMeshManipulator();
+	OcclusionCuller = new CCPUOcclusionCuller();
 	{
         //ICPUMesh* boxmesh = GeometryCreator->createCubeMeshCPU();
 
@@ -359,6 +364,15 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	// let the loader threads drain the queue, nobody may be left waiting on a dead promise
+	{
+		std::lock_guard<std::mutex> lock(AsyncLoadMutex);
+		AsyncLoadersExit = true;
+	}
+	AsyncLoadQueued.notify_all();
+	for (auto it=AsyncLoaderThreads.begin(); it!=AsyncLoaderThreads.end(); it++)
+		it->join();
+
 	clearDeletionList();
 
 	//! force to remove hardwareTextures from the driver
@@ -375,6 +389,8 @@ CSceneManager::~CSceneManager()
     if (MeshManipulator)
         MeshManipulator->drop();
 
+	delete OcclusionCuller;
+
 	if (GeometryCreator)
 		GeometryCreator->drop();
 
@@ -412,16 +428,263 @@ CSceneManager::~CSceneManager()
 //! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 ICPUMesh* CSceneManager::getMesh(const io::path& filename)
 {
-	ICPUMesh* msh = MeshCache->getMeshByName(filename);
-	if (msh)
+	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
+
+	// nothing to merge with, so neither the lock nor a pending load is needed
+	if (PendingAsyncLoads.load(std::memory_order_acquire)==0u)
+	{
+		ICPUMesh* msh = getCachedMesh(filename,absolutePath);
+		if (msh)
+			return msh;
+
+		io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+		if (!file)
+		{
+			os::Printer::log("Could not load mesh, because file could not be opened", filename.c_str(), ELL_ERROR);
+			return 0;
+		}
+
+		msh = loadMesh(file,true);
+		if (msh)
+		{
+			MeshCache->addMesh(file->getFileName(), msh);
+			msh->drop();
+		}
+		file->drop();
 		return msh;
+	}
 
-	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
-	msh = getMesh(file);
+	std::shared_future<ICPUMesh*> future;
+	io::IReadFile* file = NULL;
+	bool loadHere = false;
+	{
+		// looked up under the lock, so a load can't be published in between
+		std::lock_guard<std::mutex> lock(AsyncLoadMutex);
+		ICPUMesh* msh = getCachedMesh(filename,absolutePath);
+		if (msh)
+			return msh;
+
+		auto found = AsyncLoads.find(absolutePath);
+		if (found==AsyncLoads.end())
+		{
+			SAsyncMeshLoad& load = AsyncLoads[absolutePath];
+			PendingAsyncLoads++;
+			load.Future = load.Promise.get_future().share();
+			load.Started = true;
+			load.File = NULL;
+			future = load.Future;
+			loadHere = true;
+		}
+		else
+		{
+			future = found->second.Future;
+			// still queued, don't wait for the loader threads to get to it
+			if (!found->second.Started)
+			{
+				found->second.Started = true;
+				file = found->second.File;
+				found->second.File = NULL;
+				loadHere = true;
+			}
+		}
+	}
+
+	if (loadHere)
+	{
+		if (!file)
+			file = FileSystem->createAndOpenFile(filename);
+		completeAsyncLoad(absolutePath,filename,file,false);
+	}
+
+	return future.get();
+}
+
+
+//! gets a mesh on a loader thread, merging requests for files already being loaded.
+std::shared_future<ICPUMesh*> CSceneManager::getMeshAsync(const io::path& filename)
+{
+	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
+	{
+		std::lock_guard<std::mutex> lock(AsyncLoadMutex);
+		auto found = AsyncLoads.find(absolutePath);
+		if (found!=AsyncLoads.end())
+			return found->second.Future;
+
+		ICPUMesh* msh = getCachedMesh(filename,absolutePath);
+		if (msh)
+			return createReadyMeshFuture(msh);
+	}
+
+	// the other loaders may touch the file system, textures or state of their own, they run here
+	if (!isLoadableOnLoaderThreads(absolutePath))
+		return createReadyMeshFuture(getMesh(filename));
+
+	// opening grabs the file system and archives, which only this thread may do
+	io::IReadFile* file = openFileForLoaderThread(filename);
+	if (!file)
+	{
+		os::Printer::log("Could not load mesh, because file could not be opened", filename.c_str(), ELL_ERROR);
+		return createReadyMeshFuture(NULL);
+	}
+
+	std::unique_lock<std::mutex> lock(AsyncLoadMutex);
+	auto found = AsyncLoads.find(absolutePath);
+	if (found!=AsyncLoads.end())
+	{
+		// another thread requested it meanwhile
+		std::shared_future<ICPUMesh*> future = found->second.Future;
+		lock.unlock();
+		file->drop();
+		return future;
+	}
+
+	SAsyncMeshLoad& load = AsyncLoads[absolutePath];
+	PendingAsyncLoads++;
+	load.Future = load.Promise.get_future().share();
+	load.Started = false;
+	load.Filename = filename;
+	load.File = file;
+	std::shared_future<ICPUMesh*> future = load.Future;
+	AsyncLoadQueue.push_back(absolutePath);
+
+	if (AsyncLoaderThreads.empty())
+	{
+		// leave a core for the thread that is rendering
+		const uint32_t threadCount = std::max(std::thread::hardware_concurrency(),2u)-1u;
+		for (uint32_t i=0; i<threadCount; i++)
+			AsyncLoaderThreads.push_back(std::thread(&CSceneManager::asyncLoaderThread,this));
+	}
+	lock.unlock();
+
+	AsyncLoadQueued.notify_one();
+	return future;
+}
+
+
+//! body of the threads serving getMeshAsync()
+void CSceneManager::asyncLoaderThread()
+{
+	std::unique_lock<std::mutex> lock(AsyncLoadMutex);
+	while (true)
+	{
+		while (AsyncLoadQueue.empty()&&!AsyncLoadersExit)
+			AsyncLoadQueued.wait(lock);
+		if (AsyncLoadQueue.empty())
+			return;
+
+		io::path absolutePath = AsyncLoadQueue.front();
+		AsyncLoadQueue.pop_front();
+
+		// getMesh() may have taken the load over or even finished it already
+		auto found = AsyncLoads.find(absolutePath);
+		if (found==AsyncLoads.end()||found->second.Started)
+			continue;
+		found->second.Started = true;
+		const io::path filename = found->second.Filename;
+		io::IReadFile* file = found->second.File;
+		found->second.File = NULL;
+
+		lock.unlock();
+		completeAsyncLoad(absolutePath,filename,file,true);
+		lock.lock();
+	}
+}
+
+
+//! loads the mesh and hands it to everyone waiting on it, takes over the reference to the file
+void CSceneManager::completeAsyncLoad(const io::path& absolutePath, const io::path& filename, io::IReadFile* file, const bool& onLoaderThread)
+{
+	ICPUMesh* msh = 0;
+	io::path cachedName;
 	if (file)
-        file->drop();
+	{
+		cachedName = file->getFileName();
+		msh = loadMesh(file,!onLoaderThread);
+		// the file is one the loader thread owns alone, see openFileForLoaderThread()
+		file->drop();
+	}
+	else
+		os::Printer::log("Could not load mesh, because file could not be opened", filename.c_str(), ELL_ERROR);
 
-	return msh;
+	// publish into the cache and retire the request in one step,
+	// so that a lookup sees either the pending load or the cached mesh
+	std::promise<ICPUMesh*> promise;
+	{
+		std::lock_guard<std::mutex> lock(AsyncLoadMutex);
+		if (msh)
+		{
+			// the cache adopts the loader's reference, grabbing or dropping a mesh the main thread can already reach would race,
+			// and evicting drops meshes other threads may be grabbing, leave it to the next addMesh() on the main thread
+			if (onLoaderThread)
+				MeshCache->adoptMeshWithoutEviction(cachedName, msh);
+			else
+			{
+				MeshCache->addMesh(cachedName, msh);
+				msh->drop();
+			}
+		}
+
+		auto found = AsyncLoads.find(absolutePath);
+		promise = std::move(found->second.Promise);
+		AsyncLoads.erase(found);
+		PendingAsyncLoads--;
+	}
+	promise.set_value(msh);
+}
+
+
+//! looks the mesh up under the name it was requested with and under its absolute path, AsyncLoadMutex must be held while loads are pending
+ICPUMesh* CSceneManager::getCachedMesh(const io::path& filename, const io::path& absolutePath)
+{
+	// meshes added under names of their own keep being found by those
+	if (MeshCache->isMeshLoaded(filename))
+		return MeshCache->getMeshByName(filename);
+	return MeshCache->getMeshByName(absolutePath);
+}
+
+
+//! whether every loader which could get the file is IMeshLoader::isReentrant()
+bool CSceneManager::isLoadableOnLoaderThreads(const io::path& filename) const
+{
+	bool claimed = false;
+	for (uint32_t i=0; i<MeshLoaderList.size(); ++i)
+	{
+		if (!MeshLoaderList[i]->isALoadableFileExtension(filename))
+			continue;
+		if (!MeshLoaderList[i]->isReentrant())
+			return false;
+		claimed = true;
+	}
+	return claimed;
+}
+
+
+//! opens a file which a loader thread can read and drop without touching anything other threads use
+io::IReadFile* CSceneManager::openFileForLoaderThread(const io::path& filename)
+{
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+	if (!file || dynamic_cast<io::CReadFile*>(file) || dynamic_cast<io::CMemoryReadFile*>(file))
+		return file;
+
+	// files inside archives hold on to the archive, read them into memory here
+	const size_t size = file->getSize();
+	int8_t* data = new int8_t[size];
+	io::IReadFile* copy = NULL;
+	if (file->readAt(0,data,size)==size)
+		copy = io::createMemoryReadFile(data,size,file->getFileName(),true);
+	else
+		delete [] data;
+	file->drop();
+	return copy;
+}
+
+
+//! a future which is ready from the start
+std::shared_future<ICPUMesh*> CSceneManager::createReadyMeshFuture(ICPUMesh* mesh)
+{
+	std::promise<ICPUMesh*> ready;
+	ready.set_value(mesh);
+	return ready.get_future().share();
 }
 
 
@@ -434,11 +697,27 @@ ICPUMesh* CSceneManager::getMesh(io::IReadFile* file)
 		return 0;
     }
 
-	io::path name = file->getFileName();
 	ICPUMesh* msh = MeshCache->getMeshByName(file->getFileName());
 	if (msh)
 		return msh;
 
+	msh = loadMesh(file,true);
+	if (msh)
+	{
+		MeshCache->addMesh(file->getFileName(), msh);
+		msh->drop();
+	}
+
+	return msh;
+}
+
+
+//! runs the mesh loaders on an open file, returns a grabbed mesh which is not in the cache yet
+ICPUMesh* CSceneManager::loadMesh(io::IReadFile* file, const bool& log)
+{
+	io::path name = file->getFileName();
+	ICPUMesh* msh = 0;
+
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	int32_t count = MeshLoaderList.size();
 	for (int32_t i=count-1; i>=0; --i)
@@ -447,16 +726,17 @@ ICPUMesh* CSceneManager::getMesh(io::IReadFile* file)
 		{
 			// reset file to avoid side effects of previous calls to createMesh
 			file->seek(0);
+			_IRR_PROFILE_ZONE("IMeshLoader::createMesh");
 			msh = MeshLoaderList[i]->createMesh(file);
 			if (msh)
-			{
-				MeshCache->addMesh(file->getFileName(), msh);
-				msh->drop();
 				break;
-			}
 		}
 	}
 
+	// the logger posts to the event receiver, which loader threads must not call
+	if (!log)
+		return msh;
+
 	if (!msh)
 		os::Printer::log("Could not load mesh, file format seems to be unsupported", file->getFileName().c_str(), ELL_ERROR);
 	else
@@ -803,6 +1083,10 @@ bool CSceneManager::isCulled(ISceneNode* node) const
             return true;
 	}
 
+	// hidden behind the occluders rasterized at the start of drawAll() ?
+	if (!result && (node->getAutomaticCulling() & scene::EAC_CPU_OCCLUSION))
+		result = OcclusionCuller->isBoxOccluded(node->getBoundingBox(),node->getAbsoluteTransformation());
+
 	return result;
 }
 
@@ -943,6 +1227,8 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
+	_IRR_PROFILE_ZONE("CSceneManager::drawAll");
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
 	// reset attributes
 	Parameters.setAttribute ( "culled", 0 );
@@ -964,7 +1250,10 @@ void CSceneManager::drawAll()
 	Driver->setAllowZWriteOnTransparent( *((bool*)&(Parameters[ALLOW_ZWRITE_ON_TRANSPARENT])) );
 
 	// do animations and other stuff.
-	OnAnimate(os::Timer::getTime());
+	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll OnAnimate");
+		OnAnimate(os::Timer::getTime());
+	}
 
 	/*!
 		First Scene Node for prerendering should be the active camera
@@ -975,16 +1264,26 @@ void CSceneManager::drawAll()
 	{
 		ActiveCamera->render();
 		camWorldPos = ActiveCamera->getAbsolutePosition();
+
+		// occluders are rasterized once, before any node gets tested against them, without occluders this only forgets the last frame's depth
+		{
+			_IRR_PROFILE_ZONE("CSceneManager::drawAll CPU occlusion");
+			OcclusionCuller->rasterize(concatenateBFollowedByA(ActiveCamera->getProjectionMatrix(),ActiveCamera->getViewMatrix()),ActiveCamera->getNearValue());
+		}
 	}
 
 	// let all nodes register themselves
-	OnRegisterSceneNode();
+	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll OnRegisterSceneNode");
+		OnRegisterSceneNode();
+	}
 
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
 
 	//render camera scenes
 	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll camera pass");
 		CurrentRendertime = ESNRP_CAMERA;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1002,6 +1301,7 @@ void CSceneManager::drawAll()
 
 	// render skyboxes
 	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll sky box pass");
 		CurrentRendertime = ESNRP_SKY_BOX;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1031,6 +1331,7 @@ void CSceneManager::drawAll()
 
 	// render default objects
 	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll solid pass");
 		CurrentRendertime = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1064,6 +1365,7 @@ void CSceneManager::drawAll()
 
 	// render transparent objects.
 	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll transparent pass");
 		CurrentRendertime = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1097,6 +1399,7 @@ void CSceneManager::drawAll()
 
 	// render transparent effect objects.
 	{
+		_IRR_PROFILE_ZONE("CSceneManager::drawAll transparent effect pass");
 		CurrentRendertime = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1250,6 +1553,12 @@ IMeshManipulator* CSceneManager::getMeshManipulator()
 	return MeshManipulator;
 }
 
+//! Returns a pointer to the CPU occlusion culler.
+CCPUOcclusionCuller* CSceneManager::getCPUOcclusionCuller()
+{
+	return OcclusionCuller;
+}
+
 //! Adds a scene node to the deletion queue.
 void CSceneManager::addToDeletionQueue(IDummyTransformationSceneNode* node)
 {
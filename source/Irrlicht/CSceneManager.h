@@ -14,9 +14,16 @@
 #include "ILightManager.h"
 #include "ISkinningStateManager.h"
 #include "CMeshManipulator.h"
+#include "CCPUOcclusionCuller.h"
+#include "CMeshCache.h"
 
 #include <map>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 namespace irr
 {
@@ -50,6 +57,9 @@ namespace scene
 		//! gets a mesh. loads it if needed. returned pointer must not be dropped.
 		virtual ICPUMesh* getMesh(io::IReadFile* file);
 
+		//! gets a mesh on a loader thread, merging requests for files already being loaded.
+		virtual std::shared_future<ICPUMesh*> getMeshAsync(const io::path& filename);
+
 		//! Returns an interface to the mesh cache which is shared beween all existing scene managers.
 		virtual IMeshCache<ICPUMesh>* getMeshCache();
 
@@ -231,6 +241,9 @@ namespace scene
 		//! Returns a pointer to the mesh manipulator.
 		virtual IMeshManipulator* getMeshManipulator();
 
+		//! Returns a pointer to the CPU occlusion culler.
+		virtual CCPUOcclusionCuller* getCPUOcclusionCuller();
+
 		//! Adds a scene node to the deletion queue.
 		virtual void addToDeletionQueue(IDummyTransformationSceneNode* node);
 /*
@@ -332,6 +345,28 @@ namespace scene
 		//! clears the deletion list
 		void clearDeletionList();
 
+		//! runs the mesh loaders on an open file, returns a grabbed mesh which is not in the cache yet
+		/** Loader threads pass false for `log`, the logger calls the event receiver. */
+		ICPUMesh* loadMesh(io::IReadFile* file, const bool& log);
+
+		//! body of the threads serving getMeshAsync()
+		void asyncLoaderThread();
+
+		//! loads the mesh and hands it to everyone waiting on it, takes over the reference to the file
+		void completeAsyncLoad(const io::path& absolutePath, const io::path& filename, io::IReadFile* file, const bool& onLoaderThread);
+
+		//! looks the mesh up under the name it was requested with and under its absolute path, AsyncLoadMutex must be held while loads are pending
+		ICPUMesh* getCachedMesh(const io::path& filename, const io::path& absolutePath);
+
+		//! whether every loader which could get the file is IMeshLoader::isReentrant()
+		bool isLoadableOnLoaderThreads(const io::path& filename) const;
+
+		//! opens a file which a loader thread can read and drop without touching anything other threads use
+		io::IReadFile* openFileForLoaderThread(const io::path& filename);
+
+		//! a future which is ready from the start
+		static std::shared_future<ICPUMesh*> createReadyMeshFuture(ICPUMesh* mesh);
+
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const char* currentPath=0, bool init=false);
 
@@ -436,7 +471,7 @@ namespace scene
 		std::unordered_map<std::string,ParamStorage> Parameters;
 
 		//! Mesh cache
-		IMeshCache<ICPUMesh>* MeshCache;
+		CMeshCache<ICPUMesh>* MeshCache;
 		video::IGPUBuffer* redundantMeshDataBuf;
 
 		E_SCENE_NODE_RENDER_PASS CurrentRendertime;
@@ -453,6 +488,31 @@ namespace scene
 
 		IGeometryCreator* GeometryCreator;
 		CMeshManipulator* MeshManipulator;
+		CCPUOcclusionCuller* OcclusionCuller;
+
+		//! in-flight load shared by all requests for the same file
+		struct SAsyncMeshLoad
+		{
+			std::promise<ICPUMesh*> Promise;
+			std::shared_future<ICPUMesh*> Future;
+			//! set once a thread has taken the load, getMesh() takes over queued ones
+			bool Started;
+			//! name the load was first requested with
+			io::path Filename;
+			//! opened by getMeshAsync(), until a thread takes the load
+			io::IReadFile* File;
+		};
+		//! guards AsyncLoads, AsyncLoadQueue and AsyncLoadersExit, held across the MeshCache lookup so both agree
+		std::mutex AsyncLoadMutex;
+		std::condition_variable AsyncLoadQueued;
+		//! keyed by absolute path, so requests with different relative paths to one file get merged
+		std::map<io::path,SAsyncMeshLoad> AsyncLoads;
+		std::deque<io::path> AsyncLoadQueue;
+		//! AsyncLoads.size(), lets getMesh() skip AsyncLoadMutex while nothing loads asynchronously
+		std::atomic<uint32_t> PendingAsyncLoads;
+		//! started on the first getMeshAsync()
+		std::vector<std::thread> AsyncLoaderThreads;
+		bool AsyncLoadersExit;
 	};
 
 } // end namespace video
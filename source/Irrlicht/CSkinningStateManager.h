@@ -4,6 +4,8 @@
 
 #include "ISkinningStateManager.h"
 #include "ITextureBufferObject.h"
+#include "CProfiler.h"
+#include "CJobSystem.h"
 
 ///#define UPDATE_WHOLE_BUFFER
 
@@ -19,6 +21,12 @@ namespace scene
 #ifdef _IRR_COMPILE_WITH_OPENGL_
             video::ITextureBufferObject* TBO;
 #endif
+            //! instances posed by one job of performBoning()
+            enum E_JOB_SIZE {kInstancesPerJob = 16u};
+            //! first and last bone performBoning() posed for every instance, kept to not reallocate every frame
+            std::vector<uint32_t> instanceDirtyBones;
+            //! most threads of the global CJobSystem performBoning() poses instances on, 0 for all
+            uint32_t maxBoningThreads;
         protected:
             virtual ~CSkinningStateManager()
             {
@@ -29,7 +37,7 @@ namespace scene
 
         public:
             CSkinningStateManager(const E_BONE_UPDATE_MODE& boneControl, video::IVideoDriver* driver, const CFinalBoneHierarchy* sourceHierarchy)
-                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver)
+                                    : ISkinningStateManager(boneControl,driver,sourceHierarchy), Driver(driver), maxBoningThreads(0u)
             {
 #ifdef _IRR_COMPILE_WITH_OPENGL_
                 TBO = driver->addTextureBufferObject(finalBoneDataInstanceBuffer->getFrontBuffer(),video::ITextureBufferObject::ETBOF_RGBA32F);
@@ -38,6 +46,9 @@ namespace scene
 
             const void* getRawBoneData() {return finalBoneDataInstanceBuffer->getBackBufferPointer();}
 
+            //! Limits how many threads performBoning() poses the instances of EBUM_NONE on, 0 uses all threads of the global CJobSystem
+            void setMaxBoningThreads(const uint32_t& threads) {maxBoningThreads = threads;}
+
 #ifdef _IRR_COMPILE_WITH_OPENGL_
             virtual video::ITextureBufferObject* getBoneDataTBO() const {return TBO;}
 #else
@@ -72,6 +83,8 @@ namespace scene
                 tmp->frame = 0.f;
                 tmp->interpolateAnimation = true;
                 tmp->attachedNode = attachedNode;
+                tmp->layerCount = 0;
+                tmp->layersChanged = false;
                 if (boneControlMode!=EBUM_CONTROL)
                 {
                     FinalBoneData* boneData = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer());
@@ -188,7 +201,7 @@ namespace scene
                     return;
 
                 BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+redirect*actualSizeOfInstanceDataElement);
-                if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
+                if (currentInstance->frame==currentInstance->lastAnimatedFrame&&!currentInstance->layersChanged) //in other modes, check if also has no bones!!!
                     return;
 
                 FinalBoneData* boneDataForInstance = reinterpret_cast<FinalBoneData*>(reinterpret_cast<uint8_t*>(finalBoneDataInstanceBuffer->getBackBufferPointer())+referenceHierarchy->getBoneCount()*redirect);
@@ -203,7 +216,8 @@ namespace scene
                 size_t boneStack[256];
                 boneStack[0] = boneID;
                 size_t boneStackSize = 0;
-                while (boneDataForInstance[boneStack[boneStackSize]].lastAnimatedFrame!=currentInstance->frame && boneStack[boneStackSize] >= referenceHierarchy->getBoneLevelRangeEnd(0))
+                //! changed layers move every ancestor, until the next performBoning() the whole chain gets posed again
+                while ((currentInstance->layersChanged||boneDataForInstance[boneStack[boneStackSize]].lastAnimatedFrame!=currentInstance->frame) && boneStack[boneStackSize] >= referenceHierarchy->getBoneLevelRangeEnd(0))
                     boneStack[++boneStackSize] = referenceHierarchy->getBoneData()[boneStack[boneStackSize]].parentOffsetFromTop;
 
                 if (redirect<firstDirtyInstance)
@@ -226,21 +240,29 @@ namespace scene
                 size_t foundKeyIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
                 float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
                 core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
+                SFrameSample layerSamples[1u+2u*MAX_ANIMATION_LAYERS];
+                if (currentInstance->layerCount)
+                    sampleLayers(layerSamples,currentInstance);
 
                 while (boneStackSize--)
                 {
                     size_t j = boneStack[boneStackSize];
-                    CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx];
 
                     //core::matrix4x3 interpolatedLocalTform;
                     core::matrix3x4SIMD interpolatedLocalTform;
-                    if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
+                    if (currentInstance->layerCount)
+                        interpolatedLocalTform = blendLayers(currentInstance,layerSamples,j);
+                    else
                     {
-                        CFinalBoneHierarchy::AnimationKeyData lowerFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx-1];
-                        interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3);
+                        CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx];
+                        if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
+                        {
+                            CFinalBoneHierarchy::AnimationKeyData lowerFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundKeyIx-1];
+                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3);
+                        }
+                        else
+                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame);
                     }
-                    else
-                        interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame);
 
                     if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
                         getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform.getAsRetardedIrrlichtMatrix();
@@ -288,6 +310,201 @@ namespace scene
                 }
             }
 
+            //! Keyframe lookup of one frame, done once per instance and shared by all its bones
+            struct SFrameSample
+            {
+                size_t keyIx;
+                float interpolationFactor;
+                float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
+            };
+            inline SFrameSample sampleFrame(const float& frame) const
+            {
+                SFrameSample sample;
+                sample.keyIx = referenceHierarchy->getLowerBoundBoneKeyframes(sample.interpolationFactor,frame);
+                core::quaternion::flerp_interpolant_terms(sample.interpolantPrecalcTerm2,sample.interpolantPrecalcTerm3,sample.interpolationFactor);
+                return sample;
+            }
+            inline void sampleBone(core::vectorSIMDf& outPos, core::quaternion& outRot, core::vectorSIMDf& outScale, const SFrameSample& sample, const size_t& boneID, const bool& interpolate) const
+            {
+                const CFinalBoneHierarchy::AnimationKeyData* keys = interpolate ? referenceHierarchy->getInterpolatedAnimationData(boneID):referenceHierarchy->getNonInterpolatedAnimationData(boneID);
+                if (interpolate&&sample.interpolationFactor<1.f)
+                    CFinalBoneHierarchy::getMatrixFromKeys(outPos,outRot,outScale,keys[sample.keyIx-1],keys[sample.keyIx],sample.interpolationFactor,sample.interpolantPrecalcTerm2,sample.interpolantPrecalcTerm3);
+                else
+                    CFinalBoneHierarchy::getMatrixFromKeys(outPos,outRot,outScale,keys[sample.keyIx],keys[sample.keyIx],1.f,0.25f,0.f);
+            }
+            //! Keyframe lookups of the instance's frame then every layer's frame and reference frame, in the order blendLayers() takes them
+            inline void sampleLayers(SFrameSample* samples, const BoneHierarchyInstanceData* currentInstance) const
+            {
+                samples[0] = sampleFrame(currentInstance->frame);
+                for (uint32_t l=0; l<currentInstance->layerCount; l++)
+                {
+                    samples[1u+2u*l] = sampleFrame(currentInstance->layers[l].frame);
+                    if (currentInstance->layers[l].additive)
+                        samples[2u+2u*l] = sampleFrame(currentInstance->layers[l].referenceFrame);
+                }
+            }
+            //! Local transform of a bone of an instance with animation layers, `samples` are the instance's frame then every layer's frame and reference frame
+            inline core::matrix3x4SIMD blendLayers(const BoneHierarchyInstanceData* currentInstance, const SFrameSample* samples, const size_t& boneID) const
+            {
+                const size_t boneCount = referenceHierarchy->getBoneCount();
+                core::vectorSIMDf pos,scale;
+                core::quaternion rot;
+                //! running weighted average, so every layer is one lerp and there is nothing to divide at the end
+                float totalWeight = 0.f;
+                for (uint32_t l=0; l<currentInstance->layerCount; l++)
+                {
+                    const SAnimationLayer& layer = currentInstance->layers[l];
+                    const float weight = layer.boneMask==0xdeadbeefu ? layer.weight:(layer.weight*boneMasks[layer.boneMask*boneCount+boneID]);
+                    if (layer.additive||weight<=0.f)
+                        continue;
+
+                    core::vectorSIMDf layerPos,layerScale;
+                    core::quaternion layerRot;
+                    sampleBone(layerPos,layerRot,layerScale,samples[1u+2u*l],boneID,currentInstance->interpolateAnimation);
+                    totalWeight += weight;
+                    const float interpolant = weight/totalWeight;
+                    pos = core::mix(pos,layerPos,core::vectorSIMDf(interpolant));
+                    scale = core::mix(scale,layerScale,core::vectorSIMDf(interpolant));
+                    rot = core::quaternion::lerp(rot,layerRot,interpolant);
+                }
+                if (totalWeight>0.f)
+                    rot = core::quaternion::normalize(rot);
+                else
+                    sampleBone(pos,rot,scale,samples[0],boneID,currentInstance->interpolateAnimation);
+
+                for (uint32_t l=0; l<currentInstance->layerCount; l++)
+                {
+                    const SAnimationLayer& layer = currentInstance->layers[l];
+                    const float weight = layer.boneMask==0xdeadbeefu ? layer.weight:(layer.weight*boneMasks[layer.boneMask*boneCount+boneID]);
+                    if (!layer.additive||weight<=0.f)
+                        continue;
+
+                    core::vectorSIMDf layerPos,layerScale,referencePos,referenceScale;
+                    core::quaternion layerRot,referenceRot;
+                    sampleBone(layerPos,layerRot,layerScale,samples[1u+2u*l],boneID,currentInstance->interpolateAnimation);
+                    sampleBone(referencePos,referenceRot,referenceScale,samples[2u+2u*l],boneID,currentInstance->interpolateAnimation);
+
+                    //! axes the reference pose scales to nothing have no ratio to apply, they keep their scale
+                    core::vectorSIMDf scaleRatio = layerScale/referenceScale;
+                    for (uint32_t c=0; c<4u; c++)
+                    {
+                        if (referenceScale.pointer[c]==0.f)
+                            scaleRatio.pointer[c] = 1.f;
+                    }
+
+                    pos += (layerPos-referencePos)*weight;
+                    scale *= core::mix(core::vectorSIMDf(1.f),scaleRatio,core::vectorSIMDf(weight));
+                    referenceRot.makeInverse();
+                    rot = core::quaternion::normalize(rot*core::quaternion::normalize(core::quaternion::lerp(core::quaternion(),referenceRot*layerRot,weight)));
+                }
+
+                core::matrix3x4SIMD outMatrix;
+                outMatrix.setScaleRotationAndTranslation(scale,rot,pos);
+                return outMatrix;
+            }
+
+            //! Poses the bones of the `i`-th instance in memory which are not up to date with its frame and layers, false if there were none
+            /** Only touches the instance's own data (and its bone nodes in EBUM_READ), so different instances can be posed concurrently. */
+            inline bool animateInstance(const size_t& i, uint32_t& firstBone, uint32_t& lastBone)
+            {
+                BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
+                if (currentInstance->frame==currentInstance->lastAnimatedFrame&&!currentInstance->layersChanged) //in other modes, check if also has no bones!!!
+                    return false;
+
+                core::matrix4x3 attachedNodeTform;
+                if (boneControlMode==EBUM_READ&&currentInstance->attachedNode)
+                    attachedNodeTform = currentInstance->attachedNode->getAbsoluteTransformation();
+
+
+                float interpolationFactor;
+                size_t foundBoneIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
+                float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
+                core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
+
+                //! the keyframe lookups of all layers are shared by all bones
+                SFrameSample layerSamples[1u+2u*MAX_ANIMATION_LAYERS];
+                if (currentInstance->layerCount)
+                    sampleLayers(layerSamples,currentInstance);
+
+                bool modified = false;
+                FinalBoneData* boneDataForInstance = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer())+referenceHierarchy->getBoneCount()*i;
+                for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                {
+                    if (!currentInstance->layersChanged&&boneDataForInstance[j].lastAnimatedFrame==currentInstance->frame)
+                        continue;
+                    if (!modified)
+                    {
+                        firstBone = j;
+                        modified = true;
+                    }
+                    lastBone = j;
+                    boneDataForInstance[j].lastAnimatedFrame = currentInstance->frame;
+
+                    core::matrix4x3 interpolatedLocalTform;
+                    if (currentInstance->layerCount)
+                        interpolatedLocalTform = blendLayers(currentInstance,layerSamples,j).getAsRetardedIrrlichtMatrix();
+                    else
+                    {
+                        CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx];
+
+                        if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
+                        {
+                            CFinalBoneHierarchy::AnimationKeyData lowerFrame =  (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx-1];
+                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3).getAsRetardedIrrlichtMatrix();
+                        }
+                        else
+                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame).getAsRetardedIrrlichtMatrix();
+                    }
+
+                    if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
+                        getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform;
+                    else
+                    {
+                        const core::matrix4x3& parentTform = getGlobalMatrices(currentInstance)[referenceHierarchy->getBoneData()[j].parentOffsetFromTop];
+                        getGlobalMatrices(currentInstance)[j] = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(parentTform), core::matrix3x4SIMD().set(interpolatedLocalTform)).getAsRetardedIrrlichtMatrix();
+						//concatenateBFollowedByA(parentTform,interpolatedLocalTform);
+                    }
+                    boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j]), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix)).getAsRetardedIrrlichtMatrix();
+					//concatenateBFollowedByA(getGlobalMatrices(currentInstance)[j],referenceHierarchy->getBoneData()[j].PoseBindMatrix);
+
+
+                    core::aabbox3df bbox;
+                    bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
+                    bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
+                    bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
+                    bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
+                    bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
+                    bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
+                    //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
+					bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
+                    //
+                    if (boneControlMode==EBUM_READ)
+                    {
+                        IBoneSceneNode* bone = getBones(currentInstance)[j];
+                        if (bone)
+                        {
+							if (bone->getSkinningSpace() != IBoneSceneNode::EBSS_LOCAL)
+								bone->setRelativeTransformationMatrix(core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(attachedNodeTform), core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j])).getAsRetardedIrrlichtMatrix()/*concatenateBFollowedByA(attachedNodeTform,getGlobalMatrices(currentInstance)[j])*/);
+                            else
+                            {
+                                bone->setRelativeTransformationMatrix(interpolatedLocalTform);
+                                bone->updateAbsolutePosition();
+                            }
+                        }
+                    }
+
+                    boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
+                    boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
+                    boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
+                    boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
+                    boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
+                    boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
+                    boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
+                }
+
+                return modified;
+            }
+
             inline void TrySwapBoneBuffer()
             {
                 if (firstDirtyInstance<=lastDirtyInstance)
@@ -306,6 +523,7 @@ namespace scene
 
             virtual void performBoning()
             {
+                _IRR_PROFILE_ZONE("ISkinningStateManager::performBoning");
                 if (referenceHierarchy->getHierarchyLevels()==0||getDataInstanceCount()==0)
                     return;
 
@@ -323,96 +541,45 @@ namespace scene
                         case EBUM_READ:
                             {
                                 FinalBoneData* boneData = reinterpret_cast<FinalBoneData*>(finalBoneDataInstanceBuffer->getBackBufferPointer());
+                                //! 0xdeadbeefu as the first bone if none were posed
+                                instanceDirtyBones.resize(getDataInstanceCount()*2u);
+                                if (boneControlMode==EBUM_NONE)
+                                {
+                                    //! without bone nodes the instances share nothing, so they get posed in parallel
+                                    const uint32_t jobCount = uint32_t((getDataInstanceCount()+kInstancesPerJob-1u)/kInstancesPerJob);
+                                    CJobSystem::getGlobal()->parallelFor(jobCount,[&](const uint32_t& job)
+                                    {
+                                        const size_t jobEnd = std::min(size_t(job+1u)*kInstancesPerJob,getDataInstanceCount());
+                                        for (size_t i=size_t(job)*kInstancesPerJob; i<jobEnd; i++)
+                                        {
+                                            if (!animateInstance(i,instanceDirtyBones[i*2u],instanceDirtyBones[i*2u+1u]))
+                                                instanceDirtyBones[i*2u] = 0xdeadbeefu;
+                                        }
+                                    },maxBoningThreads);
+                                }
+                                else
+                                {
+                                    for (size_t i=0; i<getDataInstanceCount(); i++)
+                                    {
+                                        if (!animateInstance(i,instanceDirtyBones[i*2u],instanceDirtyBones[i*2u+1u]))
+                                            instanceDirtyBones[i*2u] = 0xdeadbeefu;
+                                    }
+                                }
+
                                 bool notModified = true;
                                 uint32_t localFirstDirtyInstance,localLastDirtyInstance,firstBone,lastBone;
                                 for (size_t i=0; i<getDataInstanceCount(); i++)
                                 {
-                                    BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                    if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
+                                    if (instanceDirtyBones[i*2u]==0xdeadbeefu)
                                         continue;
-
-                                    core::matrix4x3 attachedNodeTform;
-                                    if (currentInstance->attachedNode)
-                                        attachedNodeTform = currentInstance->attachedNode->getAbsoluteTransformation();
-
-
-                                    float interpolationFactor;
-                                    size_t foundBoneIx = referenceHierarchy->getLowerBoundBoneKeyframes(interpolationFactor,currentInstance->frame);
-                                    float interpolantPrecalcTerm2,interpolantPrecalcTerm3;
-                                    core::quaternion::flerp_interpolant_terms(interpolantPrecalcTerm2,interpolantPrecalcTerm3,interpolationFactor);
-
-
-                                    FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
-                                    for (size_t j=0; j<referenceHierarchy->getBoneCount(); j++)
+                                    if (notModified)
                                     {
-                                        if (boneDataForInstance[j].lastAnimatedFrame==currentInstance->frame)
-                                            continue;
-                                        if (notModified)
-                                        {
-                                            localFirstDirtyInstance = i;
-                                            firstBone = j;
-                                            notModified = false;
-                                        }
-                                        localLastDirtyInstance = i;
-                                        lastBone = j;
-                                        boneDataForInstance[j].lastAnimatedFrame = currentInstance->frame;
-
-                                        CFinalBoneHierarchy::AnimationKeyData upperFrame = (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx];
-
-                                        core::matrix4x3 interpolatedLocalTform;
-                                        if (currentInstance->interpolateAnimation&&interpolationFactor<1.f)
-                                        {
-                                            CFinalBoneHierarchy::AnimationKeyData lowerFrame =  (currentInstance->interpolateAnimation ? referenceHierarchy->getInterpolatedAnimationData(j):referenceHierarchy->getNonInterpolatedAnimationData(j))[foundBoneIx-1];
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKeys(lowerFrame,upperFrame,interpolationFactor,interpolantPrecalcTerm2,interpolantPrecalcTerm3).getAsRetardedIrrlichtMatrix();
-                                        }
-                                        else
-                                            interpolatedLocalTform = referenceHierarchy->getMatrixFromKey(upperFrame).getAsRetardedIrrlichtMatrix();
-
-                                        if (j < referenceHierarchy->getBoneLevelRangeEnd(0))
-                                            getGlobalMatrices(currentInstance)[j] = interpolatedLocalTform;
-                                        else
-                                        {
-                                            const core::matrix4x3& parentTform = getGlobalMatrices(currentInstance)[referenceHierarchy->getBoneData()[j].parentOffsetFromTop];
-                                            getGlobalMatrices(currentInstance)[j] = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(parentTform), core::matrix3x4SIMD().set(interpolatedLocalTform)).getAsRetardedIrrlichtMatrix();
-											//concatenateBFollowedByA(parentTform,interpolatedLocalTform);
-                                        }
-                                        boneDataForInstance[j].SkinningTransform = core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j]), core::matrix3x4SIMD().set(referenceHierarchy->getBoneData()[j].PoseBindMatrix)).getAsRetardedIrrlichtMatrix();
-										//concatenateBFollowedByA(getGlobalMatrices(currentInstance)[j],referenceHierarchy->getBoneData()[j].PoseBindMatrix);
-
-
-                                        core::aabbox3df bbox;
-                                        bbox.MinEdge.X = referenceHierarchy->getBoneData()[j].MinBBoxEdge[0];
-                                        bbox.MinEdge.Y = referenceHierarchy->getBoneData()[j].MinBBoxEdge[1];
-                                        bbox.MinEdge.Z = referenceHierarchy->getBoneData()[j].MinBBoxEdge[2];
-                                        bbox.MaxEdge.X = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[0];
-                                        bbox.MaxEdge.Y = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[1];
-                                        bbox.MaxEdge.Z = referenceHierarchy->getBoneData()[j].MaxBBoxEdge[2];
-                                        //boneDataForInstance[j].SkinningTransform.transformBoxEx(bbox);
-										bbox = core::transformBoxEx(bbox, core::matrix3x4SIMD().set(boneDataForInstance[j].SkinningTransform));
-                                        //
-                                        if (boneControlMode==EBUM_READ)
-                                        {
-                                            IBoneSceneNode* bone = getBones(currentInstance)[j];
-                                            if (bone)
-                                            {
-												if (bone->getSkinningSpace() != IBoneSceneNode::EBSS_LOCAL)
-													bone->setRelativeTransformationMatrix(core::matrix3x4SIMD::concatenateBFollowedByA(core::matrix3x4SIMD().set(attachedNodeTform), core::matrix3x4SIMD().set(getGlobalMatrices(currentInstance)[j])).getAsRetardedIrrlichtMatrix()/*concatenateBFollowedByA(attachedNodeTform,getGlobalMatrices(currentInstance)[j])*/);
-                                                else
-                                                {
-                                                    bone->setRelativeTransformationMatrix(interpolatedLocalTform);
-                                                    bone->updateAbsolutePosition();
-                                                }
-                                            }
-                                        }
-
-                                        boneDataForInstance[j].MinBBoxEdge[0] = bbox.MinEdge.X;
-                                        boneDataForInstance[j].MinBBoxEdge[1] = bbox.MinEdge.Y;
-                                        boneDataForInstance[j].MinBBoxEdge[2] = bbox.MinEdge.Z;
-                                        boneDataForInstance[j].MaxBBoxEdge[0] = bbox.MaxEdge.X;
-                                        boneDataForInstance[j].MaxBBoxEdge[1] = bbox.MaxEdge.Y;
-                                        boneDataForInstance[j].MaxBBoxEdge[2] = bbox.MaxEdge.Z;
-                                        boneDataForInstance[j].SkinningTransform.getSub3x3InverseTranspose(boneDataForInstance[j].SkinningNormalMatrix);
+                                        localFirstDirtyInstance = i;
+                                        firstBone = instanceDirtyBones[i*2u];
+                                        notModified = false;
                                     }
+                                    localLastDirtyInstance = i;
+                                    lastBone = instanceDirtyBones[i*2u+1u];
                                 }
 
                                 if (!notModified)
@@ -438,9 +605,10 @@ namespace scene
                                     for (size_t i=localFirstDirtyInstance; i<=localLastDirtyInstance; i++)
                                     {
                                         BoneHierarchyInstanceData* currentInstance = reinterpret_cast<BoneHierarchyInstanceData*>(instanceData+i*actualSizeOfInstanceDataElement);
-                                        if (currentInstance->frame==currentInstance->lastAnimatedFrame) //in other modes, check if also has no bones!!!
+                                        if (currentInstance->frame==currentInstance->lastAnimatedFrame&&!currentInstance->layersChanged) //in other modes, check if also has no bones!!!
                                             continue;
                                         currentInstance->lastAnimatedFrame = currentInstance->frame;
+                                        currentInstance->layersChanged = false;
 
                                         core::aabbox3df nodeBBox;
                                         FinalBoneData* boneDataForInstance = boneData+referenceHierarchy->getBoneCount()*i;
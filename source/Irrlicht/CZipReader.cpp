@@ -535,11 +535,11 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 		os::Printer::log("Reading encrypted file.");
 		uint8_t salt[16]={0};
 		const uint16_t saltSize = (((e.header.Sig & 0x00ff0000) >>16)+1)*4;
-		File->seek(e.Offset);
-		File->read(salt, saltSize);
+		size_t pos = e.Offset;
+		pos += File->readAt(pos, salt, saltSize);
 		char pwVerification[2];
 		char pwVerificationFile[2];
-		File->read(pwVerification, 2);
+		pos += File->readAt(pos, pwVerification, 2);
 		fcrypt_ctx zctx; // the encryption context
 		int rc = fcrypt_init(
 			(e.header.Sig & 0x00ff0000) >>16,
@@ -558,14 +558,14 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 		uint32_t c = 0;
 		while ((c+32768)<=decryptedSize)
 		{
-			File->read(decryptedBuf+c, 32768);
+			pos += File->readAt(pos, decryptedBuf+c, 32768);
 			fcrypt_decrypt(
 				decryptedBuf+c, // pointer to the data to decrypt
 				32768,   // how many bytes to decrypt
 				&zctx); // decryption context
 			c+=32768;
 		}
-		File->read(decryptedBuf+c, decryptedSize-c);
+		pos += File->readAt(pos, decryptedBuf+c, decryptedSize-c);
 		fcrypt_decrypt(
 			decryptedBuf+c, // pointer to the data to decrypt
 			decryptedSize-c,   // how many bytes to decrypt
@@ -582,7 +582,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 			delete [] decryptedBuf;
 			return 0;
 		}
-		File->read(fileMAC, 10);
+		File->readAt(pos, fileMAC, 10);
 		if (strncmp(fileMAC, resMAC, 10))
 		{
 			os::Printer::log("Error on encryption check");
@@ -643,8 +643,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				File->readAt(e.Offset, pcData, decryptedSize);
 			}
 
 			// Setup the inflate stream.
@@ -717,8 +716,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				File->readAt(e.Offset, pcData, decryptedSize);
 			}
 
 			bz_stream bz_ctx={0};
@@ -789,8 +787,7 @@ IReadFile* CZipReader::createAndOpenFile(uint32_t index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				File->readAt(e.Offset, pcData, decryptedSize);
 			}
 
 			ELzmaStatus status;
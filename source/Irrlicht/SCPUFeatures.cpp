@@ -0,0 +1,113 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "SCPUFeatures.h"
+#include "IrrCompileConfig.h"
+
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+void cpuid(const uint32_t& leaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+    int tmp[4];
+    __cpuidex(tmp,leaf,0);
+    for (uint32_t i=0; i<4; i++)
+        regs[i] = tmp[i];
+#else
+    __cpuid_count(leaf,0,regs[0],regs[1],regs[2],regs[3]);
+#endif
+}
+
+//! XCR0, tells which register sets the OS preserves across context switches.
+uint64_t readXCR0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t lo,hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (uint64_t(hi)<<32)|lo;
+#endif
+}
+#endif
+
+SCPUFeatures detectFeatures()
+{
+    SCPUFeatures retval;
+#ifdef __IRR_COMPILE_WITH_X86_SIMD_
+    uint32_t regs[4];
+    cpuid(0,regs);
+    const uint32_t maxLeaf = regs[0];
+    if (maxLeaf<1u)
+        return retval;
+
+    cpuid(1,regs);
+    retval.SSE2 = regs[3]&(1u<<26);
+    retval.SSE3 = regs[2]&(1u<<0);
+    retval.SSSE3 = regs[2]&(1u<<9);
+    retval.SSE4_1 = regs[2]&(1u<<19);
+
+    const bool osxsave = regs[2]&(1u<<27);
+    const bool osSavesYMM = osxsave&&(readXCR0()&0x6u)==0x6u;
+    retval.AVX = osSavesYMM&&(regs[2]&(1u<<28));
+    retval.FMA = retval.AVX&&(regs[2]&(1u<<12));
+
+    if (maxLeaf>=7u)
+    {
+        cpuid(7,regs);
+        retval.AVX2 = retval.AVX&&(regs[1]&(1u<<5));
+    }
+#endif
+    return retval;
+}
+
+SCPUFeatures& getAllowedFeatures()
+{
+    static SCPUFeatures allowed = SCPUFeatures::detect();
+    return allowed;
+}
+
+}
+
+const SCPUFeatures& SCPUFeatures::detect()
+{
+    static const SCPUFeatures detected = detectFeatures();
+    return detected;
+}
+
+const SCPUFeatures& SCPUFeatures::get()
+{
+    return getAllowedFeatures();
+}
+
+void SCPUFeatures::setAllowed(const SCPUFeatures& allowed)
+{
+    const SCPUFeatures& detected = detect();
+    SCPUFeatures& current = getAllowedFeatures();
+    current.SSE2 = allowed.SSE2&&detected.SSE2;
+    current.SSE3 = allowed.SSE3&&detected.SSE3;
+    current.SSSE3 = allowed.SSSE3&&detected.SSSE3;
+    current.SSE4_1 = allowed.SSE4_1&&detected.SSE4_1;
+    current.AVX = allowed.AVX&&detected.AVX;
+    current.AVX2 = allowed.AVX2&&detected.AVX2;
+    current.FMA = allowed.FMA&&detected.FMA;
+}
+
+} // end namespace core
+} // end namespace irr
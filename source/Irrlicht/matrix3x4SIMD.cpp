@@ -0,0 +1,386 @@
+// Copyright (C) 2017- Mateusz 'DevSH' Kielan
+// This file is part of the "IrrlichtBAW" engine.
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "SColor.h" // has to come before vectorSIMD.h, which matrix3x4SIMD.h pulls in
+#include "matrix3x4SIMD.h"
+#include "SCPUFeatures.h"
+
+#include <immintrin.h>
+
+//! The engine is only compiled for SSE3, the wider kernels get enabled per function and are only called after a CPUID check.
+#if defined(__GNUC__)||defined(__clang__)
+#define IRR_TARGET_AVX __attribute__((target("avx")))
+#define IRR_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#else
+#define IRR_TARGET_AVX
+#define IRR_TARGET_AVX2_FMA
+#endif
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+
+#define BROADCAST32(fpx) _MM_SHUFFLE(fpx, fpx, fpx, fpx)
+
+//! Every element of the matrix splatted across a register, for working on several items at once.
+struct SSplatMatrix
+{
+    SSplatMatrix(const matrix3x4SIMD& mtx)
+    {
+        for (size_t r=0; r<3; r++)
+        for (size_t c=0; c<4; c++)
+            m[r][c] = mtx.rows[r].pointer[c];
+    }
+
+    float m[3][4];
+};
+
+//! Same operation order as transformVect's horizontal adds, so the results match it.
+template<bool Translate>
+inline void transformOne(const SSplatMatrix& mtx, float* out, const float* in)
+{
+    const float x = in[0], y = in[1], z = in[2];
+    for (size_t r=0; r<3; r++)
+        out[r] = (mtx.m[r][0]*x+mtx.m[r][1]*y)+(Translate ? (mtx.m[r][2]*z+mtx.m[r][3]):(mtx.m[r][2]*z));
+}
+
+//! x0y0z0x1 y1z1x2y2 z2x3y3z3 to x0x1x2x3 y0y1y2y3 z0z1z2z3, works the same on every 128bit lane
+inline void deinterleave(const __m128& a, const __m128& b, const __m128& c, __m128& x, __m128& y, __m128& z)
+{
+    x = _mm_shuffle_ps(a,_mm_shuffle_ps(b,c,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(0,0,1,1)),_mm_shuffle_ps(b,c,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a,b,_MM_SHUFFLE(1,1,2,2)),c,_MM_SHUFFLE(3,0,2,0));
+}
+
+inline void interleave(const __m128& x, const __m128& y, const __m128& z, __m128& a, __m128& b, __m128& c)
+{
+    a = _mm_shuffle_ps(_mm_shuffle_ps(x,y,BROADCAST32(0)),_mm_shuffle_ps(z,x,_MM_SHUFFLE(1,1,0,0)),_MM_SHUFFLE(2,0,2,0));
+    b = _mm_shuffle_ps(_mm_shuffle_ps(y,z,BROADCAST32(1)),_mm_shuffle_ps(x,y,BROADCAST32(2)),_MM_SHUFFLE(2,0,2,0));
+    c = _mm_shuffle_ps(_mm_shuffle_ps(z,x,_MM_SHUFFLE(3,3,2,2)),_mm_shuffle_ps(y,z,BROADCAST32(3)),_MM_SHUFFLE(2,0,2,0));
+}
+
+IRR_TARGET_AVX inline void deinterleave(const __m256& a, const __m256& b, const __m256& c, __m256& x, __m256& y, __m256& z)
+{
+    x = _mm256_shuffle_ps(a,_mm256_shuffle_ps(b,c,_MM_SHUFFLE(1,1,2,2)),_MM_SHUFFLE(2,0,3,0));
+    y = _mm256_shuffle_ps(_mm256_shuffle_ps(a,b,_MM_SHUFFLE(0,0,1,1)),_mm256_shuffle_ps(b,c,_MM_SHUFFLE(2,2,3,3)),_MM_SHUFFLE(2,0,2,0));
+    z = _mm256_shuffle_ps(_mm256_shuffle_ps(a,b,_MM_SHUFFLE(1,1,2,2)),c,_MM_SHUFFLE(3,0,2,0));
+}
+
+IRR_TARGET_AVX inline void interleave(const __m256& x, const __m256& y, const __m256& z, __m256& a, __m256& b, __m256& c)
+{
+    a = _mm256_shuffle_ps(_mm256_shuffle_ps(x,y,BROADCAST32(0)),_mm256_shuffle_ps(z,x,_MM_SHUFFLE(1,1,0,0)),_MM_SHUFFLE(2,0,2,0));
+    b = _mm256_shuffle_ps(_mm256_shuffle_ps(y,z,BROADCAST32(1)),_mm256_shuffle_ps(x,y,BROADCAST32(2)),_MM_SHUFFLE(2,0,2,0));
+    c = _mm256_shuffle_ps(_mm256_shuffle_ps(z,x,_MM_SHUFFLE(3,3,2,2)),_mm256_shuffle_ps(y,z,BROADCAST32(3)),_MM_SHUFFLE(2,0,2,0));
+}
+
+//! Two unrelated 16 byte loads into the low and high lane
+IRR_TARGET_AVX inline __m256 loadPair(const float* lo, const float* hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)),_mm_loadu_ps(hi),1);
+}
+
+IRR_TARGET_AVX inline void storePair(float* lo, float* hi, const __m256& v)
+{
+    _mm_storeu_ps(lo,_mm256_castps256_ps128(v));
+    _mm_storeu_ps(hi,_mm256_extractf128_ps(v,1));
+}
+
+
+//! Points and normals, 4 or 8 at a time, return how many they did
+
+template<bool Translate>
+size_t transform_SSE(const SSplatMatrix& mtx, float* out, const float* in, const size_t& count)
+{
+    __m128 m[3][4];
+    for (size_t r=0; r<3; r++)
+    for (size_t c=0; c<4; c++)
+        m[r][c] = _mm_set1_ps(mtx.m[r][c]);
+
+    const size_t done = count&~size_t(3u);
+    for (size_t i=0; i<done; i+=4, in+=12, out+=12)
+    {
+        __m128 x,y,z;
+        deinterleave(_mm_loadu_ps(in),_mm_loadu_ps(in+4),_mm_loadu_ps(in+8),x,y,z);
+
+        __m128 res[3];
+        for (size_t r=0; r<3; r++)
+        {
+            const __m128 xy = _mm_add_ps(_mm_mul_ps(m[r][0],x),_mm_mul_ps(m[r][1],y));
+            const __m128 zw = Translate ? _mm_add_ps(_mm_mul_ps(m[r][2],z),m[r][3]):_mm_mul_ps(m[r][2],z);
+            res[r] = _mm_add_ps(xy,zw);
+        }
+
+        __m128 a,b,c;
+        interleave(res[0],res[1],res[2],a,b,c);
+        _mm_storeu_ps(out,a);
+        _mm_storeu_ps(out+4,b);
+        _mm_storeu_ps(out+8,c);
+    }
+    return done;
+}
+
+template<bool Translate>
+IRR_TARGET_AVX size_t transform_AVX(const SSplatMatrix& mtx, float* out, const float* in, const size_t& count)
+{
+    __m256 m[3][4];
+    for (size_t r=0; r<3; r++)
+    for (size_t c=0; c<4; c++)
+        m[r][c] = _mm256_set1_ps(mtx.m[r][c]);
+
+    const size_t done = count&~size_t(7u);
+    for (size_t i=0; i<done; i+=8, in+=24, out+=24)
+    {
+        __m256 x,y,z;
+        deinterleave(loadPair(in,in+12),loadPair(in+4,in+16),loadPair(in+8,in+20),x,y,z);
+
+        __m256 res[3];
+        for (size_t r=0; r<3; r++)
+        {
+            const __m256 xy = _mm256_add_ps(_mm256_mul_ps(m[r][0],x),_mm256_mul_ps(m[r][1],y));
+            const __m256 zw = Translate ? _mm256_add_ps(_mm256_mul_ps(m[r][2],z),m[r][3]):_mm256_mul_ps(m[r][2],z);
+            res[r] = _mm256_add_ps(xy,zw);
+        }
+
+        __m256 a,b,c;
+        interleave(res[0],res[1],res[2],a,b,c);
+        storePair(out,out+12,a);
+        storePair(out+4,out+16,b);
+        storePair(out+8,out+20,c);
+    }
+    return done;
+}
+
+template<bool Translate>
+IRR_TARGET_AVX2_FMA size_t transform_FMA(const SSplatMatrix& mtx, float* out, const float* in, const size_t& count)
+{
+    __m256 m[3][4];
+    for (size_t r=0; r<3; r++)
+    for (size_t c=0; c<4; c++)
+        m[r][c] = _mm256_set1_ps(mtx.m[r][c]);
+
+    const size_t done = count&~size_t(7u);
+    for (size_t i=0; i<done; i+=8, in+=24, out+=24)
+    {
+        __m256 x,y,z;
+        deinterleave(loadPair(in,in+12),loadPair(in+4,in+16),loadPair(in+8,in+20),x,y,z);
+
+        __m256 res[3];
+        for (size_t r=0; r<3; r++)
+        {
+            const __m256 xy = _mm256_fmadd_ps(m[r][1],y,_mm256_mul_ps(m[r][0],x));
+            const __m256 zw = Translate ? _mm256_fmadd_ps(m[r][2],z,m[r][3]):_mm256_mul_ps(m[r][2],z);
+            res[r] = _mm256_add_ps(xy,zw);
+        }
+
+        __m256 a,b,c;
+        interleave(res[0],res[1],res[2],a,b,c);
+        storePair(out,out+12,a);
+        storePair(out+4,out+16,b);
+        storePair(out+8,out+20,c);
+    }
+    return done;
+}
+
+template<bool Translate>
+void transformStream(const matrix3x4SIMD& _mtx, float* out, const float* in, const size_t& count)
+{
+    const SSplatMatrix mtx(_mtx);
+
+    const SCPUFeatures& cpu = SCPUFeatures::get();
+    size_t done;
+    if (cpu.AVX2&&cpu.FMA)
+        done = transform_FMA<Translate>(mtx,out,in,count);
+    else if (cpu.AVX)
+        done = transform_AVX<Translate>(mtx,out,in,count);
+    else
+        done = transform_SSE<Translate>(mtx,out,in,count);
+
+    for (size_t i=done; i<count; i++)
+        transformOne<Translate>(mtx,out+i*3,in+i*3);
+}
+
+
+//! Matrix concatenation, two pairs at a time with the wider registers, same operation order as matrix3x4SIMD::doJob
+
+IRR_TARGET_AVX size_t concatenate_AVX(matrix3x4SIMD* out, const matrix3x4SIMD* a, const matrix3x4SIMD* b, const size_t& count)
+{
+    const __m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(0,0,0,-1,0,0,0,-1));
+
+    const size_t done = count&~size_t(1u);
+    for (size_t i=0; i<done; i+=2)
+    {
+        const __m256 b0 = loadPair(b[i].rows[0].pointer,b[i+1].rows[0].pointer);
+        const __m256 b1 = loadPair(b[i].rows[1].pointer,b[i+1].rows[1].pointer);
+        const __m256 b2 = loadPair(b[i].rows[2].pointer,b[i+1].rows[2].pointer);
+
+        __m256 res[3];
+        for (size_t r=0; r<3; r++)
+        {
+            const __m256 ar = loadPair(a[i].rows[r].pointer,a[i+1].rows[r].pointer);
+            res[r] = _mm256_mul_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(0)),b0);
+            res[r] = _mm256_add_ps(res[r],_mm256_mul_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(1)),b1));
+            res[r] = _mm256_add_ps(res[r],_mm256_mul_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(2)),b2));
+            res[r] = _mm256_add_ps(res[r],_mm256_and_ps(ar,mask));
+        }
+
+        for (size_t r=0; r<3; r++)
+            storePair(out[i].rows[r].pointer,out[i+1].rows[r].pointer,res[r]);
+    }
+    return done;
+}
+
+IRR_TARGET_AVX2_FMA size_t concatenate_FMA(matrix3x4SIMD* out, const matrix3x4SIMD* a, const matrix3x4SIMD* b, const size_t& count)
+{
+    const __m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(0,0,0,-1,0,0,0,-1));
+
+    const size_t done = count&~size_t(1u);
+    for (size_t i=0; i<done; i+=2)
+    {
+        const __m256 b0 = loadPair(b[i].rows[0].pointer,b[i+1].rows[0].pointer);
+        const __m256 b1 = loadPair(b[i].rows[1].pointer,b[i+1].rows[1].pointer);
+        const __m256 b2 = loadPair(b[i].rows[2].pointer,b[i+1].rows[2].pointer);
+
+        __m256 res[3];
+        for (size_t r=0; r<3; r++)
+        {
+            const __m256 ar = loadPair(a[i].rows[r].pointer,a[i+1].rows[r].pointer);
+            res[r] = _mm256_mul_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(0)),b0);
+            res[r] = _mm256_fmadd_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(1)),b1,res[r]);
+            res[r] = _mm256_fmadd_ps(_mm256_shuffle_ps(ar,ar,BROADCAST32(2)),b2,res[r]);
+            res[r] = _mm256_add_ps(res[r],_mm256_and_ps(ar,mask));
+        }
+
+        for (size_t r=0; r<3; r++)
+            storePair(out[i].rows[r].pointer,out[i+1].rows[r].pointer,res[r]);
+    }
+    return done;
+}
+
+
+//! Boxes, same as transformBoxEx but picking each product with min/max instead of a select on the sign of the column,
+//! which gives the very same floats without any masks
+
+struct SBoxColumns
+{
+    SBoxColumns(const matrix3x4SIMD& mtx)
+    {
+        vectorSIMDf c0 = mtx.rows[0], c1 = mtx.rows[1], c2 = mtx.rows[2], c3 = vectorSIMDf(0.f, 0.f, 0.f, 1.f);
+        transpose4(c0, c1, c2, c3);
+
+        columns[0] = c0.getAsRegister();
+        columns[1] = c1.getAsRegister();
+        columns[2] = c2.getAsRegister();
+        columns[3] = c3.getAsRegister();
+    }
+
+    __m128 columns[4];
+};
+
+//! Loads [minX minY minZ maxX] and [maxX maxY maxZ maxZ] without reading past the box
+inline void loadBox(const aabbox3df& box, __m128& minPt, __m128& maxPt)
+{
+    const float* data = &box.MinEdge.X;
+    minPt = _mm_loadu_ps(data);
+    const __m128 tmp = _mm_loadu_ps(data+2);
+    maxPt = _mm_shuffle_ps(tmp,tmp,_MM_SHUFFLE(3,3,2,1));
+}
+
+//! Writes exactly the 6 floats of the box
+inline void storeBox(aabbox3df& box, const __m128& minPt, const __m128& maxPt)
+{
+    float* data = &box.MinEdge.X;
+    _mm_storeu_ps(data,_mm_shuffle_ps(minPt,_mm_shuffle_ps(minPt,maxPt,_MM_SHUFFLE(0,0,2,2)),_MM_SHUFFLE(2,0,1,0)));
+    _mm_storel_pi(reinterpret_cast<__m64*>(data+4),_mm_shuffle_ps(maxPt,maxPt,_MM_SHUFFLE(3,3,2,1)));
+}
+
+inline void transformBox_SSE(const SBoxColumns& mtx, aabbox3df& out, const aabbox3df& in)
+{
+    __m128 inMin, inMax;
+    loadBox(in,inMin,inMax);
+
+    const __m128* c = mtx.columns;
+    const __m128 x0 = _mm_mul_ps(c[0],_mm_shuffle_ps(inMin,inMin,BROADCAST32(0))), x1 = _mm_mul_ps(c[0],_mm_shuffle_ps(inMax,inMax,BROADCAST32(0)));
+    const __m128 y0 = _mm_mul_ps(c[1],_mm_shuffle_ps(inMin,inMin,BROADCAST32(1))), y1 = _mm_mul_ps(c[1],_mm_shuffle_ps(inMax,inMax,BROADCAST32(1)));
+    const __m128 z0 = _mm_mul_ps(c[2],_mm_shuffle_ps(inMin,inMin,BROADCAST32(2))), z1 = _mm_mul_ps(c[2],_mm_shuffle_ps(inMax,inMax,BROADCAST32(2)));
+    const __m128 lo[3] = {_mm_min_ps(x0,x1),_mm_min_ps(y0,y1),_mm_min_ps(z0,z1)};
+    const __m128 hi[3] = {_mm_max_ps(x0,x1),_mm_max_ps(y0,y1),_mm_max_ps(z0,z1)};
+
+    storeBox(out,_mm_add_ps(_mm_add_ps(_mm_add_ps(lo[0],lo[1]),lo[2]),c[3]),_mm_add_ps(_mm_add_ps(_mm_add_ps(hi[0],hi[1]),hi[2]),c[3]));
+}
+
+IRR_TARGET_AVX size_t transformBoxes_AVX(const SBoxColumns& mtx, aabbox3df* out, const aabbox3df* in, const size_t& count)
+{
+    __m256 c[4];
+    for (size_t k=0; k<4; k++)
+        c[k] = _mm256_broadcast_ps(&mtx.columns[k]);
+
+    const size_t done = count&~size_t(1u);
+    for (size_t i=0; i<done; i+=2)
+    {
+        const float* data0 = &in[i].MinEdge.X;
+        const float* data1 = &in[i+1].MinEdge.X;
+        const __m256 inMin = loadPair(data0,data1);
+        const __m256 tmp = loadPair(data0+2,data1+2);
+        const __m256 inMax = _mm256_shuffle_ps(tmp,tmp,_MM_SHUFFLE(3,3,2,1));
+
+        const __m256 x0 = _mm256_mul_ps(c[0],_mm256_shuffle_ps(inMin,inMin,BROADCAST32(0))), x1 = _mm256_mul_ps(c[0],_mm256_shuffle_ps(inMax,inMax,BROADCAST32(0)));
+        const __m256 y0 = _mm256_mul_ps(c[1],_mm256_shuffle_ps(inMin,inMin,BROADCAST32(1))), y1 = _mm256_mul_ps(c[1],_mm256_shuffle_ps(inMax,inMax,BROADCAST32(1)));
+        const __m256 z0 = _mm256_mul_ps(c[2],_mm256_shuffle_ps(inMin,inMin,BROADCAST32(2))), z1 = _mm256_mul_ps(c[2],_mm256_shuffle_ps(inMax,inMax,BROADCAST32(2)));
+        const __m256 lo[3] = {_mm256_min_ps(x0,x1),_mm256_min_ps(y0,y1),_mm256_min_ps(z0,z1)};
+        const __m256 hi[3] = {_mm256_max_ps(x0,x1),_mm256_max_ps(y0,y1),_mm256_max_ps(z0,z1)};
+        const __m256 outMin = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(lo[0],lo[1]),lo[2]),c[3]);
+        const __m256 outMax = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(hi[0],hi[1]),hi[2]),c[3]);
+
+        storeBox(out[i],_mm256_castps256_ps128(outMin),_mm256_castps256_ps128(outMax));
+        storeBox(out[i+1],_mm256_extractf128_ps(outMin,1),_mm256_extractf128_ps(outMax,1));
+    }
+    return done;
+}
+
+#undef BROADCAST32
+
+}
+
+void matrix3x4SIMD::transformPoints(const matrix3x4SIMD& _mtx, float* _out, const float* _in, size_t _count)
+{
+    transformStream<true>(_mtx,_out,_in,_count);
+}
+
+void matrix3x4SIMD::transformNormals(const matrix3x4SIMD& _mtx, float* _out, const float* _in, size_t _count)
+{
+    transformStream<false>(_mtx,_out,_in,_count);
+}
+
+void matrix3x4SIMD::concatenateBFollowedByA(matrix3x4SIMD* _out, const matrix3x4SIMD* _a, const matrix3x4SIMD* _b, size_t _count)
+{
+    const SCPUFeatures& cpu = SCPUFeatures::get();
+    size_t done = 0u;
+    if (cpu.AVX2&&cpu.FMA)
+        done = concatenate_FMA(_out,_a,_b,_count);
+    else if (cpu.AVX)
+        done = concatenate_AVX(_out,_a,_b,_count);
+
+    for (size_t i=done; i<_count; i++)
+        _out[i] = concatenateBFollowedByA(_a[i],_b[i]);
+}
+
+void matrix3x4SIMD::transformBoxes(const matrix3x4SIMD& _mtx, aabbox3df* _out, const aabbox3df* _in, size_t _count)
+{
+    const SBoxColumns mtx(_mtx);
+
+    //! no FMA variant, there is nothing to fuse with the min/max in between
+    size_t done = 0u;
+    if (SCPUFeatures::get().AVX)
+        done = transformBoxes_AVX(mtx,_out,_in,_count);
+
+    for (size_t i=done; i<_count; i++)
+        transformBox_SSE(mtx,_out[i],_in[i]);
+}
+
+} // end namespace core
+} // end namespace irr
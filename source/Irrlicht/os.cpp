@@ -209,24 +209,79 @@ namespace os
 	// The platform independent implementation of the printer
 	ILogger* Printer::Logger = 0;
 
+	//! the capture log() calls of this thread go to, if any
+	static thread_local Printer::LogCapture* tlsLogCapture = 0;
+
 	void Printer::log(const std::string& message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (tlsLogCapture)
+		{
+			LogCapture::SMessage m;
+			m.Text = message;
+			m.Level = ll;
+			m.HasHint = false;
+			tlsLogCapture->Messages.push_back(m);
+		}
+		else if (Logger)
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const std::wstring& message, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (tlsLogCapture)
+		{
+			LogCapture::SMessage m;
+			m.WideText = message;
+			m.Level = ll;
+			m.HasHint = false;
+			tlsLogCapture->Messages.push_back(m);
+		}
+		else if (Logger)
 			Logger->log(message, ll);
 	}
 
 	void Printer::log(const std::string& message, const std::string& hint, ELOG_LEVEL ll)
 	{
-		if (Logger)
+		if (tlsLogCapture)
+		{
+			LogCapture::SMessage m;
+			m.Text = message;
+			m.Hint = hint;
+			m.Level = ll;
+			m.HasHint = true;
+			tlsLogCapture->Messages.push_back(m);
+		}
+		else if (Logger)
 			Logger->log(message, hint, ll);
 	}
 
+	void Printer::LogCapture::begin()
+	{
+		Previous = tlsLogCapture;
+		tlsLogCapture = this;
+	}
+
+	void Printer::LogCapture::end()
+	{
+		tlsLogCapture = Previous;
+		Previous = 0;
+	}
+
+	void Printer::LogCapture::replay()
+	{
+		for (size_t i=0; i<Messages.size(); i++)
+		{
+			const SMessage& m = Messages[i];
+			if (m.HasHint)
+				Printer::log(m.Text, m.Hint, m.Level);
+			else if (m.WideText.size())
+				Printer::log(m.WideText, m.Level);
+			else
+				Printer::log(m.Text, m.Level);
+		}
+		Messages.clear();
+	}
+
 
 	// ------------------------------------------------------
 	// virtual timer implementation
@@ -12,6 +12,7 @@
 #include "path.h"
 #include "ILogger.h"
 #include "ITimer.h"
+#include <vector>
 
 namespace irr
 {
@@ -40,6 +41,35 @@ namespace os
 		static void log(const std::wstring& message, ELOG_LEVEL ll = ELL_INFORMATION);
 		static void log(const std::string& message, const std::string& hint, ELOG_LEVEL ll = ELL_INFORMATION);
 		static ILogger* Logger;
+
+		//! keeps what one thread logs between begin() and end(), to hand it to the Logger later on the thread which owns it
+		/** The Logger posts to the event receiver, which is not thread safe, so worker threads must not reach it directly. */
+		class LogCapture
+		{
+		public:
+			LogCapture() : Previous(0) {}
+
+			//! log() calls of the calling thread go into this capture until end()
+			void begin();
+			//! the calling thread logs to whatever it logged to before begin() again
+			void end();
+			//! passes the kept messages to the Logger in the order they were logged and forgets them
+			void replay();
+
+		private:
+			struct SMessage
+			{
+				std::string Text;
+				std::wstring WideText;
+				std::string Hint;
+				ELOG_LEVEL Level;
+				bool HasHint;
+			};
+			std::vector<SMessage> Messages;
+			LogCapture* Previous;
+
+			friend class Printer;
+		};
 	};
 
 
@@ -24,6 +24,11 @@
 //	Password string consisting of only hex digits. Must be 32 characters long.
 // -info
 // Prints mesh info to stdout.
+// -codec <thresholds|loadtime|size>
+//	How blobs get compressed: LZ4 or LZMA by blob size (default), or trial compressed with LZ4, LZ4HC, LZMA and the geometry coding keeping
+//	what loads the fastest or what is the smallest. The latter two print the codecs chosen and the projected load time.
+// -diskmbps <MB/s>
+//	Disk read bandwidth the loadtime codec selection assumes. Defaults to 200.
 // -optmesh <settings>
 //	If passed - mesh will be optimized before export. The option comes along with error metrics settings:
 //	Settings must be enclosed with curly (i.e. {}) braces and grouped in threes. Threes must be delimited with commas. Order of threes is irrelevant.
@@ -55,8 +60,9 @@ int main(int _optCnt, char** _options)
 	++_options;
 
 	irr::SIrrlichtCreationParameters params;
-	params.DriverType = video::EDT_OPENGL;
-	params.WindowSize = core::dimension2d<uint32_t>(128, 128);
+	params.DeviceType = EIDT_CONSOLE;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2d<uint32_t>(1, 1);
 	IrrlichtDevice* device = createDeviceEx(params);
 
 	if (!device)
@@ -75,6 +81,7 @@ int main(int _optCnt, char** _options)
 	bool optimizeMesh = 0;
 	bool printInfo = 0;
 	scene::CBAWMeshWriter::WriteProperties properties;
+	scene::CBAWMeshWriter::SCodecSelectionSummary summary;
 	scene::IMeshManipulator::SErrorMetric errMetrics[16];
 
 	srand(std::chrono::high_resolution_clock::now().time_since_epoch().count());
@@ -117,6 +124,31 @@ int main(int _optCnt, char** _options)
 				properties.relPath = _options[idx];
 				continue;
 			}
+			else if (idx+1 != _optCnt && core::equalsIgnoreCase("codec", _options[idx]+1))
+			{
+				++idx;
+				gatherWhat = EGT_UNDEFINED;
+				if (core::equalsIgnoreCase("thresholds", _options[idx]))
+					properties.codecSelection = scene::CBAWMeshWriter::ECS_THRESHOLDS;
+				else if (core::equalsIgnoreCase("loadtime", _options[idx]))
+					properties.codecSelection = scene::CBAWMeshWriter::ECS_MIN_LOAD_TIME;
+				else if (core::equalsIgnoreCase("size", _options[idx]))
+					properties.codecSelection = scene::CBAWMeshWriter::ECS_MIN_SIZE;
+				else
+					printf("Unknown codec selection \"%s\". Ignored.\n", _options[idx]);
+				continue;
+			}
+			else if (idx+1 != _optCnt && core::equalsIgnoreCase("diskmbps", _options[idx]+1))
+			{
+				++idx;
+				gatherWhat = EGT_UNDEFINED;
+				const double mbps = atof(_options[idx]);
+				if (mbps > 0.0)
+					properties.diskBytesPerSecond = mbps*1024.0*1024.0;
+				else
+					printf("Disk bandwidth must be positive. Ignored.\n");
+				continue;
+			}
 			else if (core::equalsIgnoreCase("info", _options[idx]+1))
 			{
 				gatherWhat = EGT_UNDEFINED;
@@ -239,11 +271,27 @@ int main(int _optCnt, char** _options)
             printFullMeshInfo(stdout, inmesh);
         }
 
-		if (usePwd)
+		const bool selectCodecs = properties.codecSelection != scene::CBAWMeshWriter::ECS_THRESHOLDS;
+		if (usePwd || selectCodecs)
+		{
+			if (!usePwd)
+				properties.encryptBlobBitField = scene::CBAWMeshWriter::EET_NOTHING;
+			properties.geometryCoding = selectCodecs;
+			properties.summary = selectCodecs ? &summary : NULL;
 			writer->writeMesh(outfile, inmesh, properties);
+		}
 		else
 			writer->writeMesh(outfile, inmesh, scene::EMWF_WRITE_COMPRESSED);
 
+		if (properties.summary)
+		{
+			const char* const codecNames[scene::CBAWMeshWriter::EBC_COUNT] = {"raw", "LZ4", "LZ4HC", "LZMA"};
+			printf("%s blob codecs:\n", outNames[i]);
+			for (uint32_t c = 0u; c < scene::CBAWMeshWriter::EBC_COUNT; ++c)
+				printf("\t%-6s %6u blobs %12llu bytes stored of %12llu\n", codecNames[c], summary.blobCount[c], (unsigned long long)summary.storedBytes[c], (unsigned long long)summary.decompressedBytes[c]);
+			printf("\t%u blobs geometry coded, projected load time %.2f ms\n", summary.geometryCodedBlobs, summary.projectedLoadTime*1000.0);
+		}
+
         smgr->getMeshCache()->removeMesh(inmesh);
 		outfile->drop();
 	}